@@ -0,0 +1,364 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisStrokeReplayBenchmark.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtMath>
+
+#include "kis_benchmark_values.h"
+
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_global.h>
+#include <kis_image.h>
+#include <kis_paint_layer.h>
+#include <kis_paint_device.h>
+#include <kis_undo_stores.h>
+#include <kis_distance_information.h>
+#include <brushengine/kis_paint_information.h>
+#include <brushengine/kis_paintop_preset.h>
+
+#include <KisGlobalResourcesInterface.h>
+#include <KisAsynchronousStrokeUpdateHelper.h>
+#include <kis_resources_snapshot.h>
+#include <strokes/KisFreehandStrokeInfo.h>
+#include <strokes/freehand_stroke.h>
+
+#include "stroke_testing_utils.h"
+
+namespace {
+
+/**
+ * The baseline comparison reports a regression when the throughput
+ * drops or the latency grows more than by this fraction
+ */
+const qreal regressionThreshold = 0.1;
+
+QStringList defaultPresets()
+{
+    return {
+        "autobrush_300px.kpp",
+        "softbrush_30px.kpp",
+        "roundmarker40px.kpp",
+        "colorsmudge.kpp",
+        "hairybrush_thesis30px1.kpp",
+        "spray_30px21rasterParticles.kpp",
+        "dyna301.kpp",
+        "deform-default.kpp",
+        "experimental.kpp"
+    };
+}
+
+struct ReplayMeasurements
+{
+    QElapsedTimer timer;
+
+    QMutex mutex;
+    QVector<qint64> eventFinishTimes;
+    int numDabs = 0;
+};
+
+/**
+ * The freehand stroke that timestamps the input events itself: an event
+ * is considered finished when the update queued after it has issued the
+ * rendering of its dabs. No jobs are added to the stroke for measuring,
+ * so the concurrency of the paintops is the same as on the canvas.
+ */
+class TimestampingFreehandStrokeStrategy : public FreehandStrokeStrategy
+{
+public:
+    TimestampingFreehandStrokeStrategy(KisResourcesSnapshotSP resources,
+                                       KisFreehandStrokeInfo *strokeInfo,
+                                       ReplayMeasurements *measurements)
+        : FreehandStrokeStrategy(resources, strokeInfo, kundo2_noi18n("Stroke Replay")),
+          m_strokeInfo(strokeInfo),
+          m_measurements(measurements)
+    {
+    }
+
+    void doStrokeCallback(KisStrokeJobData *data) override {
+        FreehandStrokeStrategy::doStrokeCallback(data);
+
+        KisAsynchronousStrokeUpdateHelper::UpdateData *d =
+            dynamic_cast<KisAsynchronousStrokeUpdateHelper::UpdateData*>(data);
+
+        if (d && !d->forceUpdate) {
+            const qint64 time = m_measurements->timer.nsecsElapsed();
+
+            QMutexLocker l(&m_measurements->mutex);
+            m_measurements->eventFinishTimes << time;
+        }
+    }
+
+    void finishStrokeCallback() override {
+        {
+            // the distance information belongs to the stroke strategy
+            QMutexLocker l(&m_measurements->mutex);
+            m_measurements->numDabs += m_strokeInfo->dragDistance->currentDabSeqNo();
+        }
+
+        FreehandStrokeStrategy::finishStrokeCallback();
+    }
+
+private:
+    KisFreehandStrokeInfo *m_strokeInfo;
+    ReplayMeasurements *m_measurements;
+};
+
+qreal percentile(QVector<qint64> values, qreal fraction)
+{
+    if (values.isEmpty()) return 0.0;
+
+    std::sort(values.begin(), values.end());
+    const int index = qBound(0, qCeil(fraction * values.size()) - 1, values.size() - 1);
+    return values[index];
+}
+
+}
+
+void KisStrokeReplayBenchmark::initTestCase()
+{
+    m_canvasSize = QSize(TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT);
+
+    const QString canvasSize = qEnvironmentVariable("KRITA_REPLAY_CANVAS");
+    if (!canvasSize.isEmpty()) {
+        const QStringList parts = canvasSize.split('x');
+        if (parts.size() == 2 && parts[0].toInt() > 0 && parts[1].toInt() > 0) {
+            m_canvasSize = QSize(parts[0].toInt(), parts[1].toInt());
+        } else {
+            qWarning() << "KRITA_REPLAY_CANVAS should have the form WIDTHxHEIGHT:" << canvasSize;
+        }
+    }
+
+    const QString recordingPath = qEnvironmentVariable("KRITA_REPLAY_RECORDING");
+    if (!recordingPath.isEmpty()) {
+        QStringList files;
+
+        if (QFileInfo(recordingPath).isDir()) {
+            QDir dir(recordingPath);
+            Q_FOREACH (const QString &fileName, dir.entryList({"*.ksir"}, QDir::Files, QDir::Name)) {
+                files << dir.filePath(fileName);
+            }
+        } else {
+            files << recordingPath;
+        }
+
+        Q_FOREACH (const QString &fileName, files) {
+            KisStrokeInputRecording recording;
+            if (recording.load(fileName) && !recording.isEmpty()) {
+                m_recordings << recording;
+            }
+        }
+
+        QVERIFY2(!m_recordings.isEmpty(), "No stroke recordings could be loaded");
+    } else {
+        createSyntheticRecording();
+    }
+
+    const QString baselinePath = qEnvironmentVariable("KRITA_REPLAY_BASELINE");
+    if (!baselinePath.isEmpty()) {
+        QFile file(baselinePath);
+        if (file.open(QIODevice::ReadOnly)) {
+            m_baseline = QJsonDocument::fromJson(file.readAll()).object();
+        } else {
+            qWarning() << "Failed to open the baseline" << baselinePath;
+        }
+    }
+}
+
+void KisStrokeReplayBenchmark::createSyntheticRecording()
+{
+    /**
+     * A loop over the canvas sampled at 200Hz, which is what a typical
+     * tablet reports, with varying pressure and tilt
+     */
+    KisStrokeInputRecording recording;
+
+    const int numSamples = 1000;
+    const qreal interval = 5.0;
+    const QPointF center(0.5 * m_canvasSize.width(), 0.5 * m_canvasSize.height());
+    const qreal radius = 0.35 * qMin(m_canvasSize.width(), m_canvasSize.height());
+
+    QPointF prevPos;
+
+    for (int i = 0; i < numSamples; i++) {
+        const qreal t = qreal(i) / (numSamples - 1);
+        const qreal angle = 4 * M_PI * t;
+
+        KisStrokeInputRecording::Sample sample;
+        sample.pos = center + radius * QPointF(std::cos(angle), 0.6 * std::sin(2 * angle));
+        sample.pressure = 0.2 + 0.8 * std::sin(M_PI * t);
+        sample.xTilt = 40.0 * std::cos(angle);
+        sample.yTilt = 20.0 * std::sin(angle);
+        sample.time = i * interval;
+        sample.speed = i > 0 ? kisDistance(sample.pos, prevPos) / interval : 0.0;
+
+        prevPos = sample.pos;
+        recording.addSample(sample);
+    }
+
+    m_recordings << recording;
+}
+
+void KisStrokeReplayBenchmark::cleanupTestCase()
+{
+    const QString fileName = QString(FILES_OUTPUT_DIR) + '/' + "stroke_replay_results.json";
+
+    QFile file(fileName);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        file.write(QJsonDocument(m_results).toJson());
+        qDebug() << "Results are saved into" << fileName;
+    } else {
+        qWarning() << "Failed to save the results into" << fileName;
+    }
+}
+
+void KisStrokeReplayBenchmark::testReplay_data()
+{
+    QTest::addColumn<QString>("presetFileName");
+
+    QStringList presets = defaultPresets();
+
+    const QString presetsList = qEnvironmentVariable("KRITA_REPLAY_PRESETS");
+    if (!presetsList.isEmpty()) {
+        presets = presetsList.split(';', Qt::SkipEmptyParts);
+    }
+
+    Q_FOREACH (const QString &preset, presets) {
+        QTest::newRow(QFileInfo(preset).completeBaseName().toLatin1()) << preset;
+    }
+}
+
+void KisStrokeReplayBenchmark::testReplay()
+{
+    QFETCH(QString, presetFileName);
+
+    const QString presetPath = QFileInfo(presetFileName).isAbsolute() ?
+        presetFileName : QString(FILES_DATA_DIR) + '/' + presetFileName;
+
+    KisPaintOpPresetSP preset(new KisPaintOpPreset(presetPath));
+    QVERIFY2(preset->load(KisGlobalResourcesInterface::instance()),
+             qPrintable(QString("Failed to load the preset %1").arg(presetPath)));
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(new KisSurrogateUndoStore(), m_canvasSize.width(), m_canvasSize.height(), cs, "stroke replay image");
+    KisPaintLayerSP layer = new KisPaintLayer(image, "replay", OPACITY_OPAQUE_U8, cs);
+    image->addNode(layer);
+
+    QScopedPointer<KoCanvasResourceProvider> manager(utils::createResourceManager(image, layer, QString()));
+    manager->setResource(KoCanvasResource::CurrentPaintOpPreset, QVariant::fromValue(preset));
+
+    int numDabs = 0;
+    int numEvents = 0;
+    qint64 totalTime = 0;
+    QVector<qint64> eventTimes;
+
+    QBENCHMARK_ONCE {
+        Q_FOREACH (const KisStrokeInputRecording &recording, m_recordings) {
+            KisResourcesSnapshotSP resources = new KisResourcesSnapshot(image, layer, manager.data());
+
+            /**
+             * The recording is painted by a real freehand stroke, so the
+             * paintops that render their dabs asynchronously (and the
+             * ones splitting the work into concurrent jobs) are measured
+             * with the update scheduler, the same way as on the canvas.
+             *
+             * The events are queued all at once, the difference between
+             * the finishing times of two events is the time the stroke
+             * spent on the latter one.
+             */
+            ReplayMeasurements measurements;
+
+            KisFreehandStrokeInfo *strokeInfo = new KisFreehandStrokeInfo();
+            KisStrokeId strokeId =
+                image->startStroke(new TimestampingFreehandStrokeStrategy(resources, strokeInfo, &measurements));
+
+            measurements.timer.start();
+
+            image->addJob(strokeId, new FreehandStrokeStrategy::Data(0, recording.paintInformation(0)));
+            image->addJob(strokeId, new KisAsynchronousStrokeUpdateHelper::UpdateData(false));
+
+            for (int i = 1; i < recording.size(); i++) {
+                image->addJob(strokeId,
+                              new FreehandStrokeStrategy::Data(0,
+                                                               recording.paintInformation(i - 1),
+                                                               recording.paintInformation(i)));
+                image->addJob(strokeId, new KisAsynchronousStrokeUpdateHelper::UpdateData(false));
+            }
+
+            image->addJob(strokeId, new KisAsynchronousStrokeUpdateHelper::UpdateData(true));
+            image->endStroke(strokeId);
+            image->waitForDone();
+
+            totalTime += measurements.timer.nsecsElapsed();
+
+            qint64 lastEventFinished = 0;
+            Q_FOREACH (qint64 time, measurements.eventFinishTimes) {
+                eventTimes << time - lastEventFinished;
+                lastEventFinished = time;
+            }
+
+            numDabs += measurements.numDabs;
+            numEvents += recording.size();
+        }
+    }
+
+    const qreal totalMs = totalTime / 1e6;
+    const qreal dabsPerSecond = totalTime > 0 ? numDabs / (totalTime / 1e9) : 0.0;
+    const qreal meanLatencyMs = !eventTimes.isEmpty() ?
+        std::accumulate(eventTimes.constBegin(), eventTimes.constEnd(), qint64(0)) / 1e6 / eventTimes.size() : 0.0;
+    const qreal p95LatencyMs = percentile(eventTimes, 0.95) / 1e6;
+    const qreal maxLatencyMs = percentile(eventTimes, 1.0) / 1e6;
+
+    qDebug().noquote()
+        << QString("%1: %2 events, %3 dabs in %4 ms, %5 dabs/s, latency mean %6 ms, p95 %7 ms, max %8 ms")
+           .arg(preset->name()).arg(numEvents).arg(numDabs)
+           .arg(totalMs, 0, 'f', 1).arg(dabsPerSecond, 0, 'f', 0)
+           .arg(meanLatencyMs, 0, 'f', 3).arg(p95LatencyMs, 0, 'f', 3).arg(maxLatencyMs, 0, 'f', 3);
+
+    QJsonObject result;
+    result["events"] = numEvents;
+    result["dabs"] = numDabs;
+    result["totalMs"] = totalMs;
+    result["dabsPerSecond"] = dabsPerSecond;
+    result["meanLatencyMs"] = meanLatencyMs;
+    result["p95LatencyMs"] = p95LatencyMs;
+    result["maxLatencyMs"] = maxLatencyMs;
+
+    const QString key = QTest::currentDataTag();
+    m_results[key] = result;
+
+    if (m_baseline.contains(key)) {
+        const QJsonObject baseline = m_baseline[key].toObject();
+        const qreal baseDabsPerSecond = baseline["dabsPerSecond"].toDouble();
+        const qreal baseP95LatencyMs = baseline["p95LatencyMs"].toDouble();
+
+        qDebug().noquote()
+            << QString("%1: dabs/s %2% vs. baseline, p95 latency %3% vs. baseline")
+               .arg(preset->name())
+               .arg(baseDabsPerSecond > 0 ? 100.0 * (dabsPerSecond / baseDabsPerSecond - 1.0) : 0.0, 0, 'f', 1)
+               .arg(baseP95LatencyMs > 0 ? 100.0 * (p95LatencyMs / baseP95LatencyMs - 1.0) : 0.0, 0, 'f', 1);
+
+        if (dabsPerSecond < (1.0 - regressionThreshold) * baseDabsPerSecond ||
+            p95LatencyMs > (1.0 + regressionThreshold) * baseP95LatencyMs) {
+
+            qWarning().noquote() << QString("Performance regression in %1").arg(preset->name());
+        }
+    }
+}
+
+SIMPLE_TEST_MAIN(KisStrokeReplayBenchmark)
@@ -0,0 +1,61 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISSTROKEREPLAYBENCHMARK_H
+#define KISSTROKEREPLAYBENCHMARK_H
+
+#include <simpletest.h>
+
+#include <QJsonObject>
+
+#include <kis_types.h>
+#include <brushengine/KisStrokeInputRecording.h>
+
+/**
+ * Replays recorded tablet input against the paintop presets.
+ *
+ * The input is recorded by Krita itself when "Performance tracing of
+ * brush strokes" is enabled in the settings: every stroke is saved into
+ * log/<preset>.stroke-input-N.ksir, together with the preset.
+ *
+ * The benchmark is configured with the environment variables:
+ *
+ * KRITA_REPLAY_RECORDING  a .ksir file or a folder with .ksir files;
+ *                         if not set, a synthetic stroke is used
+ * KRITA_REPLAY_PRESETS    a list of .kpp files separated by ';' (paths
+ *                         relative to the benchmarks data folder are
+ *                         allowed); if not set, one preset per engine
+ *                         from the data folder is used
+ * KRITA_REPLAY_CANVAS     the size of the canvas, e.g. "4000x3000"
+ * KRITA_REPLAY_BASELINE   the results file of a previous run to
+ *                         compare with
+ *
+ * The results are saved into stroke_replay_results.json in the output
+ * folder of the benchmarks.
+ */
+class KisStrokeReplayBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testReplay_data();
+    void testReplay();
+
+private:
+    void createSyntheticRecording();
+
+private:
+    QVector<KisStrokeInputRecording> m_recordings;
+    QSize m_canvasSize;
+
+    QJsonObject m_baseline;
+    QJsonObject m_results;
+};
+
+#endif // KISSTROKEREPLAYBENCHMARK_H
@@ -6,8 +6,14 @@
 
 #include "kis_qimage_pyramid.h"
 
+#include <cmath>
 #include <limits>
+#include <QCache>
+#include <QGlobalStatic>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QPainter>
+#include <QtMath>
 #include <kis_debug.h>
 
 #define MIPMAP_SIZE_THRESHOLD 512
@@ -15,12 +21,103 @@
 
 #define QPAINTER_WORKAROUND_BORDER 1
 
+/**
+ * Transformed images with less pixels than this are not cached: they are
+ * cheap to render and are generated with the exact rotation and subpixel
+ * offset.
+ */
+#define TRANSFORM_CACHE_MIN_PIXELS (256 * 256)
+
+/**
+ * The memory budget shared by the transform caches of all the pyramids
+ */
+#define TRANSFORM_CACHE_MAX_BYTES (256 * 1024 * 1024)
+
+/**
+ * Quantization of the subpixel offset of the cached images. The rotation
+ * is quantized so that the farthest pixel of the tip moves by not more
+ * than one subpixel step between two neighbouring angles, i.e. the error
+ * of the rotation is not bigger than the error of the subpixel offset.
+ */
+#define TRANSFORM_CACHE_SUBPIXEL_STEPS 8
+
+namespace {
+
+struct TransformCacheKey {
+    const void *owner;
+    int level;
+    qreal scaleX;
+    qreal scaleY;
+    int angleBin;
+    int subPixelXBin;
+    int subPixelYBin;
+    QSize size;
+
+    bool operator==(const TransformCacheKey &rhs) const {
+        return owner == rhs.owner &&
+            level == rhs.level &&
+            scaleX == rhs.scaleX &&
+            scaleY == rhs.scaleY &&
+            angleBin == rhs.angleBin &&
+            subPixelXBin == rhs.subPixelXBin &&
+            subPixelYBin == rhs.subPixelYBin &&
+            size == rhs.size;
+    }
+
+    friend inline uint qHash(const TransformCacheKey &key, uint seed = 0) {
+        return ::qHash(key.owner, seed) ^
+            ::qHash(key.level, seed + 3) ^
+            ::qHash(key.scaleX, seed) ^
+            ::qHash(key.scaleY, seed + 1) ^
+            ::qHash(key.angleBin, seed + 2) ^
+            ::qHash(key.subPixelXBin | (key.subPixelYBin << 8), seed) ^
+            ::qHash(key.size.width() | (key.size.height() << 16), seed);
+    }
+};
+
+struct GlobalTransformCache
+{
+    GlobalTransformCache()
+        : images(TRANSFORM_CACHE_MAX_BYTES)
+    {
+    }
+
+    QMutex mutex;
+    QCache<TransformCacheKey, QImage> images;
+};
+
+Q_GLOBAL_STATIC(GlobalTransformCache, s_transformCache)
+
+}
+
+/**
+ * Identifies the images of the pyramid (and all its copies) in the
+ * global cache and drops them when the last copy is destroyed
+ */
+struct KisQImagePyramid::TransformCache
+{
+    ~TransformCache() {
+        if (s_transformCache.isDestroyed()) return;
+
+        QMutexLocker l(&s_transformCache->mutex);
+
+        Q_FOREACH (const TransformCacheKey &key, s_transformCache->images.keys()) {
+            if (key.owner == this) {
+                s_transformCache->images.remove(key);
+            }
+        }
+    }
+};
+
 
 KisQImagePyramid::KisQImagePyramid(const QImage &baseImage, bool useSmoothingForEnlarging)
 {
     KIS_SAFE_ASSERT_RECOVER_RETURN(!baseImage.isNull());
 
     m_originalSize = baseImage.size();
+    m_originalImage = baseImage;
+    m_useSmoothingForEnlarging = useSmoothingForEnlarging;
+    m_transformCache.reset(new TransformCache());
 
 
     qreal scale = MAX_MIPMAP_SCALE;
@@ -238,6 +335,9 @@ QSizeF KisQImagePyramid::characteristicSize(const QSize &originalSize,
 void KisQImagePyramid::appendPyramidLevel(const QImage &image)
 {
     /**
+     * The levels are stored premultiplied: QPainter converts every fetched
+     * pixel into premultiplied form anyway, so we do that only once.
+     *
      * QPainter has a bug: when doing a transformation it decides that
      * all the pixels outside of the image (source rect) are equal to
      * the border pixels (CLAMP in terms of openGL). This means that
@@ -247,9 +347,9 @@ void KisQImagePyramid::appendPyramidLevel(const QImage &image)
      *
      * See a unittest in: KisGbrBrushTest::testQPainterTransformationBorder
      */
-    
-QSize levelSize = image.size();
-    QImage tmp = image.convertToFormat(QImage::Format_ARGB32);
+
+    QSize levelSize = image.size();
+    QImage tmp = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
     tmp = tmp.copy(-QPAINTER_WORKAROUND_BORDER,
                    -QPAINTER_WORKAROUND_BORDER,
                    image.width() + 2 * QPAINTER_WORKAROUND_BORDER,
@@ -257,6 +357,37 @@ QSize levelSize = image.size();
     m_levels.append(PyramidLevel(tmp, levelSize));
 }
 
+QImage KisQImagePyramid::renderLevel(const QImage &srcImage, QTransform transform, const QSize &dstSize)
+{
+    QImage dstImage(dstSize, QImage::Format_ARGB32_Premultiplied);
+    dstImage.fill(0);
+
+
+    /**
+     * QPainter has one more bug: when a QTransform is TxTranslate, it
+     * does wrong sampling (probably, Nearest Neighbour) even though
+     * we tell it directly that we need SmoothPixmapTransform.
+     *
+     * So here is a workaround: we set a negligible scale to convince
+     * Qt we use a non-only-translating transform.
+     */
+    while (transform.type() == QTransform::TxTranslate) {
+        const qreal scale = transform.m11();
+        const qreal fakeScale = scale - 10 * std::numeric_limits<qreal>::epsilon();
+        transform *= QTransform::fromScale(fakeScale, fakeScale);
+    }
+
+    QPainter gc(&dstImage);
+    gc.setTransform(
+        QTransform::fromTranslate(-QPAINTER_WORKAROUND_BORDER,
+                                  -QPAINTER_WORKAROUND_BORDER) * transform);
+    gc.setRenderHints(QPainter::SmoothPixmapTransform);
+    gc.drawImage(QPointF(), srcImage);
+    gc.end();
+
+    return dstImage.convertToFormat(QImage::Format_ARGB32);
+}
+
 QImage KisQImagePyramid::createImage(KisDabShape const& shape,
                                      qreal subPixelX, qreal subPixelY) const
 {
@@ -274,40 +405,142 @@ QImage KisQImagePyramid::createImage(KisDabShape const& shape,
                     m_originalSize, baseScale, m_levels[level].size,
                     &transform, &dstSize);
 
-    if (transform.isIdentity() &&
-            srcImage.format() == QImage::Format_ARGB32) {
+    if (transform.isIdentity()) {
+        return exactLevelImage(level);
+    }
+
+    if (!m_transformCache ||
+        qint64(dstSize.width()) * dstSize.height() < TRANSFORM_CACHE_MIN_PIXELS) {
 
-        return srcImage.copy(QPAINTER_WORKAROUND_BORDER,
-                             QPAINTER_WORKAROUND_BORDER,
-                             srcImage.width() - 2 * QPAINTER_WORKAROUND_BORDER,
-                             srcImage.height() - 2 * QPAINTER_WORKAROUND_BORDER);
+        return renderLevel(srcImage, transform, dstSize);
     }
 
-    QImage dstImage(dstSize, QImage::Format_ARGB32);
-    dstImage.fill(0);
+    /**
+     * Big brush tips are expensive to transform, and with rotation
+     * jitter every dab would need a new transformation. So we quantize
+     * the rotation and the subpixel offset and keep the results in the
+     * cache. The size of the image is still calculated from the exact
+     * parameters, so it is consistent with imageSize().
+     */
 
+    const QSizeF scaledSize(m_originalSize.width() * shape.scaleX(),
+                            m_originalSize.height() * shape.scaleY());
+    const qreal radius = 0.5 * std::hypot(scaledSize.width(), scaledSize.height());
+    const int angleSteps = qMax(4, qCeil(2 * M_PI * radius * TRANSFORM_CACHE_SUBPIXEL_STEPS));
+    const qreal angleStep = 2 * M_PI / angleSteps;
+    const qreal rotation = qIsNaN(shape.rotation()) ? 0.0 : shape.rotation();
+
+    TransformCacheKey key;
+    key.owner = m_transformCache.data();
+    key.level = level;
+    key.scaleX = shape.scaleX();
+    key.scaleY = shape.scaleY();
+    key.angleBin = qRound(rotation / angleStep) % angleSteps;
+    if (key.angleBin < 0) {
+        key.angleBin += angleSteps;
+    }
 
     /**
-     * QPainter has one more bug: when a QTransform is TxTranslate, it
-     * does wrong sampling (probably, Nearest Neighbour) even though
-     * we tell it directly that we need SmoothPixmapTransform.
-     *
-     * So here is a workaround: we set a negligible scale to convince
-     * Qt we use a non-only-translating transform.
+     * The offsets close to one pixel are rounded up to the next pixel
+     * instead of being clamped to the last subpixel step. The image is
+     * rendered with zero offset then and shifted by one pixel. The size
+     * of the image has been calculated for the bigger offset, so there
+     * is enough space for the shift.
      */
-    while (transform.type() == QTransform::TxTranslate) {
-        const qreal scale = transform.m11();
-        const qreal fakeScale = scale - 10 * std::numeric_limits<qreal>::epsilon();
-        transform *= QTransform::fromScale(fakeScale, fakeScale);
+    key.subPixelXBin = qRound(subPixelX * TRANSFORM_CACHE_SUBPIXEL_STEPS);
+    key.subPixelYBin = qRound(subPixelY * TRANSFORM_CACHE_SUBPIXEL_STEPS);
+
+    const int shiftX = key.subPixelXBin / TRANSFORM_CACHE_SUBPIXEL_STEPS;
+    const int shiftY = key.subPixelYBin / TRANSFORM_CACHE_SUBPIXEL_STEPS;
+    KIS_SAFE_ASSERT_RECOVER_NOOP(shiftX >= 0 && shiftX <= 1);
+    KIS_SAFE_ASSERT_RECOVER_NOOP(shiftY >= 0 && shiftY <= 1);
+
+    key.subPixelXBin %= TRANSFORM_CACHE_SUBPIXEL_STEPS;
+    key.subPixelYBin %= TRANSFORM_CACHE_SUBPIXEL_STEPS;
+    key.size = dstSize;
+
+    auto shiftImage = [shiftX, shiftY] (const QImage &image) {
+        return shiftX || shiftY ?
+            image.copy(-shiftX, -shiftY, image.width(), image.height()) :
+            image;
+    };
+
+    {
+        QMutexLocker l(&s_transformCache->mutex);
+        QImage *cachedImage = s_transformCache->images.object(key);
+        if (cachedImage) {
+            return shiftImage(*cachedImage);
+        }
     }
 
-    QPainter gc(&dstImage);
-    gc.setTransform(
-        QTransform::fromTranslate(-QPAINTER_WORKAROUND_BORDER,
-                                  -QPAINTER_WORKAROUND_BORDER) * transform);
-    gc.setRenderHints(QPainter::SmoothPixmapTransform);
-    gc.drawImage(QPointF(), srcImage);
-    gc.end();
+    const KisDabShape quantizedShape(shape.scale(), shape.ratio(), key.angleBin * angleStep);
+
+    QSize unusedSize;
+    calculateParams(quantizedShape,
+                    qreal(key.subPixelXBin) / TRANSFORM_CACHE_SUBPIXEL_STEPS,
+                    qreal(key.subPixelYBin) / TRANSFORM_CACHE_SUBPIXEL_STEPS,
+                    m_originalSize, baseScale, m_levels[level].size,
+                    &transform, &unusedSize);
+
+    const QImage dstImage = renderLevel(srcImage, transform, dstSize);
+
+    {
+        QMutexLocker l(&s_transformCache->mutex);
+        s_transformCache->images.insert(key, new QImage(dstImage), dstImage.sizeInBytes());
+    }
+
+    return shiftImage(dstImage);
+}
+
+QImage KisQImagePyramid::exactLevelImage(int level) const
+{
+    /**
+     * The levels are stored premultiplied, and converting them back
+     * loses the precision of the semi-transparent pixels. So the
+     * level is generated from the original image instead, the same
+     * way it was generated in the constructor.
+     */
+
+    const QSize levelSize = m_levels[level].size;
+
+    if (levelSize == m_originalSize) {
+        return m_originalImage.convertToFormat(QImage::Format_ARGB32);
+    }
+
+    TransformCacheKey key;
+    key.owner = m_transformCache.data();
+    key.level = level;
+    key.scaleX = 1.0;
+    key.scaleY = 1.0;
+    key.angleBin = -1;
+    key.subPixelXBin = 0;
+    key.subPixelYBin = 0;
+    key.size = levelSize;
+
+    const bool useCache =
+        m_transformCache &&
+        qint64(levelSize.width()) * levelSize.height() >= TRANSFORM_CACHE_MIN_PIXELS;
+
+    if (useCache) {
+        QMutexLocker l(&s_transformCache->mutex);
+        QImage *cachedImage = s_transformCache->images.object(key);
+        if (cachedImage) {
+            return *cachedImage;
+        }
+    }
+
+    const bool isEnlarged = levelSize.width() > m_originalSize.width();
+
+    const QImage dstImage =
+        m_originalImage.scaled(levelSize, Qt::IgnoreAspectRatio,
+                               !isEnlarged || m_useSmoothingForEnlarging ?
+                                   Qt::SmoothTransformation : Qt::FastTransformation)
+            .convertToFormat(QImage::Format_ARGB32);
+
+    if (useCache) {
+        QMutexLocker l(&s_transformCache->mutex);
+        s_transformCache->images.insert(key, new QImage(dstImage), dstImage.sizeInBytes());
+    }
 
     return dstImage;
 }
@@ -9,6 +9,7 @@
 
 #include <QImage>
 #include <QVector>
+#include <QSharedPointer>
 #include <kis_dab_shape.h>
 #include <kritabrush_export.h>
 
@@ -38,6 +39,9 @@ private:
     int findNearestLevel(qreal scale, qreal *baseScale) const;
     void appendPyramidLevel(const QImage &image);
 
+    QImage exactLevelImage(int level) const;
+    static QImage renderLevel(const QImage &srcImage, QTransform transform, const QSize &dstSize);
+
     static void calculateParams(KisDabShape const& shape,
                                 qreal subPixelX, qreal subPixelY,
                                 const QSize &originalSize,
@@ -51,6 +55,8 @@ private:
 
 private:
     QSize m_originalSize;
+    QImage m_originalImage;
+    bool m_useSmoothingForEnlarging {true};
     qreal m_baseScale {0.0};
 
     struct PyramidLevel {
@@ -62,6 +68,16 @@ private:
     };
 
     QVector<PyramidLevel> m_levels;
+
+    /**
+     * The transformed images of big brush tips are kept in a global cache
+     * with a memory budget shared by all the pyramids. The handle is shared
+     * between the copies of the pyramid (and, therefore, between the
+     * clones of the brush), so the images survive between the strokes.
+     * They are dropped from the cache when the last copy is destroyed.
+     */
+    struct TransformCache;
+    QSharedPointer<TransformCache> m_transformCache;
 };
 
 #endif /* __KIS_QIMAGE_PYRAMID_H */
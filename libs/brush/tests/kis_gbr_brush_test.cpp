@@ -242,6 +242,85 @@ void KisGbrBrushTest::testPyramidDabTransform()
     QCOMPARE(dabTransformHelper(KisDabShape(1.0, 0.5, M_PI / 4)), QSize(160, 160));
 }
 
+void KisGbrBrushTest::testPyramidTransformCache()
+{
+    QImage image(600, 400, QImage::Format_ARGB32);
+    image.fill(Qt::black);
+
+    KisQImagePyramid pyramid(image);
+    KisQImagePyramid pyramidCopy(pyramid);
+
+    const KisDabShape shape1(1.0, 1.0, 0.5);
+    const KisDabShape shape2(1.0, 1.0, 0.5 + 1e-5);
+
+    const QImage dab1 = pyramid.createImage(shape1, 0.5, 0.25);
+    const QImage dab2 = pyramidCopy.createImage(shape2, 0.5, 0.25);
+
+    QCOMPARE(dab1.size(), KisQImagePyramid::imageSize(image.size(), shape1, 0.5, 0.25));
+    QCOMPARE(dab2.size(), KisQImagePyramid::imageSize(image.size(), shape2, 0.5, 0.25));
+    QCOMPARE(dab1.format(), QImage::Format_ARGB32);
+
+    // big dabs with close parameters are taken from the shared cache
+    QCOMPARE(dab1.cacheKey(), dab2.cacheKey());
+
+    // small dabs are always rendered with the exact parameters
+    const KisDabShape smallShape(0.1, 1.0, 0.5);
+    const QImage smallDab1 = pyramid.createImage(smallShape, 0.5, 0.25);
+    const QImage smallDab2 = pyramid.createImage(smallShape, 0.5, 0.25);
+    QVERIFY(smallDab1.cacheKey() != smallDab2.cacheKey());
+    QCOMPARE(smallDab1, smallDab2);
+
+    // the angle step gets smaller with the size of the tip, for this one
+    // it is about 0.02 degree, so a 0.06 degree difference is not merged
+    const KisDabShape shape3(1.0, 1.0, 0.5 + 1e-3);
+    const QImage dab3 = pyramid.createImage(shape3, 0.5, 0.25);
+    QVERIFY(dab1.cacheKey() != dab3.cacheKey());
+
+    // the images of different pyramids are not mixed in the global cache
+    KisQImagePyramid otherPyramid(image);
+    const QImage otherDab = otherPyramid.createImage(shape1, 0.5, 0.25);
+    QVERIFY(dab1.cacheKey() != otherDab.cacheKey());
+    QCOMPARE(dab1, otherDab);
+}
+
+void KisGbrBrushTest::testPyramidTransformCacheSubPixelWrap()
+{
+    QImage image(600, 400, QImage::Format_ARGB32);
+    image.fill(Qt::black);
+
+    KisQImagePyramid pyramid(image);
+
+    /**
+     * The offset 0.97 is rounded to the next pixel, not to the last
+     * subpixel step (0.875), so the first column is left empty and the
+     * second one is fully opaque.
+     */
+    const KisDabShape shape(1.0, 1.0, 0.0);
+    const QImage dab = pyramid.createImage(shape, 0.97, 0.0);
+
+    QCOMPARE(dab.size(), KisQImagePyramid::imageSize(image.size(), shape, 0.97, 0.0));
+    QCOMPARE(qAlpha(dab.pixel(0, 200)), 0);
+    QCOMPARE(qAlpha(dab.pixel(1, 200)), 255);
+    QCOMPARE(qAlpha(dab.pixel(600, 200)), 255);
+}
+
+void KisGbrBrushTest::testPyramidIdentityTransformIsExact()
+{
+    // semi-transparent pixels lose their color in premultiplied form
+    QImage image(600, 400, QImage::Format_ARGB32);
+    image.fill(QColor(10, 200, 30, 3));
+
+    KisQImagePyramid pyramid(image);
+
+    QCOMPARE(pyramid.createImage(KisDabShape(1.0, 1.0, 0.0), 0.0, 0.0), image);
+
+    const QImage halfImage =
+        image.scaled(300, 200, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+            .convertToFormat(QImage::Format_ARGB32);
+
+    QCOMPARE(pyramid.createImage(KisDabShape(0.5, 1.0, 0.0), 0.0, 0.0), halfImage);
+}
+
 // see comment in KisQImagePyramid::appendPyramidLevel
 void KisGbrBrushTest::testQPainterTransformationBorder()
 {
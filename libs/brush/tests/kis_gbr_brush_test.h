@@ -28,6 +28,9 @@ private Q_SLOTS:
 
     void testPyramidLevelRounding();
     void testPyramidDabTransform();
+    void testPyramidTransformCache();
+    void testPyramidTransformCacheSubPixelWrap();
+    void testPyramidIdentityTransformIsExact();
 
     void testQPainterTransformationBorder();
 };
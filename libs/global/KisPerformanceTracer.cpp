@@ -0,0 +1,328 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisPerformanceTracer.h"
+
+#include <memory>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGlobalStatic>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QThread>
+
+#include <KisPortingUtils.h>
+#include "kis_assert.h"
+#include "kis_debug.h"
+
+Q_GLOBAL_STATIC(KisPerformanceTracer, s_instance)
+
+std::atomic<bool> KisPerformanceTracer::s_enabled {false};
+
+namespace {
+
+/**
+ * When tracing is left enabled for a long time we should not eat all
+ * the memory. The events that do not fit are just dropped.
+ */
+const int maxEventsPerThread = 500000;
+
+std::atomic<int> s_nextTracerId {0};
+
+struct Event {
+    const char *category;
+    const char *name;
+    qint64 start;
+    qint64 duration; // -1 for instant events
+    QString detail;
+};
+
+QString escapeJson(const QString &str)
+{
+    QString result;
+    result.reserve(str.size());
+
+    Q_FOREACH (const QChar ch, str) {
+        switch (ch.unicode()) {
+        case '"':
+            result += QLatin1String("\\\"");
+            break;
+        case '\\':
+            result += QLatin1String("\\\\");
+            break;
+        case '\n':
+            result += QLatin1String("\\n");
+            break;
+        case '\t':
+            result += QLatin1String("\\t");
+            break;
+        default:
+            if (ch.unicode() < 0x20) {
+                result += QString("\\u%1").arg(ch.unicode(), 4, 16, QLatin1Char('0'));
+            } else {
+                result += ch;
+            }
+        }
+    }
+
+    return result;
+}
+
+}
+
+struct KisPerformanceTracer::ThreadBuffer
+{
+    mutable QMutex mutex;
+    int lane = 0;
+    QString name;
+    std::vector<Event> events;
+};
+
+struct KisPerformanceTracer::Trace
+{
+    struct Lane {
+        int lane;
+        QString name;
+        std::vector<Event> events;
+    };
+
+    std::vector<Lane> lanes;
+};
+
+struct KisPerformanceTracer::Private
+{
+    QElapsedTimer timer;
+    const int tracerId = s_nextTracerId++;
+
+    /**
+     * Incremented every time the buffers are released by takeTrace(),
+     * so that the threads would know their cached buffer is stale
+     */
+    std::atomic<int> generation {0};
+
+    mutable QMutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+};
+
+namespace {
+/**
+ * The thread keeps a reference to its buffer, so the buffer stays
+ * valid even when the tracer releases it in the middle of adding
+ * an event. Such an event is just lost.
+ */
+struct CurrentThreadBuffer {
+    int tracerId = -1;
+    int generation = -1;
+    std::shared_ptr<void> buffer;
+    QString threadName;
+};
+thread_local CurrentThreadBuffer t_currentBuffer;
+}
+
+KisPerformanceTracer::KisPerformanceTracer()
+    : m_d(new Private)
+{
+    m_d->timer.start();
+}
+
+KisPerformanceTracer::~KisPerformanceTracer()
+{
+}
+
+KisPerformanceTracer* KisPerformanceTracer::instance()
+{
+    return s_instance;
+}
+
+void KisPerformanceTracer::setEnabled(bool value)
+{
+    s_enabled.store(value);
+}
+
+qint64 KisPerformanceTracer::timestamp() const
+{
+    return m_d->timer.nsecsElapsed() / 1000;
+}
+
+KisPerformanceTracer::ThreadBuffer* KisPerformanceTracer::currentThreadBuffer()
+{
+    if (t_currentBuffer.tracerId == m_d->tracerId &&
+        t_currentBuffer.generation == m_d->generation.load(std::memory_order_relaxed)) {
+
+        return static_cast<ThreadBuffer*>(t_currentBuffer.buffer.get());
+    }
+
+    QMutexLocker l(&m_d->mutex);
+
+    std::shared_ptr<ThreadBuffer> buffer = std::make_shared<ThreadBuffer>();
+    buffer->lane = int(m_d->buffers.size());
+
+    QThread *thread = QThread::currentThread();
+    if (!t_currentBuffer.threadName.isEmpty()) {
+        buffer->name = t_currentBuffer.threadName;
+    } else if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) {
+        buffer->name = "GUI thread";
+    } else if (!thread->objectName().isEmpty()) {
+        buffer->name = thread->objectName();
+    } else {
+        buffer->name = QString("Thread %1").arg(buffer->lane);
+    }
+
+    m_d->buffers.push_back(buffer);
+
+    t_currentBuffer.tracerId = m_d->tracerId;
+    t_currentBuffer.generation = m_d->generation.load();
+    t_currentBuffer.buffer = buffer;
+
+    return buffer.get();
+}
+
+void KisPerformanceTracer::addCompleteEvent(const char *category, const char *name, qint64 start, qint64 duration, const QString &detail)
+{
+    ThreadBuffer *buffer = currentThreadBuffer();
+
+    QMutexLocker l(&buffer->mutex);
+    if (int(buffer->events.size()) >= maxEventsPerThread) return;
+
+    buffer->events.push_back({category, name, start, duration, detail});
+}
+
+void KisPerformanceTracer::addInstantEvent(const char *category, const char *name, const QString &detail)
+{
+    addCompleteEvent(category, name, timestamp(), -1, detail);
+}
+
+void KisPerformanceTracer::setCurrentThreadName(const QString &name)
+{
+    t_currentBuffer.threadName = name;
+
+    ThreadBuffer *buffer = currentThreadBuffer();
+
+    QMutexLocker l(&buffer->mutex);
+    buffer->name = name;
+}
+
+void KisPerformanceTracer::clear()
+{
+    QMutexLocker l(&m_d->mutex);
+
+    for (auto &buffer : m_d->buffers) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        buffer->events.clear();
+    }
+}
+
+int KisPerformanceTracer::numEvents() const
+{
+    QMutexLocker l(&m_d->mutex);
+
+    int result = 0;
+
+    for (auto &buffer : m_d->buffers) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        result += int(buffer->events.size());
+    }
+
+    return result;
+}
+
+KisPerformanceTracer::TraceSP KisPerformanceTracer::takeTrace()
+{
+    QSharedPointer<Trace> trace(new Trace());
+
+    QMutexLocker l(&m_d->mutex);
+
+    for (auto &buffer : m_d->buffers) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        trace->lanes.push_back({buffer->lane, buffer->name, std::move(buffer->events)});
+        buffer->events.clear();
+    }
+
+    m_d->buffers.clear();
+    m_d->generation++;
+
+    return trace;
+}
+
+KisPerformanceTracer::TraceSP KisPerformanceTracer::copyTrace() const
+{
+    QSharedPointer<Trace> trace(new Trace());
+
+    QMutexLocker l(&m_d->mutex);
+
+    for (auto &buffer : m_d->buffers) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        trace->lanes.push_back({buffer->lane, buffer->name, buffer->events});
+    }
+
+    return trace;
+}
+
+bool KisPerformanceTracer::saveChromeTrace(const QString &fileName) const
+{
+    return saveChromeTrace(copyTrace(), fileName);
+}
+
+bool KisPerformanceTracer::saveChromeTrace(TraceSP trace, const QString &fileName)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(trace, false);
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        warnKrita << "KisPerformanceTracer: failed to open" << fileName << "for writing";
+        return false;
+    }
+
+    QTextStream stream(&file);
+    KisPortingUtils::setUtf8OnStream(stream);
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    bool isFirst = true;
+
+    auto startRecord = [&] () {
+        stream << (isFirst ? "\n" : ",\n");
+        isFirst = false;
+    };
+
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    for (const Trace::Lane &lane : trace->lanes) {
+        startRecord();
+        stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+               << ",\"tid\":" << lane.lane
+               << ",\"args\":{\"name\":\"" << escapeJson(lane.name) << "\"}}";
+
+        for (const Event &event : lane.events) {
+            startRecord();
+            stream << "{\"name\":\"" << event.name
+                   << "\",\"cat\":\"" << event.category;
+
+            if (event.duration >= 0) {
+                stream << "\",\"ph\":\"X\",\"ts\":" << event.start
+                       << ",\"dur\":" << event.duration;
+            } else {
+                stream << "\",\"ph\":\"i\",\"s\":\"t\",\"ts\":" << event.start;
+            }
+
+            stream << ",\"pid\":" << pid << ",\"tid\":" << lane.lane;
+
+            if (!event.detail.isEmpty()) {
+                stream << ",\"args\":{\"detail\":\"" << escapeJson(event.detail) << "\"}";
+            }
+
+            stream << "}";
+        }
+    }
+
+    stream << "\n]}\n";
+    stream.flush();
+
+    return file.error() == QFile::NoError;
+}
@@ -0,0 +1,177 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISPERFORMANCETRACER_H
+#define KISPERFORMANCETRACER_H
+
+#include <atomic>
+
+#include <QString>
+#include <QScopedPointer>
+#include <QSharedPointer>
+
+#include "kritaglobal_export.h"
+
+/**
+ * KisPerformanceTracer collects timed events from all the threads of
+ * Krita and saves them in Chrome trace-event format, which can be
+ * opened in chrome://tracing, Perfetto UI or Speedscope. Every thread
+ * gets its own lane in the trace.
+ *
+ * The tracer is disabled by default. When disabled, a trace scope costs
+ * a single relaxed atomic load, so the hooks can be left compiled in.
+ *
+ * Usage:
+ *
+ * \code{.cpp}
+ * void KisSomething::doHeavyWork()
+ * {
+ *     KIS_TRACE_SCOPE("paintop", "doHeavyWork");
+ *     ...
+ * }
+ * \endcode
+ *
+ * Category and name of the events must be string literals (or have
+ * static storage duration otherwise), since the tracer stores only
+ * the pointers. Dynamic information may be passed as a detail string,
+ * which will be saved as an argument of the event.
+ */
+class KRITAGLOBAL_EXPORT KisPerformanceTracer
+{
+public:
+    class Scope;
+
+    /**
+     * The events taken out of the tracer by takeTrace()
+     */
+    struct Trace;
+    using TraceSP = QSharedPointer<const Trace>;
+
+public:
+    KisPerformanceTracer();
+    ~KisPerformanceTracer();
+
+    static KisPerformanceTracer* instance();
+
+    static inline bool isEnabled() {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    void setEnabled(bool value);
+
+    /**
+     * Time in microseconds since the creation of the tracer
+     */
+    qint64 timestamp() const;
+
+    void addCompleteEvent(const char *category, const char *name,
+                          qint64 start, qint64 duration,
+                          const QString &detail = QString());
+
+    void addInstantEvent(const char *category, const char *name,
+                         const QString &detail = QString());
+
+    /**
+     * Sets the name of the current thread's lane in the trace
+     */
+    void setCurrentThreadName(const QString &name);
+
+    /**
+     * Drops all the events collected so far. Thread lanes are kept.
+     */
+    void clear();
+
+    int numEvents() const;
+
+    /**
+     * Moves all the events collected so far out of the tracer and
+     * releases the per-thread buffers. The threads that are still
+     * alive get new buffers on their next event, so the memory of
+     * the threads that have already finished is freed.
+     *
+     * The returned trace does not refer to the tracer anymore, so
+     * it can be saved in any thread.
+     */
+    TraceSP takeTrace();
+
+    /**
+     * Saves the events collected so far into a JSON file in
+     * Chrome trace-event format
+     */
+    bool saveChromeTrace(const QString &fileName) const;
+
+    /**
+     * Saves \p trace into a JSON file in Chrome trace-event format
+     */
+    static bool saveChromeTrace(TraceSP trace, const QString &fileName);
+
+private:
+    struct ThreadBuffer;
+    ThreadBuffer* currentThreadBuffer();
+    TraceSP copyTrace() const;
+
+private:
+    static std::atomic<bool> s_enabled;
+
+    Q_DISABLE_COPY(KisPerformanceTracer)
+
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+/**
+ * RAII helper that records a "complete" event covering the lifetime
+ * of the object. If the tracer is disabled on construction, the scope
+ * does nothing.
+ */
+class KisPerformanceTracer::Scope
+{
+public:
+    Scope(const char *category, const char *name)
+        : m_category(category),
+          m_name(name),
+          m_start(KisPerformanceTracer::isEnabled() ?
+                      KisPerformanceTracer::instance()->timestamp() : -1)
+    {
+    }
+
+    ~Scope() {
+        if (m_start >= 0) {
+            KisPerformanceTracer *tracer = KisPerformanceTracer::instance();
+            tracer->addCompleteEvent(m_category, m_name,
+                                     m_start, tracer->timestamp() - m_start,
+                                     m_detail);
+        }
+    }
+
+    /**
+     * Returns true if the event is going to be recorded. Use it to
+     * avoid generating expensive detail strings for nothing.
+     */
+    inline bool isActive() const {
+        return m_start >= 0;
+    }
+
+    inline void setDetail(const QString &detail) {
+        m_detail = detail;
+    }
+
+private:
+    Q_DISABLE_COPY(Scope)
+
+    const char *m_category;
+    const char *m_name;
+    const qint64 m_start;
+    QString m_detail;
+};
+
+#define KIS_TRACE_CONCAT_IMPL(a, b) a##b
+#define KIS_TRACE_CONCAT(a, b) KIS_TRACE_CONCAT_IMPL(a, b)
+
+#define KIS_TRACE_SCOPE(category, name) \
+    KisPerformanceTracer::Scope KIS_TRACE_CONCAT(__kisTraceScope, __LINE__)(category, name)
+
+#endif // KISPERFORMANCETRACER_H
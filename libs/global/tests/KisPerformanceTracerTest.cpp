@@ -0,0 +1,157 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisPerformanceTracerTest.h"
+
+#include "simpletest.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QThread>
+
+#include "KisPerformanceTracer.h"
+
+void KisPerformanceTracerTest::testDisabledScope()
+{
+    KisPerformanceTracer *tracer = KisPerformanceTracer::instance();
+    tracer->clear();
+
+    tracer->setEnabled(false);
+    {
+        KIS_TRACE_SCOPE("test", "disabled");
+    }
+    QCOMPARE(tracer->numEvents(), 0);
+
+    tracer->setEnabled(true);
+    {
+        KIS_TRACE_SCOPE("test", "enabled");
+    }
+    tracer->setEnabled(false);
+    QCOMPARE(tracer->numEvents(), 1);
+
+    tracer->clear();
+    QCOMPARE(tracer->numEvents(), 0);
+}
+
+void KisPerformanceTracerTest::testChromeTraceExport()
+{
+    KisPerformanceTracer tracer;
+
+    tracer.addCompleteEvent("test", "mainEvent", 10, 20, "some \"quoted\" detail");
+    tracer.addInstantEvent("test", "instantEvent");
+
+    QThread *thread = QThread::create([&tracer] () {
+        tracer.setCurrentThreadName("Worker");
+        tracer.addCompleteEvent("test", "workerEvent", 15, 5);
+    });
+    thread->start();
+    thread->wait();
+    delete thread;
+
+    QCOMPARE(tracer.numEvents(), 3);
+
+    QTemporaryDir dir;
+    const QString fileName = dir.filePath("trace.json");
+    QVERIFY(tracer.saveChromeTrace(fileName));
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+    QCOMPARE(error.error, QJsonParseError::NoError);
+
+    const QJsonArray events = doc.object().value("traceEvents").toArray();
+
+    // two thread name records and three events
+    QCOMPARE(events.size(), 5);
+
+    QHash<QString, QJsonObject> eventsByName;
+    Q_FOREACH (const QJsonValue &value, events) {
+        const QJsonObject obj = value.toObject();
+        if (obj.value("ph").toString() == "M") {
+            eventsByName.insert(obj.value("args").toObject().value("name").toString(), obj);
+        } else {
+            eventsByName.insert(obj.value("name").toString(), obj);
+        }
+    }
+
+    QVERIFY(eventsByName.contains("Worker"));
+
+    const QJsonObject mainEvent = eventsByName.value("mainEvent");
+    QCOMPARE(mainEvent.value("ph").toString(), QString("X"));
+    QCOMPARE(mainEvent.value("ts").toInt(), 10);
+    QCOMPARE(mainEvent.value("dur").toInt(), 20);
+    QCOMPARE(mainEvent.value("args").toObject().value("detail").toString(),
+             QString("some \"quoted\" detail"));
+
+    QCOMPARE(eventsByName.value("instantEvent").value("ph").toString(), QString("i"));
+
+    // every thread has its own lane
+    QCOMPARE(eventsByName.value("workerEvent").value("tid").toInt(),
+             eventsByName.value("Worker").value("tid").toInt());
+    QVERIFY(eventsByName.value("workerEvent").value("tid").toInt() !=
+            mainEvent.value("tid").toInt());
+}
+
+namespace {
+QJsonArray loadTraceEvents(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) return QJsonArray();
+
+    return QJsonDocument::fromJson(file.readAll()).object().value("traceEvents").toArray();
+}
+}
+
+void KisPerformanceTracerTest::testTakeTrace()
+{
+    KisPerformanceTracer tracer;
+
+    tracer.addCompleteEvent("test", "mainEvent", 10, 20);
+
+    QThread *thread = QThread::create([&tracer] () {
+        tracer.setCurrentThreadName("Worker");
+        tracer.addCompleteEvent("test", "workerEvent", 15, 5);
+    });
+    thread->start();
+    thread->wait();
+    delete thread;
+
+    KisPerformanceTracer::TraceSP trace = tracer.takeTrace();
+    QCOMPARE(tracer.numEvents(), 0);
+
+    // the taken trace is not affected by the new events
+    tracer.addCompleteEvent("test", "secondEvent", 30, 5);
+    QCOMPARE(tracer.numEvents(), 1);
+
+    QTemporaryDir dir;
+
+    const QString traceFileName = dir.filePath("taken.json");
+    QVERIFY(KisPerformanceTracer::saveChromeTrace(trace, traceFileName));
+
+    // two thread name records and two events
+    QCOMPARE(loadTraceEvents(traceFileName).size(), 4);
+
+    const QString tracerFileName = dir.filePath("tracer.json");
+    QVERIFY(tracer.saveChromeTrace(tracerFileName));
+
+    // the buffer of the finished worker thread has been released,
+    // so only the lane of the current thread is left
+    const QJsonArray events = loadTraceEvents(tracerFileName);
+    QCOMPARE(events.size(), 2);
+
+    Q_FOREACH (const QJsonValue &value, events) {
+        const QJsonObject obj = value.toObject();
+        if (obj.value("ph").toString() != "M") {
+            QCOMPARE(obj.value("name").toString(), QString("secondEvent"));
+        }
+    }
+}
+
+SIMPLE_TEST_MAIN(KisPerformanceTracerTest)
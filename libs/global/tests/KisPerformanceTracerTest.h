@@ -0,0 +1,21 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISPERFORMANCETRACERTEST_H
+#define KISPERFORMANCETRACERTEST_H
+
+#include <QObject>
+
+class KisPerformanceTracerTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testDisabledScope();
+    void testChromeTraceExport();
+    void testTakeTrace();
+};
+
+#endif // KISPERFORMANCETRACERTEST_H
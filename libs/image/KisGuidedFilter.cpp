@@ -0,0 +1,105 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisGuidedFilter.h"
+
+#include <QVector>
+
+#include "kis_assert.h"
+#include "KisSummedAreaTable.h"
+
+
+int KisGuidedFilter::requiredMargin(int radius)
+{
+    // the coefficients are averaged over the window once again
+    return 2 * radius;
+}
+
+void KisGuidedFilter::apply(const float *guide, const float *src, float *dst,
+                            int width, int height, int radius, float epsilon)
+{
+    apply(guide, &src, &dst, 1, width, height, radius, epsilon);
+}
+
+void KisGuidedFilter::apply(const float *guide, const float *const *srcs, float *const *dsts, int numPlanes,
+                            int width, int height, int radius, float epsilon)
+{
+    const int size = width * height;
+    if (size <= 0 || numPlanes <= 0) return;
+
+    for (int plane = 0; plane < numPlanes; plane++) {
+        KIS_SAFE_ASSERT_RECOVER_RETURN(dsts[plane] != srcs[plane] && dsts[plane] != guide);
+    }
+
+    QVector<float> meanGuide(size);
+    QVector<float> varianceGuide(size);
+
+    QVector<float> meanSrc(size);
+    QVector<float> corrGuideSrc(size);
+
+    /**
+     * The statistics of the guide are shared by all the planes. The
+     * destination of the first plane is used as a scratch buffer for
+     * the products, it is not written until its plane is finished.
+     */
+    float *tmp = dsts[0];
+
+    KisSummedAreaTable::boxMean(guide, meanGuide.data(), width, height, radius);
+
+    for (int i = 0; i < size; i++) {
+        tmp[i] = guide[i] * guide[i];
+    }
+    KisSummedAreaTable::boxMean(tmp, varianceGuide.data(), width, height, radius);
+
+    for (int i = 0; i < size; i++) {
+        varianceGuide[i] = qMax(0.0f, varianceGuide[i] - meanGuide[i] * meanGuide[i]);
+    }
+
+    for (int plane = 0; plane < numPlanes; plane++) {
+        const float *src = srcs[plane];
+        float *dst = dsts[plane];
+
+        /**
+         * a = cov(I, p) / (var(I) + eps) and b = mean(p) - a * mean(I)
+         * are stored in place of corrGuideSrc and meanSrc respectively
+         */
+        float *a = corrGuideSrc.data();
+        float *b = meanSrc.data();
+
+        if (src == guide) {
+            for (int i = 0; i < size; i++) {
+                const float mean = meanGuide[i];
+                const float coeff = varianceGuide[i] / (varianceGuide[i] + epsilon);
+
+                a[i] = coeff;
+                b[i] = mean - coeff * mean;
+            }
+        } else {
+            KisSummedAreaTable::boxMean(src, b, width, height, radius);
+
+            for (int i = 0; i < size; i++) {
+                dst[i] = guide[i] * src[i];
+            }
+            KisSummedAreaTable::boxMean(dst, a, width, height, radius);
+
+            for (int i = 0; i < size; i++) {
+                const float covariance = a[i] - meanGuide[i] * b[i];
+                const float coeff = covariance / (varianceGuide[i] + epsilon);
+
+                a[i] = coeff;
+                b[i] = b[i] - coeff * meanGuide[i];
+            }
+        }
+
+        // the mean of b replaces a, which is not needed after its own mean is found
+        KisSummedAreaTable::boxMean(a, dst, width, height, radius);
+        KisSummedAreaTable::boxMean(b, a, width, height, radius);
+
+        for (int i = 0; i < size; i++) {
+            dst[i] = dst[i] * guide[i] + a[i];
+        }
+    }
+}
@@ -0,0 +1,67 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISGUIDEDFILTER_H
+#define KISGUIDEDFILTER_H
+
+#include <QtGlobal>
+
+#include "kritaimage_export.h"
+
+/**
+ * Edge-preserving smoothing with the guided filter (He, Sun and Tang).
+ *
+ * Inside every window the output is modelled as a linear function of the
+ * guide, q = a * I + b, fitted to the input in the least squares sense.
+ * In flat areas the variance of the guide is small compared to epsilon,
+ * so a tends to zero and the window is averaged; near edges the variance
+ * is big, a tends to one and the edge is kept.
+ *
+ * All the statistics are box means, which are calculated with
+ * KisSummedAreaTable::boxMean(), so the cost per pixel does not depend
+ * on the radius.
+ *
+ * The functions work on single channel float buffers stored row by row.
+ * The windows are clipped by the borders of the buffer, so the caller
+ * should provide a margin of requiredMargin() pixels around the area
+ * it is interested in.
+ */
+namespace KisGuidedFilter
+{
+    /**
+     * \return the distance from which the pixels of the input affect
+     *         an output pixel
+     */
+    KRITAIMAGE_EXPORT
+    int requiredMargin(int radius);
+
+    /**
+     * Filters \p src using \p guide to find the edges. \p guide may be
+     * the same buffer as \p src, which makes the filter self-guided (and
+     * a bit faster). \p dst must not overlap with the other buffers.
+     *
+     * \p epsilon is the regularization term, measured in the squared
+     *    units of the guide. Edges with variance much smaller than
+     *    it are smoothed out.
+     */
+    KRITAIMAGE_EXPORT
+    void apply(const float *guide, const float *src, float *dst,
+               int width, int height, int radius, float epsilon);
+
+    /**
+     * Filters \p numPlanes planes \p srcs into \p dsts using the same
+     * \p guide for all of them. The statistics of the guide are
+     * calculated only once, and the edges are found at the same places
+     * in all the planes, so the channels of a pixel are smoothed
+     * consistently. The destinations must not overlap with the other
+     * buffers.
+     */
+    KRITAIMAGE_EXPORT
+    void apply(const float *guide, const float *const *srcs, float *const *dsts, int numPlanes,
+               int width, int height, int radius, float epsilon);
+}
+
+#endif // KISGUIDEDFILTER_H
@@ -0,0 +1,547 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisMorphology.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "kis_assert.h"
+
+
+namespace {
+
+/**
+ * All the vertical offsets in [minOffset, maxOffset] are covered by the
+ * chords of the same half-width
+ */
+struct Chord {
+    int halfWidth;
+    int minOffset;
+    int maxOffset;
+};
+
+QVector<Chord> chordsFromProfile(const QVector<int> &profile)
+{
+    QVector<Chord> chords;
+
+    const int yRadius = profile[0];
+    int halfWidth = profile.size() - 1;
+
+    for (int offset = 0; offset <= yRadius; offset++) {
+        while (profile[halfWidth] < offset) {
+            halfWidth--;
+        }
+
+        if (!chords.isEmpty() && chords.last().halfWidth == halfWidth) {
+            chords.last().maxOffset = offset;
+        } else {
+            chords.append({halfWidth, offset, offset});
+        }
+    }
+
+    return chords;
+}
+
+/**
+ * Horizontal distance from every pixel of the row to the closest pixel
+ * which is not less than \p threshold. The distances are capped at
+ * limit + 1.
+ */
+inline void rowDistances(const quint8 *src, int width, quint8 threshold, int limit, int *distances)
+{
+    const int none = limit + 1;
+
+    int distance = none;
+    for (int x = 0; x < width; x++) {
+        if (src[x] >= threshold) {
+            distance = 0;
+        } else if (distance < none) {
+            distance++;
+        }
+        distances[x] = distance;
+    }
+
+    distance = none;
+    for (int x = width - 1; x >= 0; x--) {
+        if (src[x] >= threshold) {
+            distance = 0;
+        } else if (distance < none) {
+            distance++;
+        }
+        distances[x] = qMin(distances[x], distance);
+    }
+}
+
+inline void maxOfRows(quint8 *dst, const quint8 *src, int width)
+{
+    for (int x = 0; x < width; x++) {
+        dst[x] = qMax(dst[x], src[x]);
+    }
+}
+
+/**
+ * Van Herk/Gil-Werman running maximum over the window [x - radius, x + radius]
+ */
+struct RunningMax
+{
+    RunningMax(int width, int maxRadius)
+        : m_padded(width + 2 * maxRadius),
+          m_prefix(width + 2 * maxRadius),
+          m_suffix(width + 2 * maxRadius)
+    {
+    }
+
+    void apply(const quint8 *src, quint8 *dst, int width, int radius) {
+        if (radius == 0) {
+            memcpy(dst, src, width);
+            return;
+        }
+
+        const int window = 2 * radius + 1;
+        const int paddedWidth = width + 2 * radius;
+
+        quint8 *padded = m_padded.data();
+        quint8 *prefix = m_prefix.data();
+        quint8 *suffix = m_suffix.data();
+
+        memset(padded, 0, radius);
+        memcpy(padded + radius, src, width);
+        memset(padded + radius + width, 0, radius);
+
+        for (int blockStart = 0; blockStart < paddedWidth; blockStart += window) {
+            const int blockEnd = qMin(blockStart + window, paddedWidth);
+
+            prefix[blockStart] = padded[blockStart];
+            for (int i = blockStart + 1; i < blockEnd; i++) {
+                prefix[i] = qMax(prefix[i - 1], padded[i]);
+            }
+
+            suffix[blockEnd - 1] = padded[blockEnd - 1];
+            for (int i = blockEnd - 2; i >= blockStart; i--) {
+                suffix[i] = qMax(suffix[i + 1], padded[i]);
+            }
+        }
+
+        // the window of the pixel x spans [x, x + window - 1] of the padded line
+        for (int x = 0; x < width; x++) {
+            dst[x] = qMax(suffix[x], prefix[x + window - 1]);
+        }
+    }
+
+private:
+    QVector<quint8> m_padded;
+    QVector<quint8> m_prefix;
+    QVector<quint8> m_suffix;
+};
+
+void dilateChords(const quint8 *src, quint8 *dst, int width, int height, const QVector<Chord> &chords)
+{
+    memset(dst, 0, width * height);
+
+    QVector<quint8> rows(width * height);
+    RunningMax runningMax(width, chords.first().halfWidth);
+
+    for (const Chord &chord : chords) {
+        for (int y = 0; y < height; y++) {
+            runningMax.apply(src + y * width, rows.data() + y * width, width, chord.halfWidth);
+        }
+
+        for (int y = 0; y < height; y++) {
+            quint8 *dstRow = dst + y * width;
+
+            for (int offset = chord.minOffset; offset <= chord.maxOffset; offset++) {
+                if (y - offset >= 0) {
+                    maxOfRows(dstRow, rows.constData() + (y - offset) * width, width);
+                }
+                if (offset > 0 && y + offset < height) {
+                    maxOfRows(dstRow, rows.constData() + (y + offset) * width, width);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Semi-transparent pixels of the mask, grouped by rows, with a sparse
+ * table for the range maximum queries
+ */
+struct EdgePixels
+{
+    EdgePixels(const quint8 *src, int width, int height)
+        : rowOffsets(height + 1)
+    {
+        for (int y = 0; y < height; y++) {
+            rowOffsets[y] = xs.size();
+
+            const quint8 *srcRow = src + y * width;
+            for (int x = 0; x < width; x++) {
+                if (srcRow[x] > 0 && srcRow[x] < 255) {
+                    xs.append(x);
+                    values.append(srcRow[x]);
+                }
+            }
+        }
+        rowOffsets[height] = xs.size();
+
+        /**
+         * The entries of the table may span several rows, but the queries
+         * always stay inside a row, so it doesn't matter
+         */
+        levels.append(values);
+        for (int step = 1; 2 * step <= values.size(); step *= 2) {
+            const QVector<quint8> &prev = levels.last();
+            QVector<quint8> next(prev.size() - step);
+
+            for (int i = 0; i < next.size(); i++) {
+                next[i] = qMax(prev[i], prev[i + step]);
+            }
+            levels.append(next);
+        }
+    }
+
+    /**
+     * \return the maximum of the pixels in [x0, x1] of the row \p y
+     */
+    quint8 rowMaximum(int y, int x0, int x1) const {
+        const int *rowBegin = xs.constData() + rowOffsets[y];
+        const int *rowEnd = xs.constData() + rowOffsets[y + 1];
+
+        const int *first = std::lower_bound(rowBegin, rowEnd, x0);
+        if (first == rowEnd || *first > x1) return 0;
+
+        const int *last = std::upper_bound(first, rowEnd, x1) - 1;
+
+        const int lo = first - xs.constData();
+        const int hi = last - xs.constData();
+
+        int level = 0;
+        while ((2 << level) <= hi - lo + 1) {
+            level++;
+        }
+
+        return qMax(levels[level][lo], levels[level][hi - (1 << level) + 1]);
+    }
+
+    QVector<int> rowOffsets;
+    QVector<int> xs;
+    QVector<quint8> values;
+    QVector<QVector<quint8>> levels;
+};
+
+/**
+ * \p dst should contain the binary dilation of the fully selected pixels,
+ * \p reachable --- the binary dilation of all the non-null pixels. The
+ * structuring element of the pixels in between covers only transparent
+ * or semi-transparent pixels, so only the latter ones are checked.
+ */
+void dilateEdgeBand(const quint8 *src, quint8 *dst, const quint8 *reachable,
+                    int width, int height, const QVector<Chord> &chords)
+{
+    const EdgePixels edge(src, width, height);
+
+    const int yRadius = chords.last().maxOffset;
+    QVector<int> halfWidths(yRadius + 1);
+    for (const Chord &chord : chords) {
+        for (int offset = chord.minOffset; offset <= chord.maxOffset; offset++) {
+            halfWidths[offset] = chord.halfWidth;
+        }
+    }
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const int index = y * width + x;
+            if (dst[index] || !reachable[index]) continue;
+
+            const int top = qMax(0, y - yRadius);
+            const int bottom = qMin(height - 1, y + yRadius);
+
+            quint8 result = 0;
+
+            for (int srcY = top; srcY <= bottom; srcY++) {
+                const int halfWidth = halfWidths[qAbs(srcY - y)];
+                result = qMax(result, edge.rowMaximum(srcY, x - halfWidth, x + halfWidth));
+
+                if (result == 254) break;
+            }
+
+            dst[index] = result;
+        }
+    }
+}
+
+inline void invert(quint8 *data, int size)
+{
+    for (int i = 0; i < size; i++) {
+        data[i] = 255 - data[i];
+    }
+}
+
+}
+
+namespace KisMorphology
+{
+
+QVector<int> ellipseProfile(int xRadius, int yRadius)
+{
+    KIS_SAFE_ASSERT_RECOVER(xRadius >= 0 && yRadius >= 0) {
+        xRadius = qMax(0, xRadius);
+        yRadius = qMax(0, yRadius);
+    }
+
+    QVector<int> profile(xRadius + 1);
+
+    const double divisor = xRadius > 0 ? xRadius : 1.0;
+
+    for (int k = 0; k <= xRadius; k++) {
+        const double tmp = k > 0 ? k - 0.5 : 0.0;
+        profile[k] = int(std::floor(yRadius * std::sqrt(xRadius * xRadius - tmp * tmp) / divisor + 0.5));
+    }
+
+    return profile;
+}
+
+void dilateBinary(const quint8 *src, quint8 *dst, int width, int height,
+                  const QVector<int> &profile, quint8 threshold)
+{
+    if (width <= 0 || height <= 0) return;
+    KIS_SAFE_ASSERT_RECOVER_RETURN(!profile.isEmpty());
+    KIS_SAFE_ASSERT_RECOVER_RETURN(src != dst);
+
+    const int xRadius = profile.size() - 1;
+
+    QVector<int> distances(width);
+
+    /**
+     * Every pixel whose row has a source pixel at the horizontal distance
+     * k covers the interval [y - profile[k], y + profile[k]] of its column.
+     * Since the profile is non-increasing, the closest source pixel of
+     * the row covers the longest interval.
+     *
+     * The first sweep covers the pixels from the intervals started above
+     * them, the second one --- from the intervals started below.
+     */
+
+    QVector<int> reach(width, std::numeric_limits<int>::min());
+
+    for (int y = 0; y < height; y++) {
+        rowDistances(src + y * width, width, threshold, xRadius, distances.data());
+        quint8 *dstRow = dst + y * width;
+
+        for (int x = 0; x < width; x++) {
+            const int distance = distances[x];
+            if (distance <= xRadius && profile[distance] >= 0) {
+                reach[x] = qMax(reach[x], y + profile[distance]);
+            }
+            dstRow[x] = reach[x] >= y ? 255 : 0;
+        }
+    }
+
+    reach.fill(std::numeric_limits<int>::max());
+
+    for (int y = height - 1; y >= 0; y--) {
+        rowDistances(src + y * width, width, threshold, xRadius, distances.data());
+        quint8 *dstRow = dst + y * width;
+
+        for (int x = 0; x < width; x++) {
+            const int distance = distances[x];
+            if (distance <= xRadius && profile[distance] >= 0) {
+                reach[x] = qMin(reach[x], y - profile[distance]);
+            }
+            if (reach[x] <= y) {
+                dstRow[x] = 255;
+            }
+        }
+    }
+}
+
+void dilate(quint8 *data, int width, int height, const QVector<int> &profile)
+{
+    if (width <= 0 || height <= 0) return;
+    KIS_SAFE_ASSERT_RECOVER_RETURN(!profile.isEmpty() && profile[0] >= 0);
+
+    const int numPixels = width * height;
+
+    int numEdgePixels = 0;
+    for (int i = 0; i < numPixels; i++) {
+        numEdgePixels += data[i] > 0 && data[i] < 255;
+    }
+
+    QVector<quint8> result(numPixels);
+
+    if (!numEdgePixels) {
+        dilateBinary(data, result.data(), width, height, profile, 255);
+        memcpy(data, result.constData(), numPixels);
+        return;
+    }
+
+    const QVector<Chord> chords = chordsFromProfile(profile);
+    const int yRadius = profile[0];
+
+    /**
+     * Rough estimations of the number of operations of both algorithms:
+     * every chord costs three comparisons per pixel for the running maximum
+     * and the merging of the shifted rows is vectorized. The edge band
+     * costs two binary searches and a table lookup per row of the element
+     * for every pixel of the band.
+     */
+    const qreal chordsCost = qreal(numPixels) * (3.0 * chords.size() + (2.0 * yRadius + 1) / 16.0);
+
+    if (numEdgePixels < numPixels / 2 && chordsCost > 4.0 * numPixels) {
+        QVector<quint8> reachable(numPixels);
+
+        dilateBinary(data, result.data(), width, height, profile, 255);
+        dilateBinary(data, reachable.data(), width, height, profile, 1);
+
+        int numBandPixels = 0;
+        for (int i = 0; i < numPixels; i++) {
+            numBandPixels += reachable[i] && !result[i];
+        }
+
+        const qreal bandCost = qreal(numBandPixels) * (2.0 * yRadius + 1) * 16.0;
+
+        if (bandCost < chordsCost) {
+            dilateEdgeBand(data, result.data(), reachable.constData(), width, height, chords);
+            memcpy(data, result.constData(), numPixels);
+            return;
+        }
+    }
+
+    dilateChords(data, result.data(), width, height, chords);
+    memcpy(data, result.constData(), numPixels);
+}
+
+void erode(quint8 *data, int width, int height, const QVector<int> &profile, bool edgeLock)
+{
+    if (width <= 0 || height <= 0) return;
+    KIS_SAFE_ASSERT_RECOVER_RETURN(!profile.isEmpty() && profile[0] >= 0);
+
+    const int numPixels = width * height;
+
+    invert(data, numPixels);
+    dilate(data, width, height, profile);
+    invert(data, numPixels);
+
+    if (!edgeLock) {
+        /**
+         * The element covers the points (+-xRadius, 0) and (0, +-yRadius),
+         * so it crosses the edge of the buffer exactly for these pixels
+         */
+        int xRadius = profile.size() - 1;
+        while (profile[xRadius] < 0) {
+            xRadius--;
+        }
+        const int yRadius = profile[0];
+
+        for (int y = 0; y < height; y++) {
+            quint8 *row = data + y * width;
+
+            if (y < yRadius || y >= height - yRadius) {
+                memset(row, 0, width);
+            } else {
+                const int border = qMin(xRadius, width);
+                memset(row, 0, border);
+                memset(row + width - border, 0, border);
+            }
+        }
+    }
+}
+
+QVector<quint32> squaredDistanceTransform(const quint8 *src, int width, int height, quint8 threshold)
+{
+    const quint32 infinity = std::numeric_limits<quint32>::max();
+
+    QVector<quint32> result(width * height, infinity);
+    if (width <= 0 || height <= 0) return result;
+
+    /**
+     * The vertical distances are found in two sweeps over the rows
+     */
+
+    QVector<quint32> distances(width, infinity);
+
+    for (int y = 0; y < height; y++) {
+        const quint8 *srcRow = src + y * width;
+        quint32 *dstRow = result.data() + y * width;
+
+        for (int x = 0; x < width; x++) {
+            if (srcRow[x] >= threshold) {
+                distances[x] = 0;
+            } else if (distances[x] != infinity) {
+                distances[x]++;
+            }
+            dstRow[x] = distances[x];
+        }
+    }
+
+    distances.fill(infinity);
+
+    for (int y = height - 1; y >= 0; y--) {
+        const quint8 *srcRow = src + y * width;
+        quint32 *dstRow = result.data() + y * width;
+
+        for (int x = 0; x < width; x++) {
+            if (srcRow[x] >= threshold) {
+                distances[x] = 0;
+            } else if (distances[x] != infinity) {
+                distances[x]++;
+            }
+            dstRow[x] = qMin(dstRow[x], distances[x]);
+        }
+    }
+
+    /**
+     * Lower envelope of the parabolas rooted at the vertical distances
+     * of every row
+     */
+
+    QVector<double> f(width);
+    QVector<int> v(width);
+    QVector<double> z(width + 1);
+
+    for (int y = 0; y < height; y++) {
+        quint32 *row = result.data() + y * width;
+
+        int k = -1;
+
+        for (int q = 0; q < width; q++) {
+            if (row[q] == infinity) continue;
+
+            f[q] = double(row[q]) * row[q];
+
+            double s = 0.0;
+            while (k >= 0) {
+                const int p = v[k];
+                s = ((f[q] + double(q) * q) - (f[p] + double(p) * p)) / (2.0 * (q - p));
+                if (s > z[k]) break;
+                k--;
+            }
+
+            k++;
+            v[k] = q;
+            z[k] = k > 0 ? s : -std::numeric_limits<double>::infinity();
+            z[k + 1] = std::numeric_limits<double>::infinity();
+        }
+
+        if (k < 0) continue;
+
+        int j = 0;
+        for (int x = 0; x < width; x++) {
+            while (z[j + 1] < x) {
+                j++;
+            }
+
+            const double distance = double(x - v[j]) * (x - v[j]) + f[v[j]];
+            row[x] = distance < infinity ? quint32(distance) : infinity;
+        }
+    }
+
+    return result;
+}
+
+}
@@ -0,0 +1,96 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISMORPHOLOGY_H
+#define KISMORPHOLOGY_H
+
+#include <QtGlobal>
+#include <QVector>
+
+#include "kritaimage_export.h"
+
+/**
+ * Morphological operations on 8-bit masks (e.g. the bytes of a pixel
+ * selection) stored as plain row-major buffers.
+ *
+ * The structuring elements are symmetric with respect to both axes and
+ * are described by their "profile": profile[k] is the maximum vertical
+ * offset |dy| that the element covers at the horizontal offset |dx| == k.
+ * The profile must be non-increasing; a negative value means that the
+ * column is not covered at all.
+ *
+ * The cost of the operations does not grow with the size of the element
+ * for binary masks (all the pixels are either 0 or 255):
+ *
+ *  - for every row the distance to the closest set pixel is found in two
+ *    sweeps, and every such pixel covers an interval of the column, whose
+ *    length is defined by the profile. The intervals are merged in two
+ *    more sweeps over the columns.
+ *
+ * Masks with intermediate values (antialiased or feathered selections) are
+ * handled exactly in one of two ways, whichever is expected to be cheaper:
+ *
+ *  - when the semi-transparent pixels form a thin edge, the binary algorithm
+ *    finds the areas that are fully selected or fully deselected, and only
+ *    the pixels in between look up the semi-transparent pixels of the
+ *    window with sparse tables of the rows
+ *
+ *  - otherwise the element is decomposed into horizontal chords, the rows
+ *    are dilated with van Herk/Gil-Werman running maximum (three comparisons
+ *    per pixel for any chord length) and then the shifted rows are merged
+ *
+ * Pixels outside the buffer are not part of the mask, so a dilation treats
+ * them as 0 and an erosion ignores them (see erode() for the other option).
+ */
+namespace KisMorphology
+{
+    /**
+     * \return the profile of the elliptical structuring element used by
+     *         the grow and shrink selection filters
+     */
+    KRITAIMAGE_EXPORT
+    QVector<int> ellipseProfile(int xRadius, int yRadius);
+
+    /**
+     * Replaces every pixel of \p data with the maximum of the pixels
+     * covered by the structuring element described by \p profile
+     */
+    KRITAIMAGE_EXPORT
+    void dilate(quint8 *data, int width, int height, const QVector<int> &profile);
+
+    /**
+     * Replaces every pixel of \p data with the minimum of the pixels
+     * covered by the structuring element described by \p profile.
+     *
+     * If \p edgeLock is true, the pixels outside the buffer are ignored
+     * (which is the same as extending the edge pixels infinitely),
+     * otherwise they are considered to be 0.
+     */
+    KRITAIMAGE_EXPORT
+    void erode(quint8 *data, int width, int height, const QVector<int> &profile, bool edgeLock);
+
+    /**
+     * Binary dilation: the pixels of \p dst are set to 255 if the structuring
+     * element placed at the pixel covers at least one pixel of \p src which
+     * is equal to or greater than \p threshold, and to 0 otherwise.
+     */
+    KRITAIMAGE_EXPORT
+    void dilateBinary(const quint8 *src, quint8 *dst, int width, int height,
+                      const QVector<int> &profile, quint8 threshold = 1);
+
+    /**
+     * Exact euclidean distance transform (Felzenszwalb and Huttenlocher).
+     *
+     * \return the squared distance from every pixel to the closest pixel
+     *         of \p src which is equal to or greater than \p threshold,
+     *         or std::numeric_limits<quint32>::max() if there is no such
+     *         pixel
+     */
+    KRITAIMAGE_EXPORT
+    QVector<quint32> squaredDistanceTransform(const quint8 *src, int width, int height, quint8 threshold = 1);
+}
+
+#endif // KISMORPHOLOGY_H
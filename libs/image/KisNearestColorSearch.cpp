@@ -0,0 +1,281 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisNearestColorSearch.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <QVarLengthArray>
+
+#include "kis_assert.h"
+
+
+namespace {
+
+const int cellShift = 11;
+const int cellSize = 1 << cellShift;
+
+/// the ranks below it are found without sorting the distances
+const int maxSmallRank = 8;
+
+static_assert(KisNearestColorSearch::gridSize * cellSize == 0x10000,
+              "the grid should cover the whole 16-bit range");
+
+struct Candidate {
+    float channels[3];
+    int index;
+};
+
+inline float squaredDistance(const float *color, const Candidate &candidate)
+{
+    const float d0 = color[0] - candidate.channels[0];
+    const float d1 = color[1] - candidate.channels[1];
+    const float d2 = color[2] - candidate.channels[2];
+
+    return d0 * d0 + d1 * d1 + d2 * d2;
+}
+
+}
+
+struct KisNearestColorSearch::Private
+{
+    int numColors = 0;
+    int maxCount = 1;
+    float scale[3];
+
+    /// the candidates of the cell i are [cellOffsets[i], cellOffsets[i + 1])
+    QVector<int> cellOffsets;
+    QVector<Candidate> candidates;
+
+    inline void normalize(const quint16 *color, float *result) const {
+        for (int axis = 0; axis < 3; axis++) {
+            result[axis] = color[axis] * scale[axis];
+        }
+    }
+
+    inline int cellIndex(const quint16 *color) const {
+        return ((color[0] >> cellShift) * gridSize + (color[1] >> cellShift)) * gridSize + (color[2] >> cellShift);
+    }
+
+    void buildCells(const QVector<quint16> &colors);
+};
+
+void KisNearestColorSearch::Private::buildCells(const QVector<quint16> &colors)
+{
+    const int n = numColors;
+
+    QVector<Candidate> normalizedColors(n);
+    for (int i = 0; i < n; i++) {
+        normalize(colors.constData() + 3 * i, normalizedColors[i].channels);
+        normalizedColors[i].index = i;
+    }
+
+    /**
+     * The squared distances are separable, so the minimal and maximal
+     * distances along every axis are calculated for every row of cells
+     * first, stored as [axis][cell][color]
+     */
+    QVector<float> minTerms(3 * gridSize * n);
+    QVector<float> maxTerms(3 * gridSize * n);
+
+    for (int axis = 0; axis < 3; axis++) {
+        for (int cell = 0; cell < gridSize; cell++) {
+            const float low = (cell * cellSize) * scale[axis];
+            const float high = (cell * cellSize + cellSize - 1) * scale[axis];
+
+            float *minRow = minTerms.data() + (axis * gridSize + cell) * n;
+            float *maxRow = maxTerms.data() + (axis * gridSize + cell) * n;
+
+            for (int i = 0; i < n; i++) {
+                const float value = normalizedColors[i].channels[axis];
+                const float minDistance = qMax(0.0f, qMax(low - value, value - high));
+                const float maxDistance = qMax(qAbs(value - low), qAbs(value - high));
+
+                minRow[i] = minDistance * minDistance;
+                maxRow[i] = maxDistance * maxDistance;
+            }
+        }
+    }
+
+    const int thresholdRank = qMin(maxCount, n) - 1;
+
+    QVector<float> minDistances(n);
+    QVector<float> maxDistances(thresholdRank < maxSmallRank ? 0 : n);
+
+    cellOffsets.reserve(gridSize * gridSize * gridSize + 1);
+    cellOffsets.append(0);
+
+    for (int c0 = 0; c0 < gridSize; c0++) {
+        for (int c1 = 0; c1 < gridSize; c1++) {
+            for (int c2 = 0; c2 < gridSize; c2++) {
+                const float *min0 = minTerms.constData() + c0 * n;
+                const float *min1 = minTerms.constData() + (gridSize + c1) * n;
+                const float *min2 = minTerms.constData() + (2 * gridSize + c2) * n;
+                const float *max0 = maxTerms.constData() + c0 * n;
+                const float *max1 = maxTerms.constData() + (gridSize + c1) * n;
+                const float *max2 = maxTerms.constData() + (2 * gridSize + c2) * n;
+
+                for (int i = 0; i < n; i++) {
+                    minDistances[i] = min0[i] + min1[i] + min2[i];
+                }
+
+                /**
+                 * There are at least maxCount colors not further than
+                 * the threshold from any point of the cell, so none
+                 * of the colors that are further from the whole cell
+                 * can be among the closest ones. The threshold is
+                 * widened a bit to be safe against rounding.
+                 */
+                float maxThreshold = 0.0f;
+
+                if (thresholdRank < maxSmallRank) {
+                    float smallest[maxSmallRank];
+                    int numSmallest = 0;
+
+                    for (int i = 0; i < n; i++) {
+                        const float distance = max0[i] + max1[i] + max2[i];
+
+                        if (numSmallest <= thresholdRank || distance < smallest[thresholdRank]) {
+                            int pos = numSmallest <= thresholdRank ? numSmallest++ : thresholdRank;
+
+                            while (pos > 0 && smallest[pos - 1] > distance) {
+                                smallest[pos] = smallest[pos - 1];
+                                pos--;
+                            }
+                            smallest[pos] = distance;
+                        }
+                    }
+
+                    maxThreshold = smallest[thresholdRank];
+
+                } else {
+                    for (int i = 0; i < n; i++) {
+                        maxDistances[i] = max0[i] + max1[i] + max2[i];
+                    }
+
+                    std::nth_element(maxDistances.begin(),
+                                     maxDistances.begin() + thresholdRank,
+                                     maxDistances.end());
+                    maxThreshold = maxDistances[thresholdRank];
+                }
+
+                const float threshold = maxThreshold * 1.0001f;
+
+                for (int i = 0; i < n; i++) {
+                    if (minDistances[i] <= threshold) {
+                        candidates.append(normalizedColors[i]);
+                    }
+                }
+
+                cellOffsets.append(candidates.size());
+            }
+        }
+    }
+
+    candidates.squeeze();
+}
+
+KisNearestColorSearch::KisNearestColorSearch(const QVector<quint16> &colors, int maxCount,
+                                             const QVector<float> &weights)
+    : m_d(new Private)
+{
+    KIS_SAFE_ASSERT_RECOVER_NOOP(colors.size() % 3 == 0);
+    KIS_SAFE_ASSERT_RECOVER_NOOP(maxCount > 0);
+    KIS_SAFE_ASSERT_RECOVER_NOOP(weights.isEmpty() || weights.size() == 3);
+
+    m_d->numColors = colors.size() / 3;
+    m_d->maxCount = qMax(1, maxCount);
+
+    for (int axis = 0; axis < 3; axis++) {
+        const float weight = weights.size() == 3 ? weights[axis] : 1.0f;
+        m_d->scale[axis] = weight / 65535.0f;
+    }
+
+    if (m_d->numColors > 0) {
+        m_d->buildCells(colors);
+    }
+}
+
+KisNearestColorSearch::~KisNearestColorSearch()
+{
+}
+
+int KisNearestColorSearch::numColors() const
+{
+    return m_d->numColors;
+}
+
+int KisNearestColorSearch::maxCount() const
+{
+    return m_d->maxCount;
+}
+
+int KisNearestColorSearch::nearest(const quint16 *color) const
+{
+    if (!m_d->numColors) return -1;
+
+    float normalized[3];
+    m_d->normalize(color, normalized);
+
+    const int cell = m_d->cellIndex(color);
+    const Candidate *it = m_d->candidates.constData() + m_d->cellOffsets[cell];
+    const Candidate *end = m_d->candidates.constData() + m_d->cellOffsets[cell + 1];
+
+    float bestDistance = std::numeric_limits<float>::max();
+    int bestIndex = it->index;
+
+    // the candidates are sorted by their index, so the first one wins a tie
+    for (; it != end; ++it) {
+        const float distance = squaredDistance(normalized, *it);
+        const bool isCloser = distance < bestDistance;
+        bestDistance = isCloser ? distance : bestDistance;
+        bestIndex = isCloser ? it->index : bestIndex;
+    }
+
+    return bestIndex;
+}
+
+int KisNearestColorSearch::nearest(const quint16 *color, int count, int *indices, float *squaredDistances) const
+{
+    count = qMin(count, qMin(m_d->maxCount, m_d->numColors));
+    if (count <= 0) return 0;
+
+    float normalized[3];
+    m_d->normalize(color, normalized);
+
+    const int cell = m_d->cellIndex(color);
+    const Candidate *it = m_d->candidates.constData() + m_d->cellOffsets[cell];
+    const Candidate *end = m_d->candidates.constData() + m_d->cellOffsets[cell + 1];
+
+    QVarLengthArray<float, 4> distances(count);
+    int found = 0;
+
+    for (; it != end; ++it) {
+        const float distance = squaredDistance(normalized, *it);
+
+        if (found < count || distance < distances[found - 1]) {
+            int pos = found < count ? found++ : count - 1;
+
+            while (pos > 0 && distances[pos - 1] > distance) {
+                distances[pos] = distances[pos - 1];
+                indices[pos] = indices[pos - 1];
+                pos--;
+            }
+
+            distances[pos] = distance;
+            indices[pos] = it->index;
+        }
+    }
+
+    KIS_SAFE_ASSERT_RECOVER_NOOP(found == count);
+
+    if (squaredDistances) {
+        std::copy(distances.constBegin(), distances.constBegin() + found, squaredDistances);
+    }
+
+    return found;
+}
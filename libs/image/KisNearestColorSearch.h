@@ -0,0 +1,78 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISNEARESTCOLORSEARCH_H
+#define KISNEARESTCOLORSEARCH_H
+
+#include <QtGlobal>
+#include <QScopedPointer>
+#include <QVector>
+
+#include "kritaimage_export.h"
+
+/**
+ * Finds the colors of a palette that are the closest to a given color.
+ * The colors have three 16-bit channels (e.g. Lab or RGB), the distance
+ * is euclidean, optionally with a weight per channel.
+ *
+ * The color cube is split into gridSize^3 cells and every cell stores
+ * the list of the palette colors that can be the closest ones to any
+ * color inside the cell. A color is kept in the list if its minimal
+ * distance to the cell is not bigger than the maximal distance of the
+ * maxCount()-th closest color to the cell. The lists are usually a few
+ * entries long, so a lookup is just a short loop without any branches,
+ * and its result is exact.
+ *
+ * The lists are built in the constructor, the object is immutable
+ * afterwards and can be shared by several threads.
+ */
+class KRITAIMAGE_EXPORT KisNearestColorSearch
+{
+public:
+    /**
+     * The number of cells along every axis of the color cube
+     */
+    static const int gridSize = 32;
+
+    /**
+     * \p colors contains three channels per color. The lists of the cells
+     * are built for searching up to \p maxCount closest colors. \p weights,
+     * if not empty, contains the multipliers of the three channels.
+     */
+    KisNearestColorSearch(const QVector<quint16> &colors, int maxCount = 1,
+                          const QVector<float> &weights = QVector<float>());
+    ~KisNearestColorSearch();
+
+    int numColors() const;
+    int maxCount() const;
+
+    /**
+     * \return the index of the color closest to \p color, or -1 if there
+     *         are no colors. If several colors are equally close, the
+     *         one with the smallest index is returned.
+     */
+    int nearest(const quint16 *color) const;
+
+    /**
+     * Fills \p indices with the indices of up to \p count colors closest
+     * to \p color, sorted by their distance (and by their index if the
+     * distances are equal). \p squaredDistances, if not null, is filled
+     * with the squared distances to the colors, measured with the channels
+     * normalized to 0...1 and multiplied by their weights.
+     *
+     * \return the number of the found colors, which is limited by
+     *         maxCount() and numColors()
+     */
+    int nearest(const quint16 *color, int count, int *indices, float *squaredDistances = nullptr) const;
+
+private:
+    Q_DISABLE_COPY(KisNearestColorSearch)
+
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISNEARESTCOLORSEARCH_H
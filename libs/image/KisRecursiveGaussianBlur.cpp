@@ -0,0 +1,556 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisRecursiveGaussianBlur.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+
+#include <QBitArray>
+#include <QRect>
+#include <QVector>
+
+#include <KoColorSpace.h>
+#include <KoChannelInfo.h>
+#include <KoUpdater.h>
+
+#include "kis_assert.h"
+#include "kis_global.h"
+#include "kis_paint_device.h"
+#include "kis_default_bounds.h"
+#include "kis_gaussian_kernel.h"
+#include "kis_convolution_worker.h"
+#include "kis_math_toolbox.h"
+
+
+namespace {
+
+/**
+ * Below this radius the convolution is still fast enough, and it is
+ * a bit more precise than the recursive approximation.
+ */
+const qreal minPreferredRadius = 100.0;
+
+/**
+ * All the columns of a strip are filtered as a single interleaved line.
+ * The strip should be wide enough for the inner loop to be vectorized,
+ * but narrow enough for the strip to fit into the cache.
+ */
+const int verticalStripWidth = 32;
+
+/**
+ * Coefficients of the third order recursive filter, see van Vliet, Young
+ * and Verbeek, "Recursive Gaussian Derivative Filters", 1998. The poles of
+ * the base filter (sigma = 2) are scaled to match the requested variance
+ * exactly, so, unlike the original linear fit of Young and van Vliet, the
+ * filter stays precise for huge sigmas.
+ */
+struct Coefficients
+{
+    Coefficients(qreal sigma)
+    {
+        const double targetVariance = pow2(sigma);
+
+        double minScale = 0.0;
+        double maxScale = qMax(1.0, sigma);
+
+        while (variance(maxScale) < targetVariance) {
+            maxScale *= 2.0;
+        }
+
+        // the variance grows monotonically with the scale
+        for (int i = 0; i < 64; i++) {
+            const double scale = 0.5 * (minScale + maxScale);
+
+            if (variance(scale) < targetVariance) {
+                minScale = scale;
+            } else {
+                maxScale = scale;
+            }
+        }
+
+        std::complex<double> p1;
+        double p3;
+        poles(0.5 * (minScale + maxScale), &p1, &p3);
+
+        a1 = 2.0 * p1.real() + p3;
+        a2 = -(std::norm(p1) + 2.0 * p1.real() * p3);
+        a3 = std::norm(p1) * p3;
+        b = 1.0 - (a1 + a2 + a3);
+
+        /**
+         * The matrix for the values of the backward pass at the right edge
+         * of the line, see Triggs and Sdika, "Boundary Conditions for
+         * Young-van Vliet Recursive Filtering", 2006. The (1 - a1 - a2 - a3)
+         * factor of the original normalization cancels out with the gain
+         * of our backward pass.
+         */
+        const double s = 1.0 / ((1.0 + a1 - a2 + a3) * (1.0 + a2 + (a1 - a3) * a3));
+
+        m[0][0] = s * (-a3 * a1 + 1.0 - a3 * a3 - a2);
+        m[0][1] = s * (a3 + a1) * (a2 + a3 * a1);
+        m[0][2] = s * a3 * (a1 + a3 * a2);
+        m[1][0] = s * (a1 + a3 * a2);
+        m[1][1] = -s * (a2 - 1.0) * (a2 + a3 * a1);
+        m[1][2] = -s * a3 * (a3 * a1 + a3 * a3 + a2 - 1.0);
+        m[2][0] = s * (a3 * a1 + a2 + a1 * a1 - a2 * a2);
+        m[2][1] = s * (a1 * a2 + a3 * a2 * a2 - a1 * a3 * a3 - a3 * a3 * a3 - a3 * a2 + a3);
+        m[2][2] = s * a3 * (a1 + a3 * a2);
+    }
+
+    static void poles(double scale, std::complex<double> *p1, double *p3) {
+        const std::complex<double> d1(1.40098, 1.00236);
+        const double d3 = 1.85132;
+
+        *p1 = 1.0 / std::pow(d1, 1.0 / scale);
+        *p3 = 1.0 / std::pow(d3, 1.0 / scale);
+    }
+
+    /**
+     * The variance of the forward-backward filter, every pole p
+     * contributes 2 * p / (1 - p)^2 to it
+     */
+    static double variance(double scale) {
+        std::complex<double> p1;
+        double p3;
+        poles(scale, &p1, &p3);
+
+        return 2.0 * (2.0 * (p1 / pow2(1.0 - p1)).real() + p3 / pow2(1.0 - p3));
+    }
+
+    double b;
+    double a1;
+    double a2;
+    double a3;
+    double m[3][3];
+};
+
+/**
+ * Filters \p length samples of \p lanes interleaved values each. The
+ * buffer should have space for three extra samples before and after
+ * the line, they are used for the boundary conditions.
+ */
+template <int staticLanes>
+void filterLineImpl(double *line, int length, int dynamicLanes, const Coefficients &c)
+{
+    const int lanes = staticLanes > 0 ? staticLanes : dynamicLanes;
+
+    double *const begin = line + 3 * lanes;
+    double *const end = begin + length * lanes;
+
+    /**
+     * The line is continued with its edge values, the steady state of
+     * the filter for a constant signal is the signal itself.
+     */
+    for (int i = 1; i <= 3; i++) {
+        std::copy(begin, begin + lanes, begin - i * lanes);
+    }
+    std::copy(end - lanes, end, end);
+
+    for (double *p = begin; p != end; p += lanes) {
+        for (int k = 0; k < lanes; k++) {
+            p[k] = c.b * p[k] +
+                c.a1 * p[k - lanes] +
+                c.a2 * p[k - 2 * lanes] +
+                c.a3 * p[k - 3 * lanes];
+        }
+    }
+
+    /**
+     * The right edge of the line is continued with its last value, so
+     * the Triggs-Sdika matrix gives the last value of the backward pass
+     * and the two values after it.
+     */
+    for (int k = 0; k < lanes; k++) {
+        const double edge = end[k];
+        const double u0 = end[k - lanes] - edge;
+        const double u1 = end[k - 2 * lanes] - edge;
+        const double u2 = end[k - 3 * lanes] - edge;
+
+        end[k - lanes] = c.m[0][0] * u0 + c.m[0][1] * u1 + c.m[0][2] * u2 + edge;
+        end[k] = c.m[1][0] * u0 + c.m[1][1] * u1 + c.m[1][2] * u2 + edge;
+        end[k + lanes] = c.m[2][0] * u0 + c.m[2][1] * u1 + c.m[2][2] * u2 + edge;
+    }
+
+    for (double *p = end - 2 * lanes; p >= begin; p -= lanes) {
+        for (int k = 0; k < lanes; k++) {
+            p[k] = c.b * p[k] +
+                c.a1 * p[k + lanes] +
+                c.a2 * p[k + 2 * lanes] +
+                c.a3 * p[k + 3 * lanes];
+        }
+    }
+}
+
+void filterLine(double *line, int length, int lanes, const Coefficients &c)
+{
+    switch (lanes) {
+    case 1:
+        filterLineImpl<1>(line, length, lanes, c);
+        break;
+    case 2:
+        filterLineImpl<2>(line, length, lanes, c);
+        break;
+    case 3:
+        filterLineImpl<3>(line, length, lanes, c);
+        break;
+    case 4:
+        filterLineImpl<4>(line, length, lanes, c);
+        break;
+    case 5:
+        filterLineImpl<5>(line, length, lanes, c);
+        break;
+    default:
+        filterLineImpl<0>(line, length, lanes, c);
+    }
+}
+
+inline void limitValue(qreal *value, qreal lowBound, qreal highBound) {
+    if (*value > highBound) {
+        *value = highBound;
+    } else if (!(*value >= lowBound)) {  // value < lowBound or value == NaN
+        *value = lowBound;
+    }
+}
+
+/**
+ * Converts the filtered channels of a pixel into doubles and back. The
+ * color channels are premultiplied by alpha, the same way as in the
+ * FFT convolution worker.
+ */
+struct PixelConverter
+{
+    PixelConverter(const KoColorSpace *cs, const QBitArray &channelFlags)
+    {
+        const QList<KoChannelInfo*> channels = cs->channels();
+
+        KIS_SAFE_ASSERT_RECOVER_NOOP(channelFlags.isEmpty() ||
+                                     channelFlags.size() == channels.size());
+
+        for (int i = 0; i < channels.size(); i++) {
+            if (channelFlags.isEmpty() || channelFlags.testBit(i)) {
+                convChannelList.append(channels[i]);
+            }
+        }
+
+        KisMathToolbox mathToolbox;
+
+        for (int i = 0; i < convChannelList.size(); i++) {
+            minClamp.append(mathToolbox.minChannelValue(convChannelList[i]));
+            maxClamp.append(mathToolbox.maxChannelValue(convChannelList[i]));
+            channelPos.append(convChannelList[i]->pos());
+
+            if (convChannelList[i]->channelType() == KoChannelInfo::ALPHA) {
+                alphaCachePos = i;
+                alphaRealPos = convChannelList[i]->pos();
+            }
+        }
+
+        toDoubleFuncPtr.resize(convChannelList.size());
+        fromDoubleFuncPtr.resize(convChannelList.size());
+        fromDoubleCheckNullFuncPtr.resize(convChannelList.size());
+
+        bool result = mathToolbox.getToDoubleChannelPtr(convChannelList, toDoubleFuncPtr);
+        result &= mathToolbox.getFromDoubleChannelPtr(convChannelList, fromDoubleFuncPtr);
+        result &= mathToolbox.getFromDoubleCheckNullChannelPtr(convChannelList, fromDoubleCheckNullFuncPtr);
+
+        KIS_ASSERT(result);
+    }
+
+    inline int numChannels() const {
+        return convChannelList.size();
+    }
+
+    inline void read(const quint8 *data, double *dst) const {
+        // no alpha is a rare case, so just multiply by 1.0 in that case
+        const double alphaValue = alphaCachePos >= 0 ?
+            toDoubleFuncPtr[alphaCachePos](data, alphaRealPos) : 1.0;
+
+        for (int k = 0; k < convChannelList.size(); k++) {
+            dst[k] = k != alphaCachePos ?
+                toDoubleFuncPtr[k](data, channelPos[k]) * alphaValue : alphaValue;
+        }
+    }
+
+    inline void write(quint8 *data, const double *src) const {
+        if (alphaCachePos >= 0) {
+            bool alphaIsNullInDstSpace = false;
+
+            qreal alphaValue = src[alphaCachePos];
+            limitValue(&alphaValue, minClamp[alphaCachePos], maxClamp[alphaCachePos]);
+            fromDoubleCheckNullFuncPtr[alphaCachePos](data, alphaRealPos, alphaValue, &alphaIsNullInDstSpace);
+
+            if (!alphaIsNullInDstSpace &&
+                alphaValue > std::numeric_limits<qreal>::epsilon()) {
+
+                const qreal alphaValueInv = 1.0 / alphaValue;
+
+                for (int k = 0; k < convChannelList.size(); k++) {
+                    if (k == alphaCachePos) continue;
+
+                    qreal value = src[k] * alphaValueInv;
+                    limitValue(&value, minClamp[k], maxClamp[k]);
+                    fromDoubleFuncPtr[k](data, channelPos[k], value);
+                }
+            } else {
+                for (int k = 0; k < convChannelList.size(); k++) {
+                    if (k == alphaCachePos) continue;
+                    fromDoubleFuncPtr[k](data, channelPos[k], 0.0);
+                }
+            }
+        } else {
+            for (int k = 0; k < convChannelList.size(); k++) {
+                qreal value = src[k];
+                limitValue(&value, minClamp[k], maxClamp[k]);
+                fromDoubleFuncPtr[k](data, channelPos[k], value);
+            }
+        }
+    }
+
+    QList<KoChannelInfo*> convChannelList;
+    QVector<qint32> channelPos;
+    QVector<qreal> minClamp;
+    QVector<qreal> maxClamp;
+
+    QVector<PtrToDouble> toDoubleFuncPtr;
+    QVector<PtrFromDouble> fromDoubleFuncPtr;
+    QVector<PtrFromDoubleCheckNull> fromDoubleCheckNullFuncPtr;
+
+    int alphaCachePos {-1};
+    int alphaRealPos {-1};
+};
+
+struct ProgressReporter
+{
+    ProgressReporter(KoUpdater *_updater, int _totalSteps)
+        : updater(_updater),
+          totalSteps(qMax(1, _totalSteps))
+    {
+    }
+
+    inline void step() {
+        doneSteps++;
+
+        const int percent = 100 * doneSteps / totalSteps;
+        if (updater && percent != lastPercent) {
+            updater->setProgress(percent);
+            lastPercent = percent;
+        }
+    }
+
+    inline bool isInterrupted() const {
+        return updater && updater->interrupted();
+    }
+
+    KoUpdater *updater;
+    int totalSteps;
+    int doneSteps {0};
+    int lastPercent {-1};
+};
+
+/**
+ * Filters the rows of \p dstRect horizontally. Every row reads
+ * \p halfWidth extra pixels from \p src on both sides.
+ */
+template <class IteratorFactory>
+void horizontalPass(KisPaintDeviceSP src, KisPaintDeviceSP dst,
+                    const QRect &dstRect, int halfWidth, const QRect &dataRect,
+                    const Coefficients &c, const PixelConverter &converter,
+                    ProgressReporter &progress)
+{
+    const int numChannels = converter.numChannels();
+    const int length = dstRect.width() + 2 * halfWidth;
+
+    QVector<double> line((length + 6) * numChannels);
+    double *const samples = line.data() + 3 * numChannels;
+
+    typename IteratorFactory::HLineConstIterator srcIt =
+        IteratorFactory::createHLineConstIterator(src,
+                                                  dstRect.x() - halfWidth, dstRect.y(),
+                                                  length, dataRect);
+
+    KisHLineIteratorSP dstIt =
+        dst->createHLineIteratorNG(dstRect.x(), dstRect.y(), dstRect.width());
+
+    for (int y = 0; y < dstRect.height(); y++) {
+        double *p = samples;
+        for (int x = 0; x < length; x++, p += numChannels) {
+            converter.read(srcIt->oldRawData(), p);
+            srcIt->nextPixel();
+        }
+
+        filterLine(line.data(), length, numChannels, c);
+
+        p = samples + halfWidth * numChannels;
+        for (int x = 0; x < dstRect.width(); x++, p += numChannels) {
+            converter.write(dstIt->rawData(), p);
+            dstIt->nextPixel();
+        }
+
+        srcIt->nextRow();
+        dstIt->nextRow();
+
+        progress.step();
+        if (progress.isInterrupted()) return;
+    }
+}
+
+/**
+ * Filters the columns of \p dstRect vertically in strips of
+ * verticalStripWidth columns. Every column reads \p halfHeight extra
+ * pixels from \p src on both sides.
+ */
+template <class IteratorFactory>
+void verticalPass(KisPaintDeviceSP src, KisPaintDeviceSP dst,
+                  const QRect &dstRect, int halfHeight, const QRect &dataRect,
+                  const Coefficients &c, const PixelConverter &converter,
+                  ProgressReporter &progress)
+{
+    const int numChannels = converter.numChannels();
+    const int length = dstRect.height() + 2 * halfHeight;
+
+    QVector<double> strip;
+
+    for (int stripX = dstRect.x(); stripX <= dstRect.right(); stripX += verticalStripWidth) {
+        const int stripWidth = qMin(verticalStripWidth, dstRect.right() - stripX + 1);
+        const int lanes = stripWidth * numChannels;
+
+        strip.resize((length + 6) * lanes);
+        double *const samples = strip.data() + 3 * lanes;
+
+        typename IteratorFactory::HLineConstIterator srcIt =
+            IteratorFactory::createHLineConstIterator(src,
+                                                      stripX, dstRect.y() - halfHeight,
+                                                      stripWidth, dataRect);
+
+        double *p = samples;
+        for (int y = 0; y < length; y++) {
+            for (int x = 0; x < stripWidth; x++, p += numChannels) {
+                converter.read(srcIt->oldRawData(), p);
+                srcIt->nextPixel();
+            }
+            srcIt->nextRow();
+        }
+
+        filterLine(strip.data(), length, lanes, c);
+
+        KisHLineIteratorSP dstIt =
+            dst->createHLineIteratorNG(stripX, dstRect.y(), stripWidth);
+
+        p = samples + halfHeight * lanes;
+        for (int y = 0; y < dstRect.height(); y++) {
+            for (int x = 0; x < stripWidth; x++, p += numChannels) {
+                converter.write(dstIt->rawData(), p);
+                dstIt->nextPixel();
+            }
+            dstIt->nextRow();
+        }
+
+        progress.step();
+        if (progress.isInterrupted()) return;
+    }
+}
+
+template <class IteratorFactory>
+void applyImpl(KisPaintDeviceSP device, const QRect &rect,
+               qreal xRadius, qreal yRadius,
+               const PixelConverter &converter,
+               const QRect &dataRect,
+               KoUpdater *progressUpdater)
+{
+    const int halfWidth = xRadius > 0.0 ? KisGaussianKernel::kernelSizeFromRadius(xRadius) / 2 : 0;
+    const int halfHeight = yRadius > 0.0 ? KisGaussianKernel::kernelSizeFromRadius(yRadius) / 2 : 0;
+    const int numStrips = (rect.width() + verticalStripWidth - 1) / verticalStripWidth;
+
+    if (halfWidth > 0 && halfHeight > 0) {
+        /**
+         * The rows outside the data rect are not filtered at all, the
+         * vertical pass gets them by repeating the edge rows of the
+         * intermediate device.
+         */
+        QRect intermRect = rect.adjusted(0, -halfHeight, 0, halfHeight);
+        if (dataRect.isValid()) {
+            intermRect &= dataRect;
+        }
+
+        /**
+         * The intermediate device has no wrap-around mode, otherwise the
+         * extra rows would overwrite each other
+         */
+        KisPaintDeviceSP interm = new KisPaintDevice(device->colorSpace());
+
+        const Coefficients xCoeffs(KisGaussianKernel::sigmaFromRadius(xRadius));
+        const Coefficients yCoeffs(KisGaussianKernel::sigmaFromRadius(yRadius));
+
+        ProgressReporter progress(progressUpdater, intermRect.height() + numStrips);
+
+        horizontalPass<IteratorFactory>(device, interm, intermRect, halfWidth, dataRect,
+                                        xCoeffs, converter, progress);
+        if (progress.isInterrupted()) return;
+
+        verticalPass<IteratorFactory>(interm, device, rect, halfHeight, intermRect,
+                                      yCoeffs, converter, progress);
+
+    } else if (halfWidth > 0) {
+        const Coefficients xCoeffs(KisGaussianKernel::sigmaFromRadius(xRadius));
+        ProgressReporter progress(progressUpdater, rect.height());
+
+        horizontalPass<IteratorFactory>(device, device, rect, halfWidth, dataRect,
+                                        xCoeffs, converter, progress);
+
+    } else if (halfHeight > 0) {
+        const Coefficients yCoeffs(KisGaussianKernel::sigmaFromRadius(yRadius));
+        ProgressReporter progress(progressUpdater, numStrips);
+
+        verticalPass<IteratorFactory>(device, device, rect, halfHeight, dataRect,
+                                      yCoeffs, converter, progress);
+    }
+}
+
+}
+
+bool KisRecursiveGaussianBlur::isPreferredForRadius(qreal xRadius, qreal yRadius)
+{
+    return qMax(xRadius, yRadius) >= minPreferredRadius;
+}
+
+void KisRecursiveGaussianBlur::apply(KisPaintDeviceSP device,
+                                     const QRect &rect,
+                                     qreal xRadius, qreal yRadius,
+                                     const QBitArray &channelFlags,
+                                     KoUpdater *progressUpdater,
+                                     KisConvolutionBorderOp borderOp)
+{
+    if (rect.isEmpty()) return;
+
+    const PixelConverter converter(device->colorSpace(), channelFlags);
+    if (!converter.numChannels()) return;
+
+    /**
+     * In the wraparound mode the iterators of the device do the
+     * wrapping for us, the same way as in KisConvolutionPainter.
+     */
+    if (device->defaultBounds()->wrapAroundMode() && device->supportsWraproundMode()) {
+        borderOp = BORDER_IGNORE;
+    }
+
+    if (borderOp == BORDER_REPEAT) {
+        const QRect boundsRect = device->defaultBounds()->bounds();
+        QRect dataRect = rect | boundsRect;
+
+        KIS_SAFE_ASSERT_RECOVER(boundsRect != KisDefaultBounds().bounds()) {
+            dataRect = rect | device->exactBounds();
+        }
+
+        applyImpl<RepeatIteratorFactory>(device, rect, xRadius, yRadius,
+                                         converter, dataRect, progressUpdater);
+    } else {
+        applyImpl<StandardIteratorFactory>(device, rect, xRadius, yRadius,
+                                           converter, QRect(), progressUpdater);
+    }
+}
@@ -0,0 +1,51 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISRECURSIVEGAUSSIANBLUR_H
+#define KISRECURSIVEGAUSSIANBLUR_H
+
+#include "kritaimage_export.h"
+#include "kis_types.h"
+#include "kis_convolution_painter.h"
+
+class QRect;
+class QBitArray;
+class KoUpdater;
+
+/**
+ * Gaussian blur implemented as a third order recursive (IIR) filter in
+ * Young-van Vliet form with Triggs-Sdika boundary conditions. The cost of
+ * the filter per pixel does not depend on the radius, so it is used by
+ * KisGaussianKernel::applyGaussian() for the radii where neither the
+ * spatial nor the FFT convolution is efficient.
+ *
+ * The blur is done in two passes: the rows are filtered horizontally into
+ * an intermediate device, then the columns are filtered vertically in
+ * narrow strips. Both passes process the channels of a pixel (and the
+ * columns of a strip) as a single interleaved line, so the inner loops are
+ * vectorized by the compiler.
+ *
+ * The area read from the device and the semantics of \p channelFlags and
+ * \p borderOp are the same as in the convolution based implementation.
+ */
+class KRITAIMAGE_EXPORT KisRecursiveGaussianBlur
+{
+public:
+    /**
+     * \return true if the recursive filter should be preferred over the
+     *         convolution for the passed radii
+     */
+    static bool isPreferredForRadius(qreal xRadius, qreal yRadius);
+
+    static void apply(KisPaintDeviceSP device,
+                      const QRect& rect,
+                      qreal xRadius, qreal yRadius,
+                      const QBitArray &channelFlags,
+                      KoUpdater *progressUpdater,
+                      KisConvolutionBorderOp borderOp = BORDER_REPEAT);
+};
+
+#endif // KISRECURSIVEGAUSSIANBLUR_H
@@ -0,0 +1,334 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisSlidingWindowHistogram.h"
+
+#include <QRect>
+#include <QVector>
+
+#include <KoUpdater.h>
+
+#include "kis_assert.h"
+
+
+namespace {
+
+/**
+ * The width of the stripes the rect is processed in. The source rows
+ * of the window and the column histograms are kept for a single stripe
+ * only.
+ */
+const int stripeWidth = 256;
+
+inline int ringSlot(int row, int diameter)
+{
+    const int slot = row % diameter;
+    return slot >= 0 ? slot : slot + diameter;
+}
+
+}
+
+struct KisSlidingWindowHistogram::Private
+{
+    int numBins = 0;
+    int numValues = 0;
+
+    /// the histogram of the current window
+    QVector<int> counts;
+    QVector<double> sums;
+    int numSamples = 0;
+
+    /// the histograms of the columns of the current stripe
+    QVector<int> columnCounts;
+    QVector<double> columnSums;
+    QVector<int> columnNumSamples;
+
+    /// the source rows of the current window, stored as a ring buffer
+    QVector<quint16> rowBins;
+    QVector<float> rowValues;
+
+    template <int sign>
+    inline int updateSample(int *dstCounts, double *dstSums, quint16 bin, const float *values) const {
+        if (bin == skipBin) return 0;
+
+        dstCounts[bin] += sign;
+
+        double *binSums = dstSums + bin * numValues;
+        for (int i = 0; i < numValues; i++) {
+            binSums[i] += sign * values[i];
+        }
+
+        return sign;
+    }
+
+    void fetchRow(const FetchRowFunction &func, int x, int y, int width, int slot);
+
+    void resetColumns(int srcWidth);
+
+    template <int sign>
+    void updateColumns(int slot, int srcWidth);
+
+    void clearWindow();
+
+    template <int sign>
+    void updateWindowWithColumn(int column, int srcWidth, int diameter, bool useColumnHistograms);
+};
+
+void KisSlidingWindowHistogram::Private::fetchRow(const FetchRowFunction &func, int x, int y, int width, int slot)
+{
+    quint16 *bins = rowBins.data() + slot * width;
+    float *values = numValues ? rowValues.data() + slot * width * numValues : nullptr;
+
+    func(x, y, width, bins, values);
+
+    for (int i = 0; i < width; i++) {
+        KIS_SAFE_ASSERT_RECOVER(bins[i] == skipBin || bins[i] < numBins) {
+            bins[i] = skipBin;
+        }
+    }
+}
+
+void KisSlidingWindowHistogram::Private::resetColumns(int srcWidth)
+{
+    columnCounts.fill(0, srcWidth * numBins);
+    columnSums.fill(0.0, srcWidth * numBins * numValues);
+    columnNumSamples.fill(0, srcWidth);
+}
+
+template <int sign>
+void KisSlidingWindowHistogram::Private::updateColumns(int slot, int srcWidth)
+{
+    const quint16 *bins = rowBins.constData() + slot * srcWidth;
+    const float *values = rowValues.constData() + slot * srcWidth * numValues;
+
+    for (int column = 0; column < srcWidth; column++) {
+        columnNumSamples[column] +=
+            updateSample<sign>(columnCounts.data() + column * numBins,
+                               columnSums.data() + column * numBins * numValues,
+                               bins[column], values + column * numValues);
+    }
+}
+
+void KisSlidingWindowHistogram::Private::clearWindow()
+{
+    counts.fill(0);
+    sums.fill(0.0);
+    numSamples = 0;
+}
+
+template <int sign>
+void KisSlidingWindowHistogram::Private::updateWindowWithColumn(int column, int srcWidth, int diameter, bool useColumnHistograms)
+{
+    if (useColumnHistograms) {
+        const int *srcCounts = columnCounts.constData() + column * numBins;
+        int *dstCounts = counts.data();
+
+        for (int i = 0; i < numBins; i++) {
+            dstCounts[i] += sign * srcCounts[i];
+        }
+
+        const int numSums = numBins * numValues;
+        const double *srcSums = columnSums.constData() + column * numSums;
+        double *dstSums = sums.data();
+
+        for (int i = 0; i < numSums; i++) {
+            dstSums[i] += sign * srcSums[i];
+        }
+
+        numSamples += sign * columnNumSamples[column];
+
+    } else {
+        for (int slot = 0; slot < diameter; slot++) {
+            const int index = slot * srcWidth + column;
+
+            numSamples += updateSample<sign>(counts.data(), sums.data(),
+                                             rowBins[index],
+                                             rowValues.constData() + index * numValues);
+        }
+    }
+}
+
+KisSlidingWindowHistogram::KisSlidingWindowHistogram(int numBins, int numValues)
+    : m_d(new Private)
+{
+    KIS_SAFE_ASSERT_RECOVER_NOOP(numBins > 0 && numBins < skipBin);
+    KIS_SAFE_ASSERT_RECOVER_NOOP(numValues >= 0);
+
+    m_d->numBins = qBound(1, numBins, int(skipBin) - 1);
+    m_d->numValues = qMax(0, numValues);
+    m_d->counts.resize(m_d->numBins);
+    m_d->sums.resize(m_d->numBins * m_d->numValues);
+}
+
+KisSlidingWindowHistogram::~KisSlidingWindowHistogram()
+{
+}
+
+void KisSlidingWindowHistogram::process(const QRect &rect, int radius,
+                                        FetchRowFunction fetchRow,
+                                        ProcessPixelFunction processPixel,
+                                        KoUpdater *progressUpdater)
+{
+    if (rect.isEmpty()) return;
+    KIS_SAFE_ASSERT_RECOVER_RETURN(radius >= 0);
+
+    const int diameter = 2 * radius + 1;
+
+    /**
+     * Moving the window by one pixel costs O(diameter) when done pixel-wise
+     * and O(numBins) when done column-wise
+     */
+    const bool useColumnHistograms = diameter > m_d->numBins;
+
+    const int numStripes = (rect.width() + stripeWidth - 1) / stripeWidth;
+    const int totalSteps = numStripes * rect.height();
+    int doneSteps = 0;
+    int lastPercent = -1;
+
+    for (int stripeX = rect.x(); stripeX <= rect.right(); stripeX += stripeWidth) {
+        const int width = qMin(stripeWidth, rect.right() - stripeX + 1);
+        const int srcX = stripeX - radius;
+        const int srcWidth = width + 2 * radius;
+
+        m_d->rowBins.resize(diameter * srcWidth);
+        m_d->rowValues.resize(diameter * srcWidth * m_d->numValues);
+
+        for (int srcY = rect.y() - radius; srcY <= rect.y() + radius; srcY++) {
+            m_d->fetchRow(fetchRow, srcX, srcY, srcWidth, ringSlot(srcY, diameter));
+        }
+
+        if (useColumnHistograms) {
+            m_d->resetColumns(srcWidth);
+
+            for (int slot = 0; slot < diameter; slot++) {
+                m_d->updateColumns<1>(slot, srcWidth);
+            }
+        }
+
+        for (int y = rect.y(); y <= rect.bottom(); y++) {
+            m_d->clearWindow();
+
+            for (int column = 0; column < diameter; column++) {
+                m_d->updateWindowWithColumn<1>(column, srcWidth, diameter, useColumnHistograms);
+            }
+
+            for (int i = 0; i < width; i++) {
+                if (i > 0) {
+                    m_d->updateWindowWithColumn<-1>(i - 1, srcWidth, diameter, useColumnHistograms);
+                    m_d->updateWindowWithColumn<1>(i - 1 + diameter, srcWidth, diameter, useColumnHistograms);
+                }
+
+                processPixel(stripeX + i, y, *this);
+            }
+
+            if (y < rect.bottom()) {
+                // the row leaving the window and the row entering it share the slot
+                const int slot = ringSlot(y - radius, diameter);
+
+                if (useColumnHistograms) {
+                    m_d->updateColumns<-1>(slot, srcWidth);
+                }
+
+                m_d->fetchRow(fetchRow, srcX, y + radius + 1, srcWidth, slot);
+
+                if (useColumnHistograms) {
+                    m_d->updateColumns<1>(slot, srcWidth);
+                }
+            }
+
+            doneSteps++;
+
+            if (progressUpdater) {
+                const int percent = 100 * doneSteps / totalSteps;
+                if (percent != lastPercent) {
+                    progressUpdater->setProgress(percent);
+                    lastPercent = percent;
+                }
+
+                if (progressUpdater->interrupted()) return;
+            }
+        }
+    }
+}
+
+int KisSlidingWindowHistogram::numBins() const
+{
+    return m_d->numBins;
+}
+
+int KisSlidingWindowHistogram::numValues() const
+{
+    return m_d->numValues;
+}
+
+int KisSlidingWindowHistogram::numSamples() const
+{
+    return m_d->numSamples;
+}
+
+int KisSlidingWindowHistogram::count(int bin) const
+{
+    return m_d->counts[bin];
+}
+
+const double *KisSlidingWindowHistogram::sums(int bin) const
+{
+    return m_d->sums.constData() + bin * m_d->numValues;
+}
+
+int KisSlidingWindowHistogram::mode() const
+{
+    int result = -1;
+    int maxCount = 0;
+
+    for (int i = 0; i < m_d->numBins; i++) {
+        if (m_d->counts[i] > maxCount) {
+            maxCount = m_d->counts[i];
+            result = i;
+        }
+    }
+
+    return result;
+}
+
+int KisSlidingWindowHistogram::quantile(int rank) const
+{
+    if (rank < 0 || rank >= m_d->numSamples) return -1;
+
+    int cumulativeCount = 0;
+
+    for (int i = 0; i < m_d->numBins; i++) {
+        cumulativeCount += m_d->counts[i];
+        if (cumulativeCount > rank) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+int KisSlidingWindowHistogram::median() const
+{
+    return quantile(m_d->numSamples / 2);
+}
+
+int KisSlidingWindowHistogram::minimum() const
+{
+    for (int i = 0; i < m_d->numBins; i++) {
+        if (m_d->counts[i] > 0) return i;
+    }
+
+    return -1;
+}
+
+int KisSlidingWindowHistogram::maximum() const
+{
+    for (int i = m_d->numBins - 1; i >= 0; i--) {
+        if (m_d->counts[i] > 0) return i;
+    }
+
+    return -1;
+}
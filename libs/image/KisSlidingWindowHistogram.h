@@ -0,0 +1,124 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISSLIDINGWINDOWHISTOGRAM_H
+#define KISSLIDINGWINDOWHISTOGRAM_H
+
+#include <functional>
+
+#include <QScopedPointer>
+
+#include "kritaimage_export.h"
+
+class QRect;
+class KoUpdater;
+
+/**
+ * Histogram of a square window sliding over the image. It is the base
+ * for the filters that pick a value out of the neighbourhood of a pixel:
+ * median, mode (oil paint), minimum or maximum.
+ *
+ * Every source pixel is represented by a bin index and, optionally, by
+ * a few values that are summed up per bin (e.g. the channels of the
+ * pixels, to calculate the average color of the pixels of a bin).
+ *
+ * For small windows the histogram is updated by adding and removing
+ * individual pixels (Huang, 1979), so the cost per pixel is O(radius).
+ * When the window becomes taller than the number of bins, the histograms
+ * of the columns are kept and the window is updated by adding and
+ * subtracting whole columns (Perreault and Hébert, "Median Filtering in
+ * Constant Time", 2007), so the cost per pixel does not depend on the
+ * radius anymore.
+ *
+ * The output rect is processed in vertical stripes, so the memory usage
+ * does not depend on the size of the rect.
+ */
+class KRITAIMAGE_EXPORT KisSlidingWindowHistogram
+{
+public:
+    /**
+     * The bin index of the pixels which should not be counted at all
+     */
+    static const quint16 skipBin = 0xffff;
+
+    /**
+     * Should fill the bins and (if the histogram has values) the values
+     * of \p width pixels of row \p y starting at \p x. The values are
+     * stored interleaved, numValues() per pixel.
+     */
+    using FetchRowFunction = std::function<void(int x, int y, int width, quint16 *bins, float *values)>;
+
+    /**
+     * Is called for every pixel of the processed rect, the histogram
+     * contains the window around the pixel
+     */
+    using ProcessPixelFunction = std::function<void(int x, int y, const KisSlidingWindowHistogram &histogram)>;
+
+public:
+    KisSlidingWindowHistogram(int numBins, int numValues = 0);
+    ~KisSlidingWindowHistogram();
+
+    /**
+     * Walks over \p rect and calls \p processPixel for every pixel with
+     * the window of (2 * radius + 1) x (2 * radius + 1) pixels around it
+     */
+    void process(const QRect &rect, int radius,
+                 FetchRowFunction fetchRow,
+                 ProcessPixelFunction processPixel,
+                 KoUpdater *progressUpdater = 0);
+
+    int numBins() const;
+    int numValues() const;
+
+    /**
+     * \return the number of counted pixels in the window
+     */
+    int numSamples() const;
+
+    int count(int bin) const;
+
+    /**
+     * \return the sums of the values of the pixels of \p bin
+     */
+    const double* sums(int bin) const;
+
+    /**
+     * \return the first bin with the biggest count or -1 if the window
+     *         is empty
+     */
+    int mode() const;
+
+    /**
+     * \return the bin of the pixel with the rank \p rank, i.e. the
+     *         smallest bin, for which the number of pixels in this and
+     *         all the previous bins is bigger than \p rank. Returns -1
+     *         if the window has not enough pixels.
+     */
+    int quantile(int rank) const;
+
+    /**
+     * \return the quantile of the middle pixel of the window
+     */
+    int median() const;
+
+    /**
+     * \return the first non-empty bin or -1 if the window is empty
+     */
+    int minimum() const;
+
+    /**
+     * \return the last non-empty bin or -1 if the window is empty
+     */
+    int maximum() const;
+
+private:
+    Q_DISABLE_COPY(KisSlidingWindowHistogram)
+
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISSLIDINGWINDOWHISTOGRAM_H
@@ -0,0 +1,437 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisSummedAreaTable.h"
+
+#include <limits>
+
+#include <QVarLengthArray>
+
+#include <KoColorSpace.h>
+#include <KoChannelInfo.h>
+#include <KoUpdater.h>
+
+#include "kis_assert.h"
+#include "kis_global.h"
+#include "kis_paint_device.h"
+#include "kis_painter.h"
+#include "kis_iterator_ng.h"
+#include "kis_sequential_iterator.h"
+#include "kis_default_bounds_base.h"
+
+
+namespace {
+
+/**
+ * The size of the tiles of applyBoxes(), the margins are added to it
+ */
+const int tileSize = 512;
+
+template <typename T>
+struct SumTraits {
+    // 8- and 16-bit channels premultiplied by alpha fit into 32 bits
+    using sum_type = quint64;
+    static const bool isInteger = true;
+};
+
+template <>
+struct SumTraits<float> {
+    using sum_type = double;
+    static const bool isInteger = false;
+};
+
+template <typename T>
+inline T channelFromMean(double value)
+{
+    if (SumTraits<T>::isInteger) {
+        return T(qBound(0.0, value + 0.5, double(std::numeric_limits<T>::max())));
+    } else {
+        return T(value);
+    }
+}
+
+}
+
+struct KisSummedAreaTable::Private
+{
+    const KoColorSpace *colorSpace = nullptr;
+    QRect rect;
+
+    KoChannelInfo::enumChannelValueType channelType = KoChannelInfo::UINT8;
+    int channelCount = 0;
+    /// the index of alpha in the channels of the pixel, or -1
+    int alphaIndex = -1;
+
+    /// (rect.width() + 1) * (rect.height() + 1) entries of channelCount sums
+    QVector<quint64> integerSums;
+    QVector<double> floatSums;
+
+    inline int rowStride() const {
+        return (rect.width() + 1) * channelCount;
+    }
+
+    QVector<quint64>& storage(quint64) { return integerSums; }
+    QVector<double>& storage(double) { return floatSums; }
+    const QVector<quint64>& storage(quint64) const { return integerSums; }
+    const QVector<double>& storage(double) const { return floatSums; }
+
+    template <typename T>
+    void build(KisPaintDeviceSP device, const QRect &dataRect);
+
+    /**
+     * Adds the sums over \p area (in the coordinates of the device)
+     * multiplied by \p weight to \p result. The last element of the
+     * result is the weighted number of the summed pixels.
+     */
+    template <typename T>
+    void addSums(const QRect &area, qreal weight, qreal *result) const;
+
+    template <typename T>
+    void pixelFromSums(const qreal *sums, quint8 *dst) const;
+
+    template <typename T>
+    void weightedMeanPixel(const QPoint &pos, const QVector<Box> &boxes, qreal *sums, quint8 *dst) const;
+
+    template <typename T>
+    void applyBoxes(KisPaintDeviceSP dst, const QRect &tileRect, const QVector<Box> &boxes) const;
+};
+
+template <typename T>
+void KisSummedAreaTable::Private::build(KisPaintDeviceSP device, const QRect &dataRect)
+{
+    using sum_type = typename SumTraits<T>::sum_type;
+
+    const int width = rect.width();
+    const int height = rect.height();
+    const int stride = rowStride();
+    const int pixelSize = colorSpace->pixelSize();
+
+    QVector<sum_type> &table = storage(sum_type());
+    table.fill(sum_type(0), (height + 1) * stride);
+
+    /**
+     * The columns that are read from the device, the pixels to the left
+     * and to the right of them are repeated from the edges
+     */
+    int readLeft = rect.left();
+    int readRight = rect.right();
+
+    if (dataRect.isValid()) {
+        readLeft = qBound(dataRect.left(), readLeft, dataRect.right());
+        readRight = qBound(dataRect.left(), readRight, dataRect.right());
+    }
+
+    const int readWidth = readRight - readLeft + 1;
+    QVector<quint8> row(readWidth * pixelSize);
+    QVarLengthArray<sum_type, 8> rowSums(channelCount);
+
+    for (int y = 0; y < height; y++) {
+        int srcY = rect.y() + y;
+        if (dataRect.isValid()) {
+            srcY = qBound(dataRect.top(), srcY, dataRect.bottom());
+        }
+
+        {
+            KisHLineConstIteratorSP it = device->createHLineConstIteratorNG(readLeft, srcY, readWidth);
+            quint8 *dstPtr = row.data();
+
+            do {
+                memcpy(dstPtr, it->oldRawData(), pixelSize);
+                dstPtr += pixelSize;
+            } while (it->nextPixel());
+        }
+
+        std::fill(rowSums.begin(), rowSums.end(), sum_type(0));
+
+        const sum_type *above = table.constData() + y * stride + channelCount;
+        sum_type *current = table.data() + (y + 1) * stride + channelCount;
+
+        for (int x = 0; x < width; x++) {
+            const int srcX = qBound(readLeft, rect.x() + x, readRight) - readLeft;
+            const T *pixel = reinterpret_cast<const T*>(row.constData() + srcX * pixelSize);
+
+            const sum_type alpha = alphaIndex >= 0 ? sum_type(pixel[alphaIndex]) : sum_type(1);
+
+            for (int channel = 0; channel < channelCount; channel++) {
+                rowSums[channel] += channel == alphaIndex ? alpha : sum_type(pixel[channel]) * alpha;
+                current[channel] = above[channel] + rowSums[channel];
+            }
+
+            above += channelCount;
+            current += channelCount;
+        }
+    }
+}
+
+template <typename T>
+void KisSummedAreaTable::Private::addSums(const QRect &area, qreal weight, qreal *result) const
+{
+    using sum_type = typename SumTraits<T>::sum_type;
+
+    const QVector<sum_type> &table = storage(sum_type());
+
+    const QRect clipped = area & rect;
+    if (clipped.isEmpty() || table.isEmpty()) return;
+
+    const int stride = rowStride();
+    const int left = (clipped.left() - rect.left()) * channelCount;
+    const int right = (clipped.right() + 1 - rect.left()) * channelCount;
+
+    const sum_type *top = table.constData() + (clipped.top() - rect.top()) * stride;
+    const sum_type *bottom = table.constData() + (clipped.bottom() + 1 - rect.top()) * stride;
+
+    for (int channel = 0; channel < channelCount; channel++) {
+        // the integer sums may wrap around, but their difference is exact
+        const sum_type sum =
+            bottom[right + channel] - bottom[left + channel] -
+            top[right + channel] + top[left + channel];
+
+        result[channel] += weight * qreal(sum);
+    }
+
+    result[channelCount] += weight * clipped.width() * clipped.height();
+}
+
+template <typename T>
+void KisSummedAreaTable::Private::pixelFromSums(const qreal *sums, quint8 *dstU8) const
+{
+    T *dst = reinterpret_cast<T*>(dstU8);
+    const qreal count = sums[channelCount];
+
+    if (count <= 0.0) {
+        std::fill(dst, dst + channelCount, T(0));
+        return;
+    }
+
+    if (alphaIndex < 0) {
+        for (int channel = 0; channel < channelCount; channel++) {
+            dst[channel] = channelFromMean<T>(sums[channel] / count);
+        }
+        return;
+    }
+
+    const qreal totalAlpha = sums[alphaIndex];
+
+    for (int channel = 0; channel < channelCount; channel++) {
+        if (channel == alphaIndex) {
+            dst[channel] = channelFromMean<T>(totalAlpha / count);
+        } else {
+            dst[channel] = totalAlpha > 0.0 ? channelFromMean<T>(sums[channel] / totalAlpha) : T(0);
+        }
+    }
+}
+
+template <typename T>
+void KisSummedAreaTable::Private::weightedMeanPixel(const QPoint &pos, const QVector<Box> &boxes, qreal *sums, quint8 *dst) const
+{
+    std::fill(sums, sums + channelCount + 1, 0.0);
+
+    for (const Box &box : boxes) {
+        addSums<T>(box.rect.translated(pos), box.weight, sums);
+    }
+
+    pixelFromSums<T>(sums, dst);
+}
+
+template <typename T>
+void KisSummedAreaTable::Private::applyBoxes(KisPaintDeviceSP dst, const QRect &tileRect, const QVector<Box> &boxes) const
+{
+    QVarLengthArray<qreal, 8> sums(channelCount + 1);
+
+    KisSequentialIterator dstIt(dst, tileRect);
+    while (dstIt.nextPixel()) {
+        weightedMeanPixel<T>(QPoint(dstIt.x(), dstIt.y()), boxes, sums.data(), dstIt.rawData());
+    }
+}
+
+#define DISPATCH_CHANNEL_TYPE(type, func, args)         \
+    switch (type) {                                     \
+    case KoChannelInfo::UINT8:                          \
+        func<quint8> args;                              \
+        break;                                          \
+    case KoChannelInfo::UINT16:                         \
+        func<quint16> args;                             \
+        break;                                          \
+    case KoChannelInfo::FLOAT32:                        \
+        func<float> args;                               \
+        break;                                          \
+    default:                                            \
+        KIS_SAFE_ASSERT_RECOVER_NOOP(0 && "unsupported channel type"); \
+    }
+
+bool KisSummedAreaTable::isSupported(const KoColorSpace *cs)
+{
+    const QList<KoChannelInfo*> channels = cs->channels();
+    if (channels.isEmpty()) return false;
+
+    const KoChannelInfo::enumChannelValueType type = channels.first()->channelValueType();
+
+    if (type != KoChannelInfo::UINT8 &&
+        type != KoChannelInfo::UINT16 &&
+        type != KoChannelInfo::FLOAT32) {
+
+        return false;
+    }
+
+    Q_FOREACH (const KoChannelInfo *channel, channels) {
+        if (channel->channelValueType() != type) return false;
+    }
+
+    return cs->pixelSize() == quint32(channels.size() * channels.first()->size());
+}
+
+QRect KisSummedAreaTable::borderRepeatRect(KisPaintDeviceSP device, const QRect &rect)
+{
+    // the same rules as in KisConvolutionPainter::applyMatrix()
+    if (device->defaultBounds()->wrapAroundMode() && device->supportsWraproundMode()) {
+        return QRect();
+    }
+
+    const QRect boundsRect = device->defaultBounds()->bounds();
+    return boundsRect != KisDefaultBounds().bounds() ?
+        rect | boundsRect : rect | device->exactBounds();
+}
+
+KisSummedAreaTable::KisSummedAreaTable(KisPaintDeviceSP device, const QRect &rect, const QRect &dataRect)
+    : m_d(new Private)
+{
+    m_d->colorSpace = device->colorSpace();
+    m_d->rect = rect;
+
+    KIS_SAFE_ASSERT_RECOVER_RETURN(isSupported(m_d->colorSpace));
+
+    const QList<KoChannelInfo*> channels = m_d->colorSpace->channels();
+    const int channelSize = channels.first()->size();
+
+    m_d->channelType = channels.first()->channelValueType();
+    m_d->channelCount = channels.size();
+
+    Q_FOREACH (const KoChannelInfo *channel, channels) {
+        if (channel->channelType() == KoChannelInfo::ALPHA) {
+            m_d->alphaIndex = channel->pos() / channelSize;
+        }
+    }
+
+    if (rect.isEmpty()) return;
+
+    DISPATCH_CHANNEL_TYPE(m_d->channelType, m_d->build, (device, dataRect));
+}
+
+KisSummedAreaTable::~KisSummedAreaTable()
+{
+}
+
+QRect KisSummedAreaTable::rect() const
+{
+    return m_d->rect;
+}
+
+const KoColorSpace* KisSummedAreaTable::colorSpace() const
+{
+    return m_d->colorSpace;
+}
+
+void KisSummedAreaTable::meanPixel(const QRect &area, quint8 *dst) const
+{
+    const Box box = {area, 1.0};
+    weightedMeanPixel(QPoint(), QVector<Box>({box}), dst);
+}
+
+void KisSummedAreaTable::weightedMeanPixel(const QPoint &pos, const QVector<Box> &boxes, quint8 *dst) const
+{
+    QVarLengthArray<qreal, 8> sums(m_d->channelCount + 1);
+    DISPATCH_CHANNEL_TYPE(m_d->channelType, m_d->weightedMeanPixel, (pos, boxes, sums.data(), dst));
+}
+
+void KisSummedAreaTable::applyBoxes(KisPaintDeviceSP src, KisPaintDeviceSP dst, const QRect &applyRect,
+                                    const QVector<Box> &boxes, const QRect &dataRect,
+                                    KoUpdater *progressUpdater)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(isSupported(src->colorSpace()));
+    KIS_SAFE_ASSERT_RECOVER_RETURN(*src->colorSpace() == *dst->colorSpace());
+
+    QRect kernelRect;
+    for (const Box &box : boxes) {
+        kernelRect |= box.rect;
+    }
+
+    /**
+     * The margins of the tiles overlap with the neighbouring tiles,
+     * so they cannot be written into the source device directly
+     */
+    KisPaintDeviceSP result = dst;
+    if (src == dst) {
+        result = new KisPaintDevice(dst->colorSpace());
+    }
+
+    const int tilesX = (applyRect.width() + tileSize - 1) / tileSize;
+    const int tilesY = (applyRect.height() + tileSize - 1) / tileSize;
+    int tilesDone = 0;
+
+    for (int ty = 0; ty < tilesY; ty++) {
+        for (int tx = 0; tx < tilesX; tx++) {
+            const QRect tileRect =
+                QRect(applyRect.x() + tx * tileSize, applyRect.y() + ty * tileSize, tileSize, tileSize) & applyRect;
+
+            const QRect tableRect =
+                tileRect.adjusted(kernelRect.left(), kernelRect.top(), kernelRect.right(), kernelRect.bottom());
+
+            KisSummedAreaTable table(src, tableRect, dataRect);
+            DISPATCH_CHANNEL_TYPE(table.m_d->channelType, table.m_d->applyBoxes, (result, tileRect, boxes));
+
+            tilesDone++;
+
+            if (progressUpdater) {
+                progressUpdater->setProgress(100 * tilesDone / (tilesX * tilesY));
+                if (progressUpdater->interrupted()) return;
+            }
+        }
+    }
+
+    if (result != dst) {
+        KisPainter::copyAreaOptimized(applyRect.topLeft(), result, dst, applyRect);
+    }
+}
+
+void KisSummedAreaTable::boxMean(const float *src, float *dst, int width, int height, int radius)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(radius >= 0);
+
+    if (width <= 0 || height <= 0) return;
+
+    const int stride = width + 1;
+    QVector<double> table((height + 1) * stride, 0.0);
+
+    for (int y = 0; y < height; y++) {
+        const float *srcRow = src + y * width;
+        const double *above = table.constData() + y * stride + 1;
+        double *current = table.data() + (y + 1) * stride + 1;
+
+        double rowSum = 0.0;
+
+        for (int x = 0; x < width; x++) {
+            rowSum += srcRow[x];
+            current[x] = above[x] + rowSum;
+        }
+    }
+
+    for (int y = 0; y < height; y++) {
+        const int top = qMax(0, y - radius);
+        const int bottom = qMin(height - 1, y + radius) + 1;
+
+        const double *topRow = table.constData() + top * stride;
+        const double *bottomRow = table.constData() + bottom * stride;
+        float *dstRow = dst + y * width;
+
+        for (int x = 0; x < width; x++) {
+            const int left = qMax(0, x - radius);
+            const int right = qMin(width - 1, x + radius) + 1;
+
+            const double sum = bottomRow[right] - bottomRow[left] - topRow[right] + topRow[left];
+            dstRow[x] = float(sum / ((bottom - top) * (right - left)));
+        }
+    }
+}
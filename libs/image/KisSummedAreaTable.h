@@ -0,0 +1,121 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISSUMMEDAREATABLE_H
+#define KISSUMMEDAREATABLE_H
+
+#include <QRect>
+#include <QScopedPointer>
+#include <QVector>
+
+#include "kis_types.h"
+#include "kritaimage_export.h"
+
+class KoColorSpace;
+class KoUpdater;
+
+/**
+ * Summed-area table (integral image) of a rect of a paint device. It
+ * stores the sums of all the channels over all the rects starting at the
+ * top-left corner of the table, so the sum over any rect is found with
+ * four lookups, no matter how big the rect is.
+ *
+ * The color channels are premultiplied by alpha, so the means are the
+ * same as the ones of KoMixColorsOp. 8- and 16-bit integer channels are
+ * summed exactly in 64-bit unsigned integers: even if the running sums
+ * wrap around, the sums of the boxes stay exact as long as the boxes have
+ * less than 2^32 pixels. 32-bit float channels are summed in double
+ * precision.
+ *
+ * A table takes 8 bytes per channel of every pixel, so big areas should
+ * be processed in tiles, each with its own table. applyBoxes() does that
+ * for the filters that are weighted sums of box kernels.
+ *
+ * boxMean() is the same technique for single channel float buffers, it
+ * is used by the filters that compute their own statistics, like
+ * KisGuidedFilter.
+ */
+class KRITAIMAGE_EXPORT KisSummedAreaTable
+{
+public:
+    /**
+     * A box of the kernel, \p rect is relative to the filtered pixel
+     */
+    struct Box {
+        QRect rect;
+        qreal weight = 1.0;
+    };
+
+    /**
+     * \return true if all the channels of \p cs are 8-bit or 16-bit
+     *         integers or 32-bit floats
+     */
+    static bool isSupported(const KoColorSpace *cs);
+
+    /**
+     * \return the rect whose border pixels are repeated for the
+     *         pixels outside it when \p rect of \p device is convolved
+     *         with BORDER_REPEAT, or a null rect if nothing should be
+     *         repeated (e.g. in the wrap-around mode)
+     */
+    static QRect borderRepeatRect(KisPaintDeviceSP device, const QRect &rect);
+
+    /**
+     * Builds the table of \p rect of \p device. The old data of the
+     * device is read if there is a transaction running.
+     *
+     * If \p dataRect is valid, the pixels outside it are replaced by the
+     * closest pixels inside it (the same as BORDER_REPEAT of
+     * KisConvolutionPainter).
+     */
+    KisSummedAreaTable(KisPaintDeviceSP device, const QRect &rect, const QRect &dataRect = QRect());
+    ~KisSummedAreaTable();
+
+    QRect rect() const;
+    const KoColorSpace* colorSpace() const;
+
+    /**
+     * Writes the mean color of the pixels of \p area into \p dst. The
+     * area is clipped by rect(); if nothing is left, \p dst is filled
+     * with zeros.
+     */
+    void meanPixel(const QRect &area, quint8 *dst) const;
+
+    /**
+     * Writes the mean color of the pixels covered by \p boxes placed at
+     * \p pos, weighted by the weights of the boxes
+     */
+    void weightedMeanPixel(const QPoint &pos, const QVector<Box> &boxes, quint8 *dst) const;
+
+    /**
+     * Convolves \p applyRect of \p src with the kernel made of \p boxes
+     * and writes the result into \p dst, which may be the same device.
+     *
+     * The rect is processed in tiles, the table of every tile covers the
+     * margins needed by the boxes, so the memory usage is bounded while
+     * the cost per pixel is constant for any size of the boxes.
+     */
+    static void applyBoxes(KisPaintDeviceSP src, KisPaintDeviceSP dst, const QRect &applyRect,
+                           const QVector<Box> &boxes, const QRect &dataRect,
+                           KoUpdater *progressUpdater = nullptr);
+
+    /**
+     * Replaces every element of a single channel float buffer, stored
+     * row by row, with the mean of the window of the size
+     * (2 * radius + 1)^2 around it. The windows are clipped by the
+     * borders of the buffer. The sums are accumulated in double
+     * precision. \p src and \p dst may be the same buffer.
+     */
+    static void boxMean(const float *src, float *dst, int width, int height, int radius);
+
+private:
+    Q_DISABLE_COPY(KisSummedAreaTable)
+
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISSUMMEDAREATABLE_H
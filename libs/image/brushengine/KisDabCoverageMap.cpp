@@ -0,0 +1,192 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisDabCoverageMap.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <QBitArray>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPoint>
+#include <QVector>
+
+namespace {
+
+const int cellSizeShift = 3;
+static_assert((1 << cellSizeShift) == KisDabCoverageMap::cellSize, "cellSize must be a power of two");
+
+// the map is stored in chunks of chunkSize x chunkSize cells
+const int chunkSizeShift = 5;
+const int chunkSize = 1 << chunkSizeShift;
+
+inline int cellFloor(int x) {
+    // arithmetic shift rounds towards negative infinity
+    return x >> cellSizeShift;
+}
+
+inline quint64 chunkKey(int chunkX, int chunkY) {
+    return (quint64(quint32(chunkX)) << 32) | quint64(quint32(chunkY));
+}
+
+/**
+ * \return the range of cells lying completely inside [start, end)
+ */
+inline void innerCells(int start, int end, int *firstCell, int *lastCell) {
+    *firstCell = cellFloor(start + KisDabCoverageMap::cellSize - 1);
+    *lastCell = cellFloor(end) - 1;
+}
+
+}
+
+struct KisDabCoverageMap::Private
+{
+    mutable QMutex mutex;
+    QHash<quint64, QBitArray> chunks;
+    int numSaturatedCells = 0;
+
+    bool isCellSaturated(int cellX, int cellY) const {
+        auto it = chunks.constFind(chunkKey(cellX >> chunkSizeShift, cellY >> chunkSizeShift));
+        if (it == chunks.constEnd()) return false;
+
+        return it->testBit((cellY & (chunkSize - 1)) * chunkSize + (cellX & (chunkSize - 1)));
+    }
+
+    void markCell(int cellX, int cellY) {
+        QBitArray &chunk = chunks[chunkKey(cellX >> chunkSizeShift, cellY >> chunkSizeShift)];
+        if (chunk.isEmpty()) {
+            chunk.resize(chunkSize * chunkSize);
+        }
+
+        const int bit = (cellY & (chunkSize - 1)) * chunkSize + (cellX & (chunkSize - 1));
+        if (!chunk.testBit(bit)) {
+            chunk.setBit(bit);
+            numSaturatedCells++;
+        }
+    }
+};
+
+KisDabCoverageMap::KisDabCoverageMap()
+    : m_d(new Private)
+{
+}
+
+KisDabCoverageMap::~KisDabCoverageMap()
+{
+}
+
+bool KisDabCoverageMap::isSaturated(const QRect &rc) const
+{
+    if (rc.isEmpty()) return true;
+
+    const int firstCellX = cellFloor(rc.left());
+    const int lastCellX = cellFloor(rc.right());
+    const int firstCellY = cellFloor(rc.top());
+    const int lastCellY = cellFloor(rc.bottom());
+
+    QMutexLocker l(&m_d->mutex);
+
+    if (m_d->numSaturatedCells < (lastCellX - firstCellX + 1) * (lastCellY - firstCellY + 1)) {
+        return false;
+    }
+
+    for (int cellY = firstCellY; cellY <= lastCellY; cellY++) {
+        for (int cellX = firstCellX; cellX <= lastCellX; cellX++) {
+            if (!m_d->isCellSaturated(cellX, cellY)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void KisDabCoverageMap::addSaturatedRect(const QRect &rc)
+{
+    int firstCellX, lastCellX, firstCellY, lastCellY;
+    innerCells(rc.left(), rc.left() + rc.width(), &firstCellX, &lastCellX);
+    innerCells(rc.top(), rc.top() + rc.height(), &firstCellY, &lastCellY);
+
+    QMutexLocker l(&m_d->mutex);
+
+    for (int cellY = firstCellY; cellY <= lastCellY; cellY++) {
+        for (int cellX = firstCellX; cellX <= lastCellX; cellX++) {
+            m_d->markCell(cellX, cellY);
+        }
+    }
+}
+
+void KisDabCoverageMap::addSaturatedPixels(const QRect &bounds, const quint8 *data, int pixelSize, const quint8 *saturatedPixel)
+{
+    int firstCellX, lastCellX, firstCellY, lastCellY;
+    innerCells(bounds.left(), bounds.left() + bounds.width(), &firstCellX, &lastCellX);
+    innerCells(bounds.top(), bounds.top() + bounds.height(), &firstCellY, &lastCellY);
+
+    if (firstCellX > lastCellX || firstCellY > lastCellY) return;
+
+    const int rowStride = bounds.width() * pixelSize;
+    const int numCellsX = lastCellX - firstCellX + 1;
+
+    /**
+     * First, find the saturated cells without holding the lock. For every
+     * row of cells we keep a flag per cell, which is reset as soon as a
+     * pixel of another color is found.
+     */
+    QVector<QPoint> saturatedCells;
+    QVector<bool> cellIsSaturated(numCellsX);
+
+    for (int cellY = firstCellY; cellY <= lastCellY; cellY++) {
+        std::fill(cellIsSaturated.begin(), cellIsSaturated.end(), true);
+
+        for (int y = cellY * cellSize; y < (cellY + 1) * cellSize; y++) {
+            const quint8 *rowPtr = data + (y - bounds.top()) * rowStride;
+
+            for (int i = 0; i < numCellsX; i++) {
+                if (!cellIsSaturated[i]) continue;
+
+                const int cellLeft = (firstCellX + i) * cellSize;
+                const quint8 *pixelPtr = rowPtr + (cellLeft - bounds.left()) * pixelSize;
+
+                for (int x = 0; x < cellSize; x++) {
+                    if (memcmp(pixelPtr, saturatedPixel, pixelSize)) {
+                        cellIsSaturated[i] = false;
+                        break;
+                    }
+                    pixelPtr += pixelSize;
+                }
+            }
+        }
+
+        for (int i = 0; i < numCellsX; i++) {
+            if (cellIsSaturated[i]) {
+                saturatedCells.append(QPoint(firstCellX + i, cellY));
+            }
+        }
+    }
+
+    if (saturatedCells.isEmpty()) return;
+
+    QMutexLocker l(&m_d->mutex);
+
+    for (const QPoint &cell : saturatedCells) {
+        m_d->markCell(cell.x(), cell.y());
+    }
+}
+
+int KisDabCoverageMap::numSaturatedCells() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->numSaturatedCells;
+}
+
+void KisDabCoverageMap::clear()
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->chunks.clear();
+    m_d->numSaturatedCells = 0;
+}
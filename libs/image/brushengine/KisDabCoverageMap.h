@@ -0,0 +1,74 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISDABCOVERAGEMAP_H
+#define KISDABCOVERAGEMAP_H
+
+#include "kritaimage_export.h"
+
+#include <QRect>
+#include <QScopedPointer>
+
+/**
+ * A low-resolution map of the areas of the stroke that are already
+ * saturated, i.e. fully covered with the opaque paint color.
+ *
+ * When all the dabs of a stroke have the same color, a dab painted over
+ * a saturated area with "Normal" or "Alpha Darken" blending mode doesn't
+ * change a single pixel there: the color is interpolated between two
+ * equal values and the alpha channel is already at its maximum. The
+ * paintop can skip such dabs completely without changing the result.
+ *
+ * The map consists of cells of cellSize x cellSize pixels. A cell is
+ * marked as saturated only if all its pixels are known to be saturated,
+ * so the map is always conservative.
+ *
+ * The map is thread-safe.
+ */
+class KRITAIMAGE_EXPORT KisDabCoverageMap
+{
+public:
+    static const int cellSize = 8;
+
+public:
+    KisDabCoverageMap();
+    ~KisDabCoverageMap();
+
+    /**
+     * \return true if all the pixels of \p rc are saturated
+     */
+    bool isSaturated(const QRect &rc) const;
+
+    /**
+     * Marks the cells lying completely inside \p rc as saturated
+     */
+    void addSaturatedRect(const QRect &rc);
+
+    /**
+     * Marks as saturated the cells whose pixels all equal to \p saturatedPixel
+     *
+     * \param bounds the position of the pixels in the stroke
+     * \param data the pixels themselves, with no padding between the rows
+     * \param pixelSize the size of a single pixel in bytes
+     * \param saturatedPixel the opaque paint color of the stroke
+     */
+    void addSaturatedPixels(const QRect &bounds, const quint8 *data, int pixelSize, const quint8 *saturatedPixel);
+
+    /**
+     * \return the number of the saturated cells
+     */
+    int numSaturatedCells() const;
+
+    void clear();
+
+private:
+    Q_DISABLE_COPY(KisDabCoverageMap)
+
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISDABCOVERAGEMAP_H
@@ -0,0 +1,145 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisStrokeInputRecording.h"
+
+#include <QDataStream>
+#include <QFile>
+
+#include <kis_debug.h>
+#include "kis_paint_information.h"
+
+namespace {
+const quint32 recordingMagic = 0x4b534952; // "KSIR"
+const quint32 recordingVersion = 1;
+}
+
+void KisStrokeInputRecording::addSample(const KisPaintInformation &info)
+{
+    Sample sample;
+    sample.pos = info.pos();
+    sample.pressure = info.pressure();
+    sample.xTilt = info.xTilt();
+    sample.yTilt = info.yTilt();
+    sample.rotation = info.rotation();
+    sample.tangentialPressure = info.tangentialPressure();
+    sample.perspective = info.perspective();
+    sample.time = info.currentTime();
+    sample.speed = info.drawingSpeed();
+
+    m_samples.append(sample);
+}
+
+void KisStrokeInputRecording::addSample(const Sample &sample)
+{
+    m_samples.append(sample);
+}
+
+void KisStrokeInputRecording::clear()
+{
+    m_samples.clear();
+}
+
+bool KisStrokeInputRecording::isEmpty() const
+{
+    return m_samples.isEmpty();
+}
+
+int KisStrokeInputRecording::size() const
+{
+    return m_samples.size();
+}
+
+const KisStrokeInputRecording::Sample &KisStrokeInputRecording::sample(int index) const
+{
+    return m_samples[index];
+}
+
+KisPaintInformation KisStrokeInputRecording::paintInformation(int index) const
+{
+    const Sample &s = m_samples[index];
+
+    return KisPaintInformation(s.pos, s.pressure, s.xTilt, s.yTilt,
+                               s.rotation, s.tangentialPressure,
+                               s.perspective, s.time, s.speed);
+}
+
+qreal KisStrokeInputRecording::duration() const
+{
+    return m_samples.size() > 1 ? m_samples.last().time - m_samples.first().time : 0.0;
+}
+
+bool KisStrokeInputRecording::save(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        warnKrita << "KisStrokeInputRecording: failed to open" << fileName << "for writing";
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_15);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    stream << recordingMagic << recordingVersion << quint32(m_samples.size());
+
+    for (const Sample &s : m_samples) {
+        stream << s.pos.x() << s.pos.y()
+               << s.pressure << s.xTilt << s.yTilt
+               << s.rotation << s.tangentialPressure << s.perspective
+               << s.time << s.speed;
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
+
+bool KisStrokeInputRecording::load(const QString &fileName)
+{
+    m_samples.clear();
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        warnKrita << "KisStrokeInputRecording: failed to open" << fileName;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_15);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 numSamples = 0;
+
+    stream >> magic >> version >> numSamples;
+
+    if (magic != recordingMagic || version != recordingVersion) {
+        warnKrita << "KisStrokeInputRecording: unsupported file format" << fileName;
+        return false;
+    }
+
+    for (quint32 i = 0; i < numSamples && stream.status() == QDataStream::Ok; i++) {
+        Sample s;
+        qreal x = 0.0;
+        qreal y = 0.0;
+
+        stream >> x >> y
+               >> s.pressure >> s.xTilt >> s.yTilt
+               >> s.rotation >> s.tangentialPressure >> s.perspective
+               >> s.time >> s.speed;
+
+        s.pos = QPointF(x, y);
+        m_samples.append(s);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        warnKrita << "KisStrokeInputRecording: the file is truncated" << fileName;
+        m_samples.clear();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,65 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISSTROKEINPUTRECORDING_H
+#define KISSTROKEINPUTRECORDING_H
+
+#include "kritaimage_export.h"
+
+#include <QPointF>
+#include <QString>
+#include <QVector>
+
+class KisPaintInformation;
+
+/**
+ * A sequence of paint information objects of a single freehand stroke,
+ * as they were generated from the tablet events.
+ *
+ * The recording is saved in a compact binary form, so the strokes can
+ * be recorded during a normal painting session (see
+ * KisUpdateTimeMonitor::setTracingEnabled()) and replayed later in a
+ * benchmark against any preset (see benchmarks/KisStrokeReplayBenchmark).
+ */
+class KRITAIMAGE_EXPORT KisStrokeInputRecording
+{
+public:
+    struct Sample {
+        QPointF pos;
+        qreal pressure = 1.0;
+        qreal xTilt = 0.0;
+        qreal yTilt = 0.0;
+        qreal rotation = 0.0;
+        qreal tangentialPressure = 0.0;
+        qreal perspective = 1.0;
+        qreal time = 0.0;
+        qreal speed = 0.0;
+    };
+
+public:
+    void addSample(const KisPaintInformation &info);
+    void addSample(const Sample &sample);
+
+    void clear();
+    bool isEmpty() const;
+    int size() const;
+
+    const Sample& sample(int index) const;
+    KisPaintInformation paintInformation(int index) const;
+
+    /**
+     * \return the duration of the stroke in milliseconds
+     */
+    qreal duration() const;
+
+    bool save(const QString &fileName) const;
+    bool load(const QString &fileName);
+
+private:
+    QVector<Sample> m_samples;
+};
+
+#endif // KISSTROKEINPUTRECORDING_H
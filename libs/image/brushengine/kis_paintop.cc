@@ -35,6 +35,7 @@
 #include <kis_distance_information.h>
 
 #include <qnumeric.h>
+#include <KisPerformanceTracer.h>
 
 struct Q_DECL_HIDDEN KisPaintOp::Private {
     Private(KisPaintOp *_q)
@@ -148,6 +149,8 @@ void KisPaintOp::paintLine(const KisPaintInformation &pi1,
 void KisPaintOp::paintAt(const KisPaintInformation& info, KisDistanceInformation *currentDistance)
 {
     Q_ASSERT(currentDistance);
+    KIS_TRACE_SCOPE("paintop", "paintAt");
+
     KisPaintInformation pi(info);
     pi.paintAt(*this, currentDistance);
 }
@@ -16,6 +16,9 @@
 #include "kis_math_toolbox.h"
 
 #include <QMutex>
+#include <QMutexLocker>
+#include <QHash>
+#include <QPair>
 #include <QVector>
 #include <QTextStream>
 #include <QFile>
@@ -29,11 +32,70 @@ template<class _IteratorFactory_> class KisConvolutionWorkerFFT;
 class KisConvolutionWorkerFFTLock
 {
 private:
+    struct BlockPlans {
+        fftw_plan forward {0};
+        fftw_plan backward {0};
+        bool isCached {false};
+    };
+
+    /**
+     * The plans of the tiled mode are cached per block size. Executing
+     * a plan on new arrays is thread-safe in FFTW, so all the workers
+     * share the same plans, only the planner should be guarded by
+     * fftwMutex.
+     *
+     * The plans are created for in-place transforms of fftw_malloc'ed
+     * buffers, the workers' buffers must be the same.
+     */
+    static BlockPlans fetchBlockPlans(int width, int height) {
+        QMutexLocker l(&fftwMutex);
+
+        const QPair<int, int> key(width, height);
+
+        auto it = blockPlans.constFind(key);
+        if (it != blockPlans.constEnd()) {
+            return *it;
+        }
+
+        const int length = height * (width / 2 + 1);
+        fftw_complex *buffer = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * length);
+
+        BlockPlans plans;
+        plans.forward = fftw_plan_dft_r2c_2d(height, width, (double*)buffer, buffer, FFTW_ESTIMATE);
+        plans.backward = fftw_plan_dft_c2r_2d(height, width, buffer, (double*)buffer, FFTW_ESTIMATE);
+
+        fftw_free(buffer);
+
+        if (blockPlans.size() < maxCachedBlockPlans) {
+            plans.isCached = true;
+            blockPlans.insert(key, plans);
+        }
+
+        return plans;
+    }
+
+    static void releaseBlockPlans(const BlockPlans &plans) {
+        if (plans.isCached) return;
+
+        QMutexLocker l(&fftwMutex);
+        fftw_destroy_plan(plans.forward);
+        fftw_destroy_plan(plans.backward);
+    }
+
+    /**
+     * The block sizes are rounded to FFT-friendly values, so in practice
+     * only a few of them are used
+     */
+    static constexpr int maxCachedBlockPlans = 64;
+
     static QMutex fftwMutex;
+    static QHash<QPair<int, int>, BlockPlans> blockPlans;
+
     template<class _IteratorFactory_> friend class KisConvolutionWorkerFFT;
 };
 
 QMutex KisConvolutionWorkerFFTLock::fftwMutex;
+QHash<QPair<int, int>, KisConvolutionWorkerFFTLock::BlockPlans> KisConvolutionWorkerFFTLock::blockPlans;
 
 
 template<class _IteratorFactory_>
@@ -71,11 +133,15 @@ public:
         addToProgress(0);
         if (isInterrupted()) return;
 
-        const quint32 halfKernelWidth = (kernel->width() - 1) / 2;
-        const quint32 halfKernelHeight = (kernel->height() - 1) / 2;
+        if (useTiledMode(kernel, areaSize)) {
+            executeTiled(kernel, src, srcPos, dstPos, areaSize, dataRect);
+            return;
+        }
 
-        m_fftWidth = areaSize.width() + 4 * halfKernelWidth;
-        m_fftHeight = areaSize.height() + 2 * halfKernelHeight;
+        const QPoint margin = leadingMargin(kernel);
+
+        m_fftWidth = areaSize.width() + 2 * (kernel->width() - 1);
+        m_fftHeight = areaSize.height() + kernel->height() - 1;
 
         /**
          * FIXME: check whether this "optimization" is needed to
@@ -107,8 +173,8 @@ public:
         int cacheRowStride = m_fftWidth + m_extraMem;
 
         fillCacheFromDevice(src,
-                            QRect(srcPos.x() - halfKernelWidth,
-                                  srcPos.y() - halfKernelHeight,
+                            QRect(srcPos.x() - margin.x(),
+                                  srcPos.y() - margin.y(),
                                   m_fftWidth,
                                   m_fftHeight),
                             cacheRowStride,
@@ -151,14 +217,197 @@ public:
         KisConvolutionWorkerFFTLock::fftwMutex.unlock();
 
 
-        writeResultToDevice(QRect(dstPos.x(), dstPos.y(), areaSize.width(), areaSize.height()),
-                            cacheRowStride, halfKernelWidth, halfKernelHeight,
+        writeResultToDevice(this->m_painter->device(),
+                            QRect(dstPos.x(), dstPos.y(), areaSize.width(), areaSize.height()),
+                            cacheRowStride, margin.x(), margin.y(),
                             info, dataRect);
 
         addToProgress(20);
         cleanUp();
     }
 
+    /**
+     * Overlap-save convolution: the area is split into tiles, and every
+     * tile is convolved in a separate FFT block, which includes the tile
+     * and the kernel-sized border around it. The memory usage is limited
+     * by the size of the block, which depends on the kernel size only.
+     */
+    void executeTiled(const KisConvolutionKernelSP kernel,
+                      const KisPaintDeviceSP src,
+                      QPoint srcPos,
+                      QPoint dstPos,
+                      QSize areaSize,
+                      const QRect &dataRect)
+    {
+        const QPoint margin = leadingMargin(kernel);
+
+        m_fftWidth = tiledBlockSize(kernel->width(), areaSize.width());
+        m_fftHeight = tiledBlockSize(kernel->height(), areaSize.height());
+        m_fftLength = m_fftHeight * (m_fftWidth / 2 + 1);
+        m_extraMem = (m_fftWidth % 2) ? 1 : 2;
+
+        /**
+         * Only the pixels, whose whole window fits into the block, are
+         * not spoiled by the wrap-around of the cyclic convolution
+         */
+        const int tileWidth = m_fftWidth - (kernel->width() - 1);
+        const int tileHeight = m_fftHeight - (kernel->height() - 1);
+
+        m_kernelFFT = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * m_fftLength);
+        memset(m_kernelFFT, 0, sizeof(fftw_complex) * m_fftLength);
+        fftFillKernelMatrix(kernel, m_kernelFFT);
+
+        QList<KoChannelInfo*> convChannelList = this->convolvableChannelList(src);
+
+        m_channelFFT.resize(convChannelList.count());
+        for (auto i = m_channelFFT.begin(); i != m_channelFFT.end(); ++i) {
+            *i = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * m_fftLength);
+        }
+
+        const double kernelFactor = kernel->factor() ? kernel->factor() : 1;
+        const double fftScale = 1.0 / (m_fftHeight * m_fftWidth) / kernelFactor;
+
+        FFTInfo info (fftScale, convChannelList, kernel, this->m_painter->device()->colorSpace());
+        const int cacheRowStride = m_fftWidth + m_extraMem;
+
+        const KisConvolutionWorkerFFTLock::BlockPlans plans =
+            KisConvolutionWorkerFFTLock::fetchBlockPlans(m_fftWidth, m_fftHeight);
+
+        fftw_execute_dft_r2c(plans.forward, (double*)m_kernelFFT, m_kernelFFT);
+
+        const QRect dstRect(dstPos, areaSize);
+        KisPaintDeviceSP dstDevice = this->m_painter->device();
+
+        /**
+         * Every block reads the source around its tile, so when
+         * convolving in-place, the blocks would read the pixels already
+         * written by the neighbouring tiles. Collect the result in a
+         * temporary device then.
+         */
+        KisPaintDeviceSP resultDevice = dstDevice;
+        if (dstDevice.data() == src.data()) {
+            resultDevice = new KisPaintDevice(dstDevice->colorSpace());
+            KisPainter::copyAreaOptimized(dstRect.topLeft(), dstDevice, resultDevice, dstRect);
+        }
+
+        const int numTilesX = (areaSize.width() + tileWidth - 1) / tileWidth;
+        const int numTilesY = (areaSize.height() + tileHeight - 1) / tileHeight;
+        const float progressPerTile = (100 - 10) / float(numTilesX * numTilesY);
+
+        addToProgress(10);
+
+        for (int row = 0; row < numTilesY; row++) {
+            for (int column = 0; column < numTilesX; column++) {
+                const QRect tileRect =
+                    QRect(column * tileWidth, row * tileHeight, tileWidth, tileHeight) &
+                    QRect(QPoint(), areaSize);
+
+                fillCacheFromDevice(src,
+                                    QRect(srcPos.x() + tileRect.x() - margin.x(),
+                                          srcPos.y() + tileRect.y() - margin.y(),
+                                          m_fftWidth,
+                                          m_fftHeight),
+                                    cacheRowStride,
+                                    info, dataRect);
+
+                for (auto k = m_channelFFT.begin(); k != m_channelFFT.end(); ++k) {
+                    fftw_execute_dft_r2c(plans.forward, (double*)(*k), *k);
+                    fftMultiply(*k, m_kernelFFT);
+                    fftw_execute_dft_c2r(plans.backward, *k, (double*)*k);
+                }
+
+                writeResultToDevice(resultDevice,
+                                    tileRect.translated(dstPos),
+                                    cacheRowStride, margin.x(), margin.y(),
+                                    info, dataRect);
+
+                addToProgress(progressPerTile);
+                if (isInterrupted()) {
+                    KisConvolutionWorkerFFTLock::releaseBlockPlans(plans);
+                    return;
+                }
+            }
+        }
+
+        KisConvolutionWorkerFFTLock::releaseBlockPlans(plans);
+
+        if (resultDevice != dstDevice) {
+            KisPainter::copyAreaOptimized(dstRect.topLeft(), resultDevice, dstDevice, dstRect);
+        }
+
+        cleanUp();
+    }
+
+    /**
+     * The tiled mode is used when the FFT of the whole area would eat
+     * too much memory and the blocks are noticeably smaller than the area
+     */
+    bool useTiledMode(const KisConvolutionKernelSP kernel, const QSize &areaSize) const
+    {
+        const qint64 fullArea =
+            qint64(areaSize.width() + 2 * (kernel->width() - 1)) *
+            (areaSize.height() + kernel->height() - 1);
+
+        if (fullArea <= maxUntiledFFTArea) return false;
+
+        const qint64 blockArea =
+            qint64(tiledBlockSize(kernel->width(), areaSize.width())) *
+            tiledBlockSize(kernel->height(), areaSize.height());
+
+        return 2 * blockArea <= fullArea;
+    }
+
+    /**
+     * The size of the block should be about four times bigger than the
+     * kernel, otherwise most of the work is spent on the tile borders.
+     */
+    static int tiledBlockSize(int kernelSize, int areaSize)
+    {
+        const int halfKernelSize = (kernelSize - 1) / 2;
+
+        int blockSize = 8 * halfKernelSize;
+        if (blockSize > maxPreferredBlockSize) {
+            blockSize = qMax(maxPreferredBlockSize, 4 * halfKernelSize);
+        }
+        blockSize = qMax(blockSize, minBlockSize);
+        blockSize = qMin(blockSize, areaSize + kernelSize - 1);
+
+        return optimalFFTSize(blockSize);
+    }
+
+    /**
+     * The kernel is flipped by the convolution, so the window of a pixel
+     * starts kernelSize - 1 - center pixels before it, where the center
+     * is (kernelSize - 1) / 2. For the even kernels the window reaches
+     * one pixel further to the left (top) than to the right (bottom).
+     *
+     * \return the offset of the pixel from the start of its window
+     */
+    static QPoint leadingMargin(const KisConvolutionKernelSP kernel)
+    {
+        return QPoint(kernel->width() / 2, kernel->height() / 2);
+    }
+
+    /**
+     * \return the smallest size not less than \p size, which has
+     *         no prime factors bigger than 7, FFTW is the most efficient
+     *         for such sizes
+     */
+    static int optimalFFTSize(int size)
+    {
+        for (int candidate = size; ; candidate++) {
+            int value = candidate;
+
+            for (int factor : {2, 3, 5, 7}) {
+                while (value % factor == 0) {
+                    value /= factor;
+                }
+            }
+
+            if (value == 1) return candidate;
+        }
+    }
+
     struct FFTInfo {
         FFTInfo(qreal _fftScale,
                 const QList<KoChannelInfo*> &_convChannelList,
@@ -315,19 +564,20 @@ public:
         return channelPixelValue;
     }
 
-    void writeResultToDevice(const QRect &rect,
+    void writeResultToDevice(KisPaintDeviceSP dstDevice,
+                             const QRect &rect,
                              const int cacheRowStride,
-                             const int halfKernelWidth,
-                             const int halfKernelHeight,
+                             const int marginLeft,
+                             const int marginTop,
                              const FFTInfo &info,
                              const QRect &dataRect) {
 
         typename _IteratorFactory_::HLineIterator hitDst =
-            _IteratorFactory_::createHLineIterator(this->m_painter->device(),
+            _IteratorFactory_::createHLineIterator(dstDevice,
                                                    rect.x(), rect.y(), rect.width(),
                                                    dataRect);
 
-        int initialOffset = cacheRowStride * halfKernelHeight + halfKernelWidth;
+        int initialOffset = cacheRowStride * marginTop + marginLeft;
 
         const int channelCount = info.numChannels();
         QVector<double*> channelPtr(channelCount);
@@ -544,6 +794,13 @@ private:
         m_channelFFT.clear();
     }
 private:
+    /**
+     * 2048x2048 block takes 64 MiB per channel
+     */
+    static constexpr qint64 maxUntiledFFTArea = 2048 * 2048;
+    static constexpr int minBlockSize = 256;
+    static constexpr int maxPreferredBlockSize = 2048;
+
     quint32 m_fftWidth {0};
     quint32 m_fftHeight {0};
     quint32 m_fftLength {0};
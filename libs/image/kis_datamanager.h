@@ -155,6 +155,10 @@ public:
         return ACTUAL_DATAMGR::region();
     }
 
+    KisRegion changedRegion(const KisDataManager *baseline) const {
+        return ACTUAL_DATAMGR::changedRegion(baseline);
+    }
+
 public:
 
     /**
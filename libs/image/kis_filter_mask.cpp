@@ -13,7 +13,10 @@
 #include "filter/kis_filter.h"
 #include "filter/kis_filter_configuration.h"
 #include "filter/kis_filter_registry.h"
+#include "filter/kis_color_transformation_filter.h"
+#include "filter/kis_color_transformation_configuration.h"
 #include "kis_selection.h"
+#include "kis_pixel_selection.h"
 #include "kis_processing_information.h"
 #include "kis_node.h"
 #include "kis_node_visitor.h"
@@ -166,3 +169,41 @@ QRect KisFilterMask::needRect(const QRect& rect, PositionToFilthy pos) const
     return filter->neededRect(rect, filterConfig.data(), lod);
 }
 
+KoColorTransformation* KisFilterMask::colorTransformationForRect(KisFilterConfigurationSP filterConfig,
+                                                                 const KoColorSpace *cs,
+                                                                 const QRect &rect) const
+{
+    if (!filterConfig) return 0;
+
+    KisFilterSP filter = KisFilterRegistry::instance()->value(filterConfig->name());
+
+    const KisColorTransformationFilter *colorFilter =
+        dynamic_cast<const KisColorTransformationFilter*>(filter.data());
+    const KisColorTransformationConfiguration *colorConfig =
+        dynamic_cast<const KisColorTransformationConfiguration*>(filterConfig.data());
+
+    if (!colorFilter || !colorConfig) return 0;
+
+    KisSelectionSP selection = this->selection();
+
+    if (selection) {
+        KisIndirectPaintingSupport::ReadLocker l(this);
+
+        if (hasTemporaryTarget()) return 0;
+
+        flattenSelectionProjection(selection, rect);
+
+        /**
+         * The mask is fully opaque inside the rect only when nothing has
+         * been painted there and the default pixel is selected
+         */
+        KisPixelSelectionSP projection = selection->projection();
+        if (*projection->defaultPixel().data() != MAX_SELECTED ||
+            projection->extent().intersects(rect)) {
+
+            return 0;
+        }
+    }
+
+    return colorConfig->colorTransformation(cs, colorFilter);
+}
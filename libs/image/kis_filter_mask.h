@@ -12,6 +12,8 @@
 #include "kis_node_filter_interface.h"
 #include "kis_filter_configuration.h"
 
+class KoColorSpace;
+class KoColorTransformation;
 
 /**
    An filter mask is a single channel mask that applies a particular
@@ -54,6 +56,24 @@ public:
 
     QRect changeRect(const QRect &rect, PositionToFilthy pos = N_FILTHY) const override;
     QRect needRect(const QRect &rect, PositionToFilthy pos = N_FILTHY) const override;
+
+    /**
+     * Returns the per-pixel color transformation of the filter if the mask
+     * can be applied to \p rect by just transforming its pixels in place,
+     * that is, the filter is a color transformation filter and the
+     * selection of the mask covers \p rect completely. Otherwise returns
+     * null.
+     *
+     * Such masks can be applied together with their neighbours in a single
+     * pass over the pixels (see KisLayer::applyMasks()).
+     *
+     * \p filterConfig should be the current filter() of the mask. The
+     * transformation is owned by it, so the caller should keep it alive
+     * while the transformation is in use.
+     */
+    KoColorTransformation* colorTransformationForRect(KisFilterConfigurationSP filterConfig,
+                                                      const KoColorSpace *cs,
+                                                      const QRect &rect) const;
 };
 
 #endif //_KIS_FILTER_MASK_
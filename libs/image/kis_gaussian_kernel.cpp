@@ -10,6 +10,7 @@
 #include "kis_convolution_kernel.h"
 #include <kis_convolution_painter.h>
 #include <kis_transaction.h>
+#include "KisRecursiveGaussianBlur.h"
 #include <QRect>
 
 
@@ -109,8 +110,16 @@ void KisGaussianKernel::applyGaussian(KisPaintDeviceSP device,
 {
     QPoint srcTopLeft = rect.topLeft();
 
+    /**
+     * For huge radii both convolution engines become too slow and
+     * memory-hungry, so the recursive filter is used instead. It never
+     * reads the pixels it has already written, so no transaction is needed.
+     */
+    if (KisRecursiveGaussianBlur::isPreferredForRadius(xRadius, yRadius)) {
+        KisRecursiveGaussianBlur::apply(device, rect, xRadius, yRadius,
+                                        channelFlags, progressUpdater, borderOp);
 
-    if (KisConvolutionPainter::supportsFFTW()) {
+    } else if (KisConvolutionPainter::supportsFFTW()) {
         KisConvolutionPainter painter(device, KisConvolutionPainter::FFTW);
         painter.setChannelFlags(channelFlags);
         painter.setProgress(progressUpdater);
@@ -80,6 +80,17 @@ void KisImageConfig::setEnablePerfLog(bool value)
     m_config.writeEntry("enablePerfLog", value);
 }
 
+bool KisImageConfig::enablePerfTrace(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("enablePerfTrace", false) :false;
+}
+
+void KisImageConfig::setEnablePerfTrace(bool value)
+{
+    m_config.writeEntry("enablePerfTrace", value);
+}
+
 qreal KisImageConfig::transformMaskOffBoundsReadArea() const
 {
     return m_config.readEntry("transformMaskOffBoundsReadArea", 0.5);
@@ -573,6 +584,28 @@ void KisImageConfig::setUseLodForColorizeMask(bool value)
     m_config.writeEntry("useLodForColorizeMask", value);
 }
 
+bool KisImageConfig::skipSaturatedDabs(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("skipSaturatedDabs", true) : true;
+}
+
+void KisImageConfig::setSkipSaturatedDabs(bool value)
+{
+    m_config.writeEntry("skipSaturatedDabs", value);
+}
+
+bool KisImageConfig::bakeColorAdjustmentsToLut(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("bakeColorAdjustmentsToLut", false) : false;
+}
+
+void KisImageConfig::setBakeColorAdjustmentsToLut(bool value)
+{
+    m_config.writeEntry("bakeColorAdjustmentsToLut", value);
+}
+
 int KisImageConfig::maxNumberOfThreads(bool defaultValue) const
 {
     return (defaultValue ? QThread::idealThreadCount() : m_config.readEntry("maxNumberOfThreads", QThread::idealThreadCount()));
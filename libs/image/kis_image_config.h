@@ -24,6 +24,9 @@ public:
     bool enablePerfLog(bool requestDefault = false) const;
     void setEnablePerfLog(bool value);
 
+    bool enablePerfTrace(bool requestDefault = false) const;
+    void setEnablePerfTrace(bool value);
+
     qreal transformMaskOffBoundsReadArea() const;
 
     int updatePatchHeight() const;
@@ -109,6 +112,22 @@ public:
     bool useLodForColorizeMask(bool requestDefault = false) const;
     void setUseLodForColorizeMask(bool value);
 
+    /**
+     * The pixel brush skips the dabs falling onto the areas already fully
+     * covered by the opaque color of the stroke. The result is exact, the
+     * option is a safety switch exposed in the performance settings
+     */
+    bool skipSaturatedDabs(bool requestDefault = false) const;
+    void setSkipSaturatedDabs(bool value);
+
+    /**
+     * Expensive per-pixel color adjustments (HSV, color balance, cross-channel
+     * curves) are sampled into a 3D LUT and interpolated, which is much faster
+     * but not exact
+     */
+    bool bakeColorAdjustmentsToLut(bool requestDefault = false) const;
+    void setBakeColorAdjustmentsToLut(bool value);
+
     int maxNumberOfThreads(bool defaultValue = false) const;
     void setMaxNumberOfThreads(int value);
 
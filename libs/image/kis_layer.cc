@@ -24,6 +24,7 @@
 #include <KoProperties.h>
 #include <KoCompositeOpRegistry.h>
 #include <KoColorSpace.h>
+#include <KoColorTransformation.h>
 
 #include "kis_debug.h"
 #include "kis_image.h"
@@ -32,6 +33,8 @@
 #include "kis_mask.h"
 #include "kis_effect_mask.h"
 #include "kis_filter_mask.h"
+#include "kis_busy_progress_indicator.h"
+#include "kis_sequential_iterator.h"
 #include "kis_selection_mask.h"
 #include "kis_meta_data_store.h"
 #include "kis_selection.h"
@@ -656,6 +659,77 @@ KisNode::PositionToFilthy calculatePositionToFilthy(KisNodeSP nodeInQuestion,
     return KisNode::N_BELOW_FILTHY;
 }
 
+namespace {
+
+/**
+ * Filter masks with per-pixel color filters (levels, curves, HSV
+ * adjustment etc.) don't need the temporary devices that KisMask::apply()
+ * creates for every mask, they can just transform the pixels in place.
+ * A run of such masks starting at \p first is applied in a single pass:
+ * every span of pixels goes through all the transformations while it is
+ * still in the cache.
+ *
+ * \return the number of the applied masks, or 0 if there are less than
+ *         two such masks in a row
+ */
+int applyColorTransformationMasks(const QList<KisEffectMaskSP> &masks,
+                                  const QVector<QRect> &applyRects,
+                                  const QRect &needRect,
+                                  int first,
+                                  KisPaintDeviceSP device)
+{
+    const KoColorSpace *cs = device->colorSpace();
+    const KoColorSpace *compositionCs = device->compositionSourceColorSpace();
+
+    // the same condition as for processing a device in place in KisFilter::process()
+    if (cs != compositionCs && *cs != *compositionCs) return 0;
+
+    const QRect rect = applyRects[first];
+
+    QVector<KisFilterMaskSP> filterMasks;
+    QVector<KisFilterConfigurationSP> configs;
+    QVector<KoColorTransformation*> transformations;
+
+    for (int i = first; i < masks.size(); i++) {
+        const QRect maskNeedRect = i + 1 < masks.size() ? applyRects[i + 1] : needRect;
+        if (applyRects[i] != rect || maskNeedRect != rect) break;
+
+        KisFilterMaskSP filterMask = dynamic_cast<KisFilterMask*>(masks[i].data());
+        if (!filterMask) break;
+
+        KisFilterConfigurationSP config = filterMask->filter();
+        KoColorTransformation *transformation = filterMask->colorTransformationForRect(config, cs, rect);
+        if (!transformation) break;
+
+        filterMasks.append(filterMask);
+        configs.append(config);
+        transformations.append(transformation);
+    }
+
+    if (transformations.size() < 2) return 0;
+
+    Q_FOREACH (KisFilterMaskSP mask, filterMasks) {
+        KIS_ASSERT_RECOVER_NOOP(mask->busyProgressIndicator());
+        mask->busyProgressIndicator()->update();
+    }
+
+    KisSequentialIterator it(device, rect);
+
+    int conseq = it.nConseqPixels();
+    while (it.nextPixels(conseq)) {
+        conseq = it.nConseqPixels();
+        quint8 *data = it.rawData();
+
+        for (KoColorTransformation *transformation : std::as_const(transformations)) {
+            transformation->transform(data, data, conseq);
+        }
+    }
+
+    return transformations.size();
+}
+
+}
+
 QRect KisLayer::applyMasks(const KisPaintDeviceSP source,
                            KisPaintDeviceSP destination,
                            const QRect &requestedRect,
@@ -705,15 +779,29 @@ QRect KisLayer::applyMasks(const KisPaintDeviceSP source,
                 copyOriginalToProjection(source, destination, needRect);
             }
 
-            Q_FOREACH (const KisEffectMaskSP& mask, masks) {
-                const QRect maskApplyRect = applyRects.pop();
+            QVector<QRect> maskApplyRects;
+            while (!applyRects.isEmpty()) {
+                maskApplyRects.append(applyRects.pop());
+            }
+            Q_ASSERT(maskApplyRects.size() == masks.size());
+
+            for (int i = 0; i < masks.size(); i++) {
+                const KisEffectMaskSP &mask = masks[i];
+                const QRect maskApplyRect = maskApplyRects[i];
                 const QRect maskNeedRect =
-                    applyRects.isEmpty() ? needRect : applyRects.top();
-                    
+                    i + 1 < masks.size() ? maskApplyRects[i + 1] : needRect;
+
+                const int numFusedMasks =
+                    applyColorTransformationMasks(masks, maskApplyRects, needRect, i, destination);
+
+                if (numFusedMasks > 0) {
+                    i += numFusedMasks - 1;
+                    continue;
+                }
+
                 PositionToFilthy maskPosition = calculatePositionToFilthy(mask, filthyNode, const_cast<KisLayer*>(this));
                 mask->apply(destination, maskApplyRect, maskNeedRect, maskPosition, flags);
             }
-            Q_ASSERT(applyRects.isEmpty());
         } else {
             /**
              * We can't eliminate additional copy-op
@@ -53,6 +53,11 @@
 #include "kis_command_ids.h"
 #include "kis_image_config.h"
 #include "KisFutureUtils.h"
+#include "KisRunnableStrokeJobUtils.h"
+#include "KisRunnableStrokeJobsInterface.h"
+#include "kis_processing_visitor.h"
+#include "kis_stroke_strategy_undo_command_based.h"
+#include <KoUpdater.h>
 #include "KisBatchUpdateLayerModificationCommand.h"
 #include "commands_new/KisChangeCloneLayersCommand.h"
 
@@ -707,20 +712,86 @@ namespace Private {
         bool m_skipMergingSourceLayer {false};
     };
 
-    struct MergeLayersMultiple : public KisCommandUtils::AggregateCommand {
+    /**
+     * Merges the layers in tile-aligned chunks, which are dispatched as
+     * concurrent jobs of the stroke, so flattening of a big image scales
+     * with the number of threads. The pixels are written into the newly
+     * created layer only once, on the first redo(); undo and redo of the
+     * layer itself are handled by the surrounding commands.
+     */
+    struct MergeLayersMultiple : public KUndo2Command, public KisStrokeStrategyUndoCommandBased::MutatedCommandInterface {
         MergeLayersMultiple(MergeMultipleInfoSP info) : m_info(info) {}
 
-        void populateChildCommands() override {
-            KisPainter gc(m_info->dstNode->paintDevice());
+        void redo() override {
+            if (m_isMerged) return;
+            m_isMerged = true;
 
-            foreach (KisNodeSP node, m_info->allSrcNodes()) {
-                QRect rc = node->exactBounds() | m_info->image->bounds();
-                node->projectionPlane()->apply(&gc, rc);
+            KisImageSP image = m_info->image;
+            KIS_SAFE_ASSERT_RECOVER_RETURN(image);
+
+            KisPaintDeviceSP dstDevice = m_info->dstNode->paintDevice();
+            const KisNodeList srcNodes = m_info->allSrcNodes();
+
+            QVector<QRect> nodeRects;
+            QRect totalRect;
+
+            Q_FOREACH (KisNodeSP node, srcNodes) {
+                const QRect rc = node->exactBounds() | image->bounds();
+                nodeRects << rc;
+                totalRect |= rc;
             }
+
+            const QVector<QRect> chunks =
+                KritaUtils::splitRectIntoPatches(totalRect, KritaUtils::optimalPatchSize());
+
+            QSharedPointer<KisProcessingVisitor::ProgressHelper> progressHelper;
+            if (!srcNodes.isEmpty()) {
+                progressHelper.reset(new KisProcessingVisitor::ProgressHelper(srcNodes.first().data()));
+            }
+
+            /**
+             * A single updater is shared by all the chunks, it is advanced
+             * by one step when a chunk is merged
+             */
+            KoUpdater *updater = progressHelper ? progressHelper->updater() : 0;
+            if (updater) {
+                updater->setRange(0, chunks.size());
+            }
+
+            QSharedPointer<QAtomicInt> numMergedChunks(new QAtomicInt(0));
+
+            QVector<KisRunnableStrokeJobData*> jobs;
+
+            Q_FOREACH (const QRect &chunk, chunks) {
+                KritaUtils::addJobConcurrent(jobs, [dstDevice, srcNodes, nodeRects, chunk, updater, numMergedChunks] () {
+                    KisPainter gc(dstDevice);
+
+                    for (int i = 0; i < srcNodes.size(); i++) {
+                        const QRect rc = chunk & nodeRects[i];
+                        if (rc.isEmpty()) continue;
+
+                        srcNodes[i]->projectionPlane()->apply(&gc, rc);
+                    }
+
+                    if (updater) {
+                        updater->setValue(numMergedChunks->fetchAndAddOrdered(1) + 1);
+                    }
+                });
+            }
+
+            KritaUtils::addJobBarrier(jobs, [progressHelper] () {
+                Q_UNUSED(progressHelper);
+            });
+
+            runnableJobsInterface()->addRunnableJobs(jobs);
+        }
+
+        void undo() override {
         }
 
     private:
         MergeMultipleInfoSP m_info;
+        bool m_isMerged = false;
     };
 
     struct MergeMetaData : public KUndo2Command {
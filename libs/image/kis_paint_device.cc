@@ -154,6 +154,7 @@ public:
     {
 
         m_lodData.reset();
+        m_lodPyramid.clear();
         m_externalFrameData.reset();
 
         if (!m_frames.isEmpty()) {
@@ -420,6 +421,22 @@ public:
     void uploadLodDataStruct(LodDataStruct *dst);
     KisRegion regionForLodSyncing() const;
 
+    /**
+     * A level of the persistent LoD pyramid. \p lodData is a clean
+     * downscaled copy of \p sourceDataManager, valid for the moment when
+     * \p sourceSnapshot was taken. The snapshot is a copy-on-write clone
+     * of the source, so it costs nothing until the source is written to,
+     * and every written tile can be found by comparing tile data pointers
+     * (see KisTiledDataManager::changedRegion()).
+     */
+    struct LodPyramidLevel {
+        KisDataManagerSP sourceDataManager;
+        KisDataManagerSP sourceSnapshot;
+        QScopedPointer<Data> lodData;
+    };
+    typedef QSharedPointer<LodPyramidLevel> LodPyramidLevelSP;
+    LodPyramidLevelSP validLodPyramidLevel(Data *srcData, int lod) const;
+
     void updateLodDataManager(KisDataManager *srcDataManager,
                               KisDataManager *dstDataManager, const QPoint &srcOffset, const QPoint &dstOffset,
                               const QRect &originalRect, int lod);
@@ -450,6 +467,10 @@ public:
             lodData += estimateDataSize(m_lodData.data());
         }
 
+        Q_FOREACH (LodPyramidLevelSP level, m_lodPyramid.values()) {
+            lodData += estimateDataSize(level->lodData.data());
+        }
+
         if (m_externalFrameData) {
             temporaryData += estimateDataSize(m_externalFrameData.data());
         }
@@ -593,6 +614,14 @@ private:
 private:
     DataSP m_data;
     mutable QScopedPointer<Data> m_lodData;
+
+    /**
+     * Persistent downscaled copies of the device, one per level of
+     * detail, kept between instant preview strokes. They are refreshed
+     * incrementally, only for the tiles that changed since the last
+     * synchronization.
+     */
+    QHash<int, LodPyramidLevelSP> m_lodPyramid;
     mutable QScopedPointer<Data> m_externalFrameData;
     mutable QMutex m_dataSwitchLock;
 
@@ -676,8 +705,39 @@ struct KisPaintDevice::Private::StrategyPolicy {
 struct KisPaintDevice::Private::LodDataStructImpl : public KisPaintDevice::LodDataStruct {
     LodDataStructImpl(Data *_lodData) : lodData(_lodData) {}
     QScopedPointer<Data> lodData;
+
+    /**
+     * When \p isIncremental is true, \p lodData has been cloned from
+     * a valid pyramid level and only \p dirtyRegion needs regenerating
+     */
+    bool isIncremental = false;
+    KisRegion dirtyRegion;
+
+    KisDataManagerSP sourceDataManager;
+    KisDataManagerSP sourceSnapshot;
 };
 
+KisPaintDevice::Private::LodPyramidLevelSP
+KisPaintDevice::Private::validLodPyramidLevel(Data *srcData, int lod) const
+{
+    LodPyramidLevelSP level = m_lodPyramid.value(lod);
+    if (!level) return level;
+
+    Data *lodData = level->lodData.data();
+
+    const bool isValid =
+        level->sourceDataManager == srcData->dataManager() &&
+        lodData->levelOfDetail() == lod &&
+        lodData->colorSpace() == srcData->colorSpace() &&
+        lodData->x() == KisLodTransform::coordToLodCoord(srcData->x(), lod) &&
+        lodData->y() == KisLodTransform::coordToLodCoord(srcData->y(), lod) &&
+        !memcmp(level->sourceSnapshot->defaultPixel(),
+                srcData->dataManager()->defaultPixel(),
+                srcData->dataManager()->pixelSize());
+
+    return isValid ? level : LodPyramidLevelSP();
+}
+
 KisRegion KisPaintDevice::Private::regionForLodSyncing() const
 {
     Data *srcData = currentNonLodData();
@@ -690,8 +750,56 @@ KisPaintDevice::LodDataStruct* KisPaintDevice::Private::createLodDataStruct(int
 
     Data *srcData = currentNonLodData();
 
+    LodPyramidLevelSP level = validLodPyramidLevel(srcData, newLod);
+
+    if (level) {
+        LodDataStructImpl *lodStruct =
+            new LodDataStructImpl(new Data(q, level->lodData.data(), true));
+
+        lodStruct->isIncremental = true;
+
+        /**
+         * The dirty region also contains the tiles that have been deleted
+         * from Lod0 (clear, crop, cut). They are not a part of the region
+         * for syncing anymore, so the whole dirty area is cleared here, and
+         * the areas that still have data are regenerated in
+         * updateLodDataStruct(). The rects are aligned to the LodN pixels,
+         * so that the pixels shared with the clean neighbour tiles are
+         * regenerated as well.
+         */
+        const KisRegion changedRegion =
+            srcData->dataManager()->changedRegion(level->sourceSnapshot.data())
+                .translated(srcData->x(), srcData->y());
+
+        QVector<QRect> dirtyRects;
+        Data *lodData = lodStruct->lodData.data();
+
+        Q_FOREACH (const QRect &rc, changedRegion.rects()) {
+            const QRect alignedRect = KisLodTransform::alignedRect(rc, newLod);
+            dirtyRects << alignedRect;
+
+            const QRect lodRect = KisLodTransform::scaledRect(alignedRect, newLod)
+                .translated(-lodData->x(), -lodData->y());
+
+            lodData->dataManager()->clear(lodRect.x(), lodRect.y(),
+                                          lodRect.width(), lodRect.height(),
+                                          lodData->dataManager()->defaultPixel());
+        }
+
+        lodStruct->dirtyRegion = KisRegion(std::move(dirtyRects));
+
+        lodStruct->sourceDataManager = srcData->dataManager();
+        lodStruct->sourceSnapshot = new KisDataManager(*srcData->dataManager());
+
+        lodStruct->lodData->cache()->invalidate();
+
+        return lodStruct;
+    }
+
     Data *lodData = new Data(q, srcData, false);
-    LodDataStruct *lodStruct = new LodDataStructImpl(lodData);
+    LodDataStructImpl *lodStruct = new LodDataStructImpl(lodData);
+    lodStruct->sourceDataManager = srcData->dataManager();
+    lodStruct->sourceSnapshot = new KisDataManager(*srcData->dataManager());
 
     int expectedX = KisLodTransform::coordToLodCoord(srcData->x(), newLod);
     int expectedY = KisLodTransform::coordToLodCoord(srcData->y(), newLod);
@@ -814,10 +922,21 @@ void KisPaintDevice::Private::updateLodDataStruct(LodDataStruct *_dst, const QRe
 
     const int lod = lodData->levelOfDetail();
 
-    updateLodDataManager(srcData->dataManager().data(), lodData->dataManager().data(),
-                         QPoint(srcData->x(), srcData->y()),
-                         QPoint(lodData->x(), lodData->y()),
-                         originalRect, lod);
+    if (dst->isIncremental) {
+        const KisRegion dirtyRegion = dst->dirtyRegion & originalRect;
+
+        Q_FOREACH (const QRect &rc, dirtyRegion.rects()) {
+            updateLodDataManager(srcData->dataManager().data(), lodData->dataManager().data(),
+                                 QPoint(srcData->x(), srcData->y()),
+                                 QPoint(lodData->x(), lodData->y()),
+                                 rc, lod);
+        }
+    } else {
+        updateLodDataManager(srcData->dataManager().data(), lodData->dataManager().data(),
+                             QPoint(srcData->x(), srcData->y()),
+                             QPoint(lodData->x(), lodData->y()),
+                             originalRect, lod);
+    }
 }
 
 void KisPaintDevice::Private::generateLodCloneDevice(KisPaintDeviceSP dst, const QRect &originalRect, int lod)
@@ -843,6 +962,18 @@ void KisPaintDevice::Private::uploadLodDataStruct(LodDataStruct *_dst)
 
     m_lodData->prepareClone(dst->lodData.data());
     m_lodData->dataManager()->bitBltRough(dst->lodData->dataManager(), dst->lodData->dataManager()->extent());
+
+    /**
+     * The tiles are shared with m_lodData in copy-on-write manner, so
+     * the preview stroke painting on the LodN plane will not spoil the
+     * clean copy we keep for the next synchronization.
+     */
+    LodPyramidLevelSP level(new LodPyramidLevel());
+    level->sourceDataManager = dst->sourceDataManager;
+    level->sourceSnapshot = dst->sourceSnapshot;
+    level->lodData.reset(new Data(q, dst->lodData.data(), true));
+
+    m_lodPyramid.insert(level->lodData->levelOfDetail(), level);
 }
 
 void KisPaintDevice::Private::transferFromData(Data *data, KisPaintDeviceSP targetDevice)
@@ -918,6 +918,15 @@ public:
     };
 
     KisRegion regionForLodSyncing() const;
+
+    /**
+     * Creates a structure for generating LodN plane of the device.
+     *
+     * The device keeps the result of the previous synchronization for
+     * every level of detail. If the previous result is still valid,
+     * then updateLodDataStruct() regenerates only the tiles that have
+     * been changed since then, and ignores the rest of the passed rect.
+     */
     LodDataStruct* createLodDataStruct(int lod);
     void updateLodDataStruct(LodDataStruct *dst, const QRect &srcRect);
     void uploadLodDataStruct(LodDataStruct *dst);
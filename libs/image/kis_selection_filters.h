@@ -31,8 +31,6 @@ public:
     virtual QRect changeRect(const QRect &rect, KisDefaultBoundsBaseSP defaultBounds);
 
 protected:
-    void computeBorder(qint32  *circ, qint32  xradius, qint32  yradius);
-
     void rotatePointers(quint8  **p, quint32 n);
 
     void computeTransition(quint8* transition, quint8** buf, qint32 width);
@@ -8,6 +8,9 @@
 
 #include <QMutexLocker>
 #include <QVector>
+#include <QHash>
+
+#include <algorithm>
 
 #include "kis_image_config.h"
 #include "kis_full_refresh_walker.h"
@@ -41,8 +44,134 @@
 #endif /* ENABLE_ACCUMULATOR */
 
 
+struct KisSimpleUpdateQueue::WalkersIndex
+{
+    struct Entry {
+        KisBaseRectsWalkerSP walker;
+        quint64 seqNo;
+    };
+
+    struct Location {
+        quint64 cell;
+        quint64 seqNo;
+    };
+
+    void setCellSize(int width, int height) {
+        cellWidth = qMax(1, width);
+        cellHeight = qMax(1, height);
+    }
+
+    void clear() {
+        cells.clear();
+        locations.clear();
+    }
+
+    void add(KisBaseRectsWalkerSP walker) {
+        addImpl(walker, nextSeqNo++);
+    }
+
+    void remove(KisBaseRectsWalkerSP walker) {
+        auto locationIt = locations.find(walker.data());
+        if (locationIt == locations.end()) return;
+
+        auto cellIt = cells.find(locationIt->cell);
+        KIS_SAFE_ASSERT_RECOVER_RETURN(cellIt != cells.end());
+
+        QVector<Entry> &entries = *cellIt;
+        auto it = std::find_if(entries.begin(), entries.end(),
+                               [walker] (const Entry &entry) {
+                                   return entry.walker == walker;
+                               });
+        if (it != entries.end()) {
+            entries.erase(it);
+        }
+
+        if (entries.isEmpty()) {
+            cells.erase(cellIt);
+        }
+
+        locations.erase(locationIt);
+    }
+
+    /**
+     * Should be called when the requested rect of the walker has
+     * changed. The walker keeps its original position in the queue.
+     */
+    void update(KisBaseRectsWalkerSP walker) {
+        auto locationIt = locations.find(walker.data());
+        KIS_SAFE_ASSERT_RECOVER_RETURN(locationIt != locations.end());
+
+        const quint64 seqNo = locationIt->seqNo;
+        remove(walker);
+        addImpl(walker, seqNo);
+    }
+
+    /**
+     * Returns the walkers with the same level of detail, whose
+     * requested rect's top-left corner lies in \p area, in the
+     * order they were added to the queue.
+     */
+    QVector<Entry> entriesInArea(int levelOfDetail, const QRect &area) const {
+        QVector<Entry> result;
+
+        const int firstCol = cellIndex(area.left(), cellWidth);
+        const int lastCol = cellIndex(area.right(), cellWidth);
+        const int firstRow = cellIndex(area.top(), cellHeight);
+        const int lastRow = cellIndex(area.bottom(), cellHeight);
+
+        for (int row = firstRow; row <= lastRow; row++) {
+            for (int col = firstCol; col <= lastCol; col++) {
+                auto it = cells.constFind(cellKey(levelOfDetail, col, row));
+                if (it == cells.constEnd()) continue;
+
+                Q_FOREACH (const Entry &entry, *it) {
+                    if (area.contains(entry.walker->requestedRect().topLeft())) {
+                        result.append(entry);
+                    }
+                }
+            }
+        }
+
+        std::sort(result.begin(), result.end(),
+                  [] (const Entry &lhs, const Entry &rhs) {
+                      return lhs.seqNo < rhs.seqNo;
+                  });
+
+        return result;
+    }
+
+    int cellWidth = 512;
+    int cellHeight = 512;
+
+private:
+    void addImpl(KisBaseRectsWalkerSP walker, quint64 seqNo) {
+        const QPoint pt = walker->requestedRect().topLeft();
+        const quint64 cell = cellKey(walker->levelOfDetail(),
+                                     cellIndex(pt.x(), cellWidth),
+                                     cellIndex(pt.y(), cellHeight));
+
+        cells[cell].append({walker, seqNo});
+        locations.insert(walker.data(), {cell, seqNo});
+    }
+
+    static inline int cellIndex(int coord, int cellSize) {
+        return coord >= 0 ? coord / cellSize : -((-coord - 1) / cellSize) - 1;
+    }
+
+    static inline quint64 cellKey(int levelOfDetail, int col, int row) {
+        return (quint64(quint8(levelOfDetail)) << 56) ^
+               (quint64(quint32(col) & 0xFFFFFFF) << 28) ^
+               quint64(quint32(row) & 0xFFFFFFF);
+    }
+
+    QHash<quint64, QVector<Entry>> cells;
+    QHash<KisBaseRectsWalker*, Location> locations;
+    quint64 nextSeqNo = 0;
+};
+
 KisSimpleUpdateQueue::KisSimpleUpdateQueue()
-    : m_overrideLevelOfDetail(-1)
+    : m_overrideLevelOfDetail(-1),
+      m_walkersIndex(new WalkersIndex())
 {
     updateSettings();
 }
@@ -68,6 +197,17 @@ void KisSimpleUpdateQueue::updateSettings()
     m_maxCollectAlpha = config.maxCollectAlpha();
     m_maxMergeAlpha = config.maxMergeAlpha();
     m_maxMergeCollectAlpha = config.maxMergeCollectAlpha();
+
+    if (m_walkersIndex->cellWidth != m_patchWidth ||
+        m_walkersIndex->cellHeight != m_patchHeight) {
+
+        m_walkersIndex->clear();
+        m_walkersIndex->setCellSize(m_patchWidth, m_patchHeight);
+
+        Q_FOREACH (KisBaseRectsWalkerSP walker, m_updatesList) {
+            m_walkersIndex->add(walker);
+        }
+    }
 }
 
 int KisSimpleUpdateQueue::overrideLevelOfDetail() const
@@ -111,6 +251,7 @@ bool KisSimpleUpdateQueue::processOneJob(KisUpdaterContext &updaterContext)
 
             updaterContext.addMergeJob(item);
             iter.remove();
+            m_walkersIndex->remove(item);
             jobAdded = true;
             break;
         }
@@ -236,11 +377,48 @@ void KisSimpleUpdateQueue::addJob(KisNodeSP node, const QVector<QRect> &rects,
 
     if (!walkers.isEmpty()) {
         m_lock.lock();
-        m_updatesList.append(walkers);
+        appendWalkers(walkers);
         m_lock.unlock();
     }
 }
 
+void KisSimpleUpdateQueue::appendWalkers(const KisWalkersList &walkers)
+{
+    m_updatesList.append(walkers);
+
+    Q_FOREACH (KisBaseRectsWalkerSP walker, walkers) {
+        m_walkersIndex->add(walker);
+    }
+}
+
+void KisSimpleUpdateQueue::removeWalker(KisBaseRectsWalkerSP walker)
+{
+    m_updatesList.removeOne(walker);
+    m_walkersIndex->remove(walker);
+}
+
+KisWalkersList KisSimpleUpdateQueue::mergeCandidates(const QRect &baseRect, int levelOfDetail) const
+{
+    /**
+     * The united rect of two joined walkers must fit into a single
+     * patch (see joinRects()), so the top-left corner of any joinable
+     * rect lies not further than a patch size away from \p baseRect.
+     * That stays true while baseRect grows in collectJobs(), since
+     * the grown rect is also limited by the patch size.
+     */
+    const QRect searchArea =
+        baseRect.adjusted(-m_patchWidth, -m_patchHeight, m_patchWidth, m_patchHeight);
+
+    KisWalkersList result;
+
+    Q_FOREACH (const WalkersIndex::Entry &entry,
+               m_walkersIndex->entriesInArea(levelOfDetail, searchArea)) {
+        result.append(entry.walker);
+    }
+
+    return result;
+}
+
 void KisSimpleUpdateQueue::addSpontaneousJob(KisSpontaneousJob *spontaneousJob)
 {
     QMutexLocker locker(&m_lock);
@@ -320,7 +498,9 @@ bool KisSimpleUpdateQueue::tryMergeJob(KisNodeSP node, const QRect& rc,
 
     KisBaseRectsWalkerSP goodCandidate;
     KisBaseRectsWalkerSP item;
-    KisWalkersListIterator iter(m_updatesList);
+
+    const KisWalkersList candidates = mergeCandidates(rc, levelOfDetail);
+    KisWalkersListIterator iter(candidates);
 
     /**
      * We add new jobs to the tail of the list,
@@ -367,7 +547,9 @@ void KisSimpleUpdateQueue::collectJobs(KisBaseRectsWalkerSP &baseWalker,
                                        const qreal maxAlpha)
 {
     KisBaseRectsWalkerSP item;
-    KisMutableWalkersListIterator iter(m_updatesList);
+
+    const KisWalkersList candidates = mergeCandidates(baseRect, baseWalker->levelOfDetail());
+    KisWalkersListIterator iter(candidates);
 
     while(iter.hasNext()) {
         item = iter.next();
@@ -380,12 +562,13 @@ void KisSimpleUpdateQueue::collectJobs(KisBaseRectsWalkerSP &baseWalker,
         if(item->levelOfDetail() != baseWalker->levelOfDetail()) continue;
 
         if(joinRects(baseRect, item->requestedRect(), maxAlpha)) {
-            iter.remove();
+            removeWalker(item);
         }
     }
 
     if(baseWalker->requestedRect() != baseRect) {
         baseWalker->collectRects(baseWalker->startNode(), baseRect);
+        m_walkersIndex->update(baseWalker);
     }
 }
 
@@ -8,6 +8,7 @@
 #define __KIS_SIMPLE_UPDATE_QUEUE_H
 
 #include <QMutex>
+#include <QScopedPointer>
 #include "kis_updater_context.h"
 #include <KisProjectionUpdateFlags.h>
 
@@ -61,6 +62,10 @@ protected:
                      const qreal maxAlpha);
     bool joinRects(QRect& baseRect, const QRect& newRect, qreal maxAlpha);
 
+    void appendWalkers(const KisWalkersList &walkers);
+    void removeWalker(KisBaseRectsWalkerSP walker);
+    KisWalkersList mergeCandidates(const QRect &baseRect, int levelOfDetail) const;
+
 protected:
 
     mutable QMutex m_lock;
@@ -97,6 +102,16 @@ protected:
     qreal m_maxMergeCollectAlpha;
 
     int m_overrideLevelOfDetail;
+
+private:
+    /**
+     * Spatial index of the pending walkers. Two rects can be joined
+     * only when their union fits into one update patch, so the merge
+     * candidates are looked up in a grid of patch-sized cells instead
+     * of scanning the whole m_updatesList on every update.
+     */
+    struct WalkersIndex;
+    QScopedPointer<WalkersIndex> m_walkersIndex;
 };
 
 class KRITAIMAGE_EXPORT KisTestableSimpleUpdateQueue : public KisSimpleUpdateQueue
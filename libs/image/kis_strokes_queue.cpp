@@ -16,6 +16,7 @@
 #include "kis_undo_stores.h"
 #include "kis_post_execution_undo_adapter.h"
 #include "KisCppQuirks.h"
+#include <KisPerformanceTracer.h>
 
 typedef QQueue<KisStrokeSP> StrokesQueue;
 typedef QQueue<KisStrokeSP>::iterator StrokesQueueIterator;
@@ -89,6 +90,7 @@ struct Q_DECL_HIDDEN KisStrokesQueue::Private {
     KisSuspendResumeStrategyPairFactory suspendResumeUpdatesStrokeStrategyFactory;
     std::function<void()> purgeRedoStateCallback;
     std::function<void()> postSyncLod0GUIPlaneRequestForResume;
+    std::function<void()> mutatedJobsAddedCallback;
     KisSurrogateUndoStore lodNUndoStore;
     LodNUndoStrokesFacade lodNStrokesFacade;
     KisPostExecutionUndoAdapter lodNPostExecutionUndoAdapter;
@@ -360,12 +362,18 @@ void KisStrokesQueue::addJob(KisStrokeId id, KisStrokeJobData *data)
 
 void KisStrokesQueue::addMutatedJobs(KisStrokeId id, const QVector<KisStrokeJobData *> list)
 {
-    QMutexLocker locker(&m_d->mutex);
+    {
+        QMutexLocker locker(&m_d->mutex);
 
-    KisStrokeSP stroke = id.toStrongRef();
-    KIS_SAFE_ASSERT_RECOVER_RETURN(stroke);
+        KisStrokeSP stroke = id.toStrongRef();
+        KIS_SAFE_ASSERT_RECOVER_RETURN(stroke);
+
+        stroke->addMutatedJobs(list);
+    }
 
-    stroke->addMutatedJobs(list);
+    if (m_d->mutatedJobsAddedCallback) {
+        m_d->mutatedJobsAddedCallback();
+    }
 }
 
 void KisStrokesQueue::endStroke(KisStrokeId id)
@@ -589,6 +597,8 @@ void KisStrokesQueue::Private::forceResetLodAndCloseCurrentLodRange()
 void KisStrokesQueue::processQueue(KisUpdaterContext &updaterContext,
                                    bool externalJobsPending)
 {
+    KIS_TRACE_SCOPE("scheduler", "processStrokesQueue");
+
     updaterContext.lock();
     m_d->mutex.lock();
 
@@ -720,6 +730,11 @@ void KisStrokesQueue::setPostSyncLod0GUIPlaneRequestForResumeCallback(const std:
     m_d->postSyncLod0GUIPlaneRequestForResume = callback;
 }
 
+void KisStrokesQueue::setMutatedJobsAddedCallback(const std::function<void ()> &callback)
+{
+    m_d->mutatedJobsAddedCallback = callback;
+}
+
 KisPostExecutionUndoAdapter *KisStrokesQueue::lodNPostExecutionUndoAdapter() const
 {
     return &m_d->lodNPostExecutionUndoAdapter;
@@ -772,6 +787,10 @@ void KisStrokesQueue::Private::loadStroke(KisStrokeSP stroke)
     balancingRatioOverride = stroke->balancingRatioOverride();
     currentStrokeLoaded = true;
 
+    if (KisPerformanceTracer::isEnabled()) {
+        KisPerformanceTracer::instance()->addInstantEvent("stroke", "strokeStarted", stroke->id());
+    }
+
     /**
      * Some of the strokes can cancel their work with undoing all the
      * changes they did to the paint devices. The problem is that undo
@@ -848,6 +867,10 @@ bool KisStrokesQueue::checkStrokeState(bool hasStrokeJobsRunning,
             m_d->postSyncLod0GUIPlaneRequestForResume();
         }
 
+        if (KisPerformanceTracer::isEnabled()) {
+            KisPerformanceTracer::instance()->addInstantEvent("stroke", "strokeFinished", stroke->id());
+        }
+
         m_d->strokesQueue.dequeue(); // deleted by shared pointer
         m_d->needsExclusiveAccess = false;
         m_d->wrapAroundModeSupported = false;
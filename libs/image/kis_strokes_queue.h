@@ -60,6 +60,14 @@ public:
     void setSuspendResumeUpdatesStrokeStrategyFactory(const KisSuspendResumeStrategyPairFactory &factory);
     void setPurgeRedoStateCallback(const std::function<void()> &callback);
     void setPostSyncLod0GUIPlaneRequestForResumeCallback(const std::function<void()> &callback);
+
+    /**
+     * The callback is called (without the queue lock held) every time a
+     * running stroke adds mutated jobs, e.g. to let the scheduler start
+     * them on the spare threads right away instead of waiting for some
+     * other job to finish
+     */
+    void setMutatedJobsAddedCallback(const std::function<void()> &callback);
     KisPostExecutionUndoAdapter* lodNPostExecutionUndoAdapter() const;
 
     /**
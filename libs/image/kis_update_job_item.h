@@ -18,6 +18,7 @@
 #include "kis_async_merger.h"
 #include "kis_updater_context.h"
 #include <KoAlwaysInline.h>
+#include <KisPerformanceTracer.h>
 
 //#define DEBUG_JOBS_SEQUENCE
 
@@ -87,6 +88,13 @@ private:
                            m_atomicType == Type::SPONTANEOUS);
 
                 if (m_runnableJob) {
+                    KisPerformanceTracer::Scope traceScope("updater",
+                                                           m_atomicType == Type::STROKE ?
+                                                           "strokeJob" : "spontaneousJob");
+                    if (traceScope.isActive()) {
+                        traceScope.setDetail(m_runnableJob->debugName());
+                    }
+
 #ifdef DEBUG_JOBS_SEQUENCE
                     if (m_atomicType == Type::STROKE) {
                         qDebug() << "running: stroke" << m_runnableJob->debugName();
@@ -132,6 +140,14 @@ public:
 
 #endif
 
+        KisPerformanceTracer::Scope traceScope("updater", "mergeJob");
+        if (traceScope.isActive()) {
+            const QRect rc = m_walker->changeRect();
+            traceScope.setDetail(QString("%1,%2 %3x%4")
+                                 .arg(rc.x()).arg(rc.y())
+                                 .arg(rc.width()).arg(rc.height()));
+        }
+
         m_merger.startMerge(*m_walker);
 
         QRect changeRect = m_walker->changeRect();
@@ -68,6 +68,16 @@ KisUpdateScheduler::KisUpdateScheduler(KisProjectionUpdateListener *projectionUp
 {
     updateSettings();
     connectSignals();
+
+    /**
+     * The mutated jobs are usually added by a running job that is going
+     * to wait for them (e.g. a paintop splitting its dabs into concurrent
+     * tasks), so they should be started on the spare threads right away.
+     * Otherwise, they would wait until some other job finishes.
+     */
+    m_d->strokesQueue.setMutatedJobsAddedCallback([this] () {
+        processQueues();
+    });
 }
 
 KisUpdateScheduler::KisUpdateScheduler()
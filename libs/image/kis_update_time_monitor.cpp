@@ -6,6 +6,8 @@
 
 #include "kis_update_time_monitor.h"
 
+#include <atomic>
+
 #include <QGlobalStatic>
 #include <QHash>
 #include <QSet>
@@ -20,16 +22,36 @@
 #include <QElapsedTimer>
 
 #include <QFileInfo>
+#include <QRegularExpression>
+#include <QThreadPool>
 
 #include <kis_debug.h>
 #include <KisPortingUtils.h>
+#include <KisPerformanceTracer.h>
 #include "kis_image_config.h"
 
 
 #include <brushengine/kis_paintop_preset.h>
+#include <brushengine/KisStrokeInputRecording.h>
 
 Q_GLOBAL_STATIC(KisUpdateTimeMonitor, s_instance)
 
+namespace {
+
+/**
+ * The name of a preset is arbitrary user text, so it may contain path
+ * separators or "..". Only the word characters are kept for the names
+ * of the log files.
+ */
+QString safePresetFileName(KisPaintOpPresetSP preset)
+{
+    QString name = preset->name();
+    name.replace(QRegularExpression("[^\\w\\-]"), "_");
+    return name;
+}
+
+}
+
 
 struct StrokeTicket
 {
@@ -73,9 +95,13 @@ struct Q_DECL_HIDDEN KisUpdateTimeMonitor::Private
           numTickets(0),
           numUpdates(0),
           mousePath(0.0),
-          loggingEnabled(false)
+          loggingEnabled(false),
+          tracingEnabled(false),
+          numTracedStrokes(0)
     {
-        loggingEnabled = KisImageConfig(true).enablePerfLog();
+        KisImageConfig cfg(true);
+        loggingEnabled = cfg.enablePerfLog();
+        tracingEnabled = cfg.enablePerfTrace();
     }
 
     QHash<void*, StrokeTicket*> preliminaryTickets;
@@ -93,6 +119,22 @@ struct Q_DECL_HIDDEN KisUpdateTimeMonitor::Private
     KisPaintOpPresetSP preset;
 
     bool loggingEnabled;
+
+    /**
+     * Read without the mutex by the stroke strategies and the tools
+     */
+    std::atomic<bool> tracingEnabled;
+    int numTracedStrokes;
+
+    /**
+     * The number of the traced strokes that have been started, but not
+     * finished yet. The tracer is reset only when there are none, so that
+     * the events of the previous stroke would not be cut off.
+     */
+    int numRunningTracedStrokes = 0;
+
+    KisStrokeInputRecording strokeInput;
+    int numRecordedStrokes = 0;
 };
 
 KisUpdateTimeMonitor::KisUpdateTimeMonitor()
@@ -105,6 +147,10 @@ KisUpdateTimeMonitor::KisUpdateTimeMonitor()
         }
         dir.mkdir("log");
     }
+
+    if (m_d->tracingEnabled) {
+        setTracingEnabled(true);
+    }
 }
 
 KisUpdateTimeMonitor::~KisUpdateTimeMonitor()
@@ -117,8 +163,35 @@ KisUpdateTimeMonitor* KisUpdateTimeMonitor::instance()
     return s_instance;
 }
 
+void KisUpdateTimeMonitor::setTracingEnabled(bool value)
+{
+    QMutexLocker locker(&m_d->mutex);
+
+    m_d->tracingEnabled = value;
+
+    if (value) {
+        QDir dir;
+        if (!dir.exists("log")) {
+            dir.mkdir("log");
+        }
+    }
+
+    m_d->numRunningTracedStrokes = 0;
+    KisPerformanceTracer::instance()->takeTrace();
+    KisPerformanceTracer::instance()->setEnabled(value);
+}
+
 void KisUpdateTimeMonitor::startStrokeMeasure()
 {
+    if (m_d->tracingEnabled) {
+        QMutexLocker locker(&m_d->mutex);
+
+        if (!m_d->numRunningTracedStrokes) {
+            KisPerformanceTracer::instance()->clear();
+        }
+        m_d->numRunningTracedStrokes++;
+    }
+
     if (!m_d->loggingEnabled) return;
 
     QMutexLocker locker(&m_d->mutex);
@@ -136,6 +209,32 @@ void KisUpdateTimeMonitor::startStrokeMeasure()
 
 void KisUpdateTimeMonitor::endStrokeMeasure()
 {
+    if (m_d->tracingEnabled) {
+        QString fileName;
+        KisPerformanceTracer::TraceSP trace;
+
+        {
+            QMutexLocker locker(&m_d->mutex);
+
+            const QString prefix = m_d->preset ? QString("%1.").arg(safePresetFileName(m_d->preset)) : QString();
+            fileName = QString("log/%1stroke-%2.trace.json").arg(prefix).arg(m_d->numTracedStrokes++);
+
+            if (m_d->numRunningTracedStrokes > 0) {
+                m_d->numRunningTracedStrokes--;
+            }
+
+            trace = KisPerformanceTracer::instance()->takeTrace();
+        }
+
+        /**
+         * The stroke strategy is destroyed in the strokes queue, so
+         * the trace is written in the background to not block it
+         */
+        QThreadPool::globalInstance()->start([trace, fileName] () {
+            KisPerformanceTracer::saveChromeTrace(trace, fileName);
+        });
+    }
+
     if (!m_d->loggingEnabled) return;
 
     QMutexLocker locker(&m_d->mutex);
@@ -147,8 +246,9 @@ void KisUpdateTimeMonitor::endStrokeMeasure()
 
 void KisUpdateTimeMonitor::reportPaintOpPreset(KisPaintOpPresetSP preset)
 {
-    if (!m_d->loggingEnabled) return;
+    if (!m_d->loggingEnabled && !m_d->tracingEnabled) return;
 
+    QMutexLocker locker(&m_d->mutex);
     m_d->preset = preset;
 }
 
@@ -166,6 +266,70 @@ void KisUpdateTimeMonitor::reportMouseMove(const QPointF &pos)
     m_d->lastMousePos = pos;
 }
 
+void KisUpdateTimeMonitor::startStrokeInput(const KisPaintInformation &info)
+{
+    if (!m_d->tracingEnabled) return;
+
+    QMutexLocker locker(&m_d->mutex);
+
+    m_d->strokeInput.clear();
+    m_d->strokeInput.addSample(info);
+}
+
+void KisUpdateTimeMonitor::reportStrokeInput(const KisPaintInformation &info)
+{
+    if (!m_d->tracingEnabled) return;
+
+    QMutexLocker locker(&m_d->mutex);
+    m_d->strokeInput.addSample(info);
+}
+
+void KisUpdateTimeMonitor::endStrokeInput()
+{
+    if (!m_d->tracingEnabled) return;
+
+    KisStrokeInputRecording strokeInput;
+    KoResourceSP presetCopy;
+    QString prefix;
+    int strokeIndex = 0;
+
+    {
+        QMutexLocker locker(&m_d->mutex);
+
+        if (m_d->strokeInput.isEmpty()) return;
+
+        strokeInput = m_d->strokeInput;
+        m_d->strokeInput.clear();
+
+        /**
+         * The preset may be edited by the GUI thread at any moment,
+         * so the background task gets only a copy of it
+         */
+        if (m_d->preset) {
+            const QString presetFileName = safePresetFileName(m_d->preset);
+            prefix = QString("%1.").arg(presetFileName);
+
+            presetCopy = m_d->preset->clone();
+            presetCopy->setFilename(QString("log/%1.kpp").arg(presetFileName));
+        }
+
+        strokeIndex = m_d->numRecordedStrokes++;
+    }
+
+    /**
+     * The stroke is ended in the GUI thread, so the files are written
+     * in the background to not delay the next stroke
+     */
+    QThreadPool::globalInstance()->start([strokeInput, presetCopy, prefix, strokeIndex] () {
+        if (presetCopy) {
+            presetCopy->save();
+        }
+
+        const QString fileName = QString("log/%1stroke-input-%2.ksir").arg(prefix).arg(strokeIndex);
+        strokeInput.save(fileName);
+    });
+}
+
 void KisUpdateTimeMonitor::printValues()
 {
     qint64 strokeTime = m_d->strokeTime.elapsed();
@@ -177,9 +341,11 @@ void KisUpdateTimeMonitor::printValues()
     QString prefix;
 
     if (m_d->preset) {
+        const QString presetFileName = safePresetFileName(m_d->preset);
+        prefix = QString("%1.").arg(presetFileName);
+
         KoResourceSP preset = m_d->preset->clone();
-        prefix = QString("%1.").arg(preset->name());
-        preset->setFilename(QString("log/%1.kpp").arg(preset->name()));
+        preset->setFilename(QString("log/%1.kpp").arg(presetFileName));
         preset->save();
     }
 
@@ -14,6 +14,7 @@
 #include <QVector>
 class QPointF;
 class QRect;
+class KisPaintInformation;
 
 
 class KRITAIMAGE_EXPORT KisUpdateTimeMonitor
@@ -23,11 +24,28 @@ public:
     ~KisUpdateTimeMonitor();
     static KisUpdateTimeMonitor* instance();
 
+    /**
+     * When tracing is enabled, every stroke is saved as a separate
+     * Chrome trace-event file into the \p log folder (see
+     * KisPerformanceTracer)
+     */
+    void setTracingEnabled(bool value);
+
     void startStrokeMeasure();
     void endStrokeMeasure();
     void reportPaintOpPreset(KisPaintOpPresetSP preset);
 
     void reportMouseMove(const QPointF &pos);
+
+    /**
+     * When tracing is enabled, the input of every freehand stroke is
+     * also saved into the \p log folder, together with the preset, so
+     * the stroke can be replayed later by the stroke replay benchmark
+     * (see KisStrokeInputRecording)
+     */
+    void startStrokeInput(const KisPaintInformation &info);
+    void reportStrokeInput(const KisPaintInformation &info);
+    void endStrokeInput();
     void printValues();
 
     void reportJobStarted(void *key);
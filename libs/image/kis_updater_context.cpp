@@ -207,6 +207,8 @@ void KisUpdaterContext::addSpontaneousJob(KisSpontaneousJob *spontaneousJob)
 
 void KisUpdaterContext::waitForDone()
 {
+    KIS_TRACE_SCOPE("updater", "waitForDone");
+
     QMutexLocker l(&m_runningThreadsMutex);
 
     while(m_numRunningThreads > 0) {
@@ -0,0 +1,183 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#include "KisLayerStyleIntermediatePlane.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegion>
+#include <QVector>
+
+#include "kis_datamanager.h"
+#include "kis_paint_device.h"
+#include "kis_painter.h"
+#include "kis_pixel_selection.h"
+#include "kis_global.h"
+
+
+struct KisLayerStyleIntermediatePlane::Private
+{
+    QMutex mutex;
+
+    KisPixelSelectionSP plane;
+    QRegion validRegion;
+
+    /**
+     * The areas that are being rendered right now without the lock
+     * held. The invalidations that happen meanwhile are subtracted from
+     * them, so that a job that read the outdated source would not mark
+     * its result as valid.
+     */
+    QVector<QSharedPointer<QRegion>> pendingRegions;
+
+    QByteArray configKey;
+    int levelOfDetail = 0;
+    int dependencyRadius = 0;
+
+    KisDataManagerSP sourceDataManager;
+    QPoint sourceOffset;
+    QByteArray sourceDefaultPixel;
+
+    void resetPlane() {
+        plane = new KisPixelSelection();
+        validRegion = QRegion();
+        pendingRegions.clear();
+        sourceDataManager = 0;
+        sourceDefaultPixel.clear();
+    }
+
+    void invalidate(const QRect &rect) {
+        const QRect dirtyRect = kisGrowRect(rect, dependencyRadius);
+
+        validRegion -= dirtyRect;
+
+        for (auto it = pendingRegions.begin(); it != pendingRegions.end(); ++it) {
+            **it -= dirtyRect;
+        }
+    }
+
+    void syncWithSource(KisPaintDeviceSP srcDevice);
+};
+
+void KisLayerStyleIntermediatePlane::Private::syncWithSource(KisPaintDeviceSP srcDevice)
+{
+    KisDataManagerSP dataManager = srcDevice->dataManager();
+    const QPoint offset(srcDevice->x(), srcDevice->y());
+    const QByteArray defaultPixel(reinterpret_cast<const char*>(srcDevice->defaultPixel().data()),
+                                  srcDevice->pixelSize());
+
+    /**
+     * The changes of the pixel data are reported via invalidate(), but
+     * a new data manager, a move or a new default pixel affect the
+     * whole (infinite) device without any update of a specific rect.
+     */
+    if (sourceDataManager != dataManager ||
+        sourceOffset != offset ||
+        sourceDefaultPixel != defaultPixel) {
+
+        resetPlane();
+        sourceDataManager = dataManager;
+        sourceOffset = offset;
+        sourceDefaultPixel = defaultPixel;
+    }
+}
+
+KisLayerStyleIntermediatePlane::KisLayerStyleIntermediatePlane()
+    : m_d(new Private)
+{
+    m_d->resetPlane();
+}
+
+KisLayerStyleIntermediatePlane::~KisLayerStyleIntermediatePlane()
+{
+}
+
+void KisLayerStyleIntermediatePlane::invalidate(const QRect &rect)
+{
+    if (rect.isEmpty()) return;
+
+    QMutexLocker l(&m_d->mutex);
+    m_d->invalidate(rect);
+}
+
+void KisLayerStyleIntermediatePlane::fetch(KisPaintDeviceSP srcDevice,
+                                           int levelOfDetail,
+                                           const QByteArray &configKey,
+                                           int dependencyRadius,
+                                           const QRect &rect,
+                                           KisPixelSelectionSP dst,
+                                           RenderFunction renderFunction)
+{
+    if (rect.isEmpty()) return;
+
+    KisPixelSelectionSP plane;
+    QSharedPointer<QRegion> missingRegion;
+
+    {
+        QMutexLocker l(&m_d->mutex);
+
+        if (m_d->configKey != configKey || m_d->levelOfDetail != levelOfDetail) {
+            m_d->resetPlane();
+            m_d->configKey = configKey;
+            m_d->levelOfDetail = levelOfDetail;
+        }
+
+        m_d->dependencyRadius = dependencyRadius;
+        m_d->syncWithSource(srcDevice);
+
+        plane = m_d->plane;
+        missingRegion.reset(new QRegion(QRegion(rect) - m_d->validRegion));
+
+        if (!missingRegion->isEmpty()) {
+            m_d->pendingRegions.append(missingRegion);
+        }
+    }
+
+    /**
+     * Rendering happens without the lock held: parallel update jobs
+     * usually request non-overlapping rects, and writing into different
+     * areas of a paint device is thread-safe.
+     */
+    if (!missingRegion->isEmpty()) {
+        const QRegion renderRegion = *missingRegion;
+        const QRect missingBounds = renderRegion.boundingRect();
+
+        if (renderRegion.rectCount() > 1 &&
+            qint64(missingBounds.width()) * missingBounds.height() <
+            2 * qint64(rect.width()) * rect.height()) {
+
+            /**
+             * Every rendered rect pays for the dependency border around
+             * it, so it is cheaper to render the bounds at once when the
+             * rects are fragmented.
+             */
+            renderFunction(plane, missingBounds);
+        } else {
+            for (const QRect &rc : renderRegion) {
+                renderFunction(plane, rc);
+            }
+        }
+
+        QMutexLocker l(&m_d->mutex);
+
+        /**
+         * If the plane has been reset meanwhile, the region is not
+         * in the list anymore and the result is just dropped
+         */
+        const int index = m_d->pendingRegions.indexOf(missingRegion);
+        if (index >= 0) {
+            m_d->validRegion += *missingRegion;
+            m_d->pendingRegions.remove(index);
+        }
+    }
+
+    KisPainter::copyAreaOptimized(rect.topLeft(), plane, dst, rect);
+}
+
+void KisLayerStyleIntermediatePlane::reset()
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->resetPlane();
+}
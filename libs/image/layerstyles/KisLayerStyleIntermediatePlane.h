@@ -0,0 +1,84 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef KISLAYERSTYLEINTERMEDIATEPLANE_H
+#define KISLAYERSTYLEINTERMEDIATEPLANE_H
+
+#include <functional>
+
+#include <QByteArray>
+#include <QScopedPointer>
+#include <QSharedPointer>
+
+#include "kis_types.h"
+#include "kritaimage_export.h"
+
+/**
+ * A cache for the intermediate (heavy) stage of a layer style, e.g.
+ * the blurred and contour-corrected alpha of a drop shadow or the
+ * distance map of a bevel. The plane depends on the alpha channel of
+ * the source device only, so it can be kept between the updates of the
+ * layer.
+ *
+ * The owner of the plane reports the updated areas of the source device
+ * with invalidate(). These areas, grown by the dependency radius of the
+ * stage, are dropped from the cache, and only the invalid parts of the
+ * requested rect are rendered again on the next fetch.
+ *
+ * The plane is fully reset when the configuration key, the level of
+ * detail, the data manager, the offset or the default pixel of the source
+ * device changes.
+ */
+class KRITAIMAGE_EXPORT KisLayerStyleIntermediatePlane
+{
+public:
+    /**
+     * Renders the stage into \p rect of \p plane. The function must
+     * not touch the plane outside \p rect.
+     */
+    using RenderFunction = std::function<void(KisPixelSelectionSP plane, const QRect &rect)>;
+
+public:
+    KisLayerStyleIntermediatePlane();
+    ~KisLayerStyleIntermediatePlane();
+
+    /**
+     * Copies \p rect of the plane into \p dst, rendering the missing
+     * parts with \p renderFunction first.
+     *
+     * \param configKey serialized properties of the style the stage
+     *                  depends on
+     * \param dependencyRadius the distance at which a pixel of the
+     *                         source device may still affect the stage
+     */
+    void fetch(KisPaintDeviceSP srcDevice,
+               int levelOfDetail,
+               const QByteArray &configKey,
+               int dependencyRadius,
+               const QRect &rect,
+               KisPixelSelectionSP dst,
+               RenderFunction renderFunction);
+
+    /**
+     * Marks \p rect of the source device as changed. Should be called
+     * for every update of the source, before the next fetch.
+     */
+    void invalidate(const QRect &rect);
+
+    /**
+     * Drops all the cached data
+     */
+    void reset();
+
+private:
+    Q_DISABLE_COPY(KisLayerStyleIntermediatePlane)
+
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+typedef QSharedPointer<KisLayerStyleIntermediatePlane> KisLayerStyleIntermediatePlaneSP;
+
+#endif // KISLAYERSTYLEINTERMEDIATEPLANE_H
@@ -81,6 +81,13 @@ QRect KisLayerStyleFilterProjectionPlane::recalculate(const QRect& rect, KisNode
         return QRect();
     }
 
+    /**
+     * The source is updated only within the recalculated rect, so it
+     * is the only area of the cached intermediate planes that needs
+     * to be invalidated
+     */
+    invalidateIntermediatePlanes(rect);
+
     m_d->projection.clear(rect);
     m_d->filter->processDirectly(m_d->sourceLayer->projection(),
                                  &m_d->projection,
@@ -106,6 +113,11 @@ bool KisLayerStyleFilterProjectionPlane::isEmpty() const
     return m_d->projection.isEmpty();
 }
 
+void KisLayerStyleFilterProjectionPlane::invalidateIntermediatePlanes(const QRect &rect)
+{
+    m_d->projection.invalidateIntermediatePlanes(rect);
+}
+
 KisLayerStyleKnockoutBlower *KisLayerStyleFilterProjectionPlane::knockoutBlower() const
 {
     return &m_d->knockoutBlower;
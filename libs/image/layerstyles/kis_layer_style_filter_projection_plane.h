@@ -46,6 +46,12 @@ public:
 
     KisLayerStyleKnockoutBlower *knockoutBlower() const;
 
+    /**
+     * Reports the change of \p rect of the source layer to the cached
+     * intermediate planes of the style without recalculating it
+     */
+    void invalidateIntermediatePlanes(const QRect &rect);
+
 protected:
 
     KisLayerStyleFilter* filter() const;
@@ -231,6 +231,12 @@ QRect KisLayerStyleProjectionPlane::recalculate(const QRect& rect, KisNodeSP fil
         }
     } else {
         result = sourcePlane->recalculate(rect, filthyNode, flags);
+
+        // the styles are not recalculated, but their caches should still
+        // know about the change for the moment the style is enabled again
+        Q_FOREACH (const KisLayerStyleFilterProjectionPlaneSP plane, m_d->allStyles()) {
+            plane->invalidateIntermediatePlanes(rect);
+        }
     }
 
     return result;
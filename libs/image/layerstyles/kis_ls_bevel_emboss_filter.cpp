@@ -12,6 +12,7 @@
 #include <cstdlib>
 
 #include <QBitArray>
+#include <QDataStream>
 
 #include <KoUpdater.h>
 #include <resources/KoPattern.h>
@@ -93,6 +94,50 @@ void paintBevelSelection(KisPixelSelectionSP srcSelection,
     }
 }
 
+void renderBevelPlane(KisPaintDeviceSP srcDevice,
+                      KisPixelSelectionSP plane,
+                      const QRect &rect,
+                      const psd_layer_effects_bevel_emboss *config,
+                      KisLayerStyleFilterEnvironment *env)
+{
+    const int size = config->size();
+
+    KisCachedSelection::Guard s1(*env->cachedSelection());
+    KisSelectionSP baseSelection = s1.selection();
+    KisLsUtils::selectionFromAlphaChannel(srcDevice, baseSelection, kisGrowRect(rect, size + 1));
+
+    KisPixelSelectionSP selection = baseSelection->pixelSelection();
+
+    KisCachedSelection::Guard s2(*env->cachedSelection());
+    KisPixelSelectionSP bumpmapSelection = s2.selection()->pixelSelection();
+
+    switch (config->style()) {
+    case psd_bevel_outer_bevel:
+        paintBevelSelection(selection, bumpmapSelection, rect, size, size, false, env);
+        break;
+    case psd_bevel_inner_bevel:
+        paintBevelSelection(selection, bumpmapSelection, rect, size, 0, false, env);
+        break;
+    case psd_bevel_emboss: {
+        const int initialSize = std::ceil(qreal(size) / 2.0);
+        paintBevelSelection(selection, bumpmapSelection, rect, size, initialSize, false, env);
+        break;
+    }
+    case psd_bevel_pillow_emboss: {
+        const int halfSizeF = std::floor(qreal(size) / 2.0);
+        const int halfSizeC = std::ceil(qreal(size) / 2.0);
+        // TODO: probably not correct!
+        paintBevelSelection(selection, bumpmapSelection, rect, halfSizeC, halfSizeC, false, env);
+        paintBevelSelection(selection, bumpmapSelection, rect, halfSizeF, 0, true, env);
+        break;
+    }
+    case psd_bevel_stroke_emboss:
+        break;
+    }
+
+    KisPainter::copyAreaOptimized(rect.topLeft(), bumpmapSelection, plane, rect);
+}
+
 struct ContrastOp {
     static const bool supportsCaching = false;
 
@@ -278,38 +323,50 @@ void KisLsBevelEmbossFilter::applyBevelEmboss(KisPaintDeviceSP srcDevice,
     const int size = config->size();
 
     int limitingGrowSize = 0;
-    KisCachedSelection::Guard s2(*env->cachedSelection());
-    KisPixelSelectionSP bumpmapSelection = s2.selection()->pixelSelection();
 
     switch (config->style()) {
     case psd_bevel_outer_bevel:
-        paintBevelSelection(selection, bumpmapSelection, d.applyBevelRect, size, size, false, env);
         limitingGrowSize = size;
         break;
     case psd_bevel_inner_bevel:
-        paintBevelSelection(selection, bumpmapSelection, d.applyBevelRect, size, 0, false, env);
         limitingGrowSize = 0;
         break;
-    case psd_bevel_emboss: {
-        const int initialSize = std::ceil(qreal(size) / 2.0);
-        paintBevelSelection(selection, bumpmapSelection, d.applyBevelRect, size, initialSize, false, env);
-        limitingGrowSize = initialSize;
+    case psd_bevel_emboss:
+        limitingGrowSize = std::ceil(qreal(size) / 2.0);
         break;
-    }
-    case psd_bevel_pillow_emboss: {
-        const int halfSizeF = std::floor(qreal(size) / 2.0);
-        const int halfSizeC = std::ceil(qreal(size) / 2.0);
-        // TODO: probably not correct!
-        paintBevelSelection(selection, bumpmapSelection, d.applyBevelRect, halfSizeC, halfSizeC, false, env);
-        paintBevelSelection(selection, bumpmapSelection, d.applyBevelRect, halfSizeF, 0, true, env);
-        limitingGrowSize = halfSizeC;
+    case psd_bevel_pillow_emboss:
+        limitingGrowSize = std::ceil(qreal(size) / 2.0);
         break;
-    }
     case psd_bevel_stroke_emboss:
         warnKrita << "WARNING: Stroke Emboss style is not implemented yet!";
         return;
     }
 
+    KisCachedSelection::Guard s2(*env->cachedSelection());
+    KisPixelSelectionSP bumpmapSelection = s2.selection()->pixelSelection();
+
+    /**
+     * Painting of the bevel is the heaviest stage of the style and it
+     * depends on the source alpha only, so it is fetched from the cached
+     * plane
+     */
+    QByteArray configKey;
+    {
+        QDataStream stream(&configKey, QIODevice::WriteOnly);
+        stream << int(config->style()) << size;
+    }
+
+    dst->intermediatePlane("bevel_plane")->fetch(
+        srcDevice,
+        env->currentLevelOfDetail(),
+        configKey,
+        size + 1,
+        d.applyBevelRect,
+        bumpmapSelection,
+        [&] (KisPixelSelectionSP plane, const QRect &rc) {
+            renderBevelPlane(srcDevice, plane, rc, config, env);
+        });
+
     KisCachedSelection::Guard s3(*env->cachedSelection());
     KisPixelSelectionSP limitingSelection = s3.selection()->pixelSelection();
     limitingSelection->makeCloneFromRough(selection, selection->selectedRect());
@@ -9,6 +9,7 @@
 #include <cstdlib>
 
 #include <QBitArray>
+#include <QDataStream>
 
 #include <KoUpdater.h>
 #include <resources/KoAbstractGradient.h>
@@ -108,71 +109,95 @@ struct ShadowRectsData
     QRect spreadNeedRect;
 };
 
-void KisLsDropShadowFilter::applyDropShadow(KisPaintDeviceSP srcDevice,
-                                            KisMultipleProjection *dst,
-                                            const QRect &applyRect,
-                                            const psd_layer_effects_context *context,
-                                            const psd_layer_effects_shadow_base *shadow,
-                                            KisResourcesInterfaceSP resourcesInterface,
-                                            KisLayerStyleFilterEnvironment *env) const
+namespace {
+
+bool isInnerGlowFromCenter(const psd_layer_effects_shadow_base *shadow)
 {
-    if (applyRect.isEmpty()) return;
+    const psd_layer_effects_inner_glow *iglow =
+        dynamic_cast<const psd_layer_effects_inner_glow *>(shadow);
 
-    ShadowRectsData d(applyRect, context, shadow, ShadowRectsData::NEED_RECT);
+    return iglow && iglow->source() == psd_glow_center;
+}
+
+QByteArray shadowPlaneConfigKey(const psd_layer_effects_shadow_base *shadow,
+                                const ShadowRectsData &d)
+{
+    QByteArray key;
+    QDataStream stream(&key, QIODevice::WriteOnly);
+
+    stream << d.spread_size << d.blur_size
+           << shadow->invertsSelection()
+           << int(shadow->technique())
+           << shadow->range()
+           << isInnerGlowFromCenter(shadow)
+           << shadow->antiAliased()
+           << shadow->edgeHidden();
+
+    stream.writeRawData(reinterpret_cast<const char*>(shadow->contourLookupTable()), PSD_LOOKUP_TABLE_SIZE);
+
+    return key;
+}
+
+inline QRect shadowPlaneBlurNeedRect(const QRect &rect, const ShadowRectsData &d)
+{
+    return d.blur_size ? KisLsUtils::growRectFromRadius(rect, d.blur_size) : rect;
+}
+
+inline QRect shadowPlaneSpreadNeedRect(const QRect &rect, const ShadowRectsData &d)
+{
+    const QRect blurNeedRect = shadowPlaneBlurNeedRect(rect, d);
+    return d.spread_size ? KisLsUtils::growRectFromRadius(blurNeedRect, d.spread_size) : blurNeedRect;
+}
+
+/**
+ * Renders the offset-independent part of the shadow: the alpha channel of
+ * the source spread, blurred and passed through the contour. It depends on
+ * nothing but the source alpha, so it is cached between the updates.
+ */
+void renderShadowPlane(KisPaintDeviceSP srcDevice,
+                       KisPixelSelectionSP plane,
+                       const QRect &rect,
+                       const ShadowRectsData &d,
+                       const psd_layer_effects_shadow_base *shadow,
+                       KisLayerStyleFilterEnvironment *env)
+{
+    const QRect blurNeedRect = shadowPlaneBlurNeedRect(rect, d);
+    const QRect spreadNeedRect = shadowPlaneSpreadNeedRect(rect, d);
 
     KisCachedSelection::Guard s1(*env->cachedSelection());
     KisSelectionSP baseSelection = s1.selection();
-    KisLsUtils::selectionFromAlphaChannel(srcDevice, baseSelection, d.spreadNeedRect);
+    KisLsUtils::selectionFromAlphaChannel(srcDevice, baseSelection, spreadNeedRect);
 
     KisPixelSelectionSP selection = baseSelection->pixelSelection();
 
-    //selection->convertToQImage(0, QRect(0,0,300,300)).save("0_selection_initial.png");
-
     if (shadow->invertsSelection()) {
         selection->invert();
     }
 
-    /**
-     * Copy selection which will be erased from the original later
-     */
-    KisCachedSelection::Guard s2(*env->cachedSelection());
-    KisPixelSelectionSP knockOutSelection;
-    if (shadow->knocksOut()) {
-        knockOutSelection = s2.selection()->pixelSelection();
-        knockOutSelection->makeCloneFromRough(selection, selection->selectedRect());
-    }
-
     if (shadow->technique() == psd_technique_precise) {
-        KisLsUtils::findEdge(selection, d.blurNeedRect, true);
+        KisLsUtils::findEdge(selection, blurNeedRect, true);
     }
 
     /**
      * Spread and blur the selection
      */
     if (d.spread_size) {
-        KisLsUtils::applyGaussianWithTransaction(selection, d.blurNeedRect, d.spread_size);
+        KisLsUtils::applyGaussianWithTransaction(selection, blurNeedRect, d.spread_size);
 
         // TODO: find out why in libpsd we pass false here. If we do so,
         //       the result is fully black, which is not expected
-        KisLsUtils::findEdge(selection, d.blurNeedRect, true /*shadow->edgeHidden()*/);
+        KisLsUtils::findEdge(selection, blurNeedRect, true /*shadow->edgeHidden()*/);
     }
 
-    //selection->convertToQImage(0, QRect(0,0,300,300)).save("1_selection_spread.png");
-
     if (d.blur_size) {
-        KisLsUtils::applyGaussianWithTransaction(selection, d.noiseNeedRect, d.blur_size);
+        KisLsUtils::applyGaussianWithTransaction(selection, rect, d.blur_size);
     }
-    //selection->convertToQImage(0, QRect(0,0,300,300)).save("2_selection_blur.png");
 
     if (shadow->range() != KisLsUtils::FULL_PERCENT_RANGE) {
-        KisLsUtils::adjustRange(selection, d.noiseNeedRect, shadow->range());
+        KisLsUtils::adjustRange(selection, rect, shadow->range());
     }
 
-    const psd_layer_effects_inner_glow *iglow = 0;
-    if ((iglow =
-         dynamic_cast<const psd_layer_effects_inner_glow *>(shadow)) &&
-        iglow->source() == psd_glow_center) {
-
+    if (isInnerGlowFromCenter(shadow)) {
         selection->invert();
     }
 
@@ -180,11 +205,49 @@ void KisLsDropShadowFilter::applyDropShadow(KisPaintDeviceSP srcDevice,
      * Contour correction
      */
     KisLsUtils::applyContourCorrection(selection,
-                                       d.noiseNeedRect,
+                                       rect,
                                        shadow->contourLookupTable(),
                                        shadow->antiAliased(),
                                        shadow->edgeHidden());
 
+    KisPainter::copyAreaOptimized(rect.topLeft(), selection, plane, rect);
+}
+
+}
+
+void KisLsDropShadowFilter::applyDropShadow(KisPaintDeviceSP srcDevice,
+                                            KisMultipleProjection *dst,
+                                            const QRect &applyRect,
+                                            const psd_layer_effects_context *context,
+                                            const psd_layer_effects_shadow_base *shadow,
+                                            KisResourcesInterfaceSP resourcesInterface,
+                                            KisLayerStyleFilterEnvironment *env) const
+{
+    if (applyRect.isEmpty()) return;
+
+    ShadowRectsData d(applyRect, context, shadow, ShadowRectsData::NEED_RECT);
+
+    KisCachedSelection::Guard s1(*env->cachedSelection());
+    KisSelectionSP baseSelection = s1.selection();
+    KisPixelSelectionSP selection = baseSelection->pixelSelection();
+
+    /**
+     * Spread, blur and contour correction are the heaviest stages
+     * and are fetched from the cached plane
+     */
+    const int dependencyRadius = -shadowPlaneSpreadNeedRect(QRect(0, 0, 1, 1), d).left();
+
+    dst->intermediatePlane("shadow_plane")->fetch(
+        srcDevice,
+        env->currentLevelOfDetail(),
+        shadowPlaneConfigKey(shadow, d),
+        dependencyRadius,
+        d.noiseNeedRect,
+        selection,
+        [&] (KisPixelSelectionSP plane, const QRect &rc) {
+            renderShadowPlane(srcDevice, plane, rc, d, shadow, env);
+        });
+
     //selection->convertToQImage(0, QRect(0,0,300,300)).save("3_selection_contour.png");
 
     /**
@@ -207,13 +270,19 @@ void KisLsDropShadowFilter::applyDropShadow(KisPaintDeviceSP srcDevice,
      * Knock-out original outline of the device from the resulting shade
      */
     if (shadow->knocksOut()) {
-        KIS_ASSERT_RECOVER_RETURN(knockOutSelection);
-
         QRect knockOutRect = !shadow->invertsSelection() ?
             d.srcRect : d.spreadNeedRect;
 
         knockOutRect &= d.dstRect;
 
+        KisCachedSelection::Guard s2(*env->cachedSelection());
+        KisPixelSelectionSP knockOutSelection = s2.selection()->pixelSelection();
+        KisLsUtils::selectionFromAlphaChannel(srcDevice, s2.selection(), knockOutRect);
+
+        if (shadow->invertsSelection()) {
+            knockOutSelection->invert();
+        }
+
         KisPainter gc(selection);
         gc.setCompositeOpId(COMPOSITE_ERASE);
         gc.bitBlt(knockOutRect.topLeft(), knockOutSelection, knockOutRect);
@@ -9,6 +9,7 @@
 #include <cstdlib>
 
 #include <QBitArray>
+#include <QDataStream>
 
 #include <resources/KoAbstractGradient.h>
 
@@ -118,6 +119,59 @@ void blendAndOffsetSatinSelection(KisPixelSelectionSP dstSelection,
     }
 }
 
+namespace {
+
+QByteArray satinPlaneConfigKey(const psd_layer_effects_satin *config,
+                               const SatinRectsData &d)
+{
+    QByteArray key;
+    QDataStream stream(&key, QIODevice::WriteOnly);
+
+    stream << d.blur_size
+           << config->antiAliased()
+           << config->edgeHidden();
+
+    stream.writeRawData(reinterpret_cast<const char*>(config->contourLookupTable()), PSD_LOOKUP_TABLE_SIZE);
+
+    return key;
+}
+
+void renderSatinPlane(KisPaintDeviceSP srcDevice,
+                      KisPixelSelectionSP plane,
+                      const QRect &rect,
+                      const SatinRectsData &d,
+                      const psd_layer_effects_satin *config,
+                      KisLayerStyleFilterEnvironment *env)
+{
+    const QRect blurNeedRect = d.blur_size ?
+        KisLsUtils::growRectFromRadius(rect, d.blur_size) : rect;
+
+    KisCachedSelection::Guard s1(*env->cachedSelection());
+    KisSelectionSP baseSelection = s1.selection();
+    KisLsUtils::selectionFromAlphaChannel(srcDevice, baseSelection, blurNeedRect);
+
+    KisPixelSelectionSP selection = baseSelection->pixelSelection();
+
+    //KIS_DUMP_DEVICE_2(selection, QRect(0,0,64,64), "00_selection", "dd");
+
+    KisLsUtils::applyGaussianWithTransaction(selection, rect, d.blur_size);
+
+    //KIS_DUMP_DEVICE_2(selection, QRect(0,0,64,64), "01_gauss", "dd");
+
+    /**
+     * Contour correction
+     */
+    KisLsUtils::applyContourCorrection(selection,
+                                       rect,
+                                       config->contourLookupTable(),
+                                       config->antiAliased(),
+                                       config->edgeHidden());
+
+    KisPainter::copyAreaOptimized(rect.topLeft(), selection, plane, rect);
+}
+
+}
+
 //#include "kis_paint_device_debug_utils.h"
 
 void KisLsSatinFilter::applySatin(KisPaintDeviceSP srcDevice,
@@ -134,28 +188,28 @@ void KisLsSatinFilter::applySatin(KisPaintDeviceSP srcDevice,
 
     KisCachedSelection::Guard s1(*env->cachedSelection());
     KisSelectionSP baseSelection = s1.selection();
-    KisLsUtils::selectionFromAlphaChannel(srcDevice, baseSelection, d.blurNeedRect);
-
     KisPixelSelectionSP selection = baseSelection->pixelSelection();
 
     KisCachedSelection::Guard s2(*env->cachedSelection());
     KisPixelSelectionSP tempSelection = s2.selection()->pixelSelection();
-    tempSelection->makeCloneFromRough(selection, selection->selectedRect());
-
-    //KIS_DUMP_DEVICE_2(tempSelection, QRect(0,0,64,64), "00_selection", "dd");
-
-    KisLsUtils::applyGaussianWithTransaction(tempSelection, d.satinNeedRect, d.blur_size);
-
-    //KIS_DUMP_DEVICE_2(tempSelection, QRect(0,0,64,64), "01_gauss", "dd");
 
     /**
-     * Contour correction
+     * The blurred and contour-corrected alpha does not depend on the
+     * offset of the satin, so it is fetched from the cached plane
      */
-    KisLsUtils::applyContourCorrection(tempSelection,
-                                       d.satinNeedRect,
-                                       config->contourLookupTable(),
-                                       config->antiAliased(),
-                                       config->edgeHidden());
+    const int dependencyRadius = d.blur_size ?
+        -KisLsUtils::growRectFromRadius(QRect(0, 0, 1, 1), d.blur_size).left() : 0;
+
+    dst->intermediatePlane("satin_plane")->fetch(
+        srcDevice,
+        env->currentLevelOfDetail(),
+        satinPlaneConfigKey(config, d),
+        dependencyRadius,
+        d.satinNeedRect,
+        tempSelection,
+        [&] (KisPixelSelectionSP plane, const QRect &rc) {
+            renderSatinPlane(srcDevice, plane, rc, d, config, env);
+        });
 
     //KIS_DUMP_DEVICE_2(tempSelection, QRect(0,0,64,64), "02_contour", "dd");
 
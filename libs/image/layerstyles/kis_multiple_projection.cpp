@@ -15,6 +15,7 @@
 #include "kis_painter.h"
 #include "kis_paint_device.h"
 #include "kis_layer_style_filter_environment.h"
+#include "kis_pointer_utils.h"
 
 
 struct ProjectionStruct {
@@ -25,11 +26,13 @@ struct ProjectionStruct {
 };
 
 typedef QMap<QString, ProjectionStruct> PlanesMap;
+typedef QMap<QString, KisLayerStyleIntermediatePlaneSP> IntermediatePlanesMap;
 
 struct KisMultipleProjection::Private
 {
     QReadWriteLock lock;
     PlanesMap planes;
+    IntermediatePlanesMap intermediatePlanes;
 };
 
 
@@ -120,6 +123,7 @@ void KisMultipleProjection::freeAllProjections()
 {
     QWriteLocker writeLocker(&m_d->lock);
     m_d->planes.clear();
+    m_d->intermediatePlanes.clear();
 }
 
 void KisMultipleProjection::clear(const QRect &rc)
@@ -134,6 +138,39 @@ void KisMultipleProjection::clear(const QRect &rc)
     }
 }
 
+void KisMultipleProjection::invalidateIntermediatePlanes(const QRect &rc)
+{
+    QReadLocker readLocker(&m_d->lock);
+
+    IntermediatePlanesMap::const_iterator it = m_d->intermediatePlanes.constBegin();
+    IntermediatePlanesMap::const_iterator end = m_d->intermediatePlanes.constEnd();
+
+    for (; it != end; ++it) {
+        (*it)->invalidate(rc);
+    }
+}
+
+KisLayerStyleIntermediatePlaneSP KisMultipleProjection::intermediatePlane(const QString &id)
+{
+    {
+        QReadLocker readLocker(&m_d->lock);
+
+        IntermediatePlanesMap::const_iterator it = m_d->intermediatePlanes.constFind(id);
+        if (it != m_d->intermediatePlanes.constEnd()) {
+            return *it;
+        }
+    }
+
+    QWriteLocker writeLocker(&m_d->lock);
+
+    IntermediatePlanesMap::iterator it = m_d->intermediatePlanes.find(id);
+    if (it == m_d->intermediatePlanes.end()) {
+        it = m_d->intermediatePlanes.insert(id, toQShared(new KisLayerStyleIntermediatePlane()));
+    }
+
+    return *it;
+}
+
 void KisMultipleProjection::apply(KisPaintDeviceSP dstDevice, const QRect &rect, KisLayerStyleFilterEnvironment *env)
 {
     QReadLocker readLocker(&m_d->lock);
@@ -10,6 +10,7 @@
 #include <QScopedPointer>
 #include "kis_types.h"
 #include "kritaimage_export.h"
+#include "KisLayerStyleIntermediatePlane.h"
 
 class KisLayerStyleFilterEnvironment;
 
@@ -28,6 +29,19 @@ public:
 
     void clear(const QRect &rc);
 
+    /**
+     * Returns a cache for the intermediate stage of the style with id
+     * \p id. The planes are not copied together with the projection,
+     * and are dropped by freeAllProjections().
+     */
+    KisLayerStyleIntermediatePlaneSP intermediatePlane(const QString &id);
+
+    /**
+     * Reports the change of \p rc of the source device to all the
+     * intermediate planes
+     */
+    void invalidateIntermediatePlanes(const QRect &rc);
+
     void apply(KisPaintDeviceSP dstDevice, const QRect &rect, KisLayerStyleFilterEnvironment *env);
 
     KisPaintDeviceList getLodCapableDevices() const;
@@ -0,0 +1,86 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisDabCoverageMapTest.h"
+
+#include <cstring>
+
+#include <QVector>
+
+#include "brushengine/KisDabCoverageMap.h"
+
+#include <simpletest.h>
+
+void KisDabCoverageMapTest::testSaturatedRect()
+{
+    KisDabCoverageMap map;
+
+    QVERIFY(!map.isSaturated(QRect(0, 0, 1, 1)));
+
+    // only the cells lying completely inside the rect are marked
+    map.addSaturatedRect(QRect(4, 4, 30, 30));
+    QCOMPARE(map.numSaturatedCells(), 9);
+
+    QVERIFY(map.isSaturated(QRect(8, 8, 24, 24)));
+    QVERIFY(map.isSaturated(QRect(10, 10, 3, 3)));
+    QVERIFY(!map.isSaturated(QRect(7, 8, 24, 24)));
+    QVERIFY(!map.isSaturated(QRect(8, 8, 25, 24)));
+    QVERIFY(!map.isSaturated(QRect(4, 4, 2, 2)));
+
+    // the rect crossing the chunk border
+    map.addSaturatedRect(QRect(240, 0, 32, 8));
+    QVERIFY(map.isSaturated(QRect(240, 0, 32, 8)));
+    QVERIFY(!map.isSaturated(QRect(240, 0, 33, 8)));
+
+    map.clear();
+    QCOMPARE(map.numSaturatedCells(), 0);
+    QVERIFY(!map.isSaturated(QRect(8, 8, 24, 24)));
+}
+
+void KisDabCoverageMapTest::testNegativeCoordinates()
+{
+    KisDabCoverageMap map;
+
+    map.addSaturatedRect(QRect(-304, -24, 16, 16));
+    QCOMPARE(map.numSaturatedCells(), 4);
+
+    QVERIFY(map.isSaturated(QRect(-304, -24, 16, 16)));
+    QVERIFY(!map.isSaturated(QRect(-305, -24, 16, 16)));
+    QVERIFY(!map.isSaturated(QRect(-304, -25, 16, 16)));
+
+    // the same cells in the positive quadrant must not be affected
+    QVERIFY(!map.isSaturated(QRect(296, 16, 8, 8)));
+    QVERIFY(!map.isSaturated(QRect(-296, 16, 8, 8)));
+}
+
+void KisDabCoverageMapTest::testSaturatedPixels()
+{
+    const int pixelSize = 4;
+    const QRect bounds(-3, 5, 27, 19);
+    const quint8 saturatedPixel[pixelSize] = {10, 20, 30, 255};
+
+    QVector<quint8> data(bounds.width() * bounds.height() * pixelSize);
+    for (int i = 0; i < bounds.width() * bounds.height(); i++) {
+        memcpy(data.data() + i * pixelSize, saturatedPixel, pixelSize);
+    }
+
+    // a single semi-transparent pixel at (12, 9)
+    data[((9 - bounds.top()) * bounds.width() + 12 - bounds.left()) * pixelSize + 3] = 254;
+
+    KisDabCoverageMap map;
+    map.addSaturatedPixels(bounds, data.constData(), pixelSize, saturatedPixel);
+
+    // the bounds contain 3x2 complete cells, and one of them has a hole
+    QCOMPARE(map.numSaturatedCells(), 5);
+
+    QVERIFY(map.isSaturated(QRect(0, 8, 8, 16)));
+    QVERIFY(map.isSaturated(QRect(16, 8, 8, 16)));
+    QVERIFY(map.isSaturated(QRect(8, 16, 8, 8)));
+    QVERIFY(!map.isSaturated(QRect(8, 8, 8, 8)));
+    QVERIFY(!map.isSaturated(QRect(-3, 8, 8, 8)));
+}
+
+SIMPLE_TEST_MAIN(KisDabCoverageMapTest)
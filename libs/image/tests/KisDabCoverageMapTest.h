@@ -0,0 +1,21 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISDABCOVERAGEMAPTEST_H
+#define KISDABCOVERAGEMAPTEST_H
+
+#include <simpletest.h>
+
+class KisDabCoverageMapTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testSaturatedRect();
+    void testNegativeCoordinates();
+    void testSaturatedPixels();
+};
+
+#endif // KISDABCOVERAGEMAPTEST_H
@@ -0,0 +1,196 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisGuidedFilterTest.h"
+
+#include <QVector>
+
+#include "KisGuidedFilter.h"
+
+#include <simpletest.h>
+
+namespace {
+
+const int testWidth = 61;
+const int testHeight = 47;
+
+QVector<float> randomImage(quint32 seed)
+{
+    QVector<float> image(testWidth * testHeight);
+
+    for (int i = 0; i < image.size(); i++) {
+        seed = seed * 1664525u + 1013904223u;
+        image[i] = (seed >> 8) / float(1 << 24);
+    }
+
+    return image;
+}
+
+QVector<float> referenceBoxMean(const QVector<float> &src, int radius)
+{
+    QVector<float> dst(src.size());
+
+    for (int y = 0; y < testHeight; y++) {
+        for (int x = 0; x < testWidth; x++) {
+            double sum = 0.0;
+            int count = 0;
+
+            for (int wy = qMax(0, y - radius); wy <= qMin(testHeight - 1, y + radius); wy++) {
+                for (int wx = qMax(0, x - radius); wx <= qMin(testWidth - 1, x + radius); wx++) {
+                    sum += src[wy * testWidth + wx];
+                    count++;
+                }
+            }
+
+            dst[y * testWidth + x] = sum / count;
+        }
+    }
+
+    return dst;
+}
+
+/**
+ * The guided filter written down directly from its definition
+ */
+QVector<float> referenceGuidedFilter(const QVector<float> &guide, const QVector<float> &src, int radius, float epsilon)
+{
+    const int size = src.size();
+
+    QVector<float> guideSquared(size);
+    QVector<float> guideSrc(size);
+    for (int i = 0; i < size; i++) {
+        guideSquared[i] = guide[i] * guide[i];
+        guideSrc[i] = guide[i] * src[i];
+    }
+
+    const QVector<float> meanGuide = referenceBoxMean(guide, radius);
+    const QVector<float> meanSrc = referenceBoxMean(src, radius);
+    const QVector<float> corrGuide = referenceBoxMean(guideSquared, radius);
+    const QVector<float> corrGuideSrc = referenceBoxMean(guideSrc, radius);
+
+    QVector<float> a(size);
+    QVector<float> b(size);
+    for (int i = 0; i < size; i++) {
+        const float variance = corrGuide[i] - meanGuide[i] * meanGuide[i];
+        const float covariance = corrGuideSrc[i] - meanGuide[i] * meanSrc[i];
+        a[i] = covariance / (variance + epsilon);
+        b[i] = meanSrc[i] - a[i] * meanGuide[i];
+    }
+
+    const QVector<float> meanA = referenceBoxMean(a, radius);
+    const QVector<float> meanB = referenceBoxMean(b, radius);
+
+    QVector<float> dst(size);
+    for (int i = 0; i < size; i++) {
+        dst[i] = meanA[i] * guide[i] + meanB[i];
+    }
+
+    return dst;
+}
+
+float maxDifference(const QVector<float> &a, const QVector<float> &b)
+{
+    float difference = 0.0f;
+    for (int i = 0; i < a.size(); i++) {
+        difference = qMax(difference, qAbs(a[i] - b[i]));
+    }
+    return difference;
+}
+
+}
+
+void KisGuidedFilterTest::testGuidedFilter_data()
+{
+    QTest::addColumn<int>("radius");
+    QTest::addColumn<float>("epsilon");
+    QTest::addColumn<bool>("selfGuided");
+
+    QTest::newRow("self-guided, r=2") << 2 << 0.01f << true;
+    QTest::newRow("self-guided, r=8") << 8 << 0.001f << true;
+    QTest::newRow("guided, r=2") << 2 << 0.01f << false;
+    QTest::newRow("guided, r=8") << 8 << 0.1f << false;
+}
+
+void KisGuidedFilterTest::testGuidedFilter()
+{
+    QFETCH(int, radius);
+    QFETCH(float, epsilon);
+    QFETCH(bool, selfGuided);
+
+    const QVector<float> src = randomImage(1);
+    const QVector<float> guide = selfGuided ? src : randomImage(2);
+    QVector<float> dst(src.size());
+
+    KisGuidedFilter::apply(selfGuided ? src.constData() : guide.constData(), src.constData(), dst.data(),
+                           testWidth, testHeight, radius, epsilon);
+
+    QVERIFY(maxDifference(dst, referenceGuidedFilter(guide, src, radius, epsilon)) < 1e-4f);
+}
+
+void KisGuidedFilterTest::testSharedGuide()
+{
+    const QVector<float> guide = randomImage(2);
+    const QVector<float> src1 = randomImage(1);
+    const QVector<float> src2 = randomImage(3);
+
+    const int radius = 4;
+    const float epsilon = 0.01f;
+
+    QVector<float> dst1(src1.size());
+    QVector<float> dst2(src1.size());
+    QVector<float> dst3(src1.size());
+
+    // the guide itself is one of the planes, so the self-guided branch is covered too
+    const float *srcs[] = {src1.constData(), guide.constData(), src2.constData()};
+    float *dsts[] = {dst1.data(), dst2.data(), dst3.data()};
+
+    KisGuidedFilter::apply(guide.constData(), srcs, dsts, 3, testWidth, testHeight, radius, epsilon);
+
+    QVERIFY(maxDifference(dst1, referenceGuidedFilter(guide, src1, radius, epsilon)) < 1e-4f);
+    QVERIFY(maxDifference(dst2, referenceGuidedFilter(guide, guide, radius, epsilon)) < 1e-4f);
+    QVERIFY(maxDifference(dst3, referenceGuidedFilter(guide, src2, radius, epsilon)) < 1e-4f);
+}
+
+void KisGuidedFilterTest::testEdgePreserving()
+{
+    // a noisy step edge in the middle of the image
+    QVector<float> src = randomImage(3);
+    for (int y = 0; y < testHeight; y++) {
+        for (int x = 0; x < testWidth; x++) {
+            float &value = src[y * testWidth + x];
+            value = (x < testWidth / 2 ? 0.2f : 0.8f) + 0.02f * (value - 0.5f);
+        }
+    }
+
+    const int radius = 5;
+
+    QVector<float> dst(src.size());
+    KisGuidedFilter::apply(src.constData(), src.constData(), dst.data(),
+                           testWidth, testHeight, radius, 0.001f);
+
+    float maxNoise = 0.0f;
+    float maxEdgeError = 0.0f;
+
+    for (int y = 0; y < testHeight; y++) {
+        for (int x = 0; x < testWidth; x++) {
+            const float expected = x < testWidth / 2 ? 0.2f : 0.8f;
+            const float error = qAbs(dst[y * testWidth + x] - expected);
+
+            if (qAbs(x - testWidth / 2) > KisGuidedFilter::requiredMargin(radius)) {
+                maxNoise = qMax(maxNoise, error);
+            } else {
+                maxEdgeError = qMax(maxEdgeError, error);
+            }
+        }
+    }
+
+    // the noise is smoothed out...
+    QVERIFY(maxNoise < 0.003f);
+    // ...while the edge is kept sharp
+    QVERIFY(maxEdgeError < 0.03f);
+}
+
+SIMPLE_TEST_MAIN(KisGuidedFilterTest)
@@ -0,0 +1,24 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISGUIDEDFILTERTEST_H
+#define KISGUIDEDFILTERTEST_H
+
+#include <simpletest.h>
+
+class KisGuidedFilterTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testGuidedFilter_data();
+    void testGuidedFilter();
+
+    void testSharedGuide();
+
+    void testEdgePreserving();
+};
+
+#endif // KISGUIDEDFILTERTEST_H
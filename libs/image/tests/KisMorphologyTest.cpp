@@ -0,0 +1,239 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisMorphologyTest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <QVector>
+
+#include "KisMorphology.h"
+#include "kis_global.h"
+
+#include <simpletest.h>
+
+namespace {
+
+const int testWidth = 97;
+const int testHeight = 83;
+
+enum MaskType {
+    Binary,
+    Antialiased,
+    Feathered
+};
+
+/**
+ * A few overlapping discs with hard, antialiased or very soft edges
+ */
+QVector<quint8> testMask(MaskType type)
+{
+    const qreal discs[][3] = {{20, 20, 9}, {60, 30, 17}, {45, 70, 6}, {90, 75, 12}};
+
+    QVector<quint8> mask(testWidth * testHeight);
+
+    for (int y = 0; y < testHeight; y++) {
+        for (int x = 0; x < testWidth; x++) {
+            qreal value = 0.0;
+
+            for (const auto &disc : discs) {
+                const qreal distance = std::hypot(x - disc[0], y - disc[1]);
+                const qreal radius = disc[2];
+
+                qreal coverage = 0.0;
+                switch (type) {
+                case Binary:
+                    coverage = distance <= radius ? 1.0 : 0.0;
+                    break;
+                case Antialiased:
+                    coverage = qBound(0.0, radius + 0.5 - distance, 1.0);
+                    break;
+                case Feathered:
+                    coverage = qBound(0.0, 1.5 * (radius - distance) / radius, 1.0);
+                    break;
+                }
+
+                value = qMax(value, coverage);
+            }
+
+            mask[y * testWidth + x] = qRound(value * 255);
+        }
+    }
+
+    return mask;
+}
+
+QVector<quint8> bruteForceMorphology(const QVector<quint8> &src, const QVector<int> &profile,
+                                     bool isDilation, quint8 outsideValue, bool ignoreOutside)
+{
+    QVector<quint8> result(src.size());
+
+    for (int y = 0; y < testHeight; y++) {
+        for (int x = 0; x < testWidth; x++) {
+            int value = isDilation ? 0 : 255;
+
+            for (int dx = -(profile.size() - 1); dx < profile.size(); dx++) {
+                const int maxDy = profile[qAbs(dx)];
+
+                for (int dy = -maxDy; dy <= maxDy; dy++) {
+                    const int srcX = x + dx;
+                    const int srcY = y + dy;
+
+                    int srcValue = outsideValue;
+
+                    if (srcX >= 0 && srcX < testWidth && srcY >= 0 && srcY < testHeight) {
+                        srcValue = src[srcY * testWidth + srcX];
+                    } else if (ignoreOutside) {
+                        continue;
+                    }
+
+                    value = isDilation ? qMax(value, srcValue) : qMin(value, srcValue);
+                }
+            }
+
+            result[y * testWidth + x] = value;
+        }
+    }
+
+    return result;
+}
+
+int numDifferentPixels(const QVector<quint8> &a, const QVector<quint8> &b)
+{
+    int result = 0;
+    for (int i = 0; i < a.size(); i++) {
+        result += a[i] != b[i];
+    }
+    return result;
+}
+
+}
+
+void KisMorphologyTest::testEllipseProfile()
+{
+    QCOMPARE(KisMorphology::ellipseProfile(1, 1), QVector<int>({1, 1}));
+    QCOMPARE(KisMorphology::ellipseProfile(3, 7), QVector<int>({7, 7, 6, 4}));
+    QCOMPARE(KisMorphology::ellipseProfile(4, 2), QVector<int>({2, 2, 2, 2, 1}));
+}
+
+void KisMorphologyTest::testDilate_data()
+{
+    QTest::addColumn<int>("maskType");
+    QTest::addColumn<int>("xRadius");
+    QTest::addColumn<int>("yRadius");
+
+    for (int type = Binary; type <= Feathered; type++) {
+        QTest::addRow("%d-2-2", type) << type << 2 << 2;
+        QTest::addRow("%d-3-7", type) << type << 3 << 7;
+        QTest::addRow("%d-9-4", type) << type << 9 << 4;
+        QTest::addRow("%d-25-25", type) << type << 25 << 25;
+        QTest::addRow("%d-60-40", type) << type << 60 << 40;
+    }
+}
+
+void KisMorphologyTest::testDilate()
+{
+    QFETCH(int, maskType);
+    QFETCH(int, xRadius);
+    QFETCH(int, yRadius);
+
+    const QVector<quint8> src = testMask(MaskType(maskType));
+    const QVector<int> profile = KisMorphology::ellipseProfile(xRadius, yRadius);
+
+    QVector<quint8> result = src;
+    KisMorphology::dilate(result.data(), testWidth, testHeight, profile);
+
+    const QVector<quint8> reference = bruteForceMorphology(src, profile, true, 0, false);
+    QCOMPARE(numDifferentPixels(result, reference), 0);
+
+    QVector<quint8> binaryResult(src.size());
+    KisMorphology::dilateBinary(src.constData(), binaryResult.data(), testWidth, testHeight, profile, 128);
+
+    QVector<quint8> thresholded = src;
+    for (quint8 &value : thresholded) {
+        value = value >= 128 ? 255 : 0;
+    }
+
+    const QVector<quint8> binaryReference = bruteForceMorphology(thresholded, profile, true, 0, false);
+    QCOMPARE(numDifferentPixels(binaryResult, binaryReference), 0);
+}
+
+void KisMorphologyTest::testErode_data()
+{
+    QTest::addColumn<int>("maskType");
+    QTest::addColumn<int>("xRadius");
+    QTest::addColumn<int>("yRadius");
+    QTest::addColumn<bool>("edgeLock");
+
+    for (int type = Binary; type <= Feathered; type++) {
+        QTest::addRow("%d-3-7", type) << type << 3 << 7 << false;
+        QTest::addRow("%d-3-7-lock", type) << type << 3 << 7 << true;
+        QTest::addRow("%d-12-12", type) << type << 12 << 12 << false;
+        QTest::addRow("%d-12-12-lock", type) << type << 12 << 12 << true;
+    }
+}
+
+void KisMorphologyTest::testErode()
+{
+    QFETCH(int, maskType);
+    QFETCH(int, xRadius);
+    QFETCH(int, yRadius);
+    QFETCH(bool, edgeLock);
+
+    QVector<quint8> src = testMask(MaskType(maskType));
+
+    // make the mask touch the edges of the buffer
+    for (int i = 0; i < src.size(); i++) {
+        src[i] = 255 - src[i];
+    }
+
+    const QVector<int> profile = KisMorphology::ellipseProfile(xRadius, yRadius);
+
+    QVector<quint8> result = src;
+    KisMorphology::erode(result.data(), testWidth, testHeight, profile, edgeLock);
+
+    const QVector<quint8> reference = bruteForceMorphology(src, profile, false, 0, edgeLock);
+    QCOMPARE(numDifferentPixels(result, reference), 0);
+}
+
+void KisMorphologyTest::testDistanceTransform()
+{
+    const QVector<quint8> src = testMask(Antialiased);
+
+    const QVector<quint32> result =
+        KisMorphology::squaredDistanceTransform(src.constData(), testWidth, testHeight, 128);
+
+    int numFailures = 0;
+
+    for (int y = 0; y < testHeight; y++) {
+        for (int x = 0; x < testWidth; x++) {
+            quint32 reference = std::numeric_limits<quint32>::max();
+
+            for (int srcY = 0; srcY < testHeight; srcY++) {
+                for (int srcX = 0; srcX < testWidth; srcX++) {
+                    if (src[srcY * testWidth + srcX] >= 128) {
+                        reference = qMin(reference, quint32(pow2(x - srcX) + pow2(y - srcY)));
+                    }
+                }
+            }
+
+            numFailures += result[y * testWidth + x] != reference;
+        }
+    }
+
+    QCOMPARE(numFailures, 0);
+
+    const QVector<quint8> empty(testWidth * testHeight, 0);
+    const QVector<quint32> emptyResult =
+        KisMorphology::squaredDistanceTransform(empty.constData(), testWidth, testHeight);
+
+    QVERIFY(std::all_of(emptyResult.begin(), emptyResult.end(),
+                        [] (quint32 value) { return value == std::numeric_limits<quint32>::max(); }));
+}
+
+SIMPLE_TEST_MAIN(KisMorphologyTest)
@@ -0,0 +1,27 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISMORPHOLOGYTEST_H
+#define KISMORPHOLOGYTEST_H
+
+#include <simpletest.h>
+
+class KisMorphologyTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testEllipseProfile();
+
+    void testDilate_data();
+    void testDilate();
+
+    void testErode_data();
+    void testErode();
+
+    void testDistanceTransform();
+};
+
+#endif // KISMORPHOLOGYTEST_H
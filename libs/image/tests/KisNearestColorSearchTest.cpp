@@ -0,0 +1,124 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisNearestColorSearchTest.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <QVector>
+
+#include "KisNearestColorSearch.h"
+
+#include <simpletest.h>
+
+namespace {
+
+/**
+ * A simple deterministic generator, so that the test does not depend
+ * on the implementation of the standard library
+ */
+struct TestRandom {
+    quint32 state;
+
+    quint16 next() {
+        state = state * 1664525u + 1013904223u;
+        return quint16(state >> 16);
+    }
+};
+
+}
+
+void KisNearestColorSearchTest::testNearest_data()
+{
+    QTest::addColumn<int>("numColors");
+    QTest::addColumn<int>("maxCount");
+    QTest::addColumn<bool>("clustered");
+    QTest::addColumn<bool>("weighted");
+
+    QTest::newRow("single") << 1 << 1 << false << false;
+    QTest::newRow("few") << 5 << 2 << false << false;
+    QTest::newRow("palette") << 256 << 1 << false << false;
+    QTest::newRow("palette-pairs") << 256 << 2 << false << false;
+    QTest::newRow("palette-weighted") << 64 << 2 << false << true;
+    QTest::newRow("clustered") << 100 << 2 << true << false;
+    QTest::newRow("many-neighbours") << 50 << 12 << false << true;
+}
+
+void KisNearestColorSearchTest::testNearest()
+{
+    QFETCH(int, numColors);
+    QFETCH(int, maxCount);
+    QFETCH(bool, clustered);
+    QFETCH(bool, weighted);
+
+    TestRandom random = {quint32(numColors * 31 + maxCount)};
+
+    QVector<quint16> colors(3 * numColors);
+    for (int i = 0; i < colors.size(); i++) {
+        colors[i] = clustered ? 30000 + random.next() % 1000 : random.next();
+    }
+
+    // a few exact duplicates, they are resolved by their index
+    for (int i = 3; i < qMin(colors.size(), 12); i++) {
+        colors[i] = colors[i % 3];
+    }
+
+    QVector<float> weights;
+    if (weighted) {
+        weights << 1.0f << 0.5f << 2.0f;
+    }
+
+    KisNearestColorSearch search(colors, maxCount, weights);
+    QCOMPARE(search.numColors(), numColors);
+    QCOMPARE(search.maxCount(), maxCount);
+
+    QVector<int> indices(maxCount);
+    QVector<float> distances(maxCount);
+
+    for (int i = 0; i < 2000; i++) {
+        quint16 color[3];
+        for (int axis = 0; axis < 3; axis++) {
+            // include the corners of the color cube
+            color[axis] = i % 4 ? random.next() : (random.next() & 1) * 0xffff;
+        }
+
+        QVector<std::pair<float, int>> expected;
+        for (int j = 0; j < numColors; j++) {
+            float distance = 0.0f;
+            for (int axis = 0; axis < 3; axis++) {
+                const float scale = (weighted ? weights[axis] : 1.0f) / 65535.0f;
+                const float diff = color[axis] * scale - colors[3 * j + axis] * scale;
+                distance += diff * diff;
+            }
+            expected.append(std::make_pair(distance, j));
+        }
+        std::sort(expected.begin(), expected.end());
+
+        QCOMPARE(search.nearest(color), expected[0].second);
+
+        const int found = search.nearest(color, maxCount, indices.data(), distances.data());
+        QCOMPARE(found, qMin(maxCount, numColors));
+
+        for (int j = 0; j < found; j++) {
+            QCOMPARE(indices[j], expected[j].second);
+            QVERIFY(qFuzzyCompare(1.0f + distances[j], 1.0f + expected[j].first));
+        }
+    }
+}
+
+void KisNearestColorSearchTest::testEmptyPalette()
+{
+    KisNearestColorSearch search(QVector<quint16>(), 2);
+
+    const quint16 color[3] = {100, 200, 300};
+    int indices[2];
+
+    QCOMPARE(search.nearest(color), -1);
+    QCOMPARE(search.nearest(color, 2, indices), 0);
+}
+
+SIMPLE_TEST_MAIN(KisNearestColorSearchTest)
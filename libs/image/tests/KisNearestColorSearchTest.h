@@ -0,0 +1,22 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISNEARESTCOLORSEARCHTEST_H
+#define KISNEARESTCOLORSEARCHTEST_H
+
+#include <simpletest.h>
+
+class KisNearestColorSearchTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testNearest_data();
+    void testNearest();
+
+    void testEmptyPalette();
+};
+
+#endif // KISNEARESTCOLORSEARCHTEST_H
@@ -0,0 +1,152 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisSlidingWindowHistogramTest.h"
+
+#include <QRect>
+#include <QVector>
+
+#include "KisSlidingWindowHistogram.h"
+
+#include <simpletest.h>
+
+namespace {
+
+quint16 testBin(int x, int y, int numBins)
+{
+    const quint32 hash = (quint32(x) * 73856093u) ^ (quint32(y) * 19349663u);
+
+    // leave some holes in the image
+    if (hash % 11 == 0) return KisSlidingWindowHistogram::skipBin;
+
+    return (hash >> 4) % numBins;
+}
+
+float testValue(int x, int y)
+{
+    return 0.25f * x - y;
+}
+
+}
+
+void KisSlidingWindowHistogramTest::testWindow_data()
+{
+    QTest::addColumn<int>("numBins");
+    QTest::addColumn<int>("radius");
+    QTest::addColumn<QRect>("rect");
+
+    // the window is updated pixel-wise
+    QTest::newRow("pixels") << 16 << 3 << QRect(-5, -3, 40, 20);
+    QTest::newRow("pixels-stripes") << 64 << 2 << QRect(7, 2, 300, 6);
+    QTest::newRow("zero-radius") << 16 << 0 << QRect(0, 0, 10, 10);
+
+    // the window is updated column-wise
+    QTest::newRow("columns") << 16 << 10 << QRect(-5, -3, 40, 30);
+    QTest::newRow("columns-stripes") << 4 << 3 << QRect(-20, 0, 280, 5);
+}
+
+void KisSlidingWindowHistogramTest::testWindow()
+{
+    QFETCH(int, numBins);
+    QFETCH(int, radius);
+    QFETCH(QRect, rect);
+
+    KisSlidingWindowHistogram histogram(numBins, 2);
+
+    auto fetchRow = [numBins] (int x, int y, int width, quint16 *bins, float *values) {
+        for (int i = 0; i < width; i++) {
+            bins[i] = testBin(x + i, y, numBins);
+            values[2 * i] = 1.0f;
+            values[2 * i + 1] = testValue(x + i, y);
+        }
+    };
+
+    int numProcessedPixels = 0;
+    int numFailures = 0;
+
+    auto processPixel = [&] (int x, int y, const KisSlidingWindowHistogram &h) {
+        QVector<int> counts(numBins, 0);
+        QVector<double> sums(numBins, 0.0);
+        int numSamples = 0;
+
+        for (int srcY = y - radius; srcY <= y + radius; srcY++) {
+            for (int srcX = x - radius; srcX <= x + radius; srcX++) {
+                const quint16 bin = testBin(srcX, srcY, numBins);
+                if (bin == KisSlidingWindowHistogram::skipBin) continue;
+
+                counts[bin]++;
+                sums[bin] += testValue(srcX, srcY);
+                numSamples++;
+            }
+        }
+
+        bool matches = h.numSamples() == numSamples;
+
+        for (int bin = 0; bin < numBins; bin++) {
+            matches &= h.count(bin) == counts[bin];
+            matches &= qFuzzyCompare(1.0 + h.sums(bin)[0], 1.0 + counts[bin]);
+            matches &= qAbs(h.sums(bin)[1] - sums[bin]) < 1e-3;
+        }
+
+        int expectedMode = -1;
+        for (int bin = 0; bin < numBins; bin++) {
+            if (counts[bin] > 0 &&
+                (expectedMode < 0 || counts[bin] > counts[expectedMode])) {
+
+                expectedMode = bin;
+            }
+        }
+
+        matches &= h.mode() == expectedMode;
+
+        if (!matches) {
+            numFailures++;
+            if (numFailures < 5) {
+                qWarning() << "Window mismatch at" << x << y;
+            }
+        }
+
+        numProcessedPixels++;
+    };
+
+    histogram.process(rect, radius, fetchRow, processPixel);
+
+    QCOMPARE(numProcessedPixels, rect.width() * rect.height());
+    QCOMPARE(numFailures, 0);
+}
+
+void KisSlidingWindowHistogramTest::testEmptyWindow()
+{
+    KisSlidingWindowHistogram histogram(8);
+
+    auto fetchRow = [] (int x, int y, int width, quint16 *bins, float *values) {
+        Q_UNUSED(values);
+
+        // only the pixel (0, 0) is counted
+        for (int i = 0; i < width; i++) {
+            bins[i] = x + i == 0 && y == 0 ? 5 : KisSlidingWindowHistogram::skipBin;
+        }
+    };
+
+    QVector<int> modes;
+    QVector<int> medians;
+
+    histogram.process(QRect(0, 0, 3, 1), 1, fetchRow,
+                      [&] (int x, int y, const KisSlidingWindowHistogram &h) {
+                          Q_UNUSED(x);
+                          Q_UNUSED(y);
+
+                          modes << h.mode();
+                          medians << h.median();
+
+                          QCOMPARE(h.minimum(), h.maximum());
+                      });
+
+    QCOMPARE(modes, QVector<int>({5, 5, -1}));
+    QCOMPARE(medians, QVector<int>({5, 5, -1}));
+}
+
+SIMPLE_TEST_MAIN(KisSlidingWindowHistogramTest)
@@ -0,0 +1,21 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISSLIDINGWINDOWHISTOGRAMTEST_H
+#define KISSLIDINGWINDOWHISTOGRAMTEST_H
+
+#include <simpletest.h>
+
+class KisSlidingWindowHistogramTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testWindow_data();
+    void testWindow();
+    void testEmptyWindow();
+};
+
+#endif // KISSLIDINGWINDOWHISTOGRAMTEST_H
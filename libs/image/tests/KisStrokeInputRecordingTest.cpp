@@ -0,0 +1,69 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisStrokeInputRecordingTest.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "brushengine/KisStrokeInputRecording.h"
+#include "brushengine/kis_paint_information.h"
+
+#include <simpletest.h>
+
+void KisStrokeInputRecordingTest::testSaveLoad()
+{
+    KisStrokeInputRecording recording;
+
+    for (int i = 0; i < 100; i++) {
+        recording.addSample(
+            KisPaintInformation(QPointF(10.0 + i * 2.5, 20.0 - i * 0.5),
+                                i / 100.0, 30.0, -15.0, 0.25, 0.5, 1.0,
+                                i * 5.0, 0.5 + i / 200.0));
+    }
+
+    QTemporaryDir dir;
+    const QString fileName = dir.filePath("stroke.ksir");
+
+    QVERIFY(recording.save(fileName));
+
+    KisStrokeInputRecording loaded;
+    QVERIFY(loaded.load(fileName));
+
+    QCOMPARE(loaded.size(), recording.size());
+    QCOMPARE(loaded.duration(), 495.0);
+
+    for (int i = 0; i < recording.size(); i++) {
+        const KisPaintInformation expected = recording.paintInformation(i);
+        const KisPaintInformation actual = loaded.paintInformation(i);
+
+        QVERIFY(qAbs(actual.pos().x() - expected.pos().x()) < 1e-4);
+        QVERIFY(qAbs(actual.pos().y() - expected.pos().y()) < 1e-4);
+        QVERIFY(qAbs(actual.pressure() - expected.pressure()) < 1e-6);
+        QVERIFY(qAbs(actual.xTilt() - expected.xTilt()) < 1e-6);
+        QVERIFY(qAbs(actual.yTilt() - expected.yTilt()) < 1e-6);
+        QVERIFY(qAbs(actual.currentTime() - expected.currentTime()) < 1e-6);
+        QVERIFY(qAbs(actual.drawingSpeed() - expected.drawingSpeed()) < 1e-6);
+    }
+}
+
+void KisStrokeInputRecordingTest::testLoadBrokenFile()
+{
+    QTemporaryDir dir;
+    const QString fileName = dir.filePath("broken.ksir");
+
+    {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("not a recording");
+    }
+
+    KisStrokeInputRecording recording;
+    QVERIFY(!recording.load(fileName));
+    QVERIFY(recording.isEmpty());
+}
+
+SIMPLE_TEST_MAIN(KisStrokeInputRecordingTest)
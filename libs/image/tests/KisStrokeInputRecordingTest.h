@@ -0,0 +1,20 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISSTROKEINPUTRECORDINGTEST_H
+#define KISSTROKEINPUTRECORDINGTEST_H
+
+#include <simpletest.h>
+
+class KisStrokeInputRecordingTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testSaveLoad();
+    void testLoadBrokenFile();
+};
+
+#endif // KISSTROKEINPUTRECORDINGTEST_H
@@ -0,0 +1,244 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisSummedAreaTableTest.h"
+
+#include <simpletest.h>
+
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoMixColorsOp.h>
+
+#include "kis_paint_device.h"
+#include "kis_sequential_iterator.h"
+#include "kis_convolution_painter.h"
+#include "kis_convolution_kernel.h"
+#include "KisSummedAreaTable.h"
+#include <kistest.h>
+#include "testing_timed_default_bounds.h"
+
+namespace {
+
+const QRect imageRect(0, 0, 150, 110);
+
+/**
+ * A device with random colors and alpha, with a fully transparent
+ * and a fully opaque stripe
+ */
+KisPaintDeviceSP randomDevice(const KoColorSpace *cs)
+{
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->setDefaultBounds(new TestUtil::TestingTimedDefaultBounds(imageRect));
+
+    quint32 seed = 1;
+    const int pixelSize = cs->pixelSize();
+
+    KisSequentialIterator it(dev, imageRect);
+    while (it.nextPixel()) {
+        for (int i = 0; i < pixelSize; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            it.rawData()[i] = quint8(seed >> 24);
+        }
+
+        if (it.x() < 10) {
+            cs->setOpacity(it.rawData(), OPACITY_TRANSPARENT_U8, 1);
+        } else if (it.x() < 20) {
+            cs->setOpacity(it.rawData(), OPACITY_OPAQUE_U8, 1);
+        }
+    }
+
+    return dev;
+}
+
+const KoColorSpace* colorSpaceByName(const QString &name)
+{
+    return name == "rgb16" ?
+        KoColorSpaceRegistry::instance()->rgb16() :
+        KoColorSpaceRegistry::instance()->rgb8();
+}
+
+}
+
+void KisSummedAreaTableTest::testMeanPixel_data()
+{
+    QTest::addColumn<QString>("colorSpace");
+
+    QTest::newRow("rgb8") << "rgb8";
+    QTest::newRow("rgb16") << "rgb16";
+}
+
+void KisSummedAreaTableTest::testMeanPixel()
+{
+    QFETCH(QString, colorSpace);
+
+    const KoColorSpace *cs = colorSpaceByName(colorSpace);
+    QVERIFY(KisSummedAreaTable::isSupported(cs));
+
+    KisPaintDeviceSP dev = randomDevice(cs);
+    const int pixelSize = cs->pixelSize();
+
+    const QRect tableRect(5, 7, 130, 90);
+    KisSummedAreaTable table(dev, tableRect);
+    QCOMPARE(table.rect(), tableRect);
+
+    const QRect areas[] = {
+        QRect(5, 7, 1, 1),
+        QRect(0, 0, 10, 30),
+        QRect(12, 20, 50, 3),
+        QRect(30, 40, 60, 50),
+        tableRect,
+        QRect(100, 80, 100, 100)
+    };
+
+    QVector<quint8> mean(pixelSize);
+    QVector<quint8> expected(pixelSize);
+
+    for (const QRect &area : areas) {
+        const QRect clipped = area & tableRect;
+
+        QVector<quint8> pixels(clipped.width() * clipped.height() * pixelSize);
+        dev->readBytes(pixels.data(), clipped);
+        cs->mixColorsOp()->mixColors(pixels.constData(), clipped.width() * clipped.height(), expected.data());
+
+        table.meanPixel(area, mean.data());
+
+        // the sums are exact, only the rounding of the halves may differ
+        if (pixelSize == 4) {
+            for (int i = 0; i < 4; i++) {
+                QVERIFY(qAbs(int(mean[i]) - int(expected[i])) <= 1);
+            }
+        } else {
+            const quint16 *meanChannels = reinterpret_cast<const quint16*>(mean.constData());
+            const quint16 *expectedChannels = reinterpret_cast<const quint16*>(expected.constData());
+            for (int i = 0; i < 4; i++) {
+                QVERIFY(qAbs(int(meanChannels[i]) - int(expectedChannels[i])) <= 1);
+            }
+        }
+    }
+}
+
+void KisSummedAreaTableTest::testBoxConvolution_data()
+{
+    QTest::addColumn<int>("halfWidth");
+    QTest::addColumn<int>("halfHeight");
+
+    QTest::newRow("3x3") << 1 << 1;
+    QTest::newRow("11x5") << 5 << 2;
+    QTest::newRow("1x21") << 0 << 10;
+}
+
+void KisSummedAreaTableTest::testBoxConvolution()
+{
+    QFETCH(int, halfWidth);
+    QFETCH(int, halfHeight);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    KisPaintDeviceSP refDev = randomDevice(cs);
+    KisPaintDeviceSP dev = new KisPaintDevice(*refDev);
+
+    // touches the border of the image to check the repeated pixels
+    const QRect applyRect(0, 10, 120, 100);
+
+    Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> matrix(2 * halfHeight + 1, 2 * halfWidth + 1);
+    matrix.fill(1.0);
+    KisConvolutionKernelSP kernel = KisConvolutionKernel::fromMatrix(matrix, 0, matrix.sum());
+
+    KisConvolutionPainter painter(refDev);
+    painter.applyMatrix(kernel, refDev, applyRect.topLeft(), applyRect.topLeft(), applyRect.size(), BORDER_REPEAT);
+
+    KisSummedAreaTable::Box box;
+    box.rect = QRect(-halfWidth, -halfHeight, 2 * halfWidth + 1, 2 * halfHeight + 1);
+
+    KisSummedAreaTable::applyBoxes(dev, dev, applyRect, {box},
+                                   KisSummedAreaTable::borderRepeatRect(dev, applyRect));
+
+    QByteArray refData(imageRect.width() * imageRect.height() * cs->pixelSize(), 0);
+    QByteArray data(refData.size(), 0);
+
+    refDev->readBytes(reinterpret_cast<quint8*>(refData.data()), imageRect);
+    dev->readBytes(reinterpret_cast<quint8*>(data.data()), imageRect);
+
+    /**
+     * The color of almost transparent pixels is not precise in the
+     * convolution, so it is not compared
+     */
+    int maxDifference = 0;
+
+    const int pixelSize = cs->pixelSize();
+    for (int i = 0; i < data.size(); i += pixelSize) {
+        const quint8 *refPixel = reinterpret_cast<const quint8*>(refData.constData() + i);
+        const quint8 *pixel = reinterpret_cast<const quint8*>(data.constData() + i);
+
+        const int firstChannel = refPixel[3] >= 32 ? 0 : 3;
+
+        for (int k = firstChannel; k < pixelSize; k++) {
+            maxDifference = qMax(maxDifference, qAbs(int(refPixel[k]) - int(pixel[k])));
+        }
+    }
+
+    QVERIFY2(maxDifference <= 1, QString("maxDifference: %1").arg(maxDifference).toLatin1());
+}
+
+void KisSummedAreaTableTest::testFloatBoxMean_data()
+{
+    QTest::addColumn<int>("radius");
+
+    QTest::newRow("0") << 0;
+    QTest::newRow("1") << 1;
+    QTest::newRow("5") << 5;
+    QTest::newRow("30") << 30;
+    QTest::newRow("bigger than buffer") << 100;
+}
+
+void KisSummedAreaTableTest::testFloatBoxMean()
+{
+    QFETCH(int, radius);
+
+    const int width = 61;
+    const int height = 47;
+
+    QVector<float> src(width * height);
+
+    quint32 seed = 1;
+    for (int i = 0; i < src.size(); i++) {
+        seed = seed * 1664525u + 1013904223u;
+        src[i] = (seed >> 8) / float(1 << 24);
+    }
+
+    QVector<float> expected(src.size());
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            double sum = 0.0;
+            int count = 0;
+
+            for (int wy = qMax(0, y - radius); wy <= qMin(height - 1, y + radius); wy++) {
+                for (int wx = qMax(0, x - radius); wx <= qMin(width - 1, x + radius); wx++) {
+                    sum += src[wy * width + wx];
+                    count++;
+                }
+            }
+
+            expected[y * width + x] = sum / count;
+        }
+    }
+
+    QVector<float> dst(src.size());
+    KisSummedAreaTable::boxMean(src.constData(), dst.data(), width, height, radius);
+
+    // the buffers may be the same
+    QVector<float> inPlace = src;
+    float *buffer = inPlace.data();
+    KisSummedAreaTable::boxMean(buffer, buffer, width, height, radius);
+
+    for (int i = 0; i < src.size(); i++) {
+        QVERIFY(qAbs(dst[i] - expected[i]) < 1e-5f);
+        QCOMPARE(inPlace[i], dst[i]);
+    }
+}
+
+KISTEST_MAIN(KisSummedAreaTableTest)
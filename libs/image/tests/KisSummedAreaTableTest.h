@@ -0,0 +1,26 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISSUMMEDAREATABLETEST_H
+#define KISSUMMEDAREATABLETEST_H
+
+#include <simpletest.h>
+
+class KisSummedAreaTableTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testMeanPixel_data();
+    void testMeanPixel();
+
+    void testBoxConvolution_data();
+    void testBoxConvolution();
+
+    void testFloatBoxMean_data();
+    void testFloatBoxMean();
+};
+
+#endif // KISSUMMEDAREATABLETEST_H
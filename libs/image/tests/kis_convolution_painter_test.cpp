@@ -20,6 +20,7 @@
 #include "kis_convolution_painter.h"
 #include "kis_convolution_kernel.h"
 #include <kis_gaussian_kernel.h>
+#include <KisRecursiveGaussianBlur.h>
 #include <kis_mask_generator.h>
 #include <kistest.h>
 #include "testutil.h"
@@ -450,6 +451,185 @@ void KisConvolutionPainterTest::testGaussianDetailsFFTW()
     testGaussianDetails(true);
 }
 
+void KisConvolutionPainterTest::testRecursiveGaussian_data()
+{
+    QTest::addColumn<qreal>("xRadius");
+    QTest::addColumn<qreal>("yRadius");
+
+    QTest::newRow("both") << 30.0 << 20.0;
+    QTest::newRow("horizontal") << 30.0 << 0.0;
+    QTest::newRow("vertical") << 0.0 << 12.0;
+    QTest::newRow("small") << 6.0 << 6.0;
+}
+
+void KisConvolutionPainterTest::testRecursiveGaussian()
+{
+    QFETCH(qreal, xRadius);
+    QFETCH(qreal, yRadius);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect imageRect(0, 0, 200, 150);
+
+    KisPaintDeviceSP refDev = new KisPaintDevice(cs);
+    refDev->setDefaultBounds(new TestUtil::TestingTimedDefaultBounds(imageRect));
+    refDev->fill(QRect(40, 30, 100, 60), KoColor(QColor(255, 128, 0, 200), cs));
+    refDev->fill(QRect(90, 50, 20, 80), KoColor(QColor(0, 0, 255, 255), cs));
+    refDev->fill(QRect(0, 140, 200, 10), KoColor(QColor(0, 255, 0, 255), cs));
+
+    KisPaintDeviceSP dev = new KisPaintDevice(*refDev);
+
+    const QRect applyRect(20, 10, 170, 140);
+
+    // the radii are small enough to be handled by the convolution
+    KisGaussianKernel::applyGaussian(refDev, applyRect, xRadius, yRadius, QBitArray(), 0, true);
+
+    KisRecursiveGaussianBlur::apply(dev, applyRect, xRadius, yRadius, QBitArray(), 0);
+
+    QByteArray refData(imageRect.width() * imageRect.height() * cs->pixelSize(), 0);
+    QByteArray data(refData.size(), 0);
+
+    refDev->readBytes(reinterpret_cast<quint8*>(refData.data()), imageRect);
+    dev->readBytes(reinterpret_cast<quint8*>(data.data()), imageRect);
+
+    /**
+     * The recursive filter approximates the infinite Gaussian, while the
+     * kernel is truncated at 3 sigma, so the results are not equal, but
+     * should be very close. The color of almost transparent pixels is
+     * not precise in both cases, so it is not compared.
+     */
+    int maxDifference = 0;
+
+    const int pixelSize = cs->pixelSize();
+    for (int i = 0; i < data.size(); i += pixelSize) {
+        const quint8 *refPixel = reinterpret_cast<const quint8*>(refData.constData() + i);
+        const quint8 *pixel = reinterpret_cast<const quint8*>(data.constData() + i);
+
+        const int firstChannel = refPixel[3] >= 32 ? 0 : 3;
+
+        for (int k = firstChannel; k < pixelSize; k++) {
+            maxDifference = qMax(maxDifference, qAbs(int(refPixel[k]) - int(pixel[k])));
+        }
+    }
+
+    QVERIFY2(maxDifference <= 3, QString("maxDifference: %1").arg(maxDifference).toLatin1());
+}
+
+void KisConvolutionPainterTest::testTiledFFT()
+{
+    if (!KisConvolutionPainter::supportsFFTW()) {
+        QSKIP("FFTW is not available");
+    }
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    // big enough for the FFT worker to switch into the tiled mode
+    const QRect imageRect(0, 0, 2200, 2100);
+
+    QByteArray initialData(imageRect.width() * imageRect.height() * cs->pixelSize(), 0);
+    quint8 *ptr = reinterpret_cast<quint8*>(initialData.data());
+    for (int y = 0; y < imageRect.height(); y++) {
+        for (int x = 0; x < imageRect.width(); x++) {
+            ptr[0] = (x * 7 + y * 13) % 256;
+            ptr[1] = (x / 16 + y / 8) % 2 ? 255 : 0;
+            ptr[2] = (x * y) % 251;
+            ptr[3] = 255;
+            ptr += 4;
+        }
+    }
+
+    KisPaintDeviceSP srcDev = new KisPaintDevice(cs);
+    srcDev->setDefaultBounds(new TestUtil::TestingTimedDefaultBounds(imageRect));
+    srcDev->writeBytes(reinterpret_cast<const quint8*>(initialData.constData()), imageRect);
+
+    KisPaintDeviceSP refDev = new KisPaintDevice(*srcDev);
+    KisPaintDeviceSP dev = new KisPaintDevice(*srcDev);
+
+    KisConvolutionKernelSP kernel = KisGaussianKernel::createHorizontalKernel(5.0);
+
+    KisConvolutionPainter refPainter(refDev, KisConvolutionPainter::SPATIAL);
+    refPainter.applyMatrix(kernel, srcDev, imageRect.topLeft(), imageRect.topLeft(), imageRect.size(), BORDER_REPEAT);
+
+    // convolve in-place to check that the tiles don't read each other's results
+    KisConvolutionPainter painter(dev, KisConvolutionPainter::FFTW);
+    painter.applyMatrix(kernel, dev, imageRect.topLeft(), imageRect.topLeft(), imageRect.size(), BORDER_REPEAT);
+
+    QByteArray refData(initialData.size(), 0);
+    QByteArray data(initialData.size(), 0);
+
+    refDev->readBytes(reinterpret_cast<quint8*>(refData.data()), imageRect);
+    dev->readBytes(reinterpret_cast<quint8*>(data.data()), imageRect);
+
+    int maxDifference = 0;
+    for (int i = 0; i < data.size(); i++) {
+        maxDifference = qMax(maxDifference, qAbs(int(quint8(refData[i])) - int(quint8(data[i]))));
+    }
+
+    QVERIFY2(maxDifference <= 1, QString("maxDifference: %1").arg(maxDifference).toLatin1());
+}
+
+void KisConvolutionPainterTest::testTiledFFTEvenKernel()
+{
+    if (!KisConvolutionPainter::supportsFFTW()) {
+        QSKIP("FFTW is not available");
+    }
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    // big enough for the FFT worker to switch into the tiled mode
+    const QRect imageRect(0, 0, 2200, 2100);
+
+    // small enough to be convolved in a single block
+    const QRect checkRect(500, 400, 700, 600);
+
+    QByteArray initialData(imageRect.width() * imageRect.height() * cs->pixelSize(), 0);
+    quint8 *ptr = reinterpret_cast<quint8*>(initialData.data());
+    for (int y = 0; y < imageRect.height(); y++) {
+        for (int x = 0; x < imageRect.width(); x++) {
+            ptr[0] = (x * 7 + y * 13) % 256;
+            ptr[1] = (x / 16 + y / 8) % 2 ? 255 : 0;
+            ptr[2] = (x * y) % 251;
+            ptr[3] = 255;
+            ptr += 4;
+        }
+    }
+
+    KisPaintDeviceSP srcDev = new KisPaintDevice(cs);
+    srcDev->setDefaultBounds(new TestUtil::TestingTimedDefaultBounds(imageRect));
+    srcDev->writeBytes(reinterpret_cast<const quint8*>(initialData.constData()), imageRect);
+
+    /**
+     * An asymmetric kernel of even size, so that a wrong margin of the
+     * blocks would shift the result or wrap it around the tile borders
+     */
+    Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> matrix(2, 4);
+    matrix << 1, 2, 0, 3,
+              0, 4, 1, 5;
+
+    KisConvolutionKernelSP kernel = KisConvolutionKernel::fromMatrix(matrix, 0, 16);
+
+    KisPaintDeviceSP tiledDev = new KisPaintDevice(*srcDev);
+    KisConvolutionPainter tiledPainter(tiledDev, KisConvolutionPainter::FFTW);
+    tiledPainter.applyMatrix(kernel, srcDev, imageRect.topLeft(), imageRect.topLeft(), imageRect.size(), BORDER_REPEAT);
+
+    KisPaintDeviceSP untiledDev = new KisPaintDevice(*srcDev);
+    KisConvolutionPainter untiledPainter(untiledDev, KisConvolutionPainter::FFTW);
+    untiledPainter.applyMatrix(kernel, srcDev, checkRect.topLeft(), checkRect.topLeft(), checkRect.size(), BORDER_REPEAT);
+
+    const int checkSize = checkRect.width() * checkRect.height() * cs->pixelSize();
+    QByteArray tiledData(checkSize, 0);
+    QByteArray untiledData(checkSize, 0);
+
+    tiledDev->readBytes(reinterpret_cast<quint8*>(tiledData.data()), checkRect);
+    untiledDev->readBytes(reinterpret_cast<quint8*>(untiledData.data()), checkRect);
+
+    int maxDifference = 0;
+    for (int i = 0; i < checkSize; i++) {
+        maxDifference = qMax(maxDifference, qAbs(int(quint8(tiledData[i])) - int(quint8(untiledData[i]))));
+    }
+
+    QVERIFY2(maxDifference <= 1, QString("maxDifference: %1").arg(maxDifference).toLatin1());
+}
+
 #include "kis_transaction.h"
 
 void KisConvolutionPainterTest::testDilate()
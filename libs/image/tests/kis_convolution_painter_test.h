@@ -47,6 +47,12 @@ private Q_SLOTS:
     void testGaussianDetailsSpatial();
     void testGaussianDetailsFFTW();
 
+    void testRecursiveGaussian();
+    void testRecursiveGaussian_data();
+
+    void testTiledFFT();
+    void testTiledFFTEvenKernel();
+
     void testDilate();
     void testErode();
 
@@ -7,6 +7,8 @@
 #include "kis_filter_mask_test.h"
 #include <simpletest.h>
 
+#include <QPainter>
+
 #include <KoColorSpaceRegistry.h>
 
 #include "kis_selection.h"
@@ -98,4 +100,54 @@ void KisFilterMaskTest::testProjectionSelected()
 
 }
 
+void KisFilterMaskTest::testFusedColorTransformations()
+{
+    TestUtil::MaskParent p(QRect(0, 0, IMAGE_WIDTH, IMAGE_HEIGHT));
+    KisImageSP image = p.image;
+    KisPaintLayerSP layer = p.layer;
+
+    QImage qimage(QString(FILES_DATA_DIR) + '/' + "hakonepa.png");
+    QImage inverted(QString(FILES_DATA_DIR) + '/' + "inverted_hakonepa.png");
+    layer->paintDevice()->convertFromQImage(qimage, 0, 0, 0);
+
+    KisFilterSP f = KisFilterRegistry::instance()->value("invert");
+    Q_ASSERT(f);
+    KisFilterConfigurationSP  kfc = f->defaultConfiguration(KisGlobalResourcesInterface::instance());
+    Q_ASSERT(kfc);
+
+    /**
+     * The masks with the full selection are applied in pairs in a single
+     * pass, the middle one only inverts the left half of the image
+     */
+    const QRect leftHalf(0, 0, qimage.width() / 2, qimage.height());
+
+    for (int i = 0; i < 5; i++) {
+        KisFilterMaskSP mask = new KisFilterMask(image, QString("mask%1").arg(i));
+        image->addNode(mask, layer);
+
+        mask->setFilter(kfc->cloneWithResourcesSnapshot());
+        mask->initSelection(layer);
+        mask->createNodeProgressProxy();
+
+        if (i == 2) {
+            mask->select(qimage.rect(), MIN_SELECTED);
+            mask->select(leftHalf, MAX_SELECTED);
+        }
+    }
+
+    image->initialRefreshGraph();
+
+    QImage expected = qimage.convertToFormat(QImage::Format_ARGB32);
+    QPainter gc(&expected);
+    gc.setCompositionMode(QPainter::CompositionMode_Source);
+    gc.drawImage(leftHalf.topLeft(), inverted, leftHalf);
+    gc.end();
+
+    QPoint errpoint;
+    if (!TestUtil::compareQImages(errpoint, expected, image->projection()->convertToQImage(0, 0, 0, qimage.width(), qimage.height()))) {
+        image->projection()->convertToQImage(0, 0, 0, qimage.width(), qimage.height()).save("filtermasktest3.png");
+        QFAIL(QString("Failed to apply the masks, first different pixel: %1,%2 ").arg(errpoint.x()).arg(errpoint.y()).toLatin1());
+    }
+}
+
 SIMPLE_TEST_MAIN(KisFilterMaskTest)
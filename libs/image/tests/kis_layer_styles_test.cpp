@@ -272,4 +272,98 @@ void KisLayerStylesTest::testLayerStylesRects()
     testDropShadowNeedChangeRects(0, 0, 10, 75, applyRect, needRect, changeRect);
 }
 
+QImage renderDropShadow(KisPaintDeviceSP dev,
+                        KisMultipleProjection *projection,
+                        const TestConfig &config,
+                        const QVector<QRect> &applyRects)
+{
+    const QRect dstRect(0, 0, 200, 200);
+
+    KisLsDropShadowFilter lsFilter;
+    KisPSDLayerStyleSP style(new KisPSDLayerStyle());
+    config.writeProperties(style);
+
+    TestUtil::MaskParent parent;
+    KisLayerStyleFilterEnvironment env(parent.layer.data());
+    KisLayerStyleKnockoutBlower blower;
+
+    Q_FOREACH (const QRect &rc, applyRects) {
+        projection->clear(rc);
+        lsFilter.processDirectly(dev, projection, &blower, rc, style, &env);
+    }
+
+    KisPaintDeviceSP dst = new KisPaintDevice(dev->colorSpace());
+    projection->apply(dst, dstRect, &env);
+
+    return dst->convertToQImage(0, dstRect);
+}
+
+void KisLayerStylesTest::testLayerStylesCachedPlane()
+{
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    QVector<QRect> rects;
+
+    for (int y = 0; y < 200; y += 50) {
+        for (int x = 0; x < 200; x += 50) {
+            rects << QRect(x, y, 50, 50);
+        }
+    }
+
+    TestConfig c;
+    c.distance = 20;
+    c.angle = 135;
+    c.spread = 50;
+    c.size = 10;
+    c.noise = 0;
+    c.knocks_out = true;
+    c.opacity = 50;
+    c.keep_original = false;
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->fill(QRect(50, 50, 100, 100), KoColor(Qt::red, cs));
+
+    KisMultipleProjection cachedProjection;
+    renderDropShadow(dev, &cachedProjection, c, rects);
+
+    // change the source and update only the affected area
+    const QRect changedRect(120, 120, 50, 20);
+    dev->fill(changedRect, KoColor(Qt::blue, cs));
+
+    KisLsDropShadowFilter lsFilter;
+    KisPSDLayerStyleSP style(new KisPSDLayerStyle());
+    c.writeProperties(style);
+    TestUtil::MaskParent parent;
+    KisLayerStyleFilterEnvironment env(parent.layer.data());
+
+    const QRect updateRect = lsFilter.changedRect(changedRect, style, &env);
+    cachedProjection.invalidateIntermediatePlanes(changedRect);
+    const QImage cachedResult = renderDropShadow(dev, &cachedProjection, c, {updateRect});
+
+    KisMultipleProjection freshProjection;
+    const QImage freshResult = renderDropShadow(dev, &freshProjection, c, rects);
+
+    QPoint errorPoint;
+    QVERIFY(TestUtil::compareQImages(errorPoint, cachedResult, freshResult));
+
+    // change of the default pixel is not reported via invalidation,
+    // but should still drop the cached plane
+    dev->setDefaultPixel(KoColor(Qt::green, cs));
+    const QImage defaultPixelResult = renderDropShadow(dev, &cachedProjection, c, rects);
+
+    KisMultipleProjection freshProjection3;
+    const QImage freshResult3 = renderDropShadow(dev, &freshProjection3, c, rects);
+
+    QVERIFY(TestUtil::compareQImages(errorPoint, defaultPixelResult, freshResult3));
+
+    // change of the config should drop the cached plane
+    c.size = 5;
+    const QImage changedConfigResult = renderDropShadow(dev, &cachedProjection, c, rects);
+
+    KisMultipleProjection freshProjection2;
+    const QImage freshResult2 = renderDropShadow(dev, &freshProjection2, c, rects);
+
+    QVERIFY(TestUtil::compareQImages(errorPoint, changedConfigResult, freshResult2));
+}
+
 KISTEST_MAIN(KisLayerStylesTest)
@@ -18,6 +18,8 @@ private Q_SLOTS:
     void testLayerStylesPartialVary();
 
     void testLayerStylesRects();
+
+    void testLayerStylesCachedPlane();
 };
 
 #endif /* __KIS_LAYER_STYLES_TEST_H */
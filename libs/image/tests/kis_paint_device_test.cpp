@@ -1538,6 +1538,83 @@ void KisPaintDeviceTest::testLodDevice()
                                   "lod", "lod1-offset-6-14"));
 }
 
+void KisPaintDeviceTest::testLodDeviceIncrementalSync()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect rect(0,0,300,200);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    TestingLodDefaultBounds *bounds = new TestingLodDefaultBounds(rect);
+    dev->setDefaultBounds(bounds);
+    fillGradientDevice(dev, rect);
+
+    // the first sync generates the whole level
+    bounds->testingSetLevelOfDetail(1);
+    syncLodCache(dev, 1);
+    bounds->testingSetLevelOfDetail(0);
+
+    // change a part of Lod0 and add some new tiles
+    dev->fill(QRect(70,70,20,20), KoColor(Qt::red, cs));
+    dev->fill(QRect(320,10,20,20), KoColor(Qt::blue, cs));
+
+    // the second sync should regenerate only the changed tiles
+    bounds->testingSetLevelOfDetail(1);
+    syncLodCache(dev, 1);
+    QImage incremental = dev->convertToQImage(0, 0, 0, 200, 100);
+    bounds->testingSetLevelOfDetail(0);
+
+    // compare with a device synced from scratch
+    KisPaintDeviceSP ref = new KisPaintDevice(*dev);
+    TestingLodDefaultBounds *refBounds = new TestingLodDefaultBounds(rect);
+    ref->setDefaultBounds(refBounds);
+
+    refBounds->testingSetLevelOfDetail(1);
+    syncLodCache(ref, 1);
+    QImage full = ref->convertToQImage(0, 0, 0, 200, 100);
+
+    QCOMPARE(incremental, full);
+}
+
+void KisPaintDeviceTest::testLodDeviceIncrementalClear()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect rect(0,0,300,200);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    TestingLodDefaultBounds *bounds = new TestingLodDefaultBounds(rect);
+    dev->setDefaultBounds(bounds);
+
+    // an odd offset makes the LodN pixels straddle the Lod0 tiles
+    dev->setX(3);
+    fillGradientDevice(dev, rect);
+
+    bounds->testingSetLevelOfDetail(1);
+    syncLodCache(dev, 1);
+    bounds->testingSetLevelOfDetail(0);
+
+    // delete two whole tiles and clear a part of another one
+    dev->clear(QRect(67,0,128,64));
+    dev->clear(QRect(10,100,30,30));
+
+    bounds->testingSetLevelOfDetail(1);
+    syncLodCache(dev, 1);
+    QImage incremental = dev->convertToQImage(0, 0, 0, 200, 100);
+    bounds->testingSetLevelOfDetail(0);
+
+    QCOMPARE(incremental.pixelColor(50, 15).alpha(), 0);
+    QCOMPARE(incremental.pixelColor(12, 57).alpha(), 0);
+
+    KisPaintDeviceSP ref = new KisPaintDevice(*dev);
+    TestingLodDefaultBounds *refBounds = new TestingLodDefaultBounds(rect);
+    ref->setDefaultBounds(refBounds);
+
+    refBounds->testingSetLevelOfDetail(1);
+    syncLodCache(ref, 1);
+    QImage full = ref->convertToQImage(0, 0, 0, 200, 100);
+
+    QCOMPARE(incremental, full);
+}
+
 void KisPaintDeviceTest::benchmarkLod1Generation()
 {
     const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
@@ -53,6 +53,8 @@ private Q_SLOTS:
 
     void testLodTransform();
     void testLodDevice();
+    void testLodDeviceIncrementalSync();
+    void testLodDeviceIncrementalClear();
     void benchmarkLod1Generation();
     void benchmarkLod2Generation();
     void benchmarkLod3Generation();
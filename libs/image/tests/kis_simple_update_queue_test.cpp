@@ -242,6 +242,50 @@ void KisSimpleUpdateQueueTest::testMixingTypes()
     QCOMPARE(walkersList[5]->clonesDontInvalidateFrames(), true);
 }
 
+void KisSimpleUpdateQueueTest::testMergeManySmallUpdates()
+{
+    QRect imageRect(0,0,4096,4096);
+
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "merge test");
+
+    KisPaintLayerSP paintLayer1 = new KisPaintLayer(image, "test1", OPACITY_OPAQUE_U8);
+    KisPaintLayerSP paintLayer2 = new KisPaintLayer(image, "test2", OPACITY_OPAQUE_U8);
+
+    image->barrierLock();
+    image->addNode(paintLayer1);
+    image->addNode(paintLayer2);
+    image->unlock();
+
+    KisTestableSimpleUpdateQueue queue;
+    KisWalkersList& walkersList = queue.getWalkersList();
+
+    /**
+     * Two interleaved "brush strokes" far away from each other, and
+     * one more on a different node, like in mirror painting mode
+     */
+    for (int i = 0; i < 200; i++) {
+        queue.addUpdateJob(paintLayer1, QRect(100 + i, 100, 20, 20), imageRect, 0);
+        queue.addUpdateJob(paintLayer1, QRect(3000 - i, 3000, 20, 20), imageRect, 0);
+        queue.addUpdateJob(paintLayer2, QRect(100 + i, 100, 20, 20), imageRect, 0);
+    }
+
+    QCOMPARE(walkersList.size(), 3);
+
+    QVERIFY(checkWalker(walkersList[0], QRect(100, 100, 219, 20)));
+    QVERIFY(checkWalker(walkersList[1], QRect(2801, 3000, 219, 20)));
+    QVERIFY(checkWalker(walkersList[2], QRect(100, 100, 219, 20)));
+
+    QCOMPARE(walkersList[0]->startNode(), KisNodeSP(paintLayer1));
+    QCOMPARE(walkersList[1]->startNode(), KisNodeSP(paintLayer1));
+    QCOMPARE(walkersList[2]->startNode(), KisNodeSP(paintLayer2));
+
+    // the grown walkers should still be found by the index
+    queue.addUpdateJob(paintLayer1, QRect(2795, 3000, 20, 20), imageRect, 0);
+    QCOMPARE(walkersList.size(), 3);
+    QVERIFY(checkWalker(walkersList[1], QRect(2795, 3000, 225, 20)));
+}
+
 void KisSimpleUpdateQueueTest::testSpontaneousJobsCompression()
 {
     KisTestableSimpleUpdateQueue queue;
@@ -23,6 +23,7 @@ private Q_SLOTS:
     void testSplitFullRefresh();
     void testChecksum();
     void testMixingTypes();
+    void testMergeManySmallUpdates();
     void testSpontaneousJobsCompression();
 };
 
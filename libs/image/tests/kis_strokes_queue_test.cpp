@@ -7,6 +7,9 @@
 #include "kis_strokes_queue_test.h"
 #include <simpletest.h>
 
+#include <QAtomicInt>
+#include <QThread>
+
 #include "kistest.h"
 
 #include "scheduler_utils.h"
@@ -1030,6 +1033,71 @@ void KisStrokesQueueTest::testMutatedJobs()
     t.checkNothingExecuted();
 }
 
+void KisStrokesQueueTest::testMutatedJobsAddedCallback()
+{
+    LodStrokesQueueTester t(true);
+    KisStrokesQueue &queue = t.queue;
+
+    QThread *mainThread = QThread::currentThread();
+    QAtomicInt numCallbacks;
+    QAtomicInt numCallbacksInMainThread;
+
+    /**
+     * The callback is called by the worker thread that is still running
+     * the job which mutated, so processing the queue from it should
+     * neither deadlock on the queue's mutex nor on the updater context's
+     * lock, and should start the mutated jobs on the spare thread
+     */
+    queue.setMutatedJobsAddedCallback([&] () {
+        numCallbacks.ref();
+        if (QThread::currentThread() == mainThread) {
+            numCallbacksInMainThread.ref();
+        }
+
+        queue.processQueue(t.context, false);
+    });
+
+    KisStrokeId id1 = queue.startStroke(new KisTestingStrokeStrategy(QLatin1String("str1_"), false, true, false, true));
+
+    queue.addJob(id1,
+                 new KisTestingStrokeJobData(
+                     KisStrokeJobData::CONCURRENT,
+                     KisStrokeJobData::NORMAL,
+                     true, "1"));
+
+    queue.addJob(id1,
+                 new KisTestingStrokeJobData(
+                     KisStrokeJobData::SEQUENTIAL,
+                     KisStrokeJobData::NORMAL,
+                     false, "2"));
+
+    queue.endStroke(id1);
+
+    t.processQueue();
+
+    QCOMPARE(int(numCallbacks), 1);
+    QCOMPARE(int(numCallbacksInMainThread), 0);
+
+    // one of the mutated jobs has been started on the second thread
+    // without waiting for the next processQueue() call
+    QStringList refList;
+    refList << "str1_dab_1" << "str1_dab_mutated";
+    t.checkExecutedJobs(refList);
+
+    t.processQueue();
+    refList.clear();
+    refList << "str1_dab_mutated" << "str1_dab_mutated";
+    t.checkExecutedJobs(refList);
+
+    t.processQueue();
+    t.checkOnlyExecutedJob("str1_dab_2");
+
+    t.processQueue();
+    t.checkNothingExecuted();
+
+    QCOMPARE(int(numCallbacks), 1);
+}
+
 QString sequentialityToString(KisStrokeJobData::Sequentiality seq) {
     QString result = "<unknown>";
 
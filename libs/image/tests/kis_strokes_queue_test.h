@@ -34,6 +34,7 @@ private Q_SLOTS:
     void testLodUndoBase();
     void testLodUndoBase2();
     void testMutatedJobs();
+    void testMutatedJobsAddedCallback();
     void testUniquelyConcurrentJobs();
 
 private:
@@ -269,6 +269,44 @@ void KisUpdateSchedulerTest::testEmptyStroke()
     image->waitForDone();
 }
 
+void KisUpdateSchedulerTest::testMutatedJobsFromWorker()
+{
+    KisImageSP image = buildTestingImage();
+
+    /**
+     * The mutated jobs make the image's scheduler call processQueues()
+     * from the worker thread that is still running the mutating job.
+     * The jobs are sequential, so that they could not be started by that
+     * call, but still must be run once the mutating job is finished.
+     */
+    globalExecutedDabs.clear();
+
+    KisStrokeId id = image->startStroke(new KisTestingStrokeStrategy(QLatin1String("mut_"), false, true));
+
+    image->addJob(id,
+                  new KisTestingStrokeJobData(
+                      KisStrokeJobData::SEQUENTIAL,
+                      KisStrokeJobData::NORMAL,
+                      true, "1"));
+
+    image->addJob(id,
+                  new KisTestingStrokeJobData(
+                      KisStrokeJobData::SEQUENTIAL,
+                      KisStrokeJobData::NORMAL,
+                      false, "2"));
+
+    image->endStroke(id);
+    image->waitForDone();
+
+    QStringList refList;
+    refList << "mut_dab_1"
+            << "mut_dab_mutated" << "mut_dab_mutated" << "mut_dab_mutated"
+            << "mut_dab_2";
+
+    QCOMPARE(globalExecutedDabs, refList);
+    globalExecutedDabs.clear();
+}
+
 #include "kis_lazy_wait_condition.h"
 
 void KisUpdateSchedulerTest::testLazyWaitCondition()
@@ -24,6 +24,7 @@ private Q_SLOTS:
     void testLocking();
     void testExclusiveStrokes();
     void testEmptyStroke();
+    void testMutatedJobsFromWorker();
     void testLazyWaitCondition();
     void testBlockUpdates();
 
@@ -675,6 +675,38 @@ KisRegion KisTiledDataManager::region() const
     return KisRegion(std::move(rects));
 }
 
+KisRegion KisTiledDataManager::changedRegion(const KisTiledDataManager *baseline) const
+{
+    QVector<QRect> rects;
+
+    {
+        KisTileHashTableConstIterator iter(m_hashTable);
+        KisTileSP tile;
+
+        while ((tile = iter.tile())) {
+            KisTileSP baseTile = baseline->m_hashTable->getExistingTile(tile->col(), tile->row());
+            if (!baseTile || baseTile->tileData() != tile->tileData()) {
+                rects << tile->extent();
+            }
+            iter.next();
+        }
+    }
+
+    {
+        KisTileHashTableConstIterator iter(baseline->m_hashTable);
+        KisTileSP tile;
+
+        while ((tile = iter.tile())) {
+            if (!m_hashTable->tileExists(tile->col(), tile->row())) {
+                rects << tile->extent();
+            }
+            iter.next();
+        }
+    }
+
+    return KisRegion(std::move(rects));
+}
+
 void KisTiledDataManager::setPixel(qint32 x, qint32 y, const quint8 * data)
 {
     KisTileDataWrapper tw(this, x, y, KisTileDataWrapper::WRITE);
@@ -216,6 +216,17 @@ public:
 
     KisRegion region() const;
 
+    /**
+     * Returns the region of the tiles that have been changed in
+     * comparison to \p baseline. The baseline is supposed to be a
+     * copy-on-write clone of this data manager made earlier. Since
+     * any write into a shared tile detaches its tile data, comparing
+     * tile data pointers is enough to find the written tiles without
+     * touching the pixels. Tiles that exist only in one of the two
+     * managers are also considered changed.
+     */
+    KisRegion changedRegion(const KisTiledDataManager *baseline) const;
+
     void clear(QRect clearRect, quint8 clearValue);
     void clear(QRect clearRect, const quint8 *clearPixel);
     void clear(qint32 x, qint32 y, qint32 w, qint32 h, quint8 clearValue);
@@ -339,6 +339,44 @@ void KisTiledDataManagerTest::testBitBltRough()
     delete[] buffer;
 }
 
+void KisTiledDataManagerTest::testChangedRegion()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm(1, &defaultPixel);
+
+    quint8 oddPixel1 = 128;
+    quint8 oddPixel2 = 129;
+
+    QRect rect(0,0,512,512);
+    dm.clear(rect, &oddPixel1);
+
+    KisTiledDataManager baseline(dm);
+    QVERIFY(dm.changedRegion(&baseline).isEmpty());
+
+    // reading doesn't detach the tiles
+    quint8 *buffer = new quint8[rect.width()*rect.height()];
+    dm.readBytes(buffer, rect.x(), rect.y(), rect.width(), rect.height());
+    QVERIFY(dm.changedRegion(&baseline).isEmpty());
+    delete[] buffer;
+
+    // writing detaches only the touched tiles
+    dm.clear(QRect(70,70,10,10), &oddPixel2);
+    QCOMPARE(dm.changedRegion(&baseline), KisRegion(QRect(64,64,64,64)));
+
+    // new tiles are reported as well
+    dm.setPixel(600, 10, &oddPixel2);
+    QCOMPARE(dm.changedRegion(&baseline).boundingRect(), QRect(64,0,576,128));
+    QCOMPARE(dm.changedRegion(&baseline).rectCount(), 2);
+
+    // ...as well as the tiles that exist only in the baseline
+    KisTiledDataManager newBaseline(dm);
+    dm.clear();
+    QCOMPARE(dm.changedRegion(&newBaseline).boundingRect(), QRect(0,0,640,512));
+
+    // the baseline itself stays untouched
+    QCOMPARE(baseline.extent(), rect);
+}
+
 void KisTiledDataManagerTest::testTransactions()
 {
     quint8 defaultPixel = 0;
@@ -37,6 +37,7 @@ private Q_SLOTS:
     void testVersionedBitBlt();
     void testBitBltOldData();
     void testBitBltRough();
+    void testChangedRegion();
     void testTransactions();
     void testPurgeHistory();
     void testUndoSetDefaultPixel();
@@ -66,6 +66,20 @@ inline static void fillGrayBrushWithColorPreserveLightnessRGB(quint8 *pixels, co
         }
 }
 
+/**
+ * Same as fillGrayBrushWithColorPreserveLightnessRGB(), but every pixel
+ * is filled with its own color, so a run of pixels with different colors
+ * can be processed in one call
+ */
+template<typename CSTraits>
+inline static void fillGrayBrushWithPixelColorPreserveLightnessRGB(quint8 *pixels, const QRgb *brush, qreal strength, qint32 nPixels) {
+    static const quint32 pixelSize = CSTraits::pixelSize;
+
+    for (; nPixels > 0; --nPixels, pixels += pixelSize, ++brush) {
+        fillGrayBrushWithColorPreserveLightnessRGB<CSTraits>(pixels, brush, pixels, strength, 1);
+    }
+}
+
 template<typename CSTraits>
 inline static void modulateLightnessByGrayBrushRGB(quint8 *pixels, const QRgb *brush, qreal strength, qint32 nPixels) {
     using RGBPixel = typename CSTraits::Pixel;
@@ -0,0 +1,292 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KoLut3DColorTransformation.h"
+
+#include <limits>
+#include <memory>
+
+#include <QVector>
+
+#include "KoColorSpace.h"
+#include "KoChannelInfo.h"
+#include "KoColorModelStandardIds.h"
+
+#include <kis_assert.h>
+
+
+namespace {
+
+/**
+ * The values of the grid nodes, always stored as 16-bit. The fourth
+ * value is just padding, so that a node can be processed as a vector.
+ */
+struct Node {
+    quint16 values[4];
+};
+
+/**
+ * 8-bit channels are sampled every 5 levels, so that all the nodes lie
+ * exactly on the representable values (255 == 51 * 5)
+ */
+const int gridSize8 = 52;
+const int gridSize16 = 65;
+
+}
+
+struct KoLut3DColorTransformation::Private
+{
+    QScopedPointer<KoColorTransformation> transformation;
+
+    bool is16Bit = false;
+    int gridSize = 0;
+
+    /// the positions of the channels in the pixel, in units of the channel type
+    int colorPos[3];
+    int alphaPos = 0;
+
+    /// the node (i0, i1, i2) is stored at i0 * strides[0] + i1 * strides[1] + i2
+    int strides[3];
+
+    /**
+     * transform() may be called from several threads while setParameter()
+     * bakes the LUT again, so the nodes are never modified in place: a new
+     * table is baked and swapped in atomically, and every transform() call
+     * keeps a reference to the table it has started with
+     */
+    std::shared_ptr<const QVector<Node>> nodes;
+
+    void bake();
+
+    template <typename T>
+    void bakeImpl();
+
+    template <typename T>
+    void transformImpl(const quint8 *srcU8, quint8 *dstU8, qint32 nPixels) const;
+};
+
+void KoLut3DColorTransformation::Private::bake()
+{
+    if (is16Bit) {
+        bakeImpl<quint16>();
+    } else {
+        bakeImpl<quint8>();
+    }
+}
+
+template <typename T>
+void KoLut3DColorTransformation::Private::bakeImpl()
+{
+    const int numNodes = gridSize * gridSize * gridSize;
+    const qreal maxValue = std::numeric_limits<T>::max();
+    const int scaleTo16Bit = 0xffff / std::numeric_limits<T>::max();
+
+    QVector<T> src(4 * numNodes);
+    QVector<T> dst(4 * numNodes);
+
+    QVector<T> gridValues(gridSize);
+    for (int i = 0; i < gridSize; i++) {
+        gridValues[i] = qRound(i * maxValue / (gridSize - 1));
+    }
+
+    T *pixel = src.data();
+
+    for (int i0 = 0; i0 < gridSize; i0++) {
+        for (int i1 = 0; i1 < gridSize; i1++) {
+            for (int i2 = 0; i2 < gridSize; i2++) {
+                pixel[colorPos[0]] = gridValues[i0];
+                pixel[colorPos[1]] = gridValues[i1];
+                pixel[colorPos[2]] = gridValues[i2];
+                pixel[alphaPos] = std::numeric_limits<T>::max();
+                pixel += 4;
+            }
+        }
+    }
+
+    transformation->transform(reinterpret_cast<const quint8*>(src.constData()),
+                              reinterpret_cast<quint8*>(dst.data()), numNodes);
+
+    std::shared_ptr<QVector<Node>> newNodes = std::make_shared<QVector<Node>>(numNodes);
+    Node *node = newNodes->data();
+
+    for (int i = 0; i < numNodes; i++) {
+        const T *result = dst.constData() + 4 * i;
+
+        for (int channel = 0; channel < 3; channel++) {
+            node[i].values[channel] = result[colorPos[channel]] * scaleTo16Bit;
+        }
+        node[i].values[3] = 0;
+    }
+
+    std::atomic_store(&nodes, std::shared_ptr<const QVector<Node>>(newNodes));
+}
+
+template <typename T>
+void KoLut3DColorTransformation::Private::transformImpl(const quint8 *srcU8, quint8 *dstU8, qint32 nPixels) const
+{
+    const T *src = reinterpret_cast<const T*>(srcU8);
+    T *dst = reinterpret_cast<T*>(dstU8);
+
+    const int maxValue = std::numeric_limits<T>::max();
+    const float toGrid = float(gridSize - 1) / maxValue;
+    const float fromNode = float(maxValue) / 0xffff;
+    const int maxCell = gridSize - 2;
+
+    const std::shared_ptr<const QVector<Node>> currentNodes = std::atomic_load(&nodes);
+    const Node *lut = currentNodes->constData();
+    const int cornerOffset = strides[0] + strides[1] + strides[2];
+
+    for (qint32 i = 0; i < nPixels; i++) {
+        int cell[3];
+        float fraction[3];
+
+        for (int axis = 0; axis < 3; axis++) {
+            const float x = src[colorPos[axis]] * toGrid;
+            cell[axis] = qMin(int(x), maxCell);
+            fraction[axis] = x - cell[axis];
+        }
+
+        /**
+         * Tetrahedral interpolation: the cube of the grid is split into six
+         * tetrahedra along its main diagonal, the one containing the color
+         * is defined by the order of the fractions. Its vertices are the
+         * first corner, the two corners reached by stepping along the axes
+         * with the largest fractions, and the opposite corner.
+         */
+        int first;
+        int second;
+        int third;
+
+        if (fraction[0] >= fraction[1]) {
+            if (fraction[1] >= fraction[2]) {
+                first = 0; second = 1; third = 2;
+            } else if (fraction[0] >= fraction[2]) {
+                first = 0; second = 2; third = 1;
+            } else {
+                first = 2; second = 0; third = 1;
+            }
+        } else {
+            if (fraction[2] >= fraction[1]) {
+                first = 2; second = 1; third = 0;
+            } else if (fraction[2] >= fraction[0]) {
+                first = 1; second = 2; third = 0;
+            } else {
+                first = 1; second = 0; third = 2;
+            }
+        }
+
+        const Node &c0 = lut[cell[0] * strides[0] + cell[1] * strides[1] + cell[2]];
+        const Node &c1 = (&c0)[strides[first]];
+        const Node &c2 = (&c0)[strides[first] + strides[second]];
+        const Node &c3 = (&c0)[cornerOffset];
+
+        const float w0 = 1.0f - fraction[first];
+        const float w1 = fraction[first] - fraction[second];
+        const float w2 = fraction[second] - fraction[third];
+        const float w3 = fraction[third];
+
+        float result[4];
+        for (int channel = 0; channel < 4; channel++) {
+            result[channel] = (w0 * c0.values[channel] + w1 * c1.values[channel] +
+                               w2 * c2.values[channel] + w3 * c3.values[channel]) * fromNode;
+        }
+
+        const T alpha = src[alphaPos];
+
+        for (int channel = 0; channel < 3; channel++) {
+            dst[colorPos[channel]] = qBound(0, qRound(result[channel]), maxValue);
+        }
+        dst[alphaPos] = alpha;
+
+        src += 4;
+        dst += 4;
+    }
+}
+
+KoLut3DColorTransformation::KoLut3DColorTransformation(const KoColorSpace *cs, KoColorTransformation *transformation)
+    : m_d(new Private)
+{
+    m_d->transformation.reset(transformation);
+    m_d->is16Bit = cs->colorDepthId() == Integer16BitsColorDepthID;
+    m_d->gridSize = m_d->is16Bit ? gridSize16 : gridSize8;
+
+    m_d->strides[0] = m_d->gridSize * m_d->gridSize;
+    m_d->strides[1] = m_d->gridSize;
+    m_d->strides[2] = 1;
+
+    const int channelSize = m_d->is16Bit ? 2 : 1;
+    int numColorChannels = 0;
+
+    Q_FOREACH (const KoChannelInfo *channel, cs->channels()) {
+        if (channel->channelType() == KoChannelInfo::ALPHA) {
+            m_d->alphaPos = channel->pos() / channelSize;
+        } else if (numColorChannels < 3) {
+            m_d->colorPos[numColorChannels++] = channel->pos() / channelSize;
+        }
+    }
+
+    KIS_SAFE_ASSERT_RECOVER_NOOP(numColorChannels == 3);
+
+    m_d->bake();
+}
+
+KoLut3DColorTransformation::~KoLut3DColorTransformation()
+{
+}
+
+bool KoLut3DColorTransformation::isSupported(const KoColorSpace *cs)
+{
+    if (cs->colorModelId() != RGBAColorModelID) return false;
+
+    const KoID depth = cs->colorDepthId();
+    const int channelSize =
+        depth == Integer8BitsColorDepthID ? 1 :
+        depth == Integer16BitsColorDepthID ? 2 : 0;
+
+    return channelSize &&
+        cs->channelCount() == 4 &&
+        cs->colorChannelCount() == 3 &&
+        cs->pixelSize() == quint32(4 * channelSize);
+}
+
+KoColorTransformation* KoLut3DColorTransformation::bake(const KoColorSpace *cs, KoColorTransformation *transformation)
+{
+    if (!transformation || !isSupported(cs)) {
+        return transformation;
+    }
+
+    return new KoLut3DColorTransformation(cs, transformation);
+}
+
+int KoLut3DColorTransformation::gridSize() const
+{
+    return m_d->gridSize;
+}
+
+void KoLut3DColorTransformation::transform(const quint8 *src, quint8 *dst, qint32 nPixels) const
+{
+    if (m_d->is16Bit) {
+        m_d->transformImpl<quint16>(src, dst, nPixels);
+    } else {
+        m_d->transformImpl<quint8>(src, dst, nPixels);
+    }
+}
+
+QList<QString> KoLut3DColorTransformation::parameters() const
+{
+    return m_d->transformation->parameters();
+}
+
+int KoLut3DColorTransformation::parameterId(const QString& name) const
+{
+    return m_d->transformation->parameterId(name);
+}
+
+void KoLut3DColorTransformation::setParameter(int id, const QVariant& parameter)
+{
+    m_d->transformation->setParameter(id, parameter);
+    m_d->bake();
+}
@@ -0,0 +1,81 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KO_LUT3D_COLOR_TRANSFORMATION_H
+#define KO_LUT3D_COLOR_TRANSFORMATION_H
+
+#include "KoColorTransformation.h"
+
+#include <QScopedPointer>
+
+#include "kritapigment_export.h"
+
+class KoColorSpace;
+
+/**
+ * A color transformation that samples another (expensive) transformation
+ * on a regular grid of colors once and then evaluates it for the pixels
+ * with tetrahedral interpolation of the grid nodes. Every pixel costs
+ * a few multiplications, whatever math the original transformation does.
+ *
+ * Only the integer RGBA color spaces are supported, and the baked
+ * transformation must not depend on the alpha channel: the grid is
+ * sampled with opaque colors and the alpha of the pixels is kept
+ * untouched.
+ *
+ * The result is exact for the colors lying on the grid nodes and for
+ * transformations which are linear between the nodes, for other colors
+ * it is an approximation, so baking is an option for the cases where
+ * speed matters more than the last bit of precision (e.g. filter masks
+ * updated while painting).
+ */
+class KRITAPIGMENT_EXPORT KoLut3DColorTransformation : public KoColorTransformation
+{
+public:
+    ~KoLut3DColorTransformation() override;
+
+    /**
+     * \return true if the transformations for \p cs can be baked
+     */
+    static bool isSupported(const KoColorSpace *cs);
+
+    /**
+     * Bakes \p transformation, which should work on the pixels of \p cs,
+     * into a LUT. The LUT takes ownership of \p transformation.
+     *
+     * \return the baked transformation, or \p transformation itself if
+     *         \p cs is not supported or \p transformation is null
+     */
+    static KoColorTransformation* bake(const KoColorSpace *cs, KoColorTransformation *transformation);
+
+    /**
+     * \return the number of grid nodes along every axis of the LUT
+     */
+    int gridSize() const;
+
+    void transform(const quint8 *src, quint8 *dst, qint32 nPixels) const override;
+
+    /**
+     * The parameters are forwarded to the original transformation,
+     * every setParameter() call bakes the LUT again right away, so
+     * set the parameters before baking whenever possible.
+     *
+     * The new LUT replaces the old one atomically, so transform() may
+     * run in other threads meanwhile, but setParameter() itself must
+     * not be called from several threads at once.
+     */
+    QList<QString> parameters() const override;
+    int parameterId(const QString& name) const override;
+    void setParameter(int id, const QVariant& parameter) override;
+
+private:
+    KoLut3DColorTransformation(const KoColorSpace *cs, KoColorTransformation *transformation);
+
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KO_LUT3D_COLOR_TRANSFORMATION_H
@@ -99,6 +99,11 @@ void KoRgbU16ColorSpace::fillGrayBrushWithColorAndLightnessWithStrength(quint8*
     fillGrayBrushWithColorPreserveLightnessRGB<KoBgrU16Traits>(dst, brush, brushColor, strength, nPixels);
 }
 
+void KoRgbU16ColorSpace::fillGrayBrushWithPixelColorAndLightnessWithStrength(quint8* dst, const QRgb* brush, qreal strength, qint32 nPixels) const
+{
+    fillGrayBrushWithPixelColorPreserveLightnessRGB<KoBgrU16Traits>(dst, brush, strength, nPixels);
+}
+
 void KoRgbU16ColorSpace::modulateLightnessByGrayBrush(quint8 *dst, const QRgb *brush, qreal strength, qint32 nPixels) const
 {
     modulateLightnessByGrayBrushRGB<KoBgrU16Traits>(dst, brush, strength, nPixels);
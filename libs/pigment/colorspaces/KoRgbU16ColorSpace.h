@@ -42,6 +42,7 @@ public:
 
     void fillGrayBrushWithColorAndLightnessOverlay(quint8 *dst, const QRgb *brush, quint8 *brushColor, qint32 nPixels) const override;
     void fillGrayBrushWithColorAndLightnessWithStrength(quint8* dst, const QRgb* brush, quint8* brushColor, qreal strength, qint32 nPixels) const override;
+    void fillGrayBrushWithPixelColorAndLightnessWithStrength(quint8* dst, const QRgb* brush, qreal strength, qint32 nPixels) const override;
     void modulateLightnessByGrayBrush(quint8 *dst, const QRgb *brush, qreal strength, qint32 nPixels) const override;
 
 };
@@ -110,6 +110,11 @@ void KoRgbU8ColorSpace::fillGrayBrushWithColorAndLightnessWithStrength(quint8* d
     fillGrayBrushWithColorPreserveLightnessRGB<KoBgrU8Traits>(dst, brush, brushColor, strength, nPixels);
 }
 
+void KoRgbU8ColorSpace::fillGrayBrushWithPixelColorAndLightnessWithStrength(quint8* dst, const QRgb* brush, qreal strength, qint32 nPixels) const
+{
+    fillGrayBrushWithPixelColorPreserveLightnessRGB<KoBgrU8Traits>(dst, brush, strength, nPixels);
+}
+
 void KoRgbU8ColorSpace::modulateLightnessByGrayBrush(quint8 *dst, const QRgb *brush, qreal strength, qint32 nPixels) const
 {
    modulateLightnessByGrayBrushRGB<KoBgrU8Traits>(dst, brush, strength, nPixels);
@@ -402,6 +402,7 @@ void TestKoColorSpaceAbstract::testMixColorsOpU8NoAlphaLinear()
 #include <QByteArray>
 #include <KoColor.h>
 #include <KoCompositeOpRegistry.h>
+#include <KoColorModelStandardIds.h>
 
 KoColor makeColor(std::initializer_list<quint8> data, const KoColorSpace *cs)
 {
@@ -598,5 +599,51 @@ void TestKoColorSpaceAbstract::testBitBltCrossColorSpaceWithChannelFlags()
     }
 }
 
+void TestKoColorSpaceAbstract::testFillGrayBrushWithPixelColor_data()
+{
+    QTest::addColumn<QString>("colorModelId");
+    QTest::addColumn<QString>("colorDepthId");
+
+    QTest::newRow("rgb8") << RGBAColorModelID.id() << Integer8BitsColorDepthID.id();
+    QTest::newRow("rgb16") << RGBAColorModelID.id() << Integer16BitsColorDepthID.id();
+
+    // uses the fallback implementation of KoColorSpace
+    QTest::newRow("lab16") << LABAColorModelID.id() << Integer16BitsColorDepthID.id();
+}
+
+void TestKoColorSpaceAbstract::testFillGrayBrushWithPixelColor()
+{
+    QFETCH(QString, colorModelId);
+    QFETCH(QString, colorDepthId);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace(colorModelId, colorDepthId, QString());
+    QVERIFY(cs);
+
+    const int numPixels = 1000;
+    const qreal strength = 0.7;
+
+    QByteArray pixels(numPixels * cs->pixelSize(), Qt::Uninitialized);
+    QVector<QRgb> brush(numPixels);
+
+    quint32 seed = 1;
+    for (int i = 0; i < pixels.size(); i++) {
+        seed = seed * 1664525u + 1013904223u;
+        pixels[i] = char(seed >> 24);
+    }
+    for (int i = 0; i < numPixels; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        brush[i] = qRgba(seed >> 24, seed >> 24, seed >> 24, (seed >> 16) & 0xff);
+    }
+
+    QByteArray expected = pixels;
+    for (int i = 0; i < numPixels; i++) {
+        quint8 *pixel = reinterpret_cast<quint8*>(expected.data()) + i * cs->pixelSize();
+        cs->fillGrayBrushWithColorAndLightnessWithStrength(pixel, brush.constData() + i, pixel, strength, 1);
+    }
+
+    cs->fillGrayBrushWithPixelColorAndLightnessWithStrength(reinterpret_cast<quint8*>(pixels.data()), brush.constData(), strength, numPixels);
+
+    QCOMPARE(pixels, expected);
+}
 
 SIMPLE_TEST_MAIN(TestKoColorSpaceAbstract)
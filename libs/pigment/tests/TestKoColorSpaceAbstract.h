@@ -17,6 +17,8 @@ private Q_SLOTS:
     void testMixColorsOpU8NoAlphaLinear();
     void testBitBltCrossColorSpaceWithChannelFlags_data();
     void testBitBltCrossColorSpaceWithChannelFlags();
+    void testFillGrayBrushWithPixelColor_data();
+    void testFillGrayBrushWithPixelColor();
 
 };
 
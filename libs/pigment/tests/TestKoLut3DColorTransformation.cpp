@@ -0,0 +1,259 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "TestKoLut3DColorTransformation.h"
+
+#include <simpletest.h>
+#include <kistest.h>
+
+#include <cmath>
+#include <limits>
+
+#include "KoColorSpace.h"
+#include "KoColorSpaceRegistry.h"
+#include "KoColorModelStandardIds.h"
+#include "KoLut3DColorTransformation.h"
+
+namespace {
+
+/**
+ * Swaps the first two channels and inverts the third one, so
+ * the result is linear and the interpolation should be exact
+ */
+template <typename T>
+class LinearTransformation : public KoColorTransformation
+{
+public:
+    void transform(const quint8 *srcU8, quint8 *dstU8, qint32 nPixels) const override {
+        const T *src = reinterpret_cast<const T*>(srcU8);
+        T *dst = reinterpret_cast<T*>(dstU8);
+
+        for (qint32 i = 0; i < nPixels; i++) {
+            const T c0 = src[0];
+            const T c1 = src[1];
+            const T c2 = src[2];
+
+            dst[0] = c1;
+            dst[1] = c0;
+            dst[2] = std::numeric_limits<T>::max() - c2;
+            dst[3] = src[3];
+
+            src += 4;
+            dst += 4;
+        }
+    }
+};
+
+/**
+ * Applies a gamma curve to every channel
+ */
+template <typename T>
+class GammaTransformation : public KoColorTransformation
+{
+public:
+    void transform(const quint8 *srcU8, quint8 *dstU8, qint32 nPixels) const override {
+        const T *src = reinterpret_cast<const T*>(srcU8);
+        T *dst = reinterpret_cast<T*>(dstU8);
+        const qreal maxValue = std::numeric_limits<T>::max();
+
+        for (qint32 i = 0; i < nPixels; i++) {
+            for (int channel = 0; channel < 3; channel++) {
+                dst[channel] = qRound(std::pow(src[channel] / maxValue, 2.2) * maxValue);
+            }
+            dst[3] = src[3];
+
+            src += 4;
+            dst += 4;
+        }
+    }
+};
+
+/**
+ * Adds an offset to every channel, the offset is set as a parameter
+ */
+template <typename T>
+class OffsetTransformation : public KoColorTransformation
+{
+public:
+    void transform(const quint8 *srcU8, quint8 *dstU8, qint32 nPixels) const override {
+        const T *src = reinterpret_cast<const T*>(srcU8);
+        T *dst = reinterpret_cast<T*>(dstU8);
+        const int maxValue = std::numeric_limits<T>::max();
+
+        for (qint32 i = 0; i < nPixels; i++) {
+            for (int channel = 0; channel < 3; channel++) {
+                dst[channel] = qBound(0, src[channel] + m_offset, maxValue);
+            }
+            dst[3] = src[3];
+
+            src += 4;
+            dst += 4;
+        }
+    }
+
+    QList<QString> parameters() const override {
+        return {"offset"};
+    }
+
+    int parameterId(const QString& name) const override {
+        return name == "offset" ? 0 : -1;
+    }
+
+    void setParameter(int id, const QVariant& parameter) override {
+        if (id == 0) {
+            m_offset = parameter.toInt();
+        }
+    }
+
+private:
+    int m_offset = 0;
+};
+
+template <typename T>
+QVector<T> randomPixels(int numPixels)
+{
+    QVector<T> pixels(4 * numPixels);
+
+    quint32 seed = 1;
+    for (int i = 0; i < pixels.size(); i++) {
+        seed = seed * 1664525u + 1013904223u;
+        pixels[i] = T(seed >> 16);
+    }
+
+    return pixels;
+}
+
+template <typename T>
+int maxDifference(KoColorTransformation *reference, KoColorTransformation *lut)
+{
+    const int numPixels = 10000;
+    const QVector<T> src = randomPixels<T>(numPixels);
+    QVector<T> expected(src.size());
+    QVector<T> result(src.size());
+
+    reference->transform(reinterpret_cast<const quint8*>(src.constData()),
+                         reinterpret_cast<quint8*>(expected.data()), numPixels);
+    lut->transform(reinterpret_cast<const quint8*>(src.constData()),
+                   reinterpret_cast<quint8*>(result.data()), numPixels);
+
+    int difference = 0;
+    for (int i = 0; i < src.size(); i++) {
+        difference = qMax(difference, qAbs(int(expected[i]) - int(result[i])));
+    }
+
+    return difference;
+}
+
+template <template <typename> class Transformation>
+int testColorSpace(const KoColorSpace *cs)
+{
+    if (cs->colorDepthId() == Integer16BitsColorDepthID) {
+        Transformation<quint16> reference;
+        QScopedPointer<KoColorTransformation> lut(
+            KoLut3DColorTransformation::bake(cs, new Transformation<quint16>()));
+        return maxDifference<quint16>(&reference, lut.data());
+    } else {
+        Transformation<quint8> reference;
+        QScopedPointer<KoColorTransformation> lut(
+            KoLut3DColorTransformation::bake(cs, new Transformation<quint8>()));
+        return maxDifference<quint8>(&reference, lut.data());
+    }
+}
+
+}
+
+void TestKoLut3DColorTransformation::testLinear_data()
+{
+    QTest::addColumn<bool>("is16Bit");
+    QTest::addColumn<int>("tolerance");
+
+    QTest::newRow("rgb8") << false << 0;
+    QTest::newRow("rgb16") << true << 1;
+}
+
+void TestKoLut3DColorTransformation::testLinear()
+{
+    QFETCH(bool, is16Bit);
+    QFETCH(int, tolerance);
+
+    const KoColorSpace *cs = is16Bit ?
+        KoColorSpaceRegistry::instance()->rgb16() :
+        KoColorSpaceRegistry::instance()->rgb8();
+
+    QVERIFY(KoLut3DColorTransformation::isSupported(cs));
+    QVERIFY(testColorSpace<LinearTransformation>(cs) <= tolerance);
+}
+
+void TestKoLut3DColorTransformation::testNonLinear_data()
+{
+    QTest::addColumn<bool>("is16Bit");
+    QTest::addColumn<int>("tolerance");
+
+    QTest::newRow("rgb8") << false << 1;
+    QTest::newRow("rgb16") << true << 256;
+}
+
+void TestKoLut3DColorTransformation::testNonLinear()
+{
+    QFETCH(bool, is16Bit);
+    QFETCH(int, tolerance);
+
+    const KoColorSpace *cs = is16Bit ?
+        KoColorSpaceRegistry::instance()->rgb16() :
+        KoColorSpaceRegistry::instance()->rgb8();
+
+    QVERIFY(testColorSpace<GammaTransformation>(cs) <= tolerance);
+}
+
+void TestKoLut3DColorTransformation::testInPlace()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    QScopedPointer<KoColorTransformation> lut(
+        KoLut3DColorTransformation::bake(cs, new GammaTransformation<quint8>()));
+
+    const int numPixels = 1000;
+    const QVector<quint8> src = randomPixels<quint8>(numPixels);
+    QVector<quint8> expected(src.size());
+    QVector<quint8> inPlace = src;
+
+    lut->transform(src.constData(), expected.data(), numPixels);
+    lut->transform(inPlace.constData(), inPlace.data(), numPixels);
+
+    QCOMPARE(inPlace, expected);
+}
+
+void TestKoLut3DColorTransformation::testSetParameter()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    QScopedPointer<KoColorTransformation> lut(
+        KoLut3DColorTransformation::bake(cs, new OffsetTransformation<quint8>()));
+
+    OffsetTransformation<quint8> reference;
+    QCOMPARE(maxDifference<quint8>(&reference, lut.data()), 0);
+
+    const int id = lut->parameterId("offset");
+    QCOMPARE(id, 0);
+
+    // the offset is a multiple of the grid step, so the LUT stays exact
+    lut->setParameter(id, 50);
+    reference.setParameter(id, 50);
+
+    QCOMPARE(maxDifference<quint8>(&reference, lut.data()), 0);
+}
+
+void TestKoLut3DColorTransformation::testUnsupportedColorSpace()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->lab16();
+    QVERIFY(!KoLut3DColorTransformation::isSupported(cs));
+
+    KoColorTransformation *transformation = new LinearTransformation<quint16>();
+    QScopedPointer<KoColorTransformation> result(KoLut3DColorTransformation::bake(cs, transformation));
+    QCOMPARE(result.data(), transformation);
+
+    QVERIFY(!KoLut3DColorTransformation::bake(cs, nullptr));
+}
+
+KISTEST_MAIN(TestKoLut3DColorTransformation)
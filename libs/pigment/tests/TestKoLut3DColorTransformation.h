@@ -0,0 +1,25 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef TESTKOLUT3DCOLORTRANSFORMATION_H
+#define TESTKOLUT3DCOLORTRANSFORMATION_H
+
+#include <QObject>
+
+class TestKoLut3DColorTransformation : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testLinear_data();
+    void testLinear();
+    void testNonLinear_data();
+    void testNonLinear();
+    void testInPlace();
+    void testSetParameter();
+    void testUnsupportedColorSpace();
+};
+
+#endif // TESTKOLUT3DCOLORTRANSFORMATION_H
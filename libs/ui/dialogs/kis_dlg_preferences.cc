@@ -81,6 +81,7 @@
 #include "kis_config.h"
 #include "kis_cursor.h"
 #include "kis_image_config.h"
+#include "kis_update_time_monitor.h"
 #include "kis_preference_set_registry.h"
 #include "KisMainWindow.h"
 #include "KisMimeDatabase.h"
@@ -1631,7 +1632,10 @@ void PerformanceTab::load(bool requestDefault)
     sliderUndoLimit->setValue(cfg.memorySoftLimitPercent(requestDefault));
 
     chkPerformanceLogging->setChecked(cfg.enablePerfLog(requestDefault));
+    chkPerformanceTracing->setChecked(cfg.enablePerfTrace(requestDefault));
     chkProgressReporting->setChecked(cfg.enableProgressReporting(requestDefault));
+    chkBakeColorAdjustmentsToLut->setChecked(cfg.bakeColorAdjustmentsToLut(requestDefault));
+    chkSkipSaturatedDabs->setChecked(cfg.skipSaturatedDabs(requestDefault));
 
     sliderSwapSize->setValue(cfg.maxSwapSize(requestDefault) / 1024);
     swapFileLocation->setFileName(cfg.swapDir(requestDefault));
@@ -1696,7 +1700,14 @@ void PerformanceTab::save()
     cfg.setMemoryPoolLimitPercent(sliderPoolLimit->value());
 
     cfg.setEnablePerfLog(chkPerformanceLogging->isChecked());
+
+    if (cfg.enablePerfTrace() != chkPerformanceTracing->isChecked()) {
+        cfg.setEnablePerfTrace(chkPerformanceTracing->isChecked());
+        KisUpdateTimeMonitor::instance()->setTracingEnabled(chkPerformanceTracing->isChecked());
+    }
     cfg.setEnableProgressReporting(chkProgressReporting->isChecked());
+    cfg.setBakeColorAdjustmentsToLut(chkBakeColorAdjustmentsToLut->isChecked());
+    cfg.setSkipSaturatedDabs(chkSkipSaturatedDabs->isChecked());
 
     cfg.setMaxSwapSize(sliderSwapSize->value() * 1024);
 
@@ -32,6 +32,7 @@
 #include <QVector3D>
 #include "kis_painting_tweaks.h"
 #include "KisOpenGLBufferCreationGuard.h"
+#include <KisPerformanceTracer.h>
 
 /// we use Angle's EGL on Windows, so we need access to
 /// EGL_ANGLE_platform_angle definition
@@ -327,6 +328,8 @@ KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCacheNoConversion(const QRec
 KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCacheImpl(const QRect& rect, KisImageSP srcImage, bool convertColorSpace)
 {
     if (!m_initialized) return new KisOpenGLUpdateInfo();
+
+    KIS_TRACE_SCOPE("canvas", "buildTextureUpdate");
     return m_updateInfoBuilder.buildUpdateInfo(rect, srcImage, convertColorSpace);
 }
 
@@ -340,6 +343,11 @@ void KisOpenGLImageTextures::recalculateCache(KisUpdateInfoSP info, bool blockMi
     KisOpenGLUpdateInfoSP glInfo = dynamic_cast<KisOpenGLUpdateInfo*>(info.data());
     if(!glInfo) return;
 
+    KisPerformanceTracer::Scope traceScope("canvas", "uploadTextures");
+    if (traceScope.isActive()) {
+        traceScope.setDetail(QString("%1 tiles").arg(glInfo->tileList.size()));
+    }
+
     QScopedPointer<KisOpenGLSync> sync;
     int numProcessedTiles = 0;
 
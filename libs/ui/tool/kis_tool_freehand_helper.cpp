@@ -245,6 +245,7 @@ void KisToolFreehandHelper::initPaint(KoPointerEvent *event,
     m_d->strokeTime.start();
     KisPaintInformation pi =
         m_d->infoBuilder->startStroke(event, elapsedStrokeTime(), m_d->resourceManager);
+    KisUpdateTimeMonitor::instance()->startStrokeInput(pi);
     qreal startAngle = KisAlgebra2D::directionBetweenPoints(prevPoint, pixelCoords, 0.0);
 
     initPaintImpl(startAngle,
@@ -452,6 +453,7 @@ void KisToolFreehandHelper::paintEvent(KoPointerEvent *event)
             m_d->infoBuilder->continueStroke(event,
                                              elapsedStrokeTime());
     KisUpdateTimeMonitor::instance()->reportMouseMove(info.pos());
+    KisUpdateTimeMonitor::instance()->reportStrokeInput(info);
 
     paint(info);
 }
@@ -702,6 +704,8 @@ void KisToolFreehandHelper::endPaint()
     m_d->strokesFacade->endStroke(m_d->strokeId);
     m_d->strokeId.clear();
     m_d->infoBuilder->reset();
+
+    KisUpdateTimeMonitor::instance()->endStrokeInput();
 }
 
 void KisToolFreehandHelper::cancelPaint()
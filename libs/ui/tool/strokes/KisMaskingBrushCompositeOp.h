@@ -734,24 +734,52 @@ public:
                    quint8 *dstRowStart, int dstRowStride,
                    int columns, int rows) override
     {
+        /**
+         * When the pixel size is known at compile time, the compiler can
+         * vectorize the loop (the alpha channel is read with a constant
+         * stride), so we instantiate the most common pixel sizes
+         * explicitly: RGBA/GrayA in 8 and 16 bits and RGBA in 32 bit
+         * floats.
+         */
+        switch (m_dstPixelSize) {
+        case 2:
+            compositeImpl<2>(srcRowStart, srcRowStride, dstRowStart, dstRowStride, columns, rows);
+            break;
+        case 4:
+            compositeImpl<4>(srcRowStart, srcRowStride, dstRowStart, dstRowStride, columns, rows);
+            break;
+        case 8:
+            compositeImpl<8>(srcRowStart, srcRowStride, dstRowStart, dstRowStride, columns, rows);
+            break;
+        case 16:
+            compositeImpl<16>(srcRowStart, srcRowStride, dstRowStart, dstRowStride, columns, rows);
+            break;
+        default:
+            compositeImpl<0>(srcRowStart, srcRowStride, dstRowStart, dstRowStride, columns, rows);
+            break;
+        }
+    }
+
+private:
+    template <int static_pixel_size>
+    inline void compositeImpl(const quint8 *srcRowStart, int srcRowStride,
+                              quint8 *dstRowStart, int dstRowStride,
+                              int columns, int rows)
+    {
+        const int dstPixelSize = static_pixel_size > 0 ? static_pixel_size : m_dstPixelSize;
+
         dstRowStart += m_dstAlphaOffset;
 
         for (int y = 0; y < rows; y++) {
-            const quint8 *srcPtr = srcRowStart;
+            const MaskPixel *srcPtr = reinterpret_cast<const MaskPixel*>(srcRowStart);
             quint8 *dstPtr = dstRowStart;
 
             for (int x = 0; x < columns; x++) {
-
-                const MaskPixel *srcDataPtr = reinterpret_cast<const MaskPixel*>(srcPtr);
-
-                const quint8 mask = preprocessMask(srcDataPtr);
+                const quint8 mask = preprocessMask(srcPtr + x);
                 const channels_type maskScaled = KoColorSpaceMaths<quint8, channels_type>::scaleToA(mask);
 
-                channels_type *dstDataPtr = reinterpret_cast<channels_type*>(dstPtr);
+                channels_type *dstDataPtr = reinterpret_cast<channels_type*>(dstPtr + x * dstPixelSize);
                 *dstDataPtr = m_compositeFunction.apply(maskScaled, *dstDataPtr);
-
-                srcPtr += sizeof(MaskPixel);
-                dstPtr += m_dstPixelSize;
             }
 
             srcRowStart += srcRowStride;
@@ -759,8 +787,6 @@ public:
         }
     }
 
-
-private:
     inline quint8 preprocessMask(const quint8 *pixel)
     {
         return *pixel;
@@ -6,13 +6,14 @@
 
 #include "KisMaskingBrushRenderer.h"
 
+#include <cstring>
+
 #include <KoColorSpace.h>
 #include <KoColorSpaceRegistry.h>
 #include <KoColorModelStandardIds.h>
 #include <KoChannelInfo.h>
 #include <KoCompositeOpRegistry.h>
 
-#include "kis_painter.h"
 #include "kis_paint_device.h"
 #include "kis_random_accessor_ng.h"
 
@@ -73,38 +74,57 @@ void KisMaskingBrushRenderer::updateProjection(const QRect &rc)
 {
     if (rc.isEmpty()) return;
 
-    KisPainter::copyAreaOptimized(rc.topLeft(), m_strokeDevice, m_dstDevice, rc);
+    /**
+     * Copying of the stroke into the destination device and masking of
+     * its alpha channel are fused into a single pass: every chunk of the
+     * destination (that is, a part of one tile) is filled with the stroke
+     * data and masked right away, while it is still in the CPU cache.
+     */
 
+    KisRandomConstAccessorSP srcIt = m_strokeDevice->createRandomConstAccessorNG();
     KisRandomAccessorSP dstIt = m_dstDevice->createRandomAccessorNG();
     KisRandomConstAccessorSP maskIt = m_maskDevice->createRandomConstAccessorNG();
 
+    const int pixelSize = m_dstDevice->pixelSize();
+
     qint32 dstY = rc.y();
     qint32 rowsRemaining = rc.height();
 
     while (rowsRemaining > 0) {
         qint32 dstX = rc.x();
 
+        const qint32 numContiguousSrcRows = srcIt->numContiguousRows(dstY);
         const qint32 numContiguousDstRows = dstIt->numContiguousRows(dstY);
         const qint32 numContiguousMaskRows = maskIt->numContiguousRows(dstY);
 
-        const qint32 rows = std::min({rowsRemaining, numContiguousDstRows, numContiguousMaskRows});
+        const qint32 rows = std::min({rowsRemaining, numContiguousSrcRows, numContiguousDstRows, numContiguousMaskRows});
 
         qint32 columnsRemaining = rc.width();
 
         while (columnsRemaining > 0) {
 
+            const qint32 numContiguousSrcColumns = srcIt->numContiguousColumns(dstX);
             const qint32 numContiguousDstColumns = dstIt->numContiguousColumns(dstX);
             const qint32 numContiguousMaskColumns = maskIt->numContiguousColumns(dstX);
-            const qint32 columns = std::min({columnsRemaining, numContiguousDstColumns, numContiguousMaskColumns});
+            const qint32 columns = std::min({columnsRemaining, numContiguousSrcColumns, numContiguousDstColumns, numContiguousMaskColumns});
 
+            const qint32 srcRowStride = srcIt->rowStride(dstX, dstY);
             const qint32 dstRowStride = dstIt->rowStride(dstX, dstY);
             const qint32 maskRowStride = maskIt->rowStride(dstX, dstY);
 
+            srcIt->moveTo(dstX, dstY);
             dstIt->moveTo(dstX, dstY);
             maskIt->moveTo(dstX, dstY);
 
+            const quint8 *srcPtr = srcIt->rawDataConst();
+            quint8 *dstPtr = dstIt->rawData();
+
+            for (int y = 0; y < rows; y++) {
+                memcpy(dstPtr + y * dstRowStride, srcPtr + y * srcRowStride, columns * pixelSize);
+            }
+
             m_compositeOp->composite(maskIt->rawDataConst(), maskRowStride,
-                                     dstIt->rawData(), dstRowStride,
+                                     dstPtr, dstRowStride,
                                      columns, rows);
 
             dstX += columns;
@@ -115,4 +135,3 @@ void KisMaskingBrushRenderer::updateProjection(const QRect &rc)
         rowsRemaining -= rows;
     }
 }
-
@@ -82,6 +82,17 @@ qreal KisDitherUtil::threshold(const QPoint &pos)
     return 0.5 - (m_spread / 2.0) + threshold * m_spread;
 }
 
+QSize KisDitherUtil::thresholdPeriod() const
+{
+    if (m_thresholdMode == ThresholdMode::Pattern && m_pattern) {
+        return m_pattern->pattern().size();
+    }
+    else if (m_thresholdMode == ThresholdMode::Noise) {
+        return QSize();
+    }
+    else return QSize(1, 1);
+}
+
 void KisDitherUtil::setConfiguration(const KisFilterConfiguration &config, const QString &prefix)
 {
     setThresholdMode(ThresholdMode(config.getInt(prefix + "thresholdMode")));
@@ -34,6 +34,12 @@ public:
     void setConfiguration(const KisFilterConfiguration &config, const QString &prefix = "");
     qreal threshold(const QPoint &pos);
 
+    /**
+     * \return the size of the tile that the thresholds of the non-negative
+     *         positions repeat with, or an empty size if they do not repeat
+     */
+    QSize thresholdPeriod() const;
+
 private:
 
     void setThresholdMode(const ThresholdMode thresholdMode);
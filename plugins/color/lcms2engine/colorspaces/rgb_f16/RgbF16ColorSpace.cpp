@@ -111,6 +111,11 @@ void RgbF16ColorSpace::fillGrayBrushWithColorAndLightnessWithStrength(quint8* ds
     fillGrayBrushWithColorPreserveLightnessRGB<KoRgbF16Traits>(dst, brush, brushColor, strength, nPixels);
 }
 
+void RgbF16ColorSpace::fillGrayBrushWithPixelColorAndLightnessWithStrength(quint8* dst, const QRgb* brush, qreal strength, qint32 nPixels) const
+{
+    fillGrayBrushWithPixelColorPreserveLightnessRGB<KoRgbF16Traits>(dst, brush, strength, nPixels);
+}
+
 void RgbF16ColorSpace::modulateLightnessByGrayBrush(quint8 *dst, const QRgb *brush, qreal strength, qint32 nPixels) const
 {
    modulateLightnessByGrayBrushRGB<KoRgbF16Traits>(dst, brush, strength, nPixels);
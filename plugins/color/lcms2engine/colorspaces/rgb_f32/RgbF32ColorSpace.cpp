@@ -115,6 +115,11 @@ void RgbF32ColorSpace::fillGrayBrushWithColorAndLightnessWithStrength(quint8* ds
     fillGrayBrushWithColorPreserveLightnessRGB<KoRgbF32Traits>(dst, brush, brushColor, strength, nPixels);
 }
 
+void RgbF32ColorSpace::fillGrayBrushWithPixelColorAndLightnessWithStrength(quint8* dst, const QRgb* brush, qreal strength, qint32 nPixels) const
+{
+    fillGrayBrushWithPixelColorPreserveLightnessRGB<KoRgbF32Traits>(dst, brush, strength, nPixels);
+}
+
 void RgbF32ColorSpace::modulateLightnessByGrayBrush(quint8 *dst, const QRgb *brush, qreal strength, qint32 nPixels) const
 {
     modulateLightnessByGrayBrushRGB<KoRgbF32Traits>(dst, brush, strength, nPixels);
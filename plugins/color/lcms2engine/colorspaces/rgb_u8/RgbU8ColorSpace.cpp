@@ -124,6 +124,11 @@ void RgbU8ColorSpace::fillGrayBrushWithColorAndLightnessWithStrength(quint8* dst
     fillGrayBrushWithColorPreserveLightnessRGB<KoBgrU8Traits>(dst, brush, brushColor, strength, nPixels);
 }
 
+void RgbU8ColorSpace::fillGrayBrushWithPixelColorAndLightnessWithStrength(quint8* dst, const QRgb* brush, qreal strength, qint32 nPixels) const
+{
+    fillGrayBrushWithPixelColorPreserveLightnessRGB<KoBgrU8Traits>(dst, brush, strength, nPixels);
+}
+
 void RgbU8ColorSpace::modulateLightnessByGrayBrush(quint8 *dst, const QRgb *brush, qreal strength, qint32 nPixels) const
 {
     modulateLightnessByGrayBrushRGB<KoBgrU8Traits>(dst, brush, strength, nPixels);
@@ -22,6 +22,7 @@
 #include <kis_processing_information.h>
 #include "kis_mask_generator.h"
 #include "kis_lod_transform.h"
+#include <KisSummedAreaTable.h>
 
 
 KisBlurFilter::KisBlurFilter() : KisFilter(id(), FiltersCategoryBlurId, i18n("&Blur..."))
@@ -74,6 +75,40 @@ void KisBlurFilter::processImpl(KisPaintDeviceSP device,
     qreal hFade = strength;
     qreal vFade = strength;
 
+    QBitArray channelFlags;
+    if (config) {
+        channelFlags = config->channelFlags();
+    }
+    if (channelFlags.isEmpty() || !config) {
+        channelFlags = QBitArray(device->colorSpace()->channelCount(), true);
+    }
+
+    if (shape == 2) {
+        const QRect boxRect(-int(halfWidth), -int(halfHeight), int(width), int(height));
+
+        if (KisSummedAreaTable::isSupported(device->colorSpace()) &&
+            channelFlags.count(true) == channelFlags.size()) {
+
+            KisSummedAreaTable::Box box;
+            box.rect = boxRect;
+
+            KisSummedAreaTable::applyBoxes(device, device, rect, {box},
+                                           KisSummedAreaTable::borderRepeatRect(device, rect),
+                                           progressUpdater);
+        } else {
+            Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> boxKernel(height, width);
+            boxKernel.fill(1.0);
+
+            KisConvolutionKernelSP kernel = KisConvolutionKernel::fromMatrix(boxKernel, 0, boxKernel.sum());
+            KisConvolutionPainter painter(device);
+            painter.setChannelFlags(channelFlags);
+            painter.setProgress(progressUpdater);
+            painter.applyMatrix(kernel, device, srcTopLeft, srcTopLeft, rect.size(), BORDER_REPEAT);
+        }
+
+        return;
+    }
+
     KisMaskGenerator* kas;
     switch (shape) {
     case 1:
@@ -85,14 +120,6 @@ void KisBlurFilter::processImpl(KisPaintDeviceSP device,
         break;
     }
 
-    QBitArray channelFlags;
-    if (config) {
-        channelFlags = config->channelFlags();
-    }
-    if (channelFlags.isEmpty() || !config) {
-        channelFlags = QBitArray(device->colorSpace()->channelCount(), true);
-    }
-
     KisConvolutionKernelSP kernel = KisConvolutionKernel::fromMaskGenerator(kas, rotate * M_PI / 180.0);
     delete kas;
     KisConvolutionPainter painter(device);
@@ -23,9 +23,11 @@
 #include <kis_paint_device.h>
 #include <kis_processing_information.h>
 #include "kis_lod_transform.h"
+#include <KisSummedAreaTable.h>
 
 
 #include <QPainter>
+#include <QtMath>
 
 #include <math.h>
 
@@ -83,6 +85,44 @@ struct MotionBlurProperties
     QSize kernelHalfSize;
     QLineF motionLine;
 };
+
+/**
+ * The kernel of a horizontal or vertical blur is an antialiased line with
+ * square caps, which fully covers the pixels up to half of the length
+ * from the center and partially covers the next ones. It is a weighted
+ * sum of two boxes, so it can be applied in constant time for any length.
+ *
+ * \return the boxes, or an empty vector if the blur is not axis-aligned
+ */
+QVector<KisSummedAreaTable::Box> axisAlignedBoxes(KisFilterConfigurationSP config, const KisLodTransformScalar &t)
+{
+    const int blurAngle = ((config->getInt("blurAngle", 0) % 180) + 180) % 180;
+    if (blurAngle != 0 && blurAngle != 90) {
+        return QVector<KisSummedAreaTable::Box>();
+    }
+
+    const qreal halfLength = 0.5 * t.scale(config->getInt("blurLength", 5));
+    const int innerRadius = qFloor(halfLength);
+    const qreal edgeCoverage = halfLength - innerRadius;
+
+    auto lineBox = [blurAngle] (int radius, qreal weight) {
+        KisSummedAreaTable::Box box;
+        box.rect = blurAngle == 0 ?
+            QRect(-radius, 0, 2 * radius + 1, 1) :
+            QRect(0, -radius, 1, 2 * radius + 1);
+        box.weight = weight;
+        return box;
+    };
+
+    QVector<KisSummedAreaTable::Box> boxes;
+    boxes << lineBox(innerRadius, 1.0 - edgeCoverage);
+
+    if (edgeCoverage > 0.0) {
+        boxes << lineBox(innerRadius + 1, edgeCoverage);
+    }
+
+    return boxes;
+}
 }
 
 void KisMotionBlurFilter::processImpl(KisPaintDeviceSP device,
@@ -113,6 +153,18 @@ void KisMotionBlurFilter::processImpl(KisPaintDeviceSP device,
         channelFlags = QBitArray(device->colorSpace()->channelCount(), true);
     }
 
+    const QVector<KisSummedAreaTable::Box> boxes = axisAlignedBoxes(config, t);
+
+    if (!boxes.isEmpty() &&
+        KisSummedAreaTable::isSupported(device->colorSpace()) &&
+        channelFlags.count(true) == channelFlags.size()) {
+
+        KisSummedAreaTable::applyBoxes(device, device, rect, boxes,
+                                       KisSummedAreaTable::borderRepeatRect(device, rect),
+                                       progressUpdater);
+        return;
+    }
+
     QImage kernelRepresentation(props.kernelSize, QImage::Format_RGB32);
     kernelRepresentation.fill(0);
 
@@ -38,6 +38,7 @@ KisWdgBlur::KisWdgBlur(QWidget * parent) : KisConfigWidget(parent)
     connect(widget()->intStrength, SIGNAL(valueChanged(int)), SIGNAL(sigConfigurationItemChanged()));
     connect(widget()->angleSelector, SIGNAL(angleChanged(qreal)), SIGNAL(sigConfigurationItemChanged()));
     connect(widget()->cbShape, SIGNAL(activated(int)), SIGNAL(sigConfigurationItemChanged()));
+    connect(widget()->cbShape, SIGNAL(currentIndexChanged(int)), this, SLOT(shapeChanged(int)));
 }
 
 KisWdgBlur::~KisWdgBlur()
@@ -80,6 +81,14 @@ void KisWdgBlur::setConfiguration(const KisPropertiesConfigurationSP config)
     }
 }
 
+void KisWdgBlur::shapeChanged(int shape)
+{
+    // the box is always a plain axis-aligned average
+    const bool isBox = shape == 2;
+    widget()->intStrength->setEnabled(!isBox);
+    widget()->angleSelector->setEnabled(!isBox);
+}
+
 void KisWdgBlur::linkSpacingToggled(bool b)
 {
     m_halfSizeLink = b;
@@ -30,6 +30,7 @@ private Q_SLOTS:
     void linkSpacingToggled(bool);
     void sldHalfWidthChanged(int);
     void sldHalfHeightChanged(int);
+    void shapeChanged(int);
 
 private:
 
@@ -10,6 +10,8 @@
 #include "kis_selection.h"
 #include "kis_paint_device.h"
 #include "kis_processing_information.h"
+#include "kis_image_config.h"
+#include <KoLut3DColorTransformation.h>
 #include <KisGlobalResourcesInterface.h>
 
 KisColorBalanceFilter::KisColorBalanceFilter() 
@@ -43,7 +45,13 @@ KoColorTransformation * KisColorBalanceFilter::createTransformation(const KoColo
         params["preserve_luminosity"] = config->getBool("preserve_luminosity", true);
 
     }
-    return cs->createColorTransformation("ColorBalance" , params);
+    KoColorTransformation *transformation = cs->createColorTransformation("ColorBalance" , params);
+
+    if (KisImageConfig(true).bakeColorAdjustmentsToLut()) {
+        transformation = KoLut3DColorTransformation::bake(cs, transformation);
+    }
+
+    return transformation;
 }
 
 KisFilterConfigurationSP KisColorBalanceFilter::defaultConfiguration(KisResourcesInterfaceSP resourcesInterface) const
@@ -24,6 +24,7 @@
 #include "KoColorSpace.h"
 #include "KoColorTransformation.h"
 #include "KoCompositeColorTransformation.h"
+#include "KoLut3DColorTransformation.h"
 #include "KoCompositeOp.h"
 #include "KoID.h"
 
@@ -35,6 +36,7 @@
 #include <kis_selection.h>
 #include <kis_paint_device.h>
 #include <kis_processing_information.h>
+#include <kis_image_config.h>
 #include <libs/global/kis_dom_utils.h>
 
 #include "kis_histogram.h"
@@ -381,11 +383,14 @@ KoColorTransformation* KisCrossChannelFilter::createTransformation(const KoColor
     }
 
     QVector<KoColorTransformation*> transforms;
+    // the alpha channel is not sampled by the LUT
+    bool dependsOnAlpha = false;
     // Channel order reversed in order to adjust saturation before hue. This allows mapping grays to colors.
     for (int i = virtualChannels.size() - 1; i >= 0; i--) {
         if (!curves[i].isConstant(0.5)) {
             int channel = mapChannel(virtualChannels[i]);
             int driverChannel = mapChannel(virtualChannels[drivers[i]]);
+            dependsOnAlpha |= channel == KisHSVCurve::Alpha || driverChannel == KisHSVCurve::Alpha;
             QHash<QString, QVariant> params;
             params["channel"] = channel;
             params["driverChannel"] = driverChannel;
@@ -399,5 +404,12 @@ KoColorTransformation* KisCrossChannelFilter::createTransformation(const KoColor
         }
     }
 
-    return KoCompositeColorTransformation::createOptimizedCompositeTransform(transforms);
+    KoColorTransformation *transformation =
+        KoCompositeColorTransformation::createOptimizedCompositeTransform(transforms);
+
+    if (!dependsOnAlpha && KisImageConfig(true).bakeColorAdjustmentsToLut()) {
+        transformation = KoLut3DColorTransformation::bake(cs, transformation);
+    }
+
+    return transformation;
 }
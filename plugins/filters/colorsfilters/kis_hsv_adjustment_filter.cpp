@@ -16,11 +16,13 @@
 #include <kis_selection.h>
 #include <kis_paint_device.h>
 #include <kis_processing_information.h>
+#include <kis_image_config.h>
 #include <KoColorSpace.h>
 #include <KoColorProfile.h>
 #include <KoColorSpaceRegistry.h>
 #include <KoColorModelStandardIds.h>
 #include <KoColorConversions.h>
+#include <KoLut3DColorTransformation.h>
 #include <KisGlobalResourcesInterface.h>
 #include <KisHsvColorSlider.h>
 
@@ -284,7 +286,13 @@ KoColorTransformation *KisHSVAdjustmentFilter::createTransformation(const KoColo
         params["lumaBlue"] = cs->lumaCoefficients()[2];
         params["compatibilityMode"] = compatibilityMode;
     }
-    return cs->createColorTransformation("hsv_adjustment", params);
+    KoColorTransformation *transformation = cs->createColorTransformation("hsv_adjustment", params);
+
+    if (KisImageConfig(true).bakeColorAdjustmentsToLut()) {
+        transformation = KoLut3DColorTransformation::bake(cs, transformation);
+    }
+
+    return transformation;
 }
 
 KisFilterConfigurationSP KisHSVAdjustmentFilter::defaultConfiguration(KisResourcesInterfaceSP resourcesInterface) const
@@ -27,6 +27,7 @@
 #include "KisGradientMapFilterConfiguration.h"
 #include "KisGradientMapFilterNearestCachedGradient.h"
 #include "KisGradientMapFilterDitherCachedGradient.h"
+#include "KisGradientMapFilterLut.h"
 
 KisGradientMapFilter::KisGradientMapFilter()
     : KisFilter(id(), FiltersCategoryMapId, i18n("&Gradient Map..."))
@@ -125,6 +126,17 @@ void KisGradientMapFilter::processImpl(KisPaintDeviceSP device,
     const KoColorSpace *colorSpace = device->colorSpace();
     const int cachedGradientSize = device->extent().width() + device->extent().height();
 
+    if (KisGradientMapFilterLut::isSupported(colorSpace) && cachedGradientSize > 1) {
+        KisDitherUtil ditherUtil;
+        if (colorMode == KisGradientMapFilterConfiguration::ColorMode_Dither) {
+            ditherUtil.setConfiguration(*filterConfig, "dither/");
+        }
+
+        KisGradientMapFilterLut lut(gradient, colorMode, cachedGradientSize, colorSpace);
+        lut.process(device, applyRect, &ditherUtil, progressUpdater);
+        return;
+    }
+
     if (colorMode == KisGradientMapFilterConfiguration::ColorMode_Blend) {
         KoCachedGradient cachedGradient(gradient, cachedGradientSize, colorSpace);
         BlendColorModePolicy colorModePolicy(&cachedGradient);
@@ -0,0 +1,281 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisGradientMapFilterLut.h"
+
+#include <QVector>
+
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
+#include <KoColorSpaceTraits.h>
+#include <KoCachedGradient.h>
+#include <KisDitherUtil.h>
+#include <KisSequentialIteratorProgress.h>
+#include <kis_paint_device.h>
+
+#include "KisGradientMapFilterConfiguration.h"
+#include "KisGradientMapFilterNearestCachedGradient.h"
+#include "KisGradientMapFilterDitherCachedGradient.h"
+
+namespace {
+
+/**
+ * The lightness of the 8-bit pixels is the integer 30 * r + 59 * g + 11 * b,
+ * the same as in RgbU8ColorSpace::intensityF()
+ */
+const int maxLightness8 = 100 * 255;
+
+}
+
+struct KisGradientMapFilterLut::Private
+{
+    const KoColorSpace *colorSpace = nullptr;
+    int channelSize = 0;
+    int alphaPos = 0;
+    bool isDither = false;
+    qint32 max = 0;
+
+    /// the color space the lightness of the non 8-bit pixels is measured in,
+    /// or null if the pixels are already in it
+    const KoColorSpace *lightnessColorSpace = nullptr;
+
+    /// the colors of the gradient (or of the left stops in the dither mode)
+    QVector<quint8> colors;
+    QVector<quint8> rightColors;
+    QVector<qreal> localT;
+
+    /// the index of the color for every 8-bit lightness
+    QVector<int> indices8;
+
+    void calculateIndices(const quint8 *src, int *indices, int numPixels, QVector<quint8> &buffer) const;
+
+    template <typename T>
+    void writePixels(const quint8 *srcU8, quint8 *dstU8, const int *indices,
+                     const qreal *thresholds, int numPixels) const;
+};
+
+void KisGradientMapFilterLut::Private::calculateIndices(const quint8 *src, int *indices, int numPixels, QVector<quint8> &buffer) const
+{
+    if (channelSize == 1) {
+        const KoBgrU8Traits::Pixel *pixels = reinterpret_cast<const KoBgrU8Traits::Pixel*>(src);
+
+        for (int i = 0; i < numPixels; i++) {
+            indices[i] = indices8[30 * pixels[i].red + 59 * pixels[i].green + 11 * pixels[i].blue];
+        }
+        return;
+    }
+
+    if (lightnessColorSpace) {
+        buffer.resize(numPixels * lightnessColorSpace->pixelSize());
+        colorSpace->convertPixelsTo(src, buffer.data(), lightnessColorSpace, numPixels,
+                                    KoColorConversionTransformation::internalRenderingIntent(),
+                                    KoColorConversionTransformation::internalConversionFlags());
+        src = buffer.constData();
+    }
+
+    const KoBgrU16Traits::Pixel *pixels = reinterpret_cast<const KoBgrU16Traits::Pixel*>(src);
+    const float scale = float(max) / 0xffff;
+
+    for (int i = 0; i < numPixels; i++) {
+        const float lightness = 0.30f * pixels[i].red + 0.59f * pixels[i].green + 0.11f * pixels[i].blue;
+        indices[i] = qMin(int(lightness * scale + 0.5f), max);
+    }
+}
+
+template <typename T>
+void KisGradientMapFilterLut::Private::writePixels(const quint8 *srcU8, quint8 *dstU8, const int *indices,
+                                                   const qreal *thresholds, int numPixels) const
+{
+    const T *src = reinterpret_cast<const T*>(srcU8);
+    T *dst = reinterpret_cast<T*>(dstU8);
+    const T *left = reinterpret_cast<const T*>(colors.constData());
+    const T *right = reinterpret_cast<const T*>(rightColors.constData());
+
+    for (int i = 0; i < numPixels; i++) {
+        const int index = indices[i];
+        const T *color = thresholds && localT[index] >= thresholds[i] ?
+            right + 4 * index : left + 4 * index;
+
+        // the source and the destination may be the same pixel
+        const T srcAlpha = src[alphaPos];
+
+        for (int channel = 0; channel < 4; channel++) {
+            dst[channel] = color[channel];
+        }
+        dst[alphaPos] = qMin(srcAlpha, color[alphaPos]);
+
+        src += 4;
+        dst += 4;
+    }
+}
+
+KisGradientMapFilterLut::KisGradientMapFilterLut(const KoAbstractGradientSP gradient, int colorMode, qint32 steps, const KoColorSpace *cs)
+    : m_d(new Private)
+{
+    KIS_SAFE_ASSERT_RECOVER_NOOP(isSupported(cs));
+    KIS_SAFE_ASSERT_RECOVER_NOOP(steps > 1);
+
+    m_d->colorSpace = cs;
+    m_d->channelSize = cs->pixelSize() / 4;
+    m_d->alphaPos = cs->alphaPos();
+    m_d->isDither = colorMode == KisGradientMapFilterConfiguration::ColorMode_Dither;
+    m_d->max = qMax(1, steps - 1);
+
+    const int pixelSize = cs->pixelSize();
+    const int numColors = m_d->max + 1;
+
+    m_d->colors.resize(numColors * pixelSize);
+
+    // the colors are read through the cached gradients, so the quantization
+    // of the lightness is the same as in the generic path
+    if (colorMode == KisGradientMapFilterConfiguration::ColorMode_Blend) {
+        KoCachedGradient cachedGradient(gradient, numColors, cs);
+
+        for (int i = 0; i < numColors; i++) {
+            memcpy(m_d->colors.data() + i * pixelSize, cachedGradient.cachedAt(qreal(i) / m_d->max), pixelSize);
+        }
+
+    } else if (colorMode == KisGradientMapFilterConfiguration::ColorMode_Nearest) {
+        KisGradientMapFilterNearestCachedGradient cachedGradient(gradient, numColors, cs);
+
+        for (int i = 0; i < numColors; i++) {
+            memcpy(m_d->colors.data() + i * pixelSize, cachedGradient.cachedAt(qreal(i) / m_d->max), pixelSize);
+        }
+
+    } else /* if colorMode == KisGradientMapFilterConfiguration::ColorMode_Dither */ {
+        KisGradientMapFilterDitherCachedGradient cachedGradient(gradient, numColors, cs);
+
+        m_d->rightColors.resize(numColors * pixelSize);
+        m_d->localT.resize(numColors);
+
+        for (int i = 0; i < numColors; i++) {
+            const KisGradientMapFilterDitherCachedGradient::CachedEntry &entry =
+                cachedGradient.cachedAt(qreal(i) / m_d->max);
+
+            memcpy(m_d->colors.data() + i * pixelSize, entry.leftStop.data(), pixelSize);
+            memcpy(m_d->rightColors.data() + i * pixelSize, entry.rightStop.data(), pixelSize);
+            m_d->localT[i] = entry.localT;
+        }
+    }
+
+    if (m_d->channelSize == 1) {
+        m_d->indices8.resize(maxLightness8 + 1);
+
+        for (int lightness = 0; lightness <= maxLightness8; lightness++) {
+            const qreal t = static_cast<qreal>(lightness) / maxLightness8;
+            m_d->indices8[lightness] = qMin(qint32(t * m_d->max + 0.5), m_d->max);
+        }
+    } else {
+        const KoColorSpace *srgb16 = KoColorSpaceRegistry::instance()->rgb16();
+        if (!(*cs == *srgb16)) {
+            m_d->lightnessColorSpace = srgb16;
+        }
+    }
+}
+
+KisGradientMapFilterLut::~KisGradientMapFilterLut()
+{
+}
+
+bool KisGradientMapFilterLut::isSupported(const KoColorSpace *cs)
+{
+    if (cs->colorModelId() != RGBAColorModelID) return false;
+
+    const KoID depth = cs->colorDepthId();
+    const int channelSize =
+        depth == Integer8BitsColorDepthID ? 1 :
+        depth == Integer16BitsColorDepthID ? 2 :
+        depth == Float32BitsColorDepthID ? 4 : 0;
+
+    return channelSize &&
+        cs->channelCount() == 4 &&
+        cs->colorChannelCount() == 3 &&
+        cs->pixelSize() == quint32(4 * channelSize);
+}
+
+void KisGradientMapFilterLut::process(KisPaintDeviceSP device, const QRect &applyRect,
+                                      KisDitherUtil *ditherUtil, KoUpdater *progressUpdater) const
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(*device->colorSpace() == *m_d->colorSpace);
+    KIS_SAFE_ASSERT_RECOVER_RETURN(!m_d->isDither || ditherUtil);
+
+    /**
+     * The thresholds of a pattern repeat, so they are calculated for a single
+     * tile, unless the tile is bigger than the processed area. The pattern is
+     * not wrapped for the negative positions in KisDitherUtil, so these are
+     * still passed to it.
+     */
+    QSize thresholdTileSize;
+    QVector<qreal> thresholdTile;
+
+    if (m_d->isDither) {
+        thresholdTileSize = ditherUtil->thresholdPeriod();
+
+        if (!thresholdTileSize.isEmpty() &&
+            qint64(thresholdTileSize.width()) * thresholdTileSize.height() <=
+            qint64(applyRect.width()) * applyRect.height()) {
+
+            thresholdTile.reserve(thresholdTileSize.width() * thresholdTileSize.height());
+
+            for (int y = 0; y < thresholdTileSize.height(); y++) {
+                for (int x = 0; x < thresholdTileSize.width(); x++) {
+                    thresholdTile.append(ditherUtil->threshold(QPoint(x, y)));
+                }
+            }
+        }
+    }
+
+    QVector<int> indices;
+    QVector<qreal> thresholds;
+    QVector<quint8> buffer;
+
+    KisSequentialIteratorProgress it(device, applyRect, progressUpdater);
+    int numConseqPixels = it.nConseqPixels();
+    while (it.nextPixels(numConseqPixels)) {
+        numConseqPixels = it.nConseqPixels();
+
+        const quint8 *src = it.oldRawData();
+        quint8 *dst = it.rawData();
+
+        indices.resize(numConseqPixels);
+        m_d->calculateIndices(src, indices.data(), numConseqPixels, buffer);
+
+        const qreal *runThresholds = nullptr;
+
+        if (m_d->isDither) {
+            thresholds.resize(numConseqPixels);
+
+            const int x = it.x();
+            const int y = it.y();
+
+            if (!thresholdTile.isEmpty() && x >= 0 && y >= 0) {
+                const int tileWidth = thresholdTileSize.width();
+                const qreal *tileRow = thresholdTile.constData() + (y % thresholdTileSize.height()) * tileWidth;
+                int tileX = x % tileWidth;
+
+                for (int i = 0; i < numConseqPixels; i++) {
+                    thresholds[i] = tileRow[tileX];
+                    if (++tileX == tileWidth) tileX = 0;
+                }
+            } else {
+                for (int i = 0; i < numConseqPixels; i++) {
+                    thresholds[i] = ditherUtil->threshold(QPoint(x + i, y));
+                }
+            }
+
+            runThresholds = thresholds.constData();
+        }
+
+        if (m_d->channelSize == 1) {
+            m_d->writePixels<quint8>(src, dst, indices.constData(), runThresholds, numConseqPixels);
+        } else if (m_d->channelSize == 2) {
+            m_d->writePixels<quint16>(src, dst, indices.constData(), runThresholds, numConseqPixels);
+        } else {
+            m_d->writePixels<float>(src, dst, indices.constData(), runThresholds, numConseqPixels);
+        }
+    }
+}
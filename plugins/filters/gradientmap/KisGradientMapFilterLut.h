@@ -0,0 +1,58 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_GRADIENT_MAP_FILTER_LUT_H
+#define KIS_GRADIENT_MAP_FILTER_LUT_H
+
+#include <QRect>
+#include <QScopedPointer>
+
+#include <kis_types.h>
+#include <KoAbstractGradient.h>
+
+class KoColorSpace;
+class KoUpdater;
+class KisDitherUtil;
+
+/**
+ * The gradient map of RGBA 8-bit, 16-bit and 32-bit float devices.
+ *
+ * The colors of the gradient are converted to the color space of the
+ * device once and stored as plain pixels, indexed by the quantized
+ * lightness. The lightness of a run of pixels is calculated in a tight
+ * loop without any virtual calls, which the compiler can vectorize, and
+ * the thresholds of a dithering pattern are read from a precalculated tile.
+ *
+ * The lightness is measured in sRGB, like in the generic path of
+ * KisGradientMapFilter, so the float pixels and the pixels with other
+ * profiles are converted to 16-bit sRGB first, a run at a time.
+ */
+class KisGradientMapFilterLut
+{
+public:
+    /**
+     * \p steps is the number of the cached colors, it should be at least 2
+     */
+    KisGradientMapFilterLut(const KoAbstractGradientSP gradient, int colorMode, qint32 steps, const KoColorSpace *cs);
+    ~KisGradientMapFilterLut();
+
+    static bool isSupported(const KoColorSpace *cs);
+
+    /**
+     * Maps the pixels of \p applyRect. \p ditherUtil is used in the dither
+     * mode only.
+     */
+    void process(KisPaintDeviceSP device, const QRect &applyRect,
+                 KisDitherUtil *ditherUtil, KoUpdater *progressUpdater) const;
+
+private:
+    Q_DISABLE_COPY(KisGradientMapFilterLut)
+
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif
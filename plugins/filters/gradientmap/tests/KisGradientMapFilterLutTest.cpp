@@ -0,0 +1,246 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#include "KisGradientMapFilterLutTest.h"
+
+#include <QRandomGenerator>
+
+#include <KoCachedGradient.h>
+#include <KoColor.h>
+#include <KoColorModelStandardIds.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoPattern.h>
+#include <KoStopGradient.h>
+
+#include <KisDitherUtil.h>
+#include <KisLocalStrokeResources.h>
+#include <kis_filter_configuration.h>
+#include <kis_paint_device.h>
+
+#include "../KisGradientMapFilterConfiguration.h"
+#include "../KisGradientMapFilterDitherCachedGradient.h"
+#include "../KisGradientMapFilterLut.h"
+#include "../KisGradientMapFilterNearestCachedGradient.h"
+
+namespace {
+
+/**
+ * The number of the cached colors. The lightness of the 8-bit pixels
+ * never falls exactly between two colors with 257 steps, so the rounding
+ * of the index cannot go different ways in the two paths.
+ */
+const int numSteps = 257;
+
+const QRect testRect(3, 5, 61, 37);
+
+KoAbstractGradientSP createGradient()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    QList<KoGradientStop> stops;
+    stops << KoGradientStop(0.0, KoColor(QColor(0, 0, 0, 255), cs), COLORSTOP);
+    stops << KoGradientStop(0.3, KoColor(QColor(255, 0, 0, 128), cs), COLORSTOP);
+    stops << KoGradientStop(0.6, KoColor(QColor(0, 255, 64, 255), cs), COLORSTOP);
+    stops << KoGradientStop(1.0, KoColor(QColor(255, 255, 255, 200), cs), COLORSTOP);
+
+    KoStopGradientSP gradient(new KoStopGradient(""));
+    gradient->setStops(stops);
+    return gradient;
+}
+
+KoPatternSP createPattern()
+{
+    QImage image(8, 8, QImage::Format_ARGB32);
+
+    for (int y = 0; y < image.height(); y++) {
+        for (int x = 0; x < image.width(); x++) {
+            const int value = (x * 8 + y * 3) % 64 * 4;
+            image.setPixel(x, y, qRgb(value, value, value));
+        }
+    }
+
+    return KoPatternSP(new KoPattern(image, "test_pattern", ""));
+}
+
+/**
+ * The same color mode policies as the generic path of KisGradientMapFilter
+ */
+class GenericGradientMap
+{
+public:
+    GenericGradientMap(KoAbstractGradientSP gradient, int colorMode, const KoColorSpace *cs, KisDitherUtil *ditherUtil)
+        : m_colorMode(colorMode)
+        , m_ditherUtil(ditherUtil)
+        , m_blend(gradient, numSteps, cs)
+        , m_nearest(gradient, numSteps, cs)
+        , m_dither(gradient, numSteps, cs)
+    {
+    }
+
+    static int index(qreal t) {
+        return qint32(t * (numSteps - 1) + 0.5);
+    }
+
+    const quint8* colorAtIndex(int index, int x, int y) const {
+        const qreal t = qreal(index) / (numSteps - 1);
+
+        if (m_colorMode == KisGradientMapFilterConfiguration::ColorMode_Blend) {
+            return m_blend.cachedAt(t);
+        } else if (m_colorMode == KisGradientMapFilterConfiguration::ColorMode_Nearest) {
+            return m_nearest.cachedAt(t);
+        }
+
+        const KisGradientMapFilterDitherCachedGradient::CachedEntry &entry = m_dither.cachedAt(t);
+        return entry.localT < m_ditherUtil->threshold(QPoint(x, y)) ?
+            entry.leftStop.data() : entry.rightStop.data();
+    }
+
+private:
+    int m_colorMode;
+    KisDitherUtil *m_ditherUtil;
+    KoCachedGradient m_blend;
+    KisGradientMapFilterNearestCachedGradient m_nearest;
+    KisGradientMapFilterDitherCachedGradient m_dither;
+};
+
+void fillRandomPixels(KisPaintDeviceSP dev, const QRect &rect)
+{
+    const KoColorSpace *cs = dev->colorSpace();
+    const int numChannels = rect.width() * rect.height() * 4;
+    QVector<quint8> bytes(rect.width() * rect.height() * cs->pixelSize());
+
+    QRandomGenerator rng(1234);
+
+    if (cs->colorDepthId() == Float32BitsColorDepthID) {
+        float *channels = reinterpret_cast<float*>(bytes.data());
+        for (int i = 0; i < numChannels; i++) {
+            channels[i] = rng.generateDouble();
+        }
+    } else if (cs->colorDepthId() == Integer16BitsColorDepthID) {
+        quint16 *channels = reinterpret_cast<quint16*>(bytes.data());
+        for (int i = 0; i < numChannels; i++) {
+            channels[i] = rng.bounded(0x10000);
+        }
+    } else {
+        for (int i = 0; i < numChannels; i++) {
+            bytes[i] = rng.bounded(0x100);
+        }
+    }
+
+    dev->writeBytes(bytes.constData(), rect);
+}
+
+}
+
+void KisGradientMapFilterLutTest::testGenericPath_data()
+{
+    QTest::addColumn<QString>("depth");
+    QTest::addColumn<int>("colorMode");
+    QTest::addColumn<int>("indexTolerance");
+
+    const QVector<QPair<QString, int>> depths = {
+        {Integer8BitsColorDepthID.id(), 0},
+        {Integer16BitsColorDepthID.id(), 1},
+        {Float32BitsColorDepthID.id(), 1}
+    };
+
+    const QVector<QPair<QString, int>> modes = {
+        {"blend", KisGradientMapFilterConfiguration::ColorMode_Blend},
+        {"nearest", KisGradientMapFilterConfiguration::ColorMode_Nearest},
+        {"dither", KisGradientMapFilterConfiguration::ColorMode_Dither}
+    };
+
+    /**
+     * The 8-bit lightness is calculated from the same integers in both
+     * paths, so the result should be exact. The other pixels are measured
+     * in 16-bit sRGB in single precision by the LUT, so the index of the
+     * cached color may be off by one.
+     */
+    for (const auto &depth : depths) {
+        for (const auto &mode : modes) {
+            QTest::newRow(qPrintable(QString("%1-%2").arg(mode.first, depth.first)))
+                << depth.first << mode.second << depth.second;
+        }
+    }
+}
+
+void KisGradientMapFilterLutTest::testGenericPath()
+{
+    QFETCH(QString, depth);
+    QFETCH(int, colorMode);
+    QFETCH(int, indexTolerance);
+
+    const KoColorSpace *cs =
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), depth, QString());
+    QVERIFY(cs);
+    QVERIFY(KisGradientMapFilterLut::isSupported(cs));
+
+    const KoAbstractGradientSP gradient = createGradient();
+    const KoPatternSP pattern = createPattern();
+
+    QSharedPointer<KisLocalStrokeResources> resourcesInterface(new KisLocalStrokeResources());
+    resourcesInterface->addResource(pattern);
+
+    KisFilterConfigurationSP config = new KisFilterConfiguration("gradientmap", 2, resourcesInterface);
+    config->setProperty("dither/thresholdMode", int(KisDitherUtil::Pattern));
+    config->setProperty("dither/pattern", pattern->name());
+    config->setProperty("dither/md5sum", pattern->md5Sum());
+    config->setProperty("dither/patternValueMode", int(KisDitherUtil::Lightness));
+    config->setProperty("dither/noiseSeed", 0);
+    config->setProperty("dither/spread", 1.0);
+
+    KisDitherUtil ditherUtil;
+    ditherUtil.setConfiguration(*config, "dither/");
+    QCOMPARE(ditherUtil.thresholdPeriod(), pattern->pattern().size());
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    fillRandomPixels(dev, testRect);
+
+    const int pixelSize = cs->pixelSize();
+    const int numPixels = testRect.width() * testRect.height();
+
+    QVector<quint8> srcBytes(numPixels * pixelSize);
+    dev->readBytes(srcBytes.data(), testRect);
+
+    KisGradientMapFilterLut lut(gradient, colorMode, numSteps, cs);
+    lut.process(dev, testRect, &ditherUtil, nullptr);
+
+    QVector<quint8> lutBytes(numPixels * pixelSize);
+    dev->readBytes(lutBytes.data(), testRect);
+
+    const GenericGradientMap generic(gradient, colorMode, cs, &ditherUtil);
+    QVector<quint8> expected(pixelSize);
+
+    int numMismatches = 0;
+
+    for (int i = 0; i < numPixels; i++) {
+        const int x = testRect.x() + i % testRect.width();
+        const int y = testRect.y() + i / testRect.width();
+        const quint8 *src = srcBytes.constData() + i * pixelSize;
+        const quint8 *result = lutBytes.constData() + i * pixelSize;
+
+        const int index = GenericGradientMap::index(cs->intensityF(src));
+        bool matches = false;
+
+        for (int j = qMax(0, index - indexTolerance);
+             j <= qMin(numSteps - 1, index + indexTolerance) && !matches; j++) {
+
+            const quint8 *color = generic.colorAtIndex(j, x, y);
+            memcpy(expected.data(), color, pixelSize);
+            cs->setOpacity(expected.data(), qMin(cs->opacityF(src), cs->opacityF(color)), 1);
+
+            matches = !memcmp(expected.constData(), result, pixelSize);
+        }
+
+        if (!matches && numMismatches++ < 10) {
+            qWarning() << "Pixel" << x << y << "differs from the generic path at index" << index;
+        }
+    }
+
+    QCOMPARE(numMismatches, 0);
+}
+
+SIMPLE_TEST_MAIN(KisGradientMapFilterLutTest)
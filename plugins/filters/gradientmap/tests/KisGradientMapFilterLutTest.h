@@ -0,0 +1,19 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef KISGRADIENTMAPFILTERLUTTEST_H
+#define KISGRADIENTMAPFILTERLUTTEST_H
+
+#include <simpletest.h>
+
+class KisGradientMapFilterLutTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testGenericPath_data();
+    void testGenericPath();
+};
+
+#endif // KISGRADIENTMAPFILTERLUTTEST_H
@@ -0,0 +1,356 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "kis_guided_smoothing_filter.h"
+
+#include <QBitArray>
+
+#include <KoChannelInfo.h>
+#include <KoColorConversionTransformation.h>
+#include <KoColorModelStandardIds.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoUpdater.h>
+
+#include <kis_global.h>
+#include <widgets/kis_multi_integer_filter_widget.h>
+#include <filter/kis_filter_category_ids.h>
+#include <filter/kis_filter_configuration.h>
+#include <kis_processing_information.h>
+#include <kis_paint_device.h>
+#include <kis_painter.h>
+#include <kis_sequential_iterator.h>
+#include <KisGuidedFilter.h>
+#include "kis_lod_transform.h"
+
+namespace {
+/**
+ * The size of the tiles the area is split into. The margins needed
+ * around the tiles are not bigger than 4 * radius, so the buffers of a
+ * tile stay within a few megabytes for any size of the image.
+ */
+const int tileSize = 512;
+
+/**
+ * The smoothing is the standard deviation (in 8-bit levels) of the
+ * details that are smoothed out
+ */
+inline float epsilonFromSmoothing(int smoothing)
+{
+    const float deviation = smoothing / 255.0f;
+    return deviation * deviation;
+}
+
+int scaledRadius(const KisFilterConfigurationSP config, int lod)
+{
+    KisLodTransformScalar t(lod);
+    return qRound(t.scale(qreal(config->getInt("radius", 4))));
+}
+
+/**
+ * The channels are filtered in the 32-bit float version of the color
+ * space of the device, so that the pixels are converted by whole rows
+ * instead of one by one. If there is no such version, the pixels are
+ * filtered in RGBA.
+ */
+const KoColorSpace* workingColorSpace(const KoColorSpace *cs)
+{
+    if (cs->colorDepthId() == Float32BitsColorDepthID) {
+        return cs;
+    }
+
+    const KoColorSpace *floatCs =
+        KoColorSpaceRegistry::instance()->colorSpace(cs->colorModelId().id(),
+                                                     Float32BitsColorDepthID.id(),
+                                                     cs->profile());
+
+    return floatCs ? floatCs :
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(),
+                                                     Float32BitsColorDepthID.id());
+}
+
+/**
+ * \return the flags of the channels of \p workCs, mapped from the
+ *         flags of the channels of \p cs by their display position
+ */
+QBitArray workingChannelFlags(const KoColorSpace *cs, const KoColorSpace *workCs, const QBitArray &flags)
+{
+    const QList<KoChannelInfo*> channels = cs->channels();
+    const QList<KoChannelInfo*> workChannels = workCs->channels();
+
+    if (workCs->colorModelId() != cs->colorModelId()) {
+        return QBitArray(workChannels.size(), true);
+    }
+
+    QBitArray workFlags(workChannels.size(), true);
+
+    for (int i = 0; i < channels.size(); i++) {
+        for (int j = 0; j < workChannels.size(); j++) {
+            if (workChannels[j]->displayPosition() == channels[i]->displayPosition()) {
+                workFlags.setBit(j, flags.testBit(i));
+            }
+        }
+    }
+
+    return workFlags;
+}
+}
+
+KisGuidedSmoothingFilter::KisGuidedSmoothingFilter()
+    : KisFilter(id(), FiltersCategoryEnhanceId, i18n("&Edge-Preserving Smoothing..."))
+{
+    setSupportsPainting(true);
+    setSupportsThreading(true);
+    setSupportsAdjustmentLayers(true);
+    setSupportsLevelOfDetail(true);
+}
+
+KisGuidedSmoothingFilter::~KisGuidedSmoothingFilter()
+{
+}
+
+KisConfigWidget * KisGuidedSmoothingFilter::createConfigurationWidget(QWidget* parent, const KisPaintDeviceSP dev, bool) const
+{
+    Q_UNUSED(dev);
+    vKisIntegerWidgetParam param;
+    param.push_back(KisIntegerWidgetParam(1, 100, 4, i18n("Radius"), "radius"));
+    param.push_back(KisIntegerWidgetParam(1, 100, 10, i18n("Smoothing"), "smoothing"));
+    return new KisMultiIntegerFilterWidget(id().id(), parent, id().id(), param);
+}
+
+KisFilterConfigurationSP  KisGuidedSmoothingFilter::defaultConfiguration(KisResourcesInterfaceSP resourcesInterface) const
+{
+    KisFilterConfigurationSP config = factoryConfiguration(resourcesInterface);
+    config->setProperty("radius", 4);
+    config->setProperty("smoothing", 10);
+    return config;
+}
+
+void KisGuidedSmoothingFilter::processImpl(KisPaintDeviceSP device,
+                                           const QRect& applyRect,
+                                           const KisFilterConfigurationSP config,
+                                           KoUpdater* progressUpdater
+                                           ) const
+{
+    Q_ASSERT(device);
+    KIS_SAFE_ASSERT_RECOVER_RETURN(config);
+
+    const int radius = scaledRadius(config, device->defaultBounds()->currentLevelOfDetail());
+    const float epsilon = epsilonFromSmoothing(config->getInt("smoothing", 10));
+    const int margin = KisGuidedFilter::requiredMargin(radius);
+
+    const KoColorSpace *cs = device->colorSpace();
+    const KoColorSpace *workCs = workingColorSpace(cs);
+    const int pixelSize = cs->pixelSize();
+    const int channelCount = workCs->channelCount();
+
+    QBitArray channelFlags = config->channelFlags();
+    if (channelFlags.isEmpty()) {
+        channelFlags = QBitArray(cs->channelCount(), true);
+    }
+    channelFlags = workingChannelFlags(cs, workCs, channelFlags);
+
+    /**
+     * The indexes of the channels in the pixels of workCs, the order
+     * of the channel infos may differ from the order in memory
+     */
+    const QList<KoChannelInfo*> workChannels = workCs->channels();
+    QVector<int> filteredChannels;
+    int alphaIndex = -1;
+    bool filterAlpha = false;
+
+    for (int i = 0; i < channelCount; i++) {
+        const int channel = workChannels[i]->pos() / int(sizeof(float));
+
+        if (workChannels[i]->channelType() == KoChannelInfo::ALPHA) {
+            alphaIndex = channel;
+            filterAlpha = channelFlags.testBit(i);
+        }
+
+        if (channelFlags.testBit(i)) {
+            filteredChannels.append(channel);
+        }
+    }
+
+    if (filteredChannels.isEmpty()) return;
+
+    auto convertPixels = [] (const KoColorSpace *srcCs, const quint8 *src,
+                             const KoColorSpace *dstCs, quint8 *dst, int numPixels) {
+        if (*srcCs == *dstCs) {
+            memcpy(dst, src, numPixels * srcCs->pixelSize());
+        } else {
+            srcCs->convertPixelsTo(src, dst, dstCs, numPixels,
+                                   KoColorConversionTransformation::internalRenderingIntent(),
+                                   KoColorConversionTransformation::internalConversionFlags());
+        }
+    };
+
+    /**
+     * The tiles are written into a separate device, because the margins
+     * of a tile overlap with its neighbours, which should still read the
+     * original pixels.
+     */
+    KisPaintDeviceSP result = new KisPaintDevice(cs);
+
+    const int tilesX = (applyRect.width() + tileSize - 1) / tileSize;
+    const int tilesY = (applyRect.height() + tileSize - 1) / tileSize;
+    int tilesDone = 0;
+
+    for (int ty = 0; ty < tilesY; ty++) {
+        for (int tx = 0; tx < tilesX; tx++) {
+            const QRect tileRect =
+                QRect(applyRect.x() + tx * tileSize, applyRect.y() + ty * tileSize, tileSize, tileSize) & applyRect;
+            const QRect bufferRect = kisGrowRect(tileRect, margin);
+            const int bufferSize = bufferRect.width() * bufferRect.height();
+
+            /**
+             * The pixels are read run by run into one buffer, then
+             * converted into floats and into the guide at once
+             */
+            QVector<quint8> pixels(bufferSize * pixelSize);
+            {
+                KisSequentialConstIterator srcIt(device, bufferRect);
+                quint8 *dstPtr = pixels.data();
+
+                int numConseqPixels = srcIt.nConseqPixels();
+                while (srcIt.nextPixels(numConseqPixels)) {
+                    numConseqPixels = srcIt.nConseqPixels();
+                    memcpy(dstPtr, srcIt.oldRawData(), numConseqPixels * pixelSize);
+                    dstPtr += numConseqPixels * pixelSize;
+                }
+            }
+
+            QVector<float> values(bufferSize * channelCount);
+            convertPixels(cs, pixels.constData(), workCs, reinterpret_cast<quint8*>(values.data()), bufferSize);
+
+            /**
+             * All the channels share the same guide, so that the edges are
+             * kept at the same places in all of them and the colors don't
+             * shift near the edges. The guide is the lightness scaled by
+             * alpha, mapped into [0.5, 1] for opaque pixels, so that the
+             * edges of the opacity are kept even where the lightness is
+             * the same on both sides.
+             */
+            QVector<float> guide(bufferSize);
+            {
+                QVector<quint16> lab(bufferSize * 4);
+                cs->toLabA16(pixels.constData(), reinterpret_cast<quint8*>(lab.data()), bufferSize);
+
+                for (int i = 0; i < bufferSize; i++) {
+                    const float lightness = lab[4 * i] / 65535.0f;
+                    const float alpha = lab[4 * i + 3] / 65535.0f;
+                    guide[i] = alpha * 0.5f * (1.0f + lightness);
+                }
+            }
+
+            /**
+             * The color channels are premultiplied by alpha, otherwise
+             * the colors of the transparent pixels would bleed into
+             * the neighbouring ones
+             */
+            const int numPlanes = filteredChannels.size();
+            QVector<float> planes(numPlanes * bufferSize);
+            QVector<float> filtered(numPlanes * bufferSize);
+
+            QVector<const float*> srcPlanes(numPlanes);
+            QVector<float*> dstPlanes(numPlanes);
+
+            for (int plane = 0; plane < numPlanes; plane++) {
+                const int channel = filteredChannels[plane];
+                const bool premultiply = alphaIndex >= 0 && channel != alphaIndex;
+
+                float *planePtr = planes.data() + plane * bufferSize;
+                const float *src = values.constData() + channel;
+
+                for (int i = 0; i < bufferSize; i++) {
+                    planePtr[i] = premultiply ? src[0] * src[alphaIndex - channel] : src[0];
+                    src += channelCount;
+                }
+
+                srcPlanes[plane] = planePtr;
+                dstPlanes[plane] = filtered.data() + plane * bufferSize;
+            }
+
+            KisGuidedFilter::apply(guide.constData(), srcPlanes.constData(), dstPlanes.constData(), numPlanes,
+                                   bufferRect.width(), bufferRect.height(),
+                                   radius, epsilon);
+
+            const float *filteredAlpha = nullptr;
+            if (filterAlpha) {
+                filteredAlpha = dstPlanes[filteredChannels.indexOf(alphaIndex)];
+            }
+
+            for (int plane = 0; plane < numPlanes; plane++) {
+                const int channel = filteredChannels[plane];
+                if (channel == alphaIndex) continue;
+
+                const bool premultiplied = alphaIndex >= 0;
+
+                const float *planePtr = dstPlanes[plane];
+                float *dst = values.data() + channel;
+
+                for (int i = 0; i < bufferSize; i++) {
+                    if (!premultiplied) {
+                        dst[0] = planePtr[i];
+                    } else {
+                        const float alpha =
+                            filteredAlpha ? qBound(0.0f, filteredAlpha[i], 1.0f) : dst[alphaIndex - channel];
+
+                        // the color of the fully transparent pixels is kept
+                        if (alpha > 1e-6f) {
+                            dst[0] = planePtr[i] / alpha;
+                        }
+                    }
+                    dst += channelCount;
+                }
+            }
+
+            /**
+             * The alpha is written only after all the color channels are
+             * unpremultiplied with the filtered alpha
+             */
+            if (filteredAlpha) {
+                float *dst = values.data() + alphaIndex;
+                for (int i = 0; i < bufferSize; i++) {
+                    dst[0] = qBound(0.0f, filteredAlpha[i], 1.0f);
+                    dst += channelCount;
+                }
+            }
+
+            KisSequentialIterator dstIt(result, tileRect);
+
+            int numConseqPixels = dstIt.nConseqPixels();
+            while (dstIt.nextPixels(numConseqPixels)) {
+                numConseqPixels = dstIt.nConseqPixels();
+
+                const int index = (dstIt.y() - bufferRect.y()) * bufferRect.width() +
+                                  (dstIt.x() - bufferRect.x());
+
+                convertPixels(workCs, reinterpret_cast<const quint8*>(values.constData() + index * channelCount),
+                              cs, dstIt.rawData(), numConseqPixels);
+            }
+
+            tilesDone++;
+
+            if (progressUpdater) {
+                progressUpdater->setProgress(100 * tilesDone / (tilesX * tilesY));
+                if (progressUpdater->interrupted()) return;
+            }
+        }
+    }
+
+    KisPainter::copyAreaOptimized(applyRect.topLeft(), result, device, applyRect);
+}
+
+QRect KisGuidedSmoothingFilter::neededRect(const QRect & rect, const KisFilterConfigurationSP _config, int lod) const
+{
+    return kisGrowRect(rect, KisGuidedFilter::requiredMargin(scaledRadius(_config, lod)));
+}
+
+QRect KisGuidedSmoothingFilter::changedRect(const QRect & rect, const KisFilterConfigurationSP _config, int lod) const
+{
+    return neededRect(rect, _config, lod);
+}
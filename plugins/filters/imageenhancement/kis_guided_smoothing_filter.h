@@ -0,0 +1,45 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISGUIDEDSMOOTHINGFILTER_H
+#define KISGUIDEDSMOOTHINGFILTER_H
+
+#include <filter/kis_filter.h>
+#include "kis_config_widget.h"
+
+/**
+ * Smooths noise and small details while keeping the edges sharp. The
+ * premultiplied channels are filtered by KisGuidedFilter, whose cost
+ * does not depend on the radius, all with the same guide made of the
+ * lightness and the alpha. The area is processed in tiles, so the
+ * memory usage stays bounded on big images.
+ */
+class KisGuidedSmoothingFilter : public KisFilter
+{
+public:
+    KisGuidedSmoothingFilter();
+    ~KisGuidedSmoothingFilter() override;
+public:
+
+    void processImpl(KisPaintDeviceSP device,
+                     const QRect& applyRect,
+                     const KisFilterConfigurationSP config,
+                     KoUpdater* progressUpdater
+                     ) const override;
+    KisConfigWidget * createConfigurationWidget(QWidget* parent, const KisPaintDeviceSP dev, bool useForMasks) const override;
+
+    static inline KoID id() {
+        return KoID("guidedsmoothing", i18n("Edge-Preserving Smoothing"));
+    }
+
+    QRect changedRect(const QRect &rect, const KisFilterConfigurationSP _config, int lod) const override;
+    QRect neededRect(const QRect &rect, const KisFilterConfigurationSP _config, int lod) const override;
+
+protected:
+    KisFilterConfigurationSP  defaultConfiguration(KisResourcesInterfaceSP resourcesInterface) const override;
+};
+
+#endif
@@ -0,0 +1,204 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "kis_median_filter.h"
+
+#include <algorithm>
+
+#include <QBitArray>
+
+#include <KoColorSpace.h>
+#include <KoUpdater.h>
+
+#include <kis_global.h>
+#include <widgets/kis_multi_integer_filter_widget.h>
+#include <filter/kis_filter_category_ids.h>
+#include <filter/kis_filter_configuration.h>
+#include <kis_processing_information.h>
+#include <kis_paint_device.h>
+#include <kis_painter.h>
+#include <KisGlobalResourcesInterface.h>
+#include <kis_iterator_ng.h>
+#include <KisSequentialIteratorProgress.h>
+#include <KisSlidingWindowHistogram.h>
+#include "kis_lod_transform.h"
+
+namespace {
+/**
+ * The channels are sorted into 8-bit bins. For the deeper color spaces
+ * the result is the average of the values in the median bin, so the
+ * precision of the image is not lost.
+ */
+const int numBins = 256;
+
+/**
+ * The size of the tiles the area is split into, so that the buffer
+ * of the medians does not depend on the size of the area
+ */
+const int tileSize = 512;
+}
+
+KisMedianFilter::KisMedianFilter()
+    : KisFilter(id(), FiltersCategoryEnhanceId, i18n("&Median..."))
+{
+    setSupportsPainting(true);
+    setSupportsThreading(true);
+    setSupportsAdjustmentLayers(true);
+    setSupportsLevelOfDetail(true);
+}
+
+KisMedianFilter::~KisMedianFilter()
+{
+}
+
+KisConfigWidget * KisMedianFilter::createConfigurationWidget(QWidget* parent, const KisPaintDeviceSP dev, bool) const
+{
+    Q_UNUSED(dev);
+    vKisIntegerWidgetParam param;
+    param.push_back(KisIntegerWidgetParam(1, 100, 2, i18n("Radius"), "radius"));
+    KisMultiIntegerFilterWidget *w = new KisMultiIntegerFilterWidget(id().id(), parent, id().id(), param);
+    w->setConfiguration(defaultConfiguration(KisGlobalResourcesInterface::instance()));
+    return w;
+}
+
+KisFilterConfigurationSP  KisMedianFilter::defaultConfiguration(KisResourcesInterfaceSP resourcesInterface) const
+{
+    KisFilterConfigurationSP config = factoryConfiguration(resourcesInterface);
+    config->setProperty("radius", 2);
+    return config;
+}
+
+void KisMedianFilter::processImpl(KisPaintDeviceSP device,
+                                  const QRect& applyRect,
+                                  const KisFilterConfigurationSP config,
+                                  KoUpdater* progressUpdater
+                                  ) const
+{
+    Q_ASSERT(device);
+    KIS_SAFE_ASSERT_RECOVER_RETURN(config);
+
+    KisLodTransformScalar t(device);
+    const int radius = qRound(t.scale(qreal(config->getInt("radius", 2))));
+
+    const KoColorSpace* cs = device->colorSpace();
+    const int channelCount = cs->channelCount();
+    const int alphaPos = cs->alphaPos();
+
+    QBitArray channelFlags = config->channelFlags();
+    if (channelFlags.isEmpty()) {
+        channelFlags = QBitArray(channelCount, true);
+    }
+
+    /**
+     * The tiles are written into a separate device, because the windows
+     * of the pixels of a tile overlap with its neighbours, which should
+     * still read the original pixels.
+     */
+    KisPaintDeviceSP resultDevice = new KisPaintDevice(cs);
+
+    const int tilesX = (applyRect.width() + tileSize - 1) / tileSize;
+    const int tilesY = (applyRect.height() + tileSize - 1) / tileSize;
+    const int totalSteps = tilesX * tilesY * channelCount;
+    int doneSteps = 0;
+
+    QVector<float> result;
+    QVector<float> channels(channelCount);
+
+    KisSlidingWindowHistogram histogram(numBins, 1);
+
+    for (int ty = 0; ty < tilesY; ty++) {
+        for (int tx = 0; tx < tilesX; tx++) {
+            const QRect tileRect =
+                QRect(applyRect.x() + tx * tileSize, applyRect.y() + ty * tileSize, tileSize, tileSize) & applyRect;
+            const int bufferWidth = tileRect.width();
+
+            /**
+             * The medians of all the channels are collected in a normalized
+             * buffer first, because the pixels can be written only when all
+             * the channels are known.
+             */
+            result.resize(tileRect.width() * tileRect.height() * channelCount);
+
+            {
+                KisSequentialConstIterator srcIt(device, tileRect);
+                float *dstPtr = result.data();
+
+                while (srcIt.nextPixel()) {
+                    cs->normalisedChannelsValue(srcIt.oldRawData(), channels);
+                    std::copy(channels.constBegin(), channels.constEnd(), dstPtr);
+                    dstPtr += channelCount;
+                }
+            }
+
+            for (int channel = 0; channel < channelCount; channel++) {
+                if (!channelFlags.testBit(channel)) continue;
+
+                auto fetchRow = [&] (int x, int y, int width, quint16 *bins, float *values) {
+                    KisHLineConstIteratorSP srcIt = device->createHLineConstIteratorNG(x, y, width);
+
+                    do {
+                        const quint8 *data = srcIt->oldRawData();
+
+                        // the color of transparent pixels carries no information
+                        if (channel != alphaPos && cs->opacityU8(data) == OPACITY_TRANSPARENT_U8) {
+                            *bins = KisSlidingWindowHistogram::skipBin;
+                        } else {
+                            cs->normalisedChannelsValue(data, channels);
+
+                            *bins = qBound(0, qRound(channels[channel] * (numBins - 1)), numBins - 1);
+                            *values = channels[channel];
+                        }
+
+                        bins++;
+                        values++;
+                    } while (srcIt->nextPixel());
+                };
+
+                auto processPixel = [&] (int x, int y, const KisSlidingWindowHistogram &h) {
+                    const int bin = h.median();
+                    const int index = (y - tileRect.y()) * bufferWidth + (x - tileRect.x());
+
+                    result[index * channelCount + channel] =
+                        bin >= 0 ? *h.sums(bin) / h.count(bin) : 0.0f;
+                };
+
+                histogram.process(tileRect, radius, fetchRow, processPixel);
+
+                doneSteps++;
+
+                if (progressUpdater) {
+                    progressUpdater->setProgress(100 * doneSteps / totalSteps);
+                    if (progressUpdater->interrupted()) return;
+                }
+            }
+
+            KisSequentialIterator dstIt(resultDevice, tileRect);
+            const float *srcPtr = result.constData();
+
+            while (dstIt.nextPixel()) {
+                std::copy(srcPtr, srcPtr + channelCount, channels.begin());
+                cs->fromNormalisedChannelsValue(dstIt.rawData(), channels);
+                srcPtr += channelCount;
+            }
+        }
+    }
+
+    KisPainter::copyAreaOptimized(applyRect.topLeft(), resultDevice, device, applyRect);
+}
+
+QRect KisMedianFilter::neededRect(const QRect & rect, const KisFilterConfigurationSP _config, int lod) const
+{
+    KisLodTransformScalar t(lod);
+
+    const int radius = _config->getInt("radius", 2);
+    const int margin  = qCeil(t.scale(qreal(radius)));
+    return kisGrowRect(rect, margin);
+}
+
+QRect KisMedianFilter::changedRect(const QRect & rect, const KisFilterConfigurationSP _config, int lod) const
+{
+    return neededRect(rect, _config, lod);
+}
@@ -0,0 +1,47 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISMEDIANFILTER_H
+#define KISMEDIANFILTER_H
+
+#include <filter/kis_filter.h>
+#include "kis_config_widget.h"
+
+/**
+ * Replaces every channel of a pixel with the median of the channel in
+ * a square window around the pixel. The medians are found with
+ * KisSlidingWindowHistogram by adding and removing the pixels entering
+ * and leaving the window (Huang), so the cost per pixel grows linearly
+ * with the radius. The radius is limited to 100, so the window never
+ * becomes taller than the 256 bins of the histogram, which is where the
+ * constant time column-wise update would start to pay off.
+ */
+class KisMedianFilter : public KisFilter
+{
+public:
+    KisMedianFilter();
+    ~KisMedianFilter() override;
+public:
+
+    void processImpl(KisPaintDeviceSP device,
+                     const QRect& applyRect,
+                     const KisFilterConfigurationSP config,
+                     KoUpdater* progressUpdater
+                     ) const override;
+    KisConfigWidget * createConfigurationWidget(QWidget* parent, const KisPaintDeviceSP dev, bool useForMasks) const override;
+
+    static inline KoID id() {
+        return KoID("median", i18n("Median"));
+    }
+
+    QRect changedRect(const QRect &rect, const KisFilterConfigurationSP _config, int lod) const override;
+    QRect neededRect(const QRect &rect, const KisFilterConfigurationSP _config, int lod) const override;
+
+protected:
+    KisFilterConfigurationSP  defaultConfiguration(KisResourcesInterfaceSP resourcesInterface) const override;
+};
+
+#endif
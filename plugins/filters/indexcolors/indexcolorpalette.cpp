@@ -37,33 +37,6 @@ int IndexColorPalette::numColors() const
     return colors.size();
 }
 
-LabColor IndexColorPalette::getNearestIndex(LabColor clr) const
-{
-    QVector<float> diffs;
-    diffs.resize(numColors());
-    for(int i = 0; i < numColors(); ++i)
-        diffs[i] = similarity(colors[i], clr);
-
-    int primaryColor = -1;
-    float maxDiff = std::numeric_limits<float>::min();
-    for(int i = 0; i < numColors(); ++i)
-        if(diffs[i] > maxDiff) {
-            primaryColor = i;
-            maxDiff = diffs[primaryColor];
-        }
-
-    KIS_SAFE_ASSERT_RECOVER (primaryColor >= 0) {
-        LabColor color;
-        color.L = 0;
-        color.a = 0;
-        color.b = 0;
-
-        return color;
-    }
-
-    return colors[primaryColor];
-}
-
 QPair<int, int> IndexColorPalette::getNeighbours(int mainClr) const
 {
     QVector<float> diffs;
@@ -41,7 +41,6 @@ struct IndexColorPalette
     
     void mergeMostRedundantColors();
     
-    LabColor getNearestIndex(LabColor clr) const;
     int numColors() const;
     float similarity(LabColor c0, LabColor c1) const;
     QPair< int, int > getNeighbours(int mainClr) const;
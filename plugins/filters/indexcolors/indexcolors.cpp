@@ -91,6 +91,19 @@ KisIndexColorTransformation::KisIndexColorTransformation(IndexColorPalette palet
 {
     m_palette = palette;
 
+    QVector<quint16> colors;
+    colors.reserve(3 * m_palette.numColors());
+    for (const LabColor &color : m_palette.colors) {
+        colors << color.L << color.a << color.b;
+    }
+
+    const QVector<float> weights = QVector<float>()
+        << m_palette.similarityFactors.L
+        << m_palette.similarityFactors.a
+        << m_palette.similarityFactors.b;
+
+    m_search.reset(new KisNearestColorSearch(colors, 1, weights));
+
     static const qreal max = KoColorSpaceMathsTraits<quint16>::max;
     if(alphaSteps > 0)
     {
@@ -107,28 +120,27 @@ KisIndexColorTransformation::KisIndexColorTransformation(IndexColorPalette palet
 void KisIndexColorTransformation::transform(const quint8* src, quint8* dst, qint32 nPixels) const
 {
     if (m_palette.numColors() <= 0) {
-        memcpy(dst, src, nPixels * m_colorSpace->pixelSize());
+        memcpy(dst, src, nPixels * m_psize);
         return;
     }
 
-    union
-    {
-        quint16 laba[4];
-        LabColor lab;
-    } clr;
-    while (nPixels--)
+    QVector<quint16> laba(4 * nPixels);
+    m_colorSpace->toLabA16(src, reinterpret_cast<quint8 *>(laba.data()), nPixels);
+
+    for (quint16 *clr = laba.data(); clr != laba.data() + laba.size(); clr += 4)
     {
-        m_colorSpace->toLabA16(src, reinterpret_cast<quint8 *>(clr.laba), 1);
-        clr.lab = m_palette.getNearestIndex(clr.lab);
+        const LabColor &nearest = m_palette.colors[m_search->nearest(clr)];
+        clr[0] = nearest.L;
+        clr[1] = nearest.a;
+        clr[2] = nearest.b;
         if(m_alphaStep)
         {
-            quint16 amod = clr.laba[3] % m_alphaStep;
-            clr.laba[3] = clr.laba[3] + (amod > m_alphaHalfStep ? m_alphaStep - amod : -amod);
+            quint16 amod = clr[3] % m_alphaStep;
+            clr[3] = clr[3] + (amod > m_alphaHalfStep ? m_alphaStep - amod : -amod);
         }
-        m_colorSpace->fromLabA16(reinterpret_cast<quint8 *>(clr.laba), dst, 1);
-        src += m_psize;
-        dst += m_psize;
     }
+
+    m_colorSpace->fromLabA16(reinterpret_cast<const quint8 *>(laba.constData()), dst, nPixels);
 }
 
 #include "indexcolors.moc"
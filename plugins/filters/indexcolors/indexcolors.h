@@ -12,6 +12,9 @@
 #include "filter/kis_color_transformation_filter.h"
 #include "kis_config_widget.h"
 #include <KoColor.h>
+#include <KisNearestColorSearch.h>
+
+#include <QSharedPointer>
 
 #include "indexcolorpalette.h"
 
@@ -46,6 +49,7 @@ private:
     const KoColorSpace* m_colorSpace;
     quint32 m_psize;
     IndexColorPalette m_palette;
+    QSharedPointer<const KisNearestColorSearch> m_search;
     quint16 m_alphaStep;
     quint16 m_alphaHalfStep;
 };
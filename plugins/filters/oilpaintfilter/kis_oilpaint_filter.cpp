@@ -15,6 +15,7 @@
 
 #include <stdlib.h>
 #include <vector>
+#include <algorithm>
 
 #include <QPoint>
 #include <QSpinBox>
@@ -28,7 +29,9 @@
 
 #include <KisDocument.h>
 #include <kis_image.h>
-#include <KisSequentialIteratorProgress.h>
+#include <kis_iterator_ng.h>
+#include <kis_random_accessor_ng.h>
+#include <KisSlidingWindowHistogram.h>
 #include <kis_layer.h>
 #include <filter/kis_filter_registry.h>
 #include <kis_global.h>
@@ -44,7 +47,7 @@
 KisOilPaintFilter::KisOilPaintFilter() : KisFilter(id(), FiltersCategoryArtisticId, i18n("&Oilpaint..."))
 {
     setSupportsPainting(true);
-    setSupportsThreading(false);
+    setSupportsThreading(true);
     setSupportsAdjustmentLayers(true);
 }
 
@@ -67,122 +70,79 @@ void KisOilPaintFilter::processImpl(KisPaintDeviceSP device,
 
 /* Function to apply the OilPaint effect.
  *
- * data             => The image data in RGBA mode.
- * w                => Width of image.
- * h                => Height of image.
  * BrushSize        => Brush size.
  * Smoothness       => Smooth value.
  *
- * Theory           => Using MostFrequentColor function we take the main color in
- *                     a matrix and simply write at the original position.
+ * Theory           => Take the main color in a matrix around every pixel and
+ *                     simply write it at the original position. The main color
+ *                     is the average color of the most frequent intensity in
+ *                     the matrix.
+ *
+ * The intensity histogram of the matrix is not rebuilt for every pixel, it
+ * is updated by KisSlidingWindowHistogram while the matrix slides over the
+ * image, so the cost per pixel grows slowly with the brush size.
  */
 
 void KisOilPaintFilter::OilPaint(const KisPaintDeviceSP src, KisPaintDeviceSP dst, const QRect &applyRect,
                                  int BrushSize, int Smoothness, KoUpdater* progressUpdater) const
 {
-    KisSequentialConstIteratorProgress it(src, applyRect, progressUpdater);
-    KisSequentialIterator dstIt(dst, applyRect);
-
-    while (it.nextPixel() && dstIt.nextPixel()) {
-        MostFrequentColor(src, dstIt.rawData(), applyRect, it.x(), it.y(), BrushSize, Smoothness);
-    }
-}
-
-// This method has been ported from Pieter Z. Voloshyn's algorithm code in Digikam.
-
-/* Function to determine the most frequent color in a matrix
- *
- * Bits             => Bits array
- * Width            => Image width
- * Height           => Image height
- * X                => Position horizontal
- * Y                => Position vertical
- * Radius           => Is the radius of the matrix to be analyzed
- * Intensity        => Intensity to calculate
- *
- * Theory           => This function creates a matrix with the analyzed pixel in
- *                     the center of this matrix and find the most frequent color
- */
+    const KoColorSpace* cs = src->colorSpace();
+    const int channelCount = cs->channelCount();
+    const double Scale = Smoothness / 255.0;
 
-void KisOilPaintFilter::MostFrequentColor(KisPaintDeviceSP src, quint8* dst, const QRect& /*bounds*/, int X, int Y, int Radius, int Intensity) const
-{
-    uint I;
+    KisSlidingWindowHistogram histogram(Smoothness + 1, channelCount);
+    QVector<float> channel(channelCount);
 
-    double Scale = Intensity / 255.0;
+    auto fetchRow = [&] (int x, int y, int width, quint16 *bins, float *values) {
+        KisHLineConstIteratorSP srcIt = src->createHLineConstIteratorNG(x, y, width);
 
-    // Alloc some arrays to be used
-    uchar *IntensityCount = new uchar[(Intensity + 1)];
+        do {
+            const quint8 *data = srcIt->oldRawData();
 
-    const KoColorSpace* cs = src->colorSpace();
+            if (cs->opacityU8(data) == 0) {
+                // if the pixel is transparent, it's not going to provide any useful information
+                *bins = KisSlidingWindowHistogram::skipBin;
+            } else {
+                *bins = (uint)(cs->intensity8(data) * Scale);
 
-    QVector<float> channel(cs->channelCount());
-    QVector<float>* AverageChannels = new QVector<float>[(Intensity + 1)];
+                cs->normalisedChannelsValue(data, channel);
+                std::copy(channel.constBegin(), channel.constEnd(), values);
+            }
 
-    // Erase the array
-    memset(IntensityCount, 0, (Intensity + 1) * sizeof(uchar));
+            bins++;
+            values += channelCount;
+        } while (srcIt->nextPixel());
+    };
 
-    int startx = X - Radius;
-    int starty = Y - Radius;
-    int width = (2 * Radius) + 1;
-    int height = (2 * Radius) + 1;
+    KisRandomConstAccessorSP middlePointIt = src->createRandomConstAccessorNG();
+    KisRandomAccessorSP dstIt = dst->createRandomAccessorNG();
 
-    qreal middlePointAlpha = 1;
-    {
+    auto processPixel = [&] (int x, int y, const KisSlidingWindowHistogram &h) {
         // if the current pixel is transparent, the result must be transparent, too.
-        KisSequentialConstIterator middlePointIt(src, QRect(X, Y, 1, 1));
-        middlePointIt.nextPixel();
-        middlePointAlpha = cs->opacityF(middlePointIt.oldRawData());
-    }
+        middlePointIt->moveTo(x, y);
+        const qreal middlePointAlpha = cs->opacityF(middlePointIt->oldRawData());
 
+        dstIt->moveTo(x, y);
+        quint8 *dstPixel = dstIt->rawData();
 
-    KisSequentialConstIterator srcIt(src, QRect(startx, starty, width, height));
-    while (middlePointAlpha > 0 && srcIt.nextPixel()) {
+        const int I = middlePointAlpha > 0 ? h.mode() : -1;
 
-        cs->normalisedChannelsValue(srcIt.oldRawData(), channel);
+        if (I >= 0) {
+            const int MaxInstance = h.count(I);
+            const double *sums = h.sums(I);
 
-        if (cs->opacityU8(srcIt.oldRawData()) == 0) {
-            // if the pixel is transparent, it's not going to provide any useful information
-            continue;
-        }
-
-        I = (uint)(cs->intensity8(srcIt.oldRawData()) * Scale);
-
-        IntensityCount[I]++;
-
-        if (IntensityCount[I] == 1) {
-            AverageChannels[I] = channel;
-        } else {
-            for (int i = 0; i < channel.size(); i++) {
-                AverageChannels[I][i] += channel[i];
+            for (int i = 0; i < channelCount; i++) {
+                channel[i] = sums[i] / MaxInstance;
             }
+            cs->fromNormalisedChannelsValue(dstPixel, channel);
+            cs->setOpacity(dstPixel, OPACITY_OPAQUE_U8, middlePointAlpha);
+        } else {
+            memset(dstPixel, 0, cs->pixelSize());
+            cs->setOpacity(dstPixel, OPACITY_OPAQUE_U8, middlePointAlpha);
         }
-    }
-
-    I = 0;
-    int MaxInstance = 0;
-
-    for (int i = 0 ; i <= Intensity ; ++i) {
-        if (IntensityCount[i] > MaxInstance) {
-            I = i;
-            MaxInstance = IntensityCount[i];
-        }
-    }
-
-    if (MaxInstance != 0) {
-        channel = AverageChannels[I];
-        for (int i = 0; i < channel.size(); i++) {
-            channel[i] /= MaxInstance;
-        }
-        cs->fromNormalisedChannelsValue(dst, channel);
-        cs->setOpacity(dst, OPACITY_OPAQUE_U8, middlePointAlpha);
-    } else {
-        memset(dst, 0, cs->pixelSize());
-        cs->setOpacity(dst, OPACITY_OPAQUE_U8, middlePointAlpha);
-    }
-
+    };
 
-    delete [] IntensityCount;        // free all the arrays
-    delete [] AverageChannels;
+    histogram.process(applyRect, BrushSize, fetchRow, processPixel, progressUpdater);
 }
 
 QRect KisOilPaintFilter::neededRect(const QRect & rect, const KisFilterConfigurationSP _config, int /*lod*/) const
@@ -202,7 +162,7 @@ QRect KisOilPaintFilter::changedRect(const QRect & rect, const KisFilterConfigur
 KisConfigWidget * KisOilPaintFilter::createConfigurationWidget(QWidget* parent, const KisPaintDeviceSP, bool) const
 {
     vKisIntegerWidgetParam param;
-    param.push_back(KisIntegerWidgetParam(1, 5, 1, i18n("Brush size"), "brushSize"));
+    param.push_back(KisIntegerWidgetParam(1, 25, 1, i18n("Brush size"), "brushSize"));
     param.push_back(KisIntegerWidgetParam(10, 255, 30, i18nc("smooth out the painting strokes the filter creates", "Smooth"), "smooth"));
     KisMultiIntegerFilterWidget * w = new KisMultiIntegerFilterWidget(id().id(),  parent,  id().id(),  param);
     w->setConfiguration(defaultConfiguration(KisGlobalResourcesInterface::instance()));
@@ -23,6 +23,14 @@
 #include <KisDitherUtil.h>
 #include <KisGlobalResourcesInterface.h>
 #include <KoResourceLoadResult.h>
+#include <KisNearestColorSearch.h>
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QSharedPointer>
+
+#include <cmath>
 
 K_PLUGIN_FACTORY_WITH_JSON(PalettizeFactory, "kritapalettize.json", registerPlugin<Palettize>();)
 
@@ -70,6 +78,80 @@ public:
         return palette(resourcesInterface()).resource<KoColorSet>();
     }
 
+    /**
+     * The colors of the palette prepared for the search: every filter job
+     * (one per tile) asks for it, but the search structure is built only
+     * once and then shared by all the jobs
+     */
+    struct PaletteLookup {
+        const KoColorSpace *colorspace = nullptr;
+        const KoColorSpace *workColorspace = nullptr;
+        int maxCount = 0;
+
+        /// the colors converted to the work color space, three channels per color
+        QVector<quint16> searchColors;
+        /// the colors converted to the color space of the device
+        QVector<quint8> colors;
+        /// the indices of the colors in the palette
+        QVector<quint16> indices;
+
+        QSharedPointer<const KisNearestColorSearch> search;
+    };
+    using PaletteLookupSP = QSharedPointer<const PaletteLookup>;
+
+    PaletteLookupSP paletteLookup(const KoColorSetSP palette, const KoColorSpace *colorspace,
+                                  const KoColorSpace *workColorspace, int maxCount) const
+    {
+        QSharedPointer<PaletteLookup> lookup(new PaletteLookup());
+        lookup->colorspace = colorspace;
+        lookup->workColorspace = workColorspace;
+        lookup->maxCount = maxCount;
+
+        QSet<quint64> addedColors;
+
+        quint16 index = 0;
+        for (int row = 0; row < palette->rowCount(); ++row) {
+            for (int column = 0; column < palette->columnCount(); ++column) {
+                KisSwatch swatch = palette->getColorGlobal(column, row);
+                if (swatch.isValid()) {
+                    KoColor color = swatch.color().convertedTo(colorspace);
+                    KoColor workColor = swatch.color().convertedTo(workColorspace);
+                    quint16 searchColor[3];
+                    memcpy(searchColor, workColor.data(), sizeof(searchColor));
+                    // Don't add duplicates so won't dither between identical colors
+                    const quint64 key = quint64(searchColor[0]) << 32 | quint64(searchColor[1]) << 16 | searchColor[2];
+                    if (!addedColors.contains(key)) {
+                        addedColors.insert(key);
+                        lookup->searchColors << searchColor[0] << searchColor[1] << searchColor[2];
+                        const int offset = lookup->colors.size();
+                        lookup->colors.resize(offset + colorspace->pixelSize());
+                        memcpy(lookup->colors.data() + offset, color.data(), colorspace->pixelSize());
+                        lookup->indices.append(index);
+                    }
+                }
+                ++index;
+            }
+        }
+
+        QMutexLocker locker(&m_paletteLookupMutex);
+
+        if (m_paletteLookup &&
+            m_paletteLookup->colorspace == lookup->colorspace &&
+            m_paletteLookup->workColorspace == lookup->workColorspace &&
+            m_paletteLookup->maxCount == lookup->maxCount &&
+            m_paletteLookup->searchColors == lookup->searchColors &&
+            m_paletteLookup->colors == lookup->colors &&
+            m_paletteLookup->indices == lookup->indices) {
+
+            return m_paletteLookup;
+        }
+
+        lookup->search.reset(new KisNearestColorSearch(lookup->searchColors, maxCount));
+        m_paletteLookup = lookup;
+
+        return m_paletteLookup;
+    }
+
     QList<KoResourceLoadResult> linkedResources(KisResourcesInterfaceSP globalResourcesInterface) const override
     {
 
@@ -81,6 +163,10 @@ public:
 
         return resources;
     }
+
+private:
+    mutable QMutex m_paletteLookupMutex;
+    mutable PaletteLookupSP m_paletteLookup;
 };
 
 /*******************************************************************************/
@@ -241,36 +327,12 @@ void KisFilterPalettize::processImpl(KisPaintDeviceSP device, const QRect& apply
                                               ? KoColorSpaceRegistry::instance()->lab16()
                                               : KoColorSpaceRegistry::instance()->rgb16("sRGB-elle-V2-srgbtrc.icc"));
 
-    const quint8 colorCount = ditherEnabled && colorMode == ColorMode::NearestColors ? 2 : 1;
-
-    using SearchColor = boost::geometry::model::point<quint16, 3, boost::geometry::cs::cartesian>;
-    struct ColorCandidate {
-        KoColor color;
-        quint16 index;
-        double distance;
-    };
-    using SearchEntry = std::pair<SearchColor, ColorCandidate>;
-    boost::geometry::index::rtree<SearchEntry, boost::geometry::index::quadratic<16>> rtree;
+    const int colorCount = ditherEnabled && colorMode == ColorMode::NearestColors ? 2 : 1;
 
     if (palette) {
-        // Add palette colors to search tree
-        quint16 index = 0;
-        for (int row = 0; row < palette->rowCount(); ++row) {
-            for (int column = 0; column < palette->columnCount(); ++column) {
-                KisSwatch swatch = palette->getColorGlobal(column, row);
-                if (swatch.isValid()) {
-                    KoColor color = swatch.color().convertedTo(colorspace);
-                    KoColor workColor = swatch.color().convertedTo(workColorspace);
-                    SearchColor searchColor;
-                    memcpy(&searchColor, workColor.data(), sizeof(SearchColor));
-                    // Don't add duplicates so won't dither between identical colors
-                    std::vector<SearchEntry> result;
-                    rtree.query(boost::geometry::index::contains(searchColor), std::back_inserter(result));
-                    if (result.empty()) rtree.insert(SearchEntry(searchColor, {color, index, 0.0}));
-                }
-                ++index;
-            }
-        }
+        const KisFilterPalettizeConfiguration::PaletteLookupSP lookup =
+            config->paletteLookup(palette, colorspace, workColorspace, colorCount);
+        if (lookup->indices.isEmpty()) return;
 
         KisDitherUtil ditherUtil;
         if (ditherEnabled) ditherUtil.setConfiguration(*config, "dither/");
@@ -278,70 +340,101 @@ void KisFilterPalettize::processImpl(KisPaintDeviceSP device, const QRect& apply
         KisDitherUtil alphaDitherUtil;
         if (alphaMode == AlphaMode::Dither) alphaDitherUtil.setConfiguration(*config, "alphaDither/");
 
-        KisSequentialIteratorProgress pixel(device, applyRect, progressUpdater);
-        while (pixel.nextPixel()) {
-            KoColor workColor(pixel.oldRawData(), colorspace);
-            workColor.convertTo(workColorspace);
-
-            // Find dither threshold
-            double threshold = 0.5;
-            if (ditherEnabled) {
-                threshold = ditherUtil.threshold(QPoint(pixel.x(), pixel.y()));
-
-                // Traditional per-channel ordered dithering
-                if (colorMode == ColorMode::PerChannelOffset) {
-                    QVector<float> normalized(int(workColorspace->channelCount()));
-                    workColorspace->normalisedChannelsValue(workColor.data(), normalized);
-                    for (int channel = 0; channel < int(workColorspace->channelCount()); ++channel) {
-                        normalized[channel] += (threshold - 0.5) * offsetScale;
+        const int pixelSize = colorspace->pixelSize();
+        const int workPixelSize = workColorspace->pixelSize();
+        QVector<quint8> workPixels;
+        QVector<float> normalized(int(workColorspace->channelCount()));
+
+        // Without dithering the result depends on the source pixel only, so
+        // the runs of equal pixels (common in pixel art) are searched once
+        QVector<quint8> lastSrcPixel(pixelSize);
+        QVector<quint8> lastDstPixel(pixelSize);
+        bool hasLastPixel = false;
+
+        KisSequentialIteratorProgress it(device, applyRect, progressUpdater);
+        int numConseqPixels = it.nConseqPixels();
+        while (it.nextPixels(numConseqPixels)) {
+            numConseqPixels = it.nConseqPixels();
+
+            const quint8 *src = it.oldRawData();
+            quint8 *dst = it.rawData();
+
+            workPixels.resize(numConseqPixels * workPixelSize);
+            colorspace->convertPixelsTo(src, workPixels.data(), workColorspace, numConseqPixels,
+                                        KoColorConversionTransformation::internalRenderingIntent(),
+                                        KoColorConversionTransformation::internalConversionFlags());
+
+            for (int i = 0; i < numConseqPixels; ++i) {
+                const quint8 *srcPixel = src + i * pixelSize;
+                quint8 *dstPixel = dst + i * pixelSize;
+                quint8 *workPixel = workPixels.data() + i * workPixelSize;
+                const QPoint pos(it.x() + i, it.y());
+
+                if (!ditherEnabled) {
+                    if (hasLastPixel && !memcmp(srcPixel, lastSrcPixel.constData(), pixelSize)) {
+                        memcpy(dstPixel, lastDstPixel.constData(), pixelSize);
+                        continue;
                     }
-                    workColorspace->fromNormalisedChannelsValue(workColor.data(), normalized);
+                    memcpy(lastSrcPixel.data(), srcPixel, pixelSize);
                 }
-            }
 
-            // Get candidate colors and their distances
-            SearchColor searchColor;
-            memcpy(reinterpret_cast<quint8 *>(&searchColor), workColor.data(), sizeof(SearchColor));
-            std::vector<ColorCandidate> candidateColors;
-            candidateColors.reserve(size_t(colorCount));
-            double distanceSum = 0.0;
-            for (auto it = rtree.qbegin(boost::geometry::index::nearest(searchColor, colorCount)); it != rtree.qend() && candidateColors.size() < colorCount; ++it) {
-                ColorCandidate candidate = it->second;
-                candidate.distance = boost::geometry::distance(searchColor, it->first);
-                candidateColors.push_back(candidate);
-                distanceSum += candidate.distance;
-            }
+                // Find dither threshold
+                double threshold = 0.5;
+                if (ditherEnabled) {
+                    threshold = ditherUtil.threshold(pos);
+
+                    // Traditional per-channel ordered dithering
+                    if (colorMode == ColorMode::PerChannelOffset) {
+                        workColorspace->normalisedChannelsValue(workPixel, normalized);
+                        for (int channel = 0; channel < int(workColorspace->channelCount()); ++channel) {
+                            normalized[channel] += (threshold - 0.5) * offsetScale;
+                        }
+                        workColorspace->fromNormalisedChannelsValue(workPixel, normalized);
+                    }
+                }
 
-            // Select color candidate
-            quint16 selected;
-            if (ditherEnabled && colorMode == ColorMode::NearestColors) {
-                // Sort candidates by palette order for stable dither color ordering
-                const bool swap = candidateColors[0].index > candidateColors[1].index;
-                selected = swap ^ (candidateColors[swap].distance / distanceSum > threshold);
-            }
-            else {
-                selected = 0;
-            }
-            ColorCandidate &candidate = candidateColors[selected];
-
-            // Set alpha
-            const double oldAlpha = colorspace->opacityF(pixel.oldRawData());
-            double newAlpha = oldAlpha;
-            if (alphaEnabled && !(!ditherEnabled && alphaMode == AlphaMode::Dither)) {
-                if (alphaMode == AlphaMode::Clip) {
-                    newAlpha = oldAlpha < alphaClip? 0.0 : 1.0;
+                // Get candidate colors and their distances
+                int candidates[2];
+                float squaredDistances[2];
+                const int found = lookup->search->nearest(reinterpret_cast<const quint16 *>(workPixel),
+                                                          colorCount, candidates, squaredDistances);
+
+                // Select color candidate
+                int selected = candidates[0];
+                if (ditherEnabled && colorMode == ColorMode::NearestColors && found == 2) {
+                    const double distances[2] = {std::sqrt(double(squaredDistances[0])),
+                                                 std::sqrt(double(squaredDistances[1]))};
+                    const double distanceSum = distances[0] + distances[1];
+
+                    // Sort candidates by palette order for stable dither color ordering
+                    const bool swap = lookup->indices[candidates[0]] > lookup->indices[candidates[1]];
+                    selected = candidates[swap ^ (distances[swap] / distanceSum > threshold)];
                 }
-                else if (alphaMode == AlphaMode::Index) {
-                    newAlpha = (candidate.index == alphaIndex ? 0.0 : 1.0);
+
+                // Set alpha
+                const double oldAlpha = colorspace->opacityF(srcPixel);
+                double newAlpha = oldAlpha;
+                if (alphaEnabled && !(!ditherEnabled && alphaMode == AlphaMode::Dither)) {
+                    if (alphaMode == AlphaMode::Clip) {
+                        newAlpha = oldAlpha < alphaClip? 0.0 : 1.0;
+                    }
+                    else if (alphaMode == AlphaMode::Index) {
+                        newAlpha = (lookup->indices[selected] == alphaIndex ? 0.0 : 1.0);
+                    }
+                    else if (alphaMode == AlphaMode::Dither) {
+                        newAlpha = oldAlpha < alphaDitherUtil.threshold(pos) ? 0.0 : 1.0;
+                    }
                 }
-                else if (alphaMode == AlphaMode::Dither) {
-                    newAlpha = oldAlpha < alphaDitherUtil.threshold(QPoint(pixel.x(), pixel.y())) ? 0.0 : 1.0;
+
+                // Copy color to pixel
+                memcpy(dstPixel, lookup->colors.constData() + selected * pixelSize, pixelSize);
+                colorspace->setOpacity(dstPixel, newAlpha, 1);
+
+                if (!ditherEnabled) {
+                    memcpy(lastDstPixel.data(), dstPixel, pixelSize);
+                    hasLastPixel = true;
                 }
             }
-            colorspace->setOpacity(candidate.color.data(), newAlpha, 1);
-
-            // Copy color to pixel
-            memcpy(pixel.rawData(), candidate.color.data(), colorspace->pixelSize());
         }
     }
 }
@@ -38,10 +38,17 @@
 
 #include "widgets/kis_multi_integer_filter_widget.h"
 #include <KoMixColorsOp.h>
+#include <KisSummedAreaTable.h>
 #include <KisSequentialIteratorProgress.h>
 #include "kis_algebra_2d.h"
 #include "kis_lod_transform.h"
 
+namespace {
+/**
+ * The approximate size of the tiles the blocks are grouped into
+ */
+const int tileSize = 256;
+}
 
 KisPixelizeFilter::KisPixelizeFilter() : KisFilter(id(), FiltersCategoryArtisticId, i18n("&Pixelize..."))
 {
@@ -83,6 +90,55 @@ void KisPixelizeFilter::processImpl(KisPaintDeviceSP device,
 
     progressUpdater->setRange(firstRow, lastRow);
 
+    if (KisSummedAreaTable::isSupported(device->colorSpace())) {
+        /**
+         * The blocks are grouped into tiles. The summed-area table of a
+         * tile is built in a single pass over its pixels, after that the
+         * mean of every block takes four lookups and the tile is filled in
+         * another single pass, so no iterators are created per block.
+         */
+        const int blocksPerTileX = qMax(1, tileSize / pixelWidth);
+        const int blocksPerTileY = qMax(1, tileSize / pixelHeight);
+
+        for (qint32 i = firstRow; i <= lastRow; i += blocksPerTileY) {
+            const qint32 numRows = qMin(blocksPerTileY, lastRow - i + 1);
+
+            for (qint32 j = firstCol; j <= lastCol; j += blocksPerTileX) {
+                const qint32 numCols = qMin(blocksPerTileX, lastCol - j + 1);
+
+                const QRect tileRect =
+                    QRect(j * pixelWidth, i * pixelHeight,
+                          numCols * pixelWidth, numRows * pixelHeight) & deviceBounds;
+                const QRect writeRect = tileRect & applyRect;
+                if (writeRect.isEmpty()) continue;
+
+                KisSummedAreaTable table(device, tileRect);
+                QVector<quint8> blockColors(numRows * numCols * pixelSize);
+
+                for (int row = 0; row < numRows; row++) {
+                    for (int col = 0; col < numCols; col++) {
+                        const QRect blockRect((j + col) * pixelWidth, (i + row) * pixelHeight,
+                                              pixelWidth, pixelHeight);
+
+                        table.meanPixel(blockRect, blockColors.data() + (row * numCols + col) * pixelSize);
+                    }
+                }
+
+                KisSequentialIterator dstIt(device, writeRect);
+                while (dstIt.nextPixel()) {
+                    const int col = divideFloor(dstIt.x(), pixelWidth) - j;
+                    const int row = divideFloor(dstIt.y(), pixelHeight) - i;
+
+                    memcpy(dstIt.rawData(), blockColors.constData() + (row * numCols + col) * pixelSize, pixelSize);
+                }
+            }
+
+            progressUpdater->setValue(i + numRows - 1);
+        }
+
+        return;
+    }
+
     for(qint32 i = firstRow; i <= lastRow; i++) {
         for(qint32 j = firstCol; j <= lastCol; j++) {
             const QRect maxPatchRect(j * pixelWidth, i * pixelHeight,
@@ -0,0 +1,158 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisColorSmudgeDabPipeline.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQueue>
+
+#include "kis_assert.h"
+#include "KisRunnableStrokeJobsInterface.h"
+#include "KisRunnableStrokeJobData.h"
+#include <tool/strokes/FreehandStrokeRunnableJobDataWithUpdate.h>
+#include <KisPerformanceTracer.h>
+
+namespace {
+/**
+ * When the blending of the dabs is slower than preparing of the masks,
+ * the queue would grow infinitely. After the limit is reached, the
+ * stroke's thread blends the dabs itself, which throttles the producer.
+ */
+const int maxQueuedDabs = 16;
+}
+
+struct KisColorSmudgeDabPipeline::Private
+{
+    KisColorSmudgeStrategy *strategy = 0;
+    KisRunnableStrokeJobsInterface *runnableJobsInterface = 0;
+
+    /// serializes the blending stage of the drain job and the
+    /// throttled stroke's thread
+    QMutex blendingMutex;
+
+    /// protects the fields below
+    mutable QMutex queueMutex;
+    QQueue<Request> queue;
+    int numPendingDabs = 0;
+    QVector<QRect> dirtyRects;
+
+    /// a drain job is queued or running
+    bool drainJobActive = false;
+};
+
+KisColorSmudgeDabPipeline::KisColorSmudgeDabPipeline(KisColorSmudgeStrategy *strategy,
+                                                     KisRunnableStrokeJobsInterface *runnableJobsInterface)
+    : m_d(new Private)
+{
+    KIS_SAFE_ASSERT_RECOVER_NOOP(runnableJobsInterface);
+
+    m_d->strategy = strategy;
+    m_d->runnableJobsInterface = runnableJobsInterface;
+}
+
+KisColorSmudgeDabPipeline::~KisColorSmudgeDabPipeline()
+{
+}
+
+void KisColorSmudgeDabPipeline::addDab(const Request &request)
+{
+    int numQueuedDabs = 0;
+    bool needsDrainJob = false;
+
+    {
+        QMutexLocker l(&m_d->queueMutex);
+
+        m_d->queue.enqueue(request);
+        m_d->queue.last().dab.detach();
+        m_d->numPendingDabs++;
+
+        numQueuedDabs = m_d->queue.size();
+
+        needsDrainJob = !m_d->drainJobActive;
+        m_d->drainJobActive = true;
+    }
+
+    /**
+     * A single job blends all the queued dabs one by one and exits when
+     * the queue becomes empty. Queueing a job per dab would occupy a worker
+     * thread per dab, all of them but one waiting for the blending lock,
+     * and would starve the update jobs sharing the thread pool.
+     */
+    if (needsDrainJob) {
+        m_d->runnableJobsInterface->addRunnableJob(
+            new FreehandStrokeRunnableJobDataWithUpdate(
+                [this] () {
+                    KIS_TRACE_SCOPE("paintop", "KisColorSmudgeDabPipeline::drain");
+                    while (this->processNextDab(true));
+                },
+                KisStrokeJobData::CONCURRENT));
+    }
+
+    if (numQueuedDabs > maxQueuedDabs) {
+        processNextDab(false);
+    }
+}
+
+bool KisColorSmudgeDabPipeline::processNextDab(bool isDrainJob)
+{
+    KIS_TRACE_SCOPE("paintop", "KisColorSmudgeDabPipeline::processNextDab");
+
+    /**
+     * The dab is taken from the queue under the blending lock, so the
+     * dabs are blended in the order they were added, even when the stroke's
+     * thread blends a dab itself while the drain job is running.
+     */
+    QMutexLocker blendingLocker(&m_d->blendingMutex);
+
+    Request request;
+
+    {
+        QMutexLocker l(&m_d->queueMutex);
+        if (m_d->queue.isEmpty()) {
+            /**
+             * The flag is reset under the same lock the dabs are queued
+             * with, so a dab added right after that gets a new drain job
+             */
+            if (isDrainJob) {
+                m_d->drainJobActive = false;
+            }
+            return false;
+        }
+        request = m_d->queue.dequeue();
+    }
+
+    const QVector<QRect> rects =
+        m_d->strategy->paintDab(request.dab,
+                                request.srcRect, request.dstRect,
+                                request.paintColor,
+                                request.opacity, request.colorRate,
+                                request.smudgeRate,
+                                request.maxSmudgeRate,
+                                request.paintThickness,
+                                request.smudgeRadius);
+
+    QMutexLocker l(&m_d->queueMutex);
+    m_d->dirtyRects += rects;
+    m_d->numPendingDabs--;
+
+    return true;
+}
+
+bool KisColorSmudgeDabPipeline::hasPendingDabs() const
+{
+    QMutexLocker l(&m_d->queueMutex);
+    return m_d->numPendingDabs > 0;
+}
+
+QVector<QRect> KisColorSmudgeDabPipeline::takeDirtyRects()
+{
+    QMutexLocker l(&m_d->queueMutex);
+
+    QVector<QRect> rects;
+    std::swap(rects, m_d->dirtyRects);
+    return rects;
+}
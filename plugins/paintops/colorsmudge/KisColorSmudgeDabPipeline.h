@@ -0,0 +1,92 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISCOLORSMUDGEDABPIPELINE_H
+#define KISCOLORSMUDGEDABPIPELINE_H
+
+#include <QScopedPointer>
+#include <QRect>
+#include <QVector>
+
+#include <KoColor.h>
+
+#include "KisColorSmudgeStrategy.h"
+
+class KisRunnableStrokeJobsInterface;
+
+/**
+ * Splits the rendering of the color smudge dabs into two stages:
+ *
+ * 1) The dab mask is generated and all the per-dab options are computed
+ *    in KisColorSmudgeOp::paintAt(), i.e. in the stroke's own thread.
+ *
+ * 2) Sampling, smearing, blending of the color rate and writing into the
+ *    device happen in a single concurrent drain job, which blends the
+ *    queued dabs one by one until the queue is empty.
+ *
+ * Therefore, the mask of dab N+1 is prepared while dab N is still being
+ * blended in a worker thread.
+ *
+ * Every smudge dab reads the pixels written by the previous one, and the
+ * strategies reuse their blending buffers, so the second stage of the
+ * dabs is executed strictly in the order the dabs were added.
+ *
+ * The dirty rects of the blended dabs are collected by the pipeline and
+ * should be fetched by the paintop in doAsynchronousUpdate().
+ */
+class KisColorSmudgeDabPipeline
+{
+public:
+    struct Request
+    {
+        KisColorSmudgeStrategy::Dab dab;
+        QRect srcRect;
+        QRect dstRect;
+        KoColor paintColor;
+        qreal opacity = 1.0;
+        qreal colorRate = 0.0;
+        qreal smudgeRate = 1.0;
+        qreal maxSmudgeRate = 1.0;
+        qreal paintThickness = 1.0;
+        qreal smudgeRadius = 0.0;
+    };
+
+public:
+    KisColorSmudgeDabPipeline(KisColorSmudgeStrategy *strategy,
+                              KisRunnableStrokeJobsInterface *runnableJobsInterface);
+    ~KisColorSmudgeDabPipeline();
+
+    /**
+     * Queues the dab for blending. The dab is detached from the buffers
+     * of the dab cache, so the next dab can be prepared right away.
+     */
+    void addDab(const Request &request);
+
+    /**
+     * \return true if some dabs are queued or are being blended right now
+     */
+    bool hasPendingDabs() const;
+
+    /**
+     * \return the dirty rects of the dabs blended since the previous call
+     */
+    QVector<QRect> takeDirtyRects();
+
+private:
+    /**
+     * Blends the oldest queued dab. \p isDrainJob tells if the
+     * call comes from the drain job or from the throttled stroke.
+     *
+     * \return false if the queue was empty
+     */
+    bool processNextDab(bool isDrainJob);
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISCOLORSMUDGEDABPIPELINE_H
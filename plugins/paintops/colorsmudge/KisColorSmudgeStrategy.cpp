@@ -6,7 +6,22 @@
 
 #include "KisColorSmudgeStrategy.h"
 
+#include "kis_fixed_paint_device.h"
+
 KisColorSmudgeStrategy::KisColorSmudgeStrategy()
         : m_memoryAllocator(new KisOptimizedByteArray::PooledMemoryAllocator())
 {
 }
+
+void KisColorSmudgeStrategy::Dab::detach()
+{
+    if (maskDab) {
+        maskDab = new KisFixedPaintDevice(*maskDab);
+    }
+
+    if (origDab) {
+        origDab = new KisFixedPaintDevice(*origDab);
+    }
+
+    shouldPreserve = false;
+}
@@ -12,6 +12,32 @@
 
 class KisColorSmudgeStrategy
 {
+public:
+    /**
+     * The dab prepared by updateMask(). The strategy keeps no per-dab
+     * state between updateMask() and paintDab(), so the next dab can be
+     * prepared while the previous one is still being painted.
+     */
+    struct Dab
+    {
+        KisFixedPaintDeviceSP maskDab;
+
+        /// the colored stamp or the lightness map of the dab, if the
+        /// strategy uses it
+        KisFixedPaintDeviceSP origDab;
+
+        /// the devices are shared with the dab cache and should not be
+        /// modified in place when rendering mirrored dabs
+        bool shouldPreserve = true;
+
+        /**
+         * Makes the dab independent from the buffers of the dab cache and
+         * the strategy, which are reused for the next dab. The data of
+         * fixed paint devices is copy-on-write, so the call is cheap.
+         */
+        void detach();
+    };
+
 public:
     KisColorSmudgeStrategy();
 
@@ -19,14 +45,15 @@ public:
 
     virtual void initializePainting() = 0;
 
-    virtual void updateMask(KisDabCache *dabCache,
-                            const KisPaintInformation& info,
-                            const KisDabShape &shape,
-                            const QPointF &cursorPoint,
-                            QRect *dstDabRect,
-                            qreal lightnessStrength) = 0;
+    virtual Dab updateMask(KisDabCache *dabCache,
+                           const KisPaintInformation& info,
+                           const KisDabShape &shape,
+                           const QPointF &cursorPoint,
+                           QRect *dstDabRect,
+                           qreal lightnessStrength) = 0;
 
-    virtual QVector<QRect> paintDab(const QRect &srcRect, const QRect &dstRect,
+    virtual QVector<QRect> paintDab(const Dab &dab,
+                                    const QRect &srcRect, const QRect &dstRect,
                                     const KoColor &currentPaintColor,
                                     qreal opacity,
                                     qreal colorRateValue,
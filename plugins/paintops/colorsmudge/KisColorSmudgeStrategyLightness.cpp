@@ -87,9 +87,10 @@ KisColorSmudgeStrategyBase::DabColoringStrategy &KisColorSmudgeStrategyLightness
     return m_coloringStrategy;
 }
 
-void KisColorSmudgeStrategyLightness::updateMask(KisDabCache *dabCache, const KisPaintInformation &info,
-                                                 const KisDabShape &shape, const QPointF &cursorPoint,
-                                                 QRect *dstDabRect, qreal paintThickness)
+KisColorSmudgeStrategy::Dab
+KisColorSmudgeStrategyLightness::updateMask(KisDabCache *dabCache, const KisPaintInformation &info,
+                                            const KisDabShape &shape, const QPointF &cursorPoint,
+                                            QRect *dstDabRect, qreal paintThickness)
 {
     m_origDab = dabCache->fetchNormalizedImageDab(m_origDab->colorSpace(),
                                                   cursorPoint,
@@ -98,13 +99,13 @@ void KisColorSmudgeStrategyLightness::updateMask(KisDabCache *dabCache, const Ki
                                                   1.0,
                                                   dstDabRect);
 
-    m_shouldPreserveOriginalDab = !dabCache->needSeparateOriginal();
+    bool shouldPreserveOriginalDab = !dabCache->needSeparateOriginal();
 
     const int numPixels = m_origDab->bounds().width() * m_origDab->bounds().height();
 
     if (paintThickness < 1.0) {
-        if (m_shouldPreserveOriginalDab) {
-            m_shouldPreserveOriginalDab = false;
+        if (shouldPreserveOriginalDab) {
+            shouldPreserveOriginalDab = false;
             m_origDab = new KisFixedPaintDevice(*m_origDab);
         }
 
@@ -132,10 +133,17 @@ void KisColorSmudgeStrategyLightness::updateMask(KisDabCache *dabCache, const Ki
     m_maskDab->setRect(m_origDab->bounds());
     m_maskDab->lazyGrowBufferWithoutInitialization();
     m_origDab->colorSpace()->copyOpacityU8(m_origDab->data(), m_maskDab->data(), numPixels);
+
+    Dab dab;
+    dab.maskDab = m_maskDab;
+    dab.origDab = m_origDab;
+    dab.shouldPreserve = shouldPreserveOriginalDab;
+
+    return dab;
 }
 
 QVector<QRect>
-KisColorSmudgeStrategyLightness::paintDab(const QRect &srcRect, const QRect &dstRect, const KoColor &currentPaintColor,
+KisColorSmudgeStrategyLightness::paintDab(const Dab &dab, const QRect &srcRect, const QRect &dstRect, const KoColor &currentPaintColor,
                                           qreal opacity, qreal colorRateValue, qreal smudgeRateValue,
                                           qreal maxPossibleSmudgeRateValue, qreal paintThicknessValue,
                                           qreal smudgeRadiusValue)
@@ -152,7 +160,7 @@ KisColorSmudgeStrategyLightness::paintDab(const QRect &srcRect, const QRect &dst
 
     blendBrush({ &m_finalPainter },
         m_sourceWrapperDevice,
-        m_maskDab, m_shouldPreserveOriginalDab,
+        dab.maskDab, dab.shouldPreserve,
         srcRect, dstRect,
         currentPaintColor,
         opacity,
@@ -168,8 +176,8 @@ KisColorSmudgeStrategyLightness::paintDab(const QRect &srcRect, const QRect &dst
         1.0 : KisAlgebra2D::lerp(overlaySmearRate, 1.0, paintThicknessValue);
     const qreal brushHeightmapOpacity = opacity * overlayAdjustment;
     m_heightmapPainter.setOpacityF(brushHeightmapOpacity);
-    m_heightmapPainter.bltFixed(dstRect.topLeft(), m_origDab, m_origDab->bounds());
-    m_heightmapPainter.renderMirrorMaskSafe(dstRect, m_origDab, m_shouldPreserveOriginalDab);
+    m_heightmapPainter.bltFixed(dstRect.topLeft(), dab.origDab, dab.origDab->bounds());
+    m_heightmapPainter.renderMirrorMaskSafe(dstRect, dab.origDab, dab.shouldPreserve);
 
 
     KisFixedPaintDeviceSP tempColorDevice =
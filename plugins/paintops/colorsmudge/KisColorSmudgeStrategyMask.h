@@ -20,12 +20,12 @@ public:
 
     DabColoringStrategy &coloringStrategy() override;
 
-    void updateMask(KisDabCache *dabCache,
-                    const KisPaintInformation& info,
-                    const KisDabShape &shape,
-                    const QPointF &cursorPoint,
-                    QRect *dstDabRect, 
-                    qreal lightnessStrength) override;
+    Dab updateMask(KisDabCache *dabCache,
+                   const KisPaintInformation& info,
+                   const KisDabShape &shape,
+                   const QPointF &cursorPoint,
+                   QRect *dstDabRect,
+                   qreal lightnessStrength) override;
 
 private:
     DabColoringStrategyMask m_coloringStrategy;
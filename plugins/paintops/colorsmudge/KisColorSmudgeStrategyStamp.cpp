@@ -6,6 +6,8 @@
 
 #include "KisColorSmudgeStrategyStamp.h"
 
+#include <KoColorSpaceRegistry.h>
+
 #include "kis_fixed_paint_device.h"
 #include "kis_image.h"
 #include "KisOverlayPaintDeviceWrapper.h"
@@ -15,6 +17,7 @@ KisColorSmudgeStrategyStamp::KisColorSmudgeStrategyStamp(KisPainter *painter, Ki
                                                          bool useDullingMode, bool useOverlayMode)
         : KisColorSmudgeStrategyWithOverlay(painter, image, smearAlpha, useDullingMode, useOverlayMode)
         , m_origDab(new KisFixedPaintDevice(m_layerOverlayDevice->overlayColorSpace())) // TODO: check compositionSourceColorSpace!
+        , m_maskDab(new KisFixedPaintDevice(KoColorSpaceRegistry::instance()->alpha8()))
 {
 }
 
@@ -23,8 +26,9 @@ KisColorSmudgeStrategyBase::DabColoringStrategy &KisColorSmudgeStrategyStamp::co
     return m_coloringStrategy;
 }
 
-void KisColorSmudgeStrategyStamp::updateMask(KisDabCache *dabCache, const KisPaintInformation &info,
-                                             const KisDabShape &shape, const QPointF &cursorPoint, QRect *dstDabRect, qreal lightnessStrength)
+KisColorSmudgeStrategy::Dab
+KisColorSmudgeStrategyStamp::updateMask(KisDabCache *dabCache, const KisPaintInformation &info,
+                                        const KisDabShape &shape, const QPointF &cursorPoint, QRect *dstDabRect, qreal lightnessStrength)
 {
 
     static KoColor color(Qt::black, m_origDab->colorSpace());
@@ -38,13 +42,32 @@ void KisColorSmudgeStrategyStamp::updateMask(KisDabCache *dabCache, const KisPai
                                    dstDabRect,
                                    lightnessStrength);
 
-    m_coloringStrategy.setStampDab(m_origDab);
-
     const int numPixels = m_origDab->bounds().width() * m_origDab->bounds().height();
 
     m_maskDab->setRect(m_origDab->bounds());
     m_maskDab->lazyGrowBufferWithoutInitialization();
     m_origDab->colorSpace()->copyOpacityU8(m_origDab->data(), m_maskDab->data(), numPixels);
 
-    m_shouldPreserveMaskDab = false;
+    Dab dab;
+    dab.maskDab = m_maskDab;
+    dab.origDab = m_origDab;
+    dab.shouldPreserve = false;
+
+    return dab;
+}
+
+QVector<QRect> KisColorSmudgeStrategyStamp::paintDab(const Dab &dab,
+                                                     const QRect &srcRect, const QRect &dstRect,
+                                                     const KoColor &currentPaintColor, qreal opacity,
+                                                     qreal colorRateValue, qreal smudgeRateValue,
+                                                     qreal maxPossibleSmudgeRateValue,
+                                                     qreal lightnessStrengthValue, qreal smudgeRadiusValue)
+{
+    m_coloringStrategy.setStampDab(dab.origDab);
+
+    return KisColorSmudgeStrategyWithOverlay::paintDab(dab, srcRect, dstRect,
+                                                       currentPaintColor, opacity,
+                                                       colorRateValue, smudgeRateValue,
+                                                       maxPossibleSmudgeRateValue,
+                                                       lightnessStrengthValue, smudgeRadiusValue);
 }
@@ -19,15 +19,20 @@ struct KisColorSmudgeStrategyStamp : public KisColorSmudgeStrategyWithOverlay
 
     DabColoringStrategy &coloringStrategy() override;
 
-    void updateMask(KisDabCache *dabCache,
-                    const KisPaintInformation& info,
-                    const KisDabShape &shape,
-                    const QPointF &cursorPoint,
-                    QRect *dstDabRect,
-                    qreal lightnessStrength) override;
+    Dab updateMask(KisDabCache *dabCache,
+                   const KisPaintInformation& info,
+                   const KisDabShape &shape,
+                   const QPointF &cursorPoint,
+                   QRect *dstDabRect,
+                   qreal lightnessStrength) override;
+
+    QVector<QRect> paintDab(const Dab &dab, const QRect &srcRect, const QRect &dstRect, const KoColor &currentPaintColor, qreal opacity,
+                            qreal colorRateValue, qreal smudgeRateValue, qreal maxPossibleSmudgeRateValue,
+                            qreal lightnessStrengthValue, qreal smudgeRadiusValue) override;
 
 private:
     KisFixedPaintDeviceSP m_origDab;
+    KisFixedPaintDeviceSP m_maskDab;
     DabColoringStrategyStamp m_coloringStrategy;
 };
 
@@ -26,13 +26,11 @@ public:
 
     QVector<KisPainter*> finalPainters();
 
-    QVector<QRect> paintDab(const QRect &srcRect, const QRect &dstRect, const KoColor &currentPaintColor, qreal opacity,
+    QVector<QRect> paintDab(const Dab &dab, const QRect &srcRect, const QRect &dstRect, const KoColor &currentPaintColor, qreal opacity,
                             qreal colorRateValue, qreal smudgeRateValue, qreal maxPossibleSmudgeRateValue,
                             qreal lightnessStrengthValue, qreal smudgeRadiusValue) override;
 
 protected:
-    KisFixedPaintDeviceSP m_maskDab;
-    bool m_shouldPreserveMaskDab = true;
     QScopedPointer<KisOverlayPaintDeviceWrapper> m_layerOverlayDevice;
 
 private:
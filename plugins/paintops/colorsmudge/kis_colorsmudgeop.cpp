@@ -29,6 +29,7 @@
 #include "KisColorSmudgeStrategyMask.h"
 #include "KisColorSmudgeStrategyStamp.h"
 #include "KisColorSmudgeStrategyMaskLegacy.h"
+#include "KisColorSmudgeDabPipeline.h"
 
 struct ColorSmudgeInterstrokeDataFactory : public KisInterstrokeDataFactory
 {
@@ -111,6 +112,16 @@ KisColorSmudgeOp::KisColorSmudgeOp(const KisPaintOpSettingsSP settings, KisPaint
     }
 
     m_strategy->initializePainting();
+
+    /**
+     * Without the jobs interface (e.g. when the paintop is used outside
+     * of a stroke) the dabs are blended synchronously in paintAt()
+     */
+    if (painter->runnableStrokeJobsInterface()) {
+        m_dabPipeline.reset(new KisColorSmudgeDabPipeline(m_strategy.data(),
+                                                          painter->runnableStrokeJobsInterface()));
+    }
+
     m_paintColor = painter->paintColor().convertedTo(m_strategy->preciseColorSpace());
 
     m_hsvOptions.append(KisHSVOption::createHueOption(settings.data()));
@@ -179,7 +190,8 @@ KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
 
 
     const qreal paintThickness = m_paintThicknessOption.apply(info);
-    m_strategy->updateMask(m_dabCache, info, shape, scatteredPos, &m_dstDabRect, paintThickness);
+    const KisColorSmudgeStrategy::Dab dab =
+        m_strategy->updateMask(m_dabCache, info, shape, scatteredPos, &m_dstDabRect, paintThickness);
 
     QPointF newCenterPos = QRectF(m_dstDabRect).center();
     /**
@@ -213,20 +225,48 @@ KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
         m_hsvTransform->transform(paintColor.data(), paintColor.data(), 1);
     }
 
-    const QVector<QRect> dirtyRects =
-            m_strategy->paintDab(srcDabRect, m_dstDabRect,
-                                 paintColor,
-                                 fpOpacity, colorRate,
-                                 smudgeRate,
-                                 maxSmudgeRate,
-                                 paintThickness,
-                                 smudgeRadiusPortion);
-
-    painter()->addDirtyRects(dirtyRects);
+    if (m_dabPipeline) {
+        KisColorSmudgeDabPipeline::Request request;
+        request.dab = dab;
+        request.srcRect = srcDabRect;
+        request.dstRect = m_dstDabRect;
+        request.paintColor = paintColor;
+        request.opacity = fpOpacity;
+        request.colorRate = colorRate;
+        request.smudgeRate = smudgeRate;
+        request.maxSmudgeRate = maxSmudgeRate;
+        request.paintThickness = paintThickness;
+        request.smudgeRadius = smudgeRadiusPortion;
+
+        m_dabPipeline->addDab(request);
+    } else {
+        const QVector<QRect> dirtyRects =
+                m_strategy->paintDab(dab, srcDabRect, m_dstDabRect,
+                                     paintColor,
+                                     fpOpacity, colorRate,
+                                     smudgeRate,
+                                     maxSmudgeRate,
+                                     paintThickness,
+                                     smudgeRadiusPortion);
+
+        painter()->addDirtyRects(dirtyRects);
+    }
 
     return spacingInfo;
 }
 
+std::pair<int, bool> KisColorSmudgeOp::doAsynchronousUpdate(QVector<KisRunnableStrokeJobData*> &jobs)
+{
+    std::pair<int, bool> result = KisBrushBasedPaintOp::doAsynchronousUpdate(jobs);
+
+    if (m_dabPipeline) {
+        painter()->addDirtyRects(m_dabPipeline->takeDirtyRects());
+        result.second = m_dabPipeline->hasPendingDabs();
+    }
+
+    return result;
+}
+
 KisSpacingInformation KisColorSmudgeOp::updateSpacingImpl(const KisPaintInformation &info) const
 {
     const qreal scale = m_sizeOption.apply(info) * KisLodTransform::lodToScale(painter()->device());
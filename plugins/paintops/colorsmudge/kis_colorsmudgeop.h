@@ -37,6 +37,7 @@ class KoColorSpace;
 class KisInterstrokeDataFactory;
 
 class KisColorSmudgeStrategy;
+class KisColorSmudgeDabPipeline;
 
 class KisColorSmudgeOp: public KisBrushBasedPaintOp
 {
@@ -46,6 +47,8 @@ public:
 
     static KisInterstrokeDataFactory* createInterstrokeDataFactory(const KisPaintOpSettingsSP settings, KisResourcesInterfaceSP resourcesInterface);
 
+    std::pair<int, bool> doAsynchronousUpdate(QVector<KisRunnableStrokeJobData*> &jobs) override;
+
 protected:
     KisSpacingInformation paintAt(const KisPaintInformation& info) override;
 
@@ -79,6 +82,7 @@ private:
 
     KoColorTransformation *m_hsvTransform {0};
     QScopedPointer<KisColorSmudgeStrategy> m_strategy;
+    QScopedPointer<KisColorSmudgeDabPipeline> m_dabPipeline;
 };
 
 #endif // _KIS_COLORSMUDGEOP_H_
@@ -34,6 +34,14 @@
 #include <KisRenderedDab.h>
 #include <kis_tool_freehand.h>
 #include "KisBrushOpResources.h"
+#include <KisDabCoverageMap.h>
+#include <KisColorSourceOptionData.h>
+#include <KisTextureOptionData.h>
+#include <KisDarkenOption.h>
+#include <KisHSVOption.h>
+#include <kis_color_source.h>
+#include <kis_color_source_option.h>
+#include <KoCompositeOpRegistry.h>
 
 #include <KisRunnableStrokeJobData.h>
 #include <KisRunnableStrokeJobUtils.h>
@@ -95,12 +103,126 @@ KisBrushOp::KisBrushOp(const KisPaintOpSettingsSP settings, KisPainter *painter,
                     painter->runnableStrokeJobsInterface(),
                     &m_mirrorOption,
                     &m_precisionOption));
+
+    if (KisImageConfig(true).skipSaturatedDabs()) {
+        initSaturatedDabsSkipping(settings, painter);
+    }
 }
 
 KisBrushOp::~KisBrushOp()
 {
 }
 
+void KisBrushOp::initSaturatedDabsSkipping(const KisPaintOpSettingsSP settings, KisPainter *painter)
+{
+    /**
+     * When all the dabs of the stroke have the same opaque color, the areas
+     * fully covered by the opaque parts of the dabs cannot be changed by any
+     * further dab, so such dabs can be skipped. The skipped dabs must not
+     * have any per-dab state though: random mirroring, pipe brushes, random
+     * colors or texture offsets would make all the following dabs different.
+     */
+    if (m_brush->brushType() != MASK || m_brush->brushApplication() != ALPHAMASK) return;
+    if (m_mirrorOption.isChecked()) return;
+
+    KisColorSourceOptionData colorSourceData;
+    colorSourceData.read(settings.data());
+    if (colorSourceData.type != KisColorSourceOptionData::PLAIN) return;
+
+    if (KisMixOption(settings.data()).isChecked()) return;
+    if (KisDarkenOption(settings.data()).isChecked()) return;
+
+    QScopedPointer<KisHSVOption> hueOption(KisHSVOption::createHueOption(settings.data()));
+    QScopedPointer<KisHSVOption> saturationOption(KisHSVOption::createSaturationOption(settings.data()));
+    QScopedPointer<KisHSVOption> valueOption(KisHSVOption::createValueOption(settings.data()));
+    if (hueOption->isChecked() || saturationOption->isChecked() || valueOption->isChecked()) return;
+
+    KisTextureOptionData textureData;
+    textureData.read(settings.data());
+    if (textureData.isEnabled) return;
+
+    const KoColorSpace *dabColorSpace = painter->device()->compositionSourceColorSpace();
+    if (*dabColorSpace != *painter->device()->colorSpace()) return;
+
+    /**
+     * Select the color exactly the way KisBrushOpResources does that for
+     * every dab. If the color differs from the real one for any reason,
+     * no pixels will match it, and nothing will ever be skipped.
+     */
+    QScopedPointer<KisColorSource> colorSource(KisColorSourceOption(settings.data()).createColorSource(painter));
+    colorSource->selectColor(KisMixOption(settings.data()).apply(KisPaintInformation()), KisPaintInformation());
+
+    const KisUniformColorSource *uniformColorSource =
+        dynamic_cast<const KisUniformColorSource*>(colorSource.data());
+    KIS_SAFE_ASSERT_RECOVER_RETURN(uniformColorSource);
+
+    KoColor color = uniformColorSource->uniformColor();
+    color.convertTo(dabColorSpace);
+    if (color.opacityF() != OPACITY_OPAQUE_F) return;
+
+    m_saturatedPixel = color;
+    m_saturatedArea.reset(new KisDabCoverageMap());
+}
+
+bool KisBrushOp::canSkipSaturatedDabs()
+{
+    if (!m_saturatedArea) return false;
+
+    KisPainter *p = painter();
+    const QBitArray channelFlags = p->channelFlags();
+    const QString compositeOpId = p->compositeOpId();
+
+    return !p->selection() &&
+        (channelFlags.isEmpty() || channelFlags.count(true) == channelFlags.size()) &&
+        (compositeOpId == COMPOSITE_OVER || compositeOpId == COMPOSITE_ALPHA_DARKEN) &&
+        !p->hasMirroring() &&
+        !p->device()->defaultBounds()->wrapAroundMode();
+}
+
+bool KisBrushOp::isSaturatedDab(KisBrushSP brush, const QPointF &cursorPos,
+                                const KisDabShape &shape, const KisPaintInformation &info,
+                                qreal dabOpacity)
+{
+    /**
+     * The average opacity of the stroke, which is used by the Alpha Darken
+     * blending mode, is not changed by an opaque dab only if the previous
+     * dab was opaque as well.
+     */
+    if (dabOpacity != OPACITY_OPAQUE_F || m_lastDabOpacity != OPACITY_OPAQUE_F) return false;
+    if (!canSkipSaturatedDabs()) return false;
+
+    const int width = brush->maskWidth(shape, 0, 0, info);
+    const int height = brush->maskHeight(shape, 0, 0, info);
+
+    /**
+     * With lower precision levels the dab cache may reuse the previous dab
+     * for the next one, and the dab that would be reused depends on which
+     * dabs have been skipped.
+     */
+    if (m_precisionOption.effectivePrecisionLevel(qMin(width, height) + 1) < 5) return false;
+
+    // the subpixel offset and the sharpness option may shift the dab by a pixel
+    const QRect dabRect =
+        kisGrowRect(QRectF(cursorPos - brush->hotSpot(shape, info),
+                           QSizeF(width, height)).toAlignedRect(), 2);
+
+    return m_saturatedArea->isSaturated(dabRect);
+}
+
+void KisBrushOp::markSaturatedDabs(const QList<KisRenderedDab> &dabs)
+{
+    const KoColorSpace *colorSpace = m_saturatedPixel.colorSpace();
+    const int pixelSize = colorSpace->pixelSize();
+
+    Q_FOREACH (const KisRenderedDab &dab, dabs) {
+        if (dab.opacity != OPACITY_OPAQUE_F || dab.flow != OPACITY_OPAQUE_F) continue;
+        if (*dab.device->colorSpace() != *colorSpace) continue;
+
+        m_saturatedArea->addSaturatedPixels(dab.realBounds(), dab.device->constData(),
+                                            pixelSize, m_saturatedPixel.data());
+    }
+}
+
 KisSpacingInformation KisBrushOp::paintAt(const KisPaintInformation& info)
 {
     if (!painter()->device()) return KisSpacingInformation(1.0);
@@ -138,7 +260,13 @@ KisSpacingInformation KisBrushOp::paintAt(const KisPaintInformation& info)
                                              m_softnessOption.apply(info),
                                              m_lightnessStrengthOption.apply(info));
 
-    m_dabExecutor->addDab(request, dabOpacity, dabFlow);
+    const bool isSaturated =
+        m_saturatedArea && isSaturatedDab(brush, cursorPos, shape, info, dabOpacity);
+    m_lastDabOpacity = dabOpacity;
+
+    if (!isSaturated) {
+        m_dabExecutor->addDab(request, dabOpacity, dabFlow);
+    }
 
 
     KisSpacingInformation spacingInfo =
@@ -303,6 +431,19 @@ std::pair<int, bool> KisBrushOp::doAsynchronousUpdate(QVector<KisRunnableStrokeJ
             );
         }
 
+        /**
+         * The dabs are only read by the blitting jobs, so their saturated
+         * areas can be collected in parallel with blitting. All the dabs
+         * that are still to be added will be blitted after these ones.
+         */
+        if (canSkipSaturatedDabs()) {
+            KritaUtils::addJobConcurrent(jobs,
+                [state, this] () {
+                    markSaturatedDabs(state->dabsQueue);
+                }
+            );
+        }
+
         /**
          * After the dab has been rendered once, we should mirror it either one
          * (h __or__ v) or three (h __and__ v) times. This sequence of 'if's achieves
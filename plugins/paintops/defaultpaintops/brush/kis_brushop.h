@@ -25,11 +25,14 @@
 
 #include <QElapsedTimer>
 
+#include <KoColor.h>
+
 class KisPainter;
 class KisColorSource;
 class KisDabRenderingExecutor;
 struct KisRenderedDab;
 class KisRunnableStrokeJobData;
+class KisDabCoverageMap;
 
 class KisBrushOp : public KisBrushBasedPaintOp
 {
@@ -61,6 +64,14 @@ protected:
     UpdateSharedStateSP m_updateSharedState;
 
 
+private:
+    void initSaturatedDabsSkipping(const KisPaintOpSettingsSP settings, KisPainter *painter);
+    bool canSkipSaturatedDabs();
+    bool isSaturatedDab(KisBrushSP brush, const QPointF &cursorPos,
+                        const KisDabShape &shape, const KisPaintInformation &info,
+                        qreal dabOpacity);
+    void markSaturatedDabs(const QList<KisRenderedDab> &dabs);
+
 private:
     KisAirbrushOptionData m_airbrushData;
 
@@ -88,6 +99,10 @@ private:
 
     const int m_minUpdatePeriod;
     const int m_maxUpdatePeriod;
+
+    QScopedPointer<KisDabCoverageMap> m_saturatedArea;
+    KoColor m_saturatedPixel;
+    qreal m_lastDabOpacity = OPACITY_TRANSPARENT_F;
 };
 
 #endif // KIS_BRUSHOP_H_
@@ -0,0 +1,178 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisHairyInkBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <QHash>
+
+#include <KoColorSpace.h>
+#include <KoCompositeOp.h>
+#include <KoCompositeOpRegistry.h>
+
+#include <kis_assert.h>
+#include <kis_default_bounds_base.h>
+#include <kis_global.h>
+#include <kis_paint_device.h>
+#include <kis_random_accessor_ng.h>
+#include <KisPaintOpConcurrentTasks.h>
+
+namespace {
+// the size of the tiles of a paint device
+const int tileSizeShift = 6;
+
+/**
+ * Rasterizing less writes than that is not worth waking up
+ * another thread
+ */
+const int minWritesPerGroup = 4096;
+}
+
+KisHairyInkBuffer::KisHairyInkBuffer(const KoColorSpace *colorSpace, WriteMode mode)
+    : m_colorSpace(colorSpace)
+    , m_mode(mode)
+    , m_pixelSize(colorSpace->pixelSize())
+{
+}
+
+void KisHairyInkBuffer::setColor(const quint8 *color)
+{
+    if (m_currentColorOffset >= 0 &&
+        !memcmp(m_colors.constData() + m_currentColorOffset, color, m_pixelSize)) {
+
+        return;
+    }
+
+    m_currentColorOffset = m_colors.size();
+    m_colors.resize(m_currentColorOffset + m_pixelSize);
+    memcpy(m_colors.data() + m_currentColorOffset, color, m_pixelSize);
+}
+
+int KisHairyInkBuffer::numWrites() const
+{
+    return m_writes.size();
+}
+
+QVector<QVector<int>> KisHairyInkBuffer::splitIntoTileGroups(int numGroups) const
+{
+    QHash<quint64, int> tileIndexes;
+    QVector<QVector<int>> tiles;
+
+    for (int i = 0; i < m_writes.size(); i++) {
+        const Write &write = m_writes[i];
+        const quint64 key =
+            (quint64(quint32(write.x >> tileSizeShift)) << 32) |
+            quint64(quint32(write.y >> tileSizeShift));
+
+        auto it = tileIndexes.find(key);
+        if (it == tileIndexes.end()) {
+            it = tileIndexes.insert(key, tiles.size());
+            tiles.append(QVector<int>());
+        }
+
+        tiles[*it].append(i);
+    }
+
+    /**
+     * Distribute the tiles between the groups greedily, the busiest
+     * tiles first
+     */
+    std::sort(tiles.begin(), tiles.end(),
+              [] (const QVector<int> &lhs, const QVector<int> &rhs) {
+                  return lhs.size() > rhs.size();
+              });
+
+    QVector<QVector<int>> groups(qBound(1, numGroups, qMax(1, tiles.size())));
+
+    for (const QVector<int> &tile : tiles) {
+        auto smallestGroup =
+            std::min_element(groups.begin(), groups.end(),
+                             [] (const QVector<int> &lhs, const QVector<int> &rhs) {
+                                 return lhs.size() < rhs.size();
+                             });
+        *smallestGroup += tile;
+    }
+
+    return groups;
+}
+
+void KisHairyInkBuffer::rasterize(KisPaintDeviceSP dab, const QVector<int> &writeIndexes) const
+{
+    rasterizeImpl(dab, writeIndexes.size(),
+                  [&writeIndexes] (int i) { return writeIndexes[i]; });
+}
+
+void KisHairyInkBuffer::rasterize(KisPaintDeviceSP dab) const
+{
+    rasterizeImpl(dab, m_writes.size(),
+                  [] (int i) { return i; });
+}
+
+void KisHairyInkBuffer::rasterize(KisPaintDeviceSP dab,
+                                  KisRunnableStrokeJobsInterface *jobsInterface,
+                                  int maxNumGroups) const
+{
+    const int numGroups = qMin(maxNumGroups, m_writes.size() / minWritesPerGroup);
+
+    if (numGroups < 2 || dab->defaultBounds()->wrapAroundMode()) {
+        rasterize(dab);
+        return;
+    }
+
+    const QVector<QVector<int>> groups = splitIntoTileGroups(numGroups);
+
+    KisPaintOpConcurrentTasks::run(jobsInterface,
+                                   groups.size(),
+                                   [&] (int i) {
+                                       rasterize(dab, groups[i]);
+                                   });
+}
+
+template <typename IndexFunc>
+void KisHairyInkBuffer::rasterizeImpl(KisPaintDeviceSP dab, int numWrites, IndexFunc index) const
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(*dab->colorSpace() == *m_colorSpace);
+
+    const KoCompositeOp *compositeOp = m_colorSpace->compositeOp(COMPOSITE_OVER);
+    KisRandomAccessorSP accessor = dab->createRandomAccessorNG();
+
+    QVector<quint8> colorBuffer(m_pixelSize);
+    quint8 *color = colorBuffer.data();
+
+    for (int i = 0; i < numWrites; i++) {
+        const Write &write = m_writes[index(i)];
+
+        memcpy(color, m_colors.constData() + write.colorOffset, m_pixelSize);
+
+        accessor->moveTo(write.x, write.y);
+        quint8 *dst = accessor->rawData();
+
+        switch (m_mode) {
+        case CompositeOver:
+            if (write.opacity >= 0) {
+                m_colorSpace->setOpacity(color, quint8(write.opacity), 1);
+            }
+            compositeOp->composite(dst, m_pixelSize, color, m_pixelSize, 0, 0, 1, 1, OPACITY_OPAQUE_F);
+            break;
+        case AccumulateOpacity: {
+            const quint8 opacity =
+                quint8(kisBoundFast<quint16>(OPACITY_TRANSPARENT_U8,
+                                             write.opacity + m_colorSpace->opacityU8(dst),
+                                             OPACITY_OPAQUE_U8));
+            memcpy(dst, color, m_pixelSize);
+            m_colorSpace->setOpacity(dst, opacity, 1);
+            break;
+        }
+        case Darken:
+            if (m_colorSpace->opacityU8(dst) < m_colorSpace->opacityU8(color)) {
+                memcpy(dst, color, m_pixelSize);
+            }
+            break;
+        }
+    }
+}
@@ -0,0 +1,98 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISHAIRYINKBUFFER_H
+#define KISHAIRYINKBUFFER_H
+
+#include <QSharedPointer>
+#include <QVector>
+
+#include <kis_types.h>
+
+class KoColorSpace;
+class KisRunnableStrokeJobsInterface;
+
+/**
+ * The pixel writes the bristles of the hairy brush have done during a
+ * single paint event.
+ *
+ * The simulation of the bristles (ink depletion, saturation etc.) is
+ * sequential, but the writes can be rasterized into the dab in
+ * parallel: they are split into groups of tiles, and the order of the
+ * writes is preserved inside every tile.
+ */
+class KisHairyInkBuffer
+{
+public:
+    enum WriteMode {
+        /// composite the color over the pixel
+        CompositeOver,
+        /// copy the color, but sum the opacity with the one of the pixel
+        AccumulateOpacity,
+        /// copy the color if it is more opaque than the pixel
+        Darken
+    };
+
+    struct Write {
+        qint32 x;
+        qint32 y;
+        qint32 colorOffset;
+        /// overrides the opacity of the color if not negative
+        qint16 opacity;
+    };
+
+public:
+    KisHairyInkBuffer(const KoColorSpace *colorSpace, WriteMode mode);
+
+    /**
+     * Makes \p color the color of the following writes
+     */
+    void setColor(const quint8 *color);
+
+    inline void addWrite(int x, int y, int opacity = -1) {
+        m_writes.append({x, y, m_currentColorOffset, qint16(opacity)});
+    }
+
+    int numWrites() const;
+
+    /**
+     * Splits the writes into at most \p numGroups groups of tiles with
+     * approximately the same number of writes. Every group is a list of
+     * write indexes that can be rasterized independently of the other
+     * groups.
+     */
+    QVector<QVector<int>> splitIntoTileGroups(int numGroups) const;
+
+    void rasterize(KisPaintDeviceSP dab, const QVector<int> &writeIndexes) const;
+    void rasterize(KisPaintDeviceSP dab) const;
+
+    /**
+     * Writes all the ink into \p dab, splitting the work into at most
+     * \p maxNumGroups concurrent jobs of the stroke when there is enough
+     * of it. In wrap-around mode the writes are rasterized serially,
+     * because two groups of tiles may map onto the same device tile.
+     */
+    void rasterize(KisPaintDeviceSP dab,
+                   KisRunnableStrokeJobsInterface *jobsInterface,
+                   int maxNumGroups) const;
+
+private:
+    template <typename IndexFunc>
+    void rasterizeImpl(KisPaintDeviceSP dab, int numWrites, IndexFunc index) const;
+
+private:
+    const KoColorSpace *m_colorSpace;
+    WriteMode m_mode;
+    int m_pixelSize;
+
+    QVector<Write> m_writes;
+    QVector<quint8> m_colors;
+    qint32 m_currentColorOffset {-1};
+};
+
+typedef QSharedPointer<KisHairyInkBuffer> KisHairyInkBufferSP;
+
+#endif // KISHAIRYINKBUFFER_H
@@ -6,53 +6,50 @@
 
 #include "bristle.h"
 
-Bristle::Bristle(float x, float y, float length)
-    : m_x(x)
-    , m_y(y)
-    , m_prevX(x)
-    , m_prevY(y)
-    , m_length(length)
-{}
-
-Bristle::~Bristle()
-{
-}
+#include <cstring>
 
-void Bristle::setLength(float length)
+void Bristles::clear(int pixelSize)
 {
-    m_length = length;
+    m_pixelSize = pixelSize;
+
+    x.clear();
+    y.clear();
+    prevX.clear();
+    prevY.clear();
+    length.clear();
+    inkAmount.clear();
+    counter.clear();
+    colors.clear();
 }
 
-
-void Bristle::addInk(float value)
+void Bristles::append(float _x, float _y, float _length, const quint8 *color)
 {
-    m_inkAmount = m_inkAmount + value;
+    x.append(_x);
+    y.append(_y);
+    prevX.append(_x);
+    prevY.append(_y);
+    length.append(_length);
+    inkAmount.append(0.0f);
+    counter.append(0);
+
+    const int offset = colors.size();
+    colors.resize(offset + m_pixelSize);
+    memcpy(colors.data() + offset, color, m_pixelSize);
 }
 
-void Bristle::removeInk(float value)
+void Bristles::setColor(int index, const quint8 *color)
 {
-    m_inkAmount = m_inkAmount - value;
+    memcpy(colors.data() + index * m_pixelSize, color, m_pixelSize);
 }
 
-void Bristle::setInkAmount(float inkAmount)
+void Bristles::setInkAmount(int index, float value)
 {
-    if (inkAmount > 1.0f) {
-        inkAmount = 1.0f;
+    if (value > 1.0f) {
+        value = 1.0f;
     }
-    else if (inkAmount < -1.0f) {
-        inkAmount = -1.0f;
+    else if (value < -1.0f) {
+        value = -1.0f;
     }
 
-    m_inkAmount = inkAmount;
-}
-
-void Bristle::setColor(const KoColor &color)
-{
-    m_color = color;
-}
-
-
-void Bristle::setEnabled(bool enabled)
-{
-    m_enabled = enabled;
+    inkAmount[index] = value;
 }
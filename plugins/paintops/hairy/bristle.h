@@ -7,101 +7,53 @@
 #ifndef _BRISTLE_H_
 #define _BRISTLE_H_
 
-#include <cmath>
-#include <KoColor.h>
+#include <QVector>
+#include <QtGlobal>
 
-class Bristle
+/**
+ * The state of all the bristles of the brush, stored as a structure
+ * of arrays, so that the per-event position updates can be done for
+ * all the bristles in tight (vectorizable) loops.
+ */
+class Bristles
 {
-
 public:
-    Bristle() = default;
-    Bristle(float x, float y, float length);
-    ~Bristle();
-
-    inline float x() const {
-        return m_x;
-    }
-
-    inline float y() const {
-        return m_y;
-    }
-
-    inline float prevX() const {
-        return m_prevX;
-    }
-
-    inline float prevY() const {
-        return m_prevY;
-    }
-
-    inline float length() const {
-        return m_length;
-    }
+    void clear(int pixelSize);
+    void append(float x, float y, float length, const quint8 *color);
 
-    inline  const KoColor &color() const {
-        return m_color;
+    inline int size() const {
+        return x.size();
     }
 
-    inline int counter() const {
-        return m_counter;
+    inline const quint8* color(int index) const {
+        return colors.constData() + index * m_pixelSize;
     }
 
-    inline void upIncrement() {
-        m_counter++;
-    }
-
-    inline float inkAmount() const {
-        return m_inkAmount;
-    };
-
-    inline float distanceCenter() {
-        return std::sqrt(m_x * m_x + m_y * m_y);
-    }
+    void setColor(int index, const quint8 *color);
 
-    inline void setX(float x) {
-        m_x = x;
-    }
-    inline void setY(float y) {
-        m_y = y;
-    }
+    void setInkAmount(int index, float inkAmount);
 
-    inline void setPrevX(float prevX) {
-        m_prevX = prevX;
-    }
+    // coordinates of the bristles relative to the center of the brush
+    QVector<float> x;
+    QVector<float> y;
 
-    inline void setPrevY(float prevY) {
-        m_prevY = prevY;
-    }
+    // the end of the bristle path in the previous event, relative to
+    // the position of the brush
+    QVector<float> prevX;
+    QVector<float> prevY;
 
-    inline bool enabled() const {
-        return m_enabled;
-    }
+    // the value of the brush tip at the bristle, the "z" coordinate
+    QVector<float> length;
 
-    void setLength(float length);
-    void setColor(const KoColor &color);
+    QVector<float> inkAmount;
 
-    void addInk(float value);
-    void removeInk(float value);
-    void setInkAmount(float inkAmount);
-    void setEnabled(bool enabled);
+    // the number of pixels the bristle has painted, used for depletion
+    QVector<int> counter;
 
+    QVector<quint8> colors;
 
 private:
-    void init(float x, float y, float length);
-
-    // coordinates of bristle
-    float m_x{0.0f};
-    float m_y{0.0f};
-    float m_prevX{0.0f};
-    float m_prevY{0.0f};
-    float m_length{0.0f}; // z - coordinate
-    KoColor m_color;
-    float m_inkAmount{0.0f};
-
-    // new dimension in bristle
-    int m_counter{0};
-
-    bool m_enabled{true};
+    int m_pixelSize {0};
 };
 
 #endif
@@ -16,7 +16,6 @@
 #include <QVector>
 
 #include <kis_types.h>
-#include <kis_random_accessor_ng.h>
 #include <kis_cross_device_color_sampler.h>
 #include <kis_fixed_paint_device.h>
 
@@ -38,18 +37,15 @@ HairyBrush::HairyBrush()
 HairyBrush::~HairyBrush()
 {
     delete m_transfo;
-    qDeleteAll(m_bristles.begin(), m_bristles.end());
-    m_bristles.clear();
 }
 
 
-void HairyBrush::initAndCache()
+void HairyBrush::initAndCache(const KoColorSpace *colorSpace)
 {
-    m_compositeOp = m_dab->colorSpace()->compositeOp(COMPOSITE_OVER);
-    m_pixelSize = m_dab->colorSpace()->pixelSize();
+    m_pixelSize = colorSpace->pixelSize();
 
     if (m_properties->useSaturation) {
-        m_transfo = m_dab->colorSpace()->createColorTransformation("hsv_adjustment", m_params);
+        m_transfo = colorSpace->createColorTransformation("hsv_adjustment", m_params);
         if (m_transfo) {
             m_saturationId = m_transfo->parameterId("s");
         }
@@ -65,27 +61,23 @@ void HairyBrush::fromDabWithDensity(KisFixedPaintDeviceSP dab, qreal density)
     int centerY = height * 0.5;
 
     // make mask
-    Bristle * bristle = nullptr;
     qreal alpha;
 
     quint8 * dabPointer = dab->data();
     quint8 pixelSize = dab->pixelSize();
     const KoColorSpace * cs = dab->colorSpace();
-    KoColor bristleColor(cs);
 
     KisRandomSource randomSource(0);
 
+    m_bristles.clear(pixelSize);
+
     for (int y = 0; y < height; y++) {
         for (int x = 0; x < width; x++) {
             alpha =  cs->opacityF(dabPointer);
             if (alpha != 0.0) {
                 if (density == 1.0 || randomSource.generateNormalized() <= density) {
-                    memcpy(bristleColor.data(), dabPointer, pixelSize);
-
-                    bristle = new Bristle(x - centerX, y - centerY, alpha); // using value from image as length of bristle
-                    bristle->setColor(bristleColor);
-
-                    m_bristles.append(bristle);
+                    // using value from image as length of bristle
+                    m_bristles.append(x - centerX, y - centerY, alpha, dabPointer);
                 }
             }
             dabPointer += pixelSize;
@@ -94,7 +86,7 @@ void HairyBrush::fromDabWithDensity(KisFixedPaintDeviceSP dab, qreal density)
 }
 
 
-void HairyBrush::paintLine(KisPaintDeviceSP dab, KisPaintDeviceSP layer, const KisPaintInformation &pi1, const KisPaintInformation &pi2, qreal scale, qreal rotation)
+KisHairyInkBufferSP HairyBrush::paintLine(KisPaintDeviceSP dab, KisPaintDeviceSP layer, const KisPaintInformation &pi1, const KisPaintInformation &pi2, qreal scale, qreal rotation)
 {
     m_counter++;
 
@@ -121,16 +113,12 @@ void HairyBrush::paintLine(KisPaintDeviceSP dab, KisPaintDeviceSP layer, const K
     // this pressure controls shear and ink depletion
     qreal pressure = mousePressure * (pi2.pressure() * 2);
 
-    Bristle *bristle = 0;
-    KoColor bristleColor(dab->colorSpace());
-
-    m_dabAccessor = dab->createRandomAccessorNG();
-
-    m_dab = dab;
+    const KoColorSpace *colorSpace = dab->colorSpace();
+    KoColor bristleColor(colorSpace);
 
     // initialization block
     if (firstStroke()) {
-        initAndCache();
+        initAndCache(colorSpace);
     }
 
     /*If this is first time the brush touches the canvas and
@@ -138,55 +126,91 @@ void HairyBrush::paintLine(KisPaintDeviceSP dab, KisPaintDeviceSP layer, const K
     if (m_properties->inkDepletionEnabled &&
             firstStroke() && m_properties->useSoakInk) {
         if (layer) {
-            colorifyBristles(layer, pi1.pos());
+            colorifyBristles(layer, colorSpace, pi1.pos());
         }
         else {
             dbgKrita << "Can't soak the ink from the layer";
         }
     }
 
+    KisHairyInkBuffer::WriteMode writeMode = KisHairyInkBuffer::CompositeOver;
+    if (!m_properties->useCompositing) {
+        writeMode = m_properties->antialias ?
+            KisHairyInkBuffer::AccumulateOpacity :
+            KisHairyInkBuffer::Darken;
+    }
+
+    KisHairyInkBufferSP ink(new KisHairyInkBuffer(colorSpace, writeMode));
+
+    const int bristleCount = m_bristles.size();
+
+    /**
+     * The random offsets are fetched in the same order they were
+     * fetched before the bristles became a structure of arrays, so
+     * that the strokes stay reproducible.
+     */
     KisRandomSourceSP randomSource = pi2.randomSource();
 
+    m_endX.resize(bristleCount);
+    m_endY.resize(bristleCount);
+
+    for (int i = 0; i < bristleCount; i++) {
+        m_endX[i] = (randomSource->generateNormalized() * 2 - 1.0) * m_properties->randomFactor;
+        m_endY[i] = (randomSource->generateNormalized() * 2 - 1.0) * m_properties->randomFactor;
+    }
+
+    /**
+     * Map all the bristles with the transform
+     *
+     *     rotate(-angle) * scale(scale) * translate(random) * shear(shear)
+     *
+     * The loop is written explicitly (instead of using QTransform) to
+     * let the compiler vectorize it.
+     */
+    {
+        const float shear = pressure * m_properties->shearFactor;
+        const float cosA = std::cos(angle) * scale;
+        const float sinA = std::sin(angle) * scale;
+
+        const float *srcX = m_bristles.x.constData();
+        const float *srcY = m_bristles.y.constData();
+        float *endX = m_endX.data();
+        float *endY = m_endY.data();
+
+        for (int i = 0; i < bristleCount; i++) {
+            const float sx = srcX[i] + shear * srcY[i] + endX[i];
+            const float sy = srcY[i] + shear * srcX[i] + endY[i];
+
+            endX[i] = cosA * sx + sinA * sy;
+            endY[i] = cosA * sy - sinA * sx;
+        }
+    }
+
+    const bool continuePath = !firstStroke() && m_properties->connectedPath;
+
     qreal fx1, fy1, fx2, fy2;
-    qreal randomX, randomY;
-    qreal shear;
 
     float inkDepletion = 0.0;
     int inkDepletionSize = m_properties->inkDepletionCurve.size();
-    int bristleCount = m_bristles.size();
     int bristlePathSize;
     qreal threshold = 1.0 - pi2.pressure();
     for (int i = 0; i < bristleCount; i++) {
 
-        if (!m_bristles.at(i)->enabled()) continue;
-        bristle = m_bristles[i];
-
-        randomX = (randomSource->generateNormalized() * 2 - 1.0) * m_properties->randomFactor;
-        randomY = (randomSource->generateNormalized() * 2 - 1.0) * m_properties->randomFactor;
-
-        shear = pressure * m_properties->shearFactor;
+        fx2 = m_endX[i];
+        fy2 = m_endY[i];
 
-        m_transform.reset();
-        m_transform.rotateRadians(-angle);
-        m_transform.scale(scale, scale);
-        m_transform.translate(randomX, randomY);
-        m_transform.shear(shear, shear);
-
-        if (firstStroke() || (!m_properties->connectedPath)) {
-            // transform start dab
-            m_transform.map(bristle->x(), bristle->y(), &fx1, &fy1);
-            // transform end dab
-            m_transform.map(bristle->x(), bristle->y(), &fx2, &fy2);
+        if (continuePath) {
+            // continue the path of the bristle from the previous position
+            fx1 = m_bristles.prevX[i];
+            fy1 = m_bristles.prevY[i];
         }
         else {
-            // continue the path of the bristle from the previous position
-            fx1 = bristle->prevX();
-            fy1 = bristle->prevY();
-            m_transform.map(bristle->x(), bristle->y(), &fx2, &fy2);
+            fx1 = fx2;
+            fy1 = fy2;
         }
         // remember the end point
-        bristle->setPrevX(fx2);
-        bristle->setPrevY(fy2);
+        m_bristles.prevX[i] = fx2;
+        m_bristles.prevY[i] = fy2;
 
         // all coords relative to device position
         fx1 += x1;
@@ -195,7 +219,7 @@ void HairyBrush::paintLine(KisPaintDeviceSP dab, KisPaintDeviceSP layer, const K
         fx2 += x2;
         fy2 += y2;
 
-        if (m_properties->threshold && (bristle->length() < threshold)) continue;
+        if (m_properties->threshold && (m_bristles.length[i] < threshold)) continue;
         // paint between first and last dab
         const QVector<QPointF> bristlePath = m_trajectory.getLinearTrajectory(QPointF(fx1, fy1), QPointF(fx2, fy2), 1.0);
         bristlePathSize = m_trajectory.size();
@@ -205,65 +229,65 @@ void HairyBrush::paintLine(KisPaintDeviceSP dab, KisPaintDeviceSP layer, const K
             bristlePathSize -= 1;
         }
 
-        memcpy(bristleColor.data(), bristle->color().data() , m_pixelSize);
-        for (int i = 0; i < bristlePathSize ; i++) {
+        memcpy(bristleColor.data(), m_bristles.color(i), m_pixelSize);
+        for (int j = 0; j < bristlePathSize ; j++) {
 
             if (m_properties->inkDepletionEnabled) {
-                inkDepletion = fetchInkDepletion(bristle, inkDepletionSize);
+                inkDepletion = fetchInkDepletion(i, inkDepletionSize);
 
                 if (m_properties->useSaturation && m_transfo != 0) {
-                    saturationDepletion(bristle, bristleColor, pressure, inkDepletion);
+                    saturationDepletion(i, bristleColor, pressure, inkDepletion);
                 }
 
                 if (m_properties->useOpacity) {
-                    opacityDepletion(bristle, bristleColor, pressure, inkDepletion);
+                    opacityDepletion(i, bristleColor, pressure, inkDepletion);
                 }
 
             }
             else {
                 if (bristleColor.opacityU8() != 0) {
-                    bristleColor.setOpacity(bristle->length());
+                    bristleColor.setOpacity(qreal(m_bristles.length[i]));
                 }
             }
 
-            addBristleInk(bristle, bristlePath.at(i), bristleColor);
-            bristle->setInkAmount(1.0 - inkDepletion);
-            bristle->upIncrement();
+            addBristleInk(ink.data(), bristlePath.at(j), bristleColor);
+            m_bristles.setInkAmount(i, 1.0 - inkDepletion);
+            m_bristles.counter[i]++;
         }
 
     }
-    m_dab = nullptr;
-    m_dabAccessor = nullptr;
+
+    return ink;
 }
 
 
-inline qreal HairyBrush::fetchInkDepletion(Bristle* bristle, int inkDepletionSize)
+inline qreal HairyBrush::fetchInkDepletion(int bristle, int inkDepletionSize)
 {
-    if (bristle->counter() >= inkDepletionSize - 1) {
+    if (m_bristles.counter[bristle] >= inkDepletionSize - 1) {
         return m_properties->inkDepletionCurve[inkDepletionSize - 1];
     } else {
-        return m_properties->inkDepletionCurve[bristle->counter()];
+        return m_properties->inkDepletionCurve[m_bristles.counter[bristle]];
     }
 }
 
 
-void HairyBrush::saturationDepletion(Bristle * bristle, KoColor &bristleColor, qreal pressure, qreal inkDepletion)
+void HairyBrush::saturationDepletion(int bristle, KoColor &bristleColor, qreal pressure, qreal inkDepletion)
 {
     qreal saturation;
     if (m_properties->useWeights) {
         // new weighted way (experiment)
         saturation = (
                          (pressure * m_properties->pressureWeight) +
-                         (bristle->length() * m_properties->bristleLengthWeight) +
-                         (bristle->inkAmount() * m_properties->bristleInkAmountWeight) +
+                         (m_bristles.length[bristle] * m_properties->bristleLengthWeight) +
+                         (m_bristles.inkAmount[bristle] * m_properties->bristleInkAmountWeight) +
                          ((1.0 - inkDepletion) * m_properties->inkDepletionWeight)) - 1.0;
     }
     else {
         // old way of computing saturation
         saturation = (
                          pressure *
-                         bristle->length() *
-                         bristle->inkAmount() *
+                         m_bristles.length[bristle] *
+                         m_bristles.inkAmount[bristle] *
                          (1.0 - inkDepletion)) - 1.0;
 
     }
@@ -275,127 +299,45 @@ void HairyBrush::saturationDepletion(Bristle * bristle, KoColor &bristleColor, q
     m_transfo->transform(bristleColor.data(), bristleColor.data() , 1);
 }
 
-void HairyBrush::opacityDepletion(Bristle* bristle, KoColor& bristleColor, qreal pressure, qreal inkDepletion)
+void HairyBrush::opacityDepletion(int bristle, KoColor& bristleColor, qreal pressure, qreal inkDepletion)
 {
     qreal opacity = OPACITY_OPAQUE_F;
     if (m_properties->useWeights) {
         opacity = pressure * m_properties->pressureWeight +
-                  bristle->length() * m_properties->bristleLengthWeight +
-                  bristle->inkAmount() * m_properties->bristleInkAmountWeight +
+                  m_bristles.length[bristle] * m_properties->bristleLengthWeight +
+                  m_bristles.inkAmount[bristle] * m_properties->bristleInkAmountWeight +
                   (1.0 - inkDepletion) * m_properties->inkDepletionWeight;
     }
     else {
         opacity =
-            bristle->length() *
-            bristle->inkAmount();
+            m_bristles.length[bristle] *
+            m_bristles.inkAmount[bristle];
     }
 
     opacity = kisBoundFast(0.0, opacity, 1.0);
     bristleColor.setOpacity(opacity);
 }
 
-inline void HairyBrush::addBristleInk(Bristle *bristle,const QPointF &pos, const KoColor &color)
+inline void HairyBrush::addBristleInk(KisHairyInkBuffer *ink, const QPointF &pos, const KoColor &color)
 {
-    Q_UNUSED(bristle);
+    ink->setColor(color.data());
+
     if (m_properties->antialias) {
-        if (m_properties->useCompositing) {
-            paintParticle(pos, color);
-        } else {
-            paintParticle(pos, color, 1.0);
-        }
+        // opacity top left, right, bottom left, right
+        const quint8 opacity = color.opacityU8();
+
+        const int ipx = int (pos.x());
+        const int ipy = int (pos.y());
+        const qreal fx = qAbs(pos.x() - ipx);
+        const qreal fy = qAbs(pos.y() - ipy);
+
+        ink->addWrite(ipx, ipy, qRound((1.0 - fx) * (1.0 - fy) * opacity));
+        ink->addWrite(ipx + 1, ipy, qRound((fx)  * (1.0 - fy) * opacity));
+        ink->addWrite(ipx, ipy + 1, qRound((1.0 - fx) * (fy)  * opacity));
+        ink->addWrite(ipx + 1, ipy + 1, qRound((fx)  * (fy)  * opacity));
     }
     else {
-        int ix = qRound(pos.x());
-        int iy = qRound(pos.y());
-        if (m_properties->useCompositing) {
-            plotPixel(ix, iy, color);
-        }
-        else {
-            darkenPixel(ix, iy, color);
-        }
-    }
-}
-
-void HairyBrush::paintParticle(QPointF pos, const KoColor& color, qreal weight)
-{
-    // opacity top left, right, bottom left, right
-    quint8 opacity = color.opacityU8();
-    opacity *= weight;
-
-    int ipx = int (pos.x());
-    int ipy = int (pos.y());
-    qreal fx = qAbs(pos.x() - ipx);
-    qreal fy = qAbs(pos.y() - ipy);
-
-    quint8 btl = qRound((1.0 - fx) * (1.0 - fy) * opacity);
-    quint8 btr = qRound((fx)  * (1.0 - fy) * opacity);
-    quint8 bbl = qRound((1.0 - fx) * (fy)  * opacity);
-    quint8 bbr = qRound((fx)  * (fy)  * opacity);
-
-    const KoColorSpace * cs = m_dab->colorSpace();
-
-    m_dabAccessor->moveTo(ipx  , ipy);
-    btl = quint8(kisBoundFast<quint16>(OPACITY_TRANSPARENT_U8, btl + cs->opacityU8(m_dabAccessor->rawData()), OPACITY_OPAQUE_U8));
-    memcpy(m_dabAccessor->rawData(), color.data(), cs->pixelSize());
-    cs->setOpacity(m_dabAccessor->rawData(), btl, 1);
-
-    m_dabAccessor->moveTo(ipx + 1, ipy);
-    btr =  quint8(kisBoundFast<quint16>(OPACITY_TRANSPARENT_U8, btr + cs->opacityU8(m_dabAccessor->rawData()), OPACITY_OPAQUE_U8));
-    memcpy(m_dabAccessor->rawData(), color.data(), cs->pixelSize());
-    cs->setOpacity(m_dabAccessor->rawData(), btr, 1);
-
-    m_dabAccessor->moveTo(ipx, ipy + 1);
-    bbl = quint8(kisBoundFast<quint16>(OPACITY_TRANSPARENT_U8, bbl + cs->opacityU8(m_dabAccessor->rawData()), OPACITY_OPAQUE_U8));
-    memcpy(m_dabAccessor->rawData(), color.data(), cs->pixelSize());
-    cs->setOpacity(m_dabAccessor->rawData(), bbl, 1);
-
-    m_dabAccessor->moveTo(ipx + 1, ipy + 1);
-    bbr = quint8(kisBoundFast<quint16>(OPACITY_TRANSPARENT_U8, bbr + cs->opacityU8(m_dabAccessor->rawData()), OPACITY_OPAQUE_U8));
-    memcpy(m_dabAccessor->rawData(), color.data(), cs->pixelSize());
-    cs->setOpacity(m_dabAccessor->rawData(), bbr, 1);
-}
-
-void HairyBrush::paintParticle(QPointF pos, const KoColor& color)
-{
-    // opacity top left, right, bottom left, right
-    memcpy(m_color.data(), color.data(), m_pixelSize);
-    quint8 opacity = color.opacityU8();
-
-    int ipx = int (pos.x());
-    int ipy = int (pos.y());
-    qreal fx = qAbs(pos.x() - ipx);
-    qreal fy = qAbs(pos.y() - ipy);
-
-    quint8 btl = qRound((1.0 - fx) * (1.0 - fy) * opacity);
-    quint8 btr = qRound((fx)  * (1.0 - fy) * opacity);
-    quint8 bbl = qRound((1.0 - fx) * (fy)  * opacity);
-    quint8 bbr = qRound((fx)  * (fy)  * opacity);
-
-    m_color.setOpacity(btl);
-    plotPixel(ipx  , ipy, m_color);
-
-    m_color.setOpacity(btr);
-    plotPixel(ipx + 1  , ipy, m_color);
-
-    m_color.setOpacity(bbl);
-    plotPixel(ipx  , ipy + 1, m_color);
-
-    m_color.setOpacity(bbr);
-    plotPixel(ipx + 1 , ipy + 1, m_color);
-}
-
-
-inline void HairyBrush::plotPixel(int wx, int wy, const KoColor &color)
-{
-    m_dabAccessor->moveTo(wx, wy);
-    m_compositeOp->composite(m_dabAccessor->rawData(), m_pixelSize, color.data() , m_pixelSize, 0, 0, 1, 1, OPACITY_OPAQUE_F);
-}
-
-inline void HairyBrush::darkenPixel(int wx, int wy, const KoColor &color)
-{
-    m_dabAccessor->moveTo(wx, wy);
-    if (m_dab->colorSpace()->opacityU8(m_dabAccessor->rawData()) < color.opacityU8()) {
-        memcpy(m_dabAccessor->rawData(), color.data(), m_pixelSize);
+        ink->addWrite(qRound(pos.x()), qRound(pos.y()));
     }
 }
 
@@ -416,22 +358,18 @@ double HairyBrush::computeMousePressure(double distance)
 }
 
 
-void HairyBrush::colorifyBristles(KisPaintDeviceSP source, QPointF point)
+void HairyBrush::colorifyBristles(KisPaintDeviceSP source, const KoColorSpace *colorSpace, QPointF point)
 {
-    KoColor bristleColor(m_dab->colorSpace());
+    KoColor bristleColor(colorSpace);
     KisCrossDeviceColorSamplerInt colorSampler(source, bristleColor);
 
-    Bristle *b = 0;
     int size = m_bristles.size();
     for (int i = 0; i < size; i++) {
-        b = m_bristles[i];
-        int x = qRound(b->x() + point.x());
-        int y = qRound(b->y() + point.y());
+        int x = qRound(m_bristles.x[i] + point.x());
+        int y = qRound(m_bristles.y[i] + point.y());
 
         colorSampler.sampleOldColor(x, y, bristleColor.data());
-        b->setColor(bristleColor);
+        m_bristles.setColor(i, bristleColor.data());
     }
 
 }
-
-
@@ -9,18 +9,15 @@
 
 #include <QVector>
 #include <QList>
-#include <QTransform>
 
 #include <KoColor.h>
 
 #include "trajectory.h"
 #include "bristle.h"
+#include "KisHairyInkBuffer.h"
 
 #include <kis_paint_device.h>
 #include <brushengine/kis_paint_information.h>
-#include <kis_random_accessor_ng.h>
-
-class KoCompositeOp;
 
 
 class KisHairyProperties
@@ -61,7 +58,12 @@ public:
     HairyBrush();
     ~HairyBrush();
 
-    void paintLine(KisPaintDeviceSP dab, KisPaintDeviceSP layer, const KisPaintInformation &pi1, const KisPaintInformation &pi2, qreal scale, qreal rotation);
+    /**
+     * Moves the bristles along the line and returns the ink they have left
+     * on the way. The ink is not written into \p dab, it should be
+     * rasterized by the caller with KisHairyInkBuffer::rasterize().
+     */
+    KisHairyInkBufferSP paintLine(KisPaintDeviceSP dab, KisPaintDeviceSP layer, const KisPaintInformation &pi1, const KisPaintInformation &pi2, qreal scale, qreal rotation);
     /// set ink color for the whole bristle shape
     void setInkColor(const KoColor &color) {
         m_color = color;
@@ -74,45 +76,37 @@ public:
     void fromDabWithDensity(KisFixedPaintDeviceSP dab, qreal density);
 
 private:
-    /// paints single bristle
-    void addBristleInk(Bristle *bristle,const QPointF &pos, const KoColor &color);
-    /// composite single pixel to dab
-    void plotPixel(int wx, int wy, const KoColor &color);
-    /// check the opacity of dab pixel and if the opacity is less than color, it will copy color to dab
-    void darkenPixel(int wx, int wy, const KoColor &color);
-    /// paint wu particle by copying the color and setup just the opacity, weight is complementary to opacity of the color
-    void paintParticle(QPointF pos, const KoColor& color, qreal weight);
-    /// paint wu particle using composite operation
-    void paintParticle(QPointF pos, const KoColor& color);
+    /// paints single bristle, in antialiased mode it is a wu particle
+    void addBristleInk(KisHairyInkBuffer *ink, const QPointF &pos, const KoColor &color);
     /// similar to sample input color in spray
-    void colorifyBristles(KisPaintDeviceSP source, QPointF point);
+    void colorifyBristles(KisPaintDeviceSP source, const KoColorSpace *colorSpace, QPointF point);
 
     void repositionBristles(double angle, double slope);
     /// compute mouse pressure according distance
     double computeMousePressure(double distance);
 
     /// simulate running out of saturation
-    void saturationDepletion(Bristle * bristle, KoColor &bristleColor, qreal pressure, qreal inkDepletion);
+    void saturationDepletion(int bristle, KoColor &bristleColor, qreal pressure, qreal inkDepletion);
     /// simulate running out of ink through opacity decreasing
-    void opacityDepletion(Bristle * bristle, KoColor &bristleColor, qreal pressure, qreal inkDepletion);
+    void opacityDepletion(int bristle, KoColor &bristleColor, qreal pressure, qreal inkDepletion);
     /// fetch actual ink status according depletion curve
-    qreal fetchInkDepletion(Bristle * bristle, int inkDepletionSize);
+    qreal fetchInkDepletion(int bristle, int inkDepletionSize);
 
-    void initAndCache();
+    void initAndCache(const KoColorSpace *colorSpace);
 
 private:
     const KisHairyProperties * m_properties {nullptr};
 
-    QVector<Bristle*> m_bristles;
-    QTransform m_transform;
+    Bristles m_bristles;
+
+    // the per-event end points of the bristle paths, relative to the
+    // position of the brush
+    QVector<float> m_endX;
+    QVector<float> m_endY;
 
     // used for interpolation the path of bristles
     Trajectory m_trajectory;
     QHash<QString, QVariant> m_params;
-    // temporary device
-    KisPaintDeviceSP m_dab;
-    KisRandomAccessorSP m_dabAccessor;
-    const KoCompositeOp * m_compositeOp {nullptr};
     quint32 m_pixelSize {0};
 
     int m_counter {0};
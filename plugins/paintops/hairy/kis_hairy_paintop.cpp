@@ -25,6 +25,7 @@
 #include <kis_lod_transform.h>
 #include <kis_spacing_information.h>
 #include <KoResourceLoadResult.h>
+#include "kis_image_config.h"
 
 
 #include "kis_brush.h"
@@ -34,6 +35,7 @@ KisHairyPaintOp::KisHairyPaintOp(const KisPaintOpSettingsSP settings, KisPainter
     , m_opacityOption(settings.data(), node)
     , m_sizeOption(settings.data())
     , m_rotationOption(settings.data())
+    , m_maxNumThreads(KisImageConfig(true).maxNumberOfThreads())
 {
     Q_UNUSED(image);
     Q_ASSERT(settings);
@@ -147,7 +149,10 @@ void KisHairyPaintOp::paintLine(const KisPaintInformation &pi1, const KisPaintIn
     // during initialization), so we should just skip the distance info
     // update
 
-    m_brush.paintLine(m_dab, m_dev, pi1, pi, scale * m_hairyBristleOption.scaleFactor, mirrorFlip ? -rotation : rotation);
+    KisHairyInkBufferSP ink =
+        m_brush.paintLine(m_dab, m_dev, pi1, pi, scale * m_hairyBristleOption.scaleFactor, mirrorFlip ? -rotation : rotation);
+
+    ink->rasterize(m_dab, painter()->runnableStrokeJobsInterface(), m_maxNumThreads);
 
     //QRect rc = m_dab->exactBounds();
     QRect rc = m_dab->extent();
@@ -51,6 +51,8 @@ private:
     KisSizeOption m_sizeOption;
     KisRotationOption m_rotationOption;
 
+    int m_maxNumThreads {1};
+
     void loadSettings();
 };
 
@@ -0,0 +1,306 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#include "KisHairyInkBufferTest.h"
+
+#include <thread>
+#include <vector>
+
+#include <QRandomGenerator>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoCompositeOpRegistry.h>
+
+#include <kis_default_bounds_base.h>
+#include <kis_global.h>
+#include <kis_paint_device.h>
+#include <kis_random_accessor_ng.h>
+#include <KisRunnableStrokeJobDataBase.h>
+#include <KisRunnableStrokeJobsInterface.h>
+
+#include "../KisHairyInkBuffer.h"
+
+namespace {
+
+struct TestWrite {
+    int x;
+    int y;
+    int colorIndex;
+    int opacity;
+};
+
+QVector<KoColor> testColors(const KoColorSpace *cs)
+{
+    return {
+        KoColor(QColor(255, 0, 0, 255), cs),
+        KoColor(QColor(0, 255, 0, 128), cs),
+        KoColor(QColor(0, 0, 255, 200), cs),
+        KoColor(QColor(30, 60, 90, 64), cs),
+        KoColor(QColor(250, 200, 10, 16), cs)
+    };
+}
+
+/**
+ * The writes are spread over several tiles, including the ones at
+ * negative coordinates. The color changes every few writes, like the
+ * color of a bristle does.
+ */
+QVector<TestWrite> generateWrites(int numWrites, const QRect &area, bool withOpacity, int numColors)
+{
+    QRandomGenerator rng(1234);
+
+    QVector<TestWrite> writes;
+    int colorIndex = 0;
+
+    for (int i = 0; i < numWrites; i++) {
+        if (rng.bounded(8) == 0) {
+            colorIndex = rng.bounded(numColors);
+        }
+
+        writes.append({area.x() + rng.bounded(area.width()),
+                       area.y() + rng.bounded(area.height()),
+                       colorIndex,
+                       withOpacity ? rng.bounded(256) : -1});
+    }
+
+    return writes;
+}
+
+KisHairyInkBufferSP createInkBuffer(const KoColorSpace *cs,
+                                    KisHairyInkBuffer::WriteMode mode,
+                                    const QVector<TestWrite> &writes)
+{
+    const QVector<KoColor> colors = testColors(cs);
+    KisHairyInkBufferSP ink(new KisHairyInkBuffer(cs, mode));
+
+    for (const TestWrite &write : writes) {
+        ink->setColor(colors[write.colorIndex].data());
+        ink->addWrite(write.x, write.y, write.opacity);
+    }
+
+    return ink;
+}
+
+/**
+ * Writes the pixels one by one, the way HairyBrush did it before the
+ * ink was buffered (plotPixel(), paintParticle() and darkenPixel())
+ */
+void referenceRasterize(KisPaintDeviceSP dab,
+                        KisHairyInkBuffer::WriteMode mode,
+                        const QVector<TestWrite> &writes)
+{
+    const KoColorSpace *cs = dab->colorSpace();
+    const int pixelSize = cs->pixelSize();
+    const KoCompositeOp *compositeOp = cs->compositeOp(COMPOSITE_OVER);
+    const QVector<KoColor> colors = testColors(cs);
+
+    KisRandomAccessorSP accessor = dab->createRandomAccessorNG();
+
+    for (const TestWrite &write : writes) {
+        KoColor color = colors[write.colorIndex];
+
+        accessor->moveTo(write.x, write.y);
+        quint8 *dst = accessor->rawData();
+
+        switch (mode) {
+        case KisHairyInkBuffer::CompositeOver:
+            if (write.opacity >= 0) {
+                color.setOpacity(quint8(write.opacity));
+            }
+            compositeOp->composite(dst, pixelSize, color.data(), pixelSize, 0, 0, 1, 1, OPACITY_OPAQUE_F);
+            break;
+        case KisHairyInkBuffer::AccumulateOpacity: {
+            const quint8 opacity =
+                quint8(kisBoundFast<quint16>(OPACITY_TRANSPARENT_U8,
+                                             write.opacity + cs->opacityU8(dst),
+                                             OPACITY_OPAQUE_U8));
+            memcpy(dst, color.data(), pixelSize);
+            cs->setOpacity(dst, opacity, 1);
+            break;
+        }
+        case KisHairyInkBuffer::Darken:
+            if (cs->opacityU8(dst) < color.opacityU8()) {
+                memcpy(dst, color.data(), pixelSize);
+            }
+            break;
+        }
+    }
+}
+
+bool compareDevices(KisPaintDeviceSP dev1, KisPaintDeviceSP dev2, const QRect &rect)
+{
+    const int bufferSize = rect.width() * rect.height() * dev1->pixelSize();
+
+    QVector<quint8> bytes1(bufferSize);
+    QVector<quint8> bytes2(bufferSize);
+
+    dev1->readBytes(bytes1.data(), rect);
+    dev2->readBytes(bytes2.data(), rect);
+
+    return bytes1 == bytes2;
+}
+
+/**
+ * Starts every job in its own thread right away
+ */
+struct ThreadedJobsInterface : public KisRunnableStrokeJobsInterface
+{
+    ~ThreadedJobsInterface() override {
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+    }
+
+    void addRunnableJobs(const QVector<KisRunnableStrokeJobDataBase*> &list) override {
+        for (KisRunnableStrokeJobDataBase *job : list) {
+            threads.emplace_back([job] () {
+                job->run();
+                delete job;
+            });
+        }
+    }
+
+    std::vector<std::thread> threads;
+};
+
+/**
+ * Collects the jobs without running them
+ */
+struct DeferredJobsInterface : public KisRunnableStrokeJobsInterface
+{
+    ~DeferredJobsInterface() override {
+        qDeleteAll(jobs);
+    }
+
+    void addRunnableJobs(const QVector<KisRunnableStrokeJobDataBase*> &list) override {
+        jobs += list;
+    }
+
+    QVector<KisRunnableStrokeJobDataBase*> jobs;
+};
+
+struct WrapAroundDefaultBounds : public KisDefaultBoundsBase
+{
+    QRect bounds() const override {
+        return QRect(0, 0, 100, 100);
+    }
+    bool wrapAroundMode() const override {
+        return true;
+    }
+    WrapAroundAxis wrapAroundModeAxis() const override {
+        return WRAPAROUND_BOTH;
+    }
+    int currentLevelOfDetail() const override {
+        return 0;
+    }
+    int currentTime() const override {
+        return 0;
+    }
+    bool externalFrameActive() const override {
+        return false;
+    }
+    void * sourceCookie() const override {
+        return 0;
+    }
+};
+
+KisPaintDeviceSP createWrapAroundDevice(const KoColorSpace *cs)
+{
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->setDefaultBounds(new WrapAroundDefaultBounds());
+    dev->setSupportsWraparoundMode(true);
+    return dev;
+}
+
+}
+
+void KisHairyInkBufferTest::testRasterize_data()
+{
+    QTest::addColumn<int>("mode");
+    QTest::addColumn<bool>("withOpacity");
+
+    QTest::newRow("composite") << int(KisHairyInkBuffer::CompositeOver) << false;
+    QTest::newRow("composite-opacity") << int(KisHairyInkBuffer::CompositeOver) << true;
+    QTest::newRow("accumulate") << int(KisHairyInkBuffer::AccumulateOpacity) << true;
+    QTest::newRow("darken") << int(KisHairyInkBuffer::Darken) << false;
+}
+
+void KisHairyInkBufferTest::testRasterize()
+{
+    QFETCH(int, mode);
+    QFETCH(bool, withOpacity);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const KisHairyInkBuffer::WriteMode writeMode = KisHairyInkBuffer::WriteMode(mode);
+
+    // a few writes per pixel, so that the order of the writes matters
+    const QRect area(-150, -100, 300, 200);
+    const QVector<TestWrite> writes = generateWrites(150000, area, withOpacity, testColors(cs).size());
+
+    KisPaintDeviceSP reference = new KisPaintDevice(cs);
+    referenceRasterize(reference, writeMode, writes);
+
+    KisHairyInkBufferSP ink = createInkBuffer(cs, writeMode, writes);
+
+    // serial path
+    {
+        KisPaintDeviceSP dab = new KisPaintDevice(cs);
+        ink->rasterize(dab);
+        QVERIFY(compareDevices(dab, reference, area));
+    }
+
+    // the groups of tiles are independent, so their order doesn't matter
+    {
+        const QVector<QVector<int>> groups = ink->splitIntoTileGroups(4);
+        QCOMPARE(groups.size(), 4);
+
+        KisPaintDeviceSP dab = new KisPaintDevice(cs);
+        for (int i = groups.size() - 1; i >= 0; i--) {
+            ink->rasterize(dab, groups[i]);
+        }
+        QVERIFY(compareDevices(dab, reference, area));
+    }
+
+    // concurrent path
+    {
+        KisPaintDeviceSP dab = new KisPaintDevice(cs);
+
+        {
+            ThreadedJobsInterface jobsInterface;
+            ink->rasterize(dab, &jobsInterface, 4);
+            QCOMPARE(jobsInterface.threads.size(), size_t(3));
+        }
+
+        QVERIFY(compareDevices(dab, reference, area));
+    }
+}
+
+void KisHairyInkBufferTest::testWrapAroundFallback()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const KisHairyInkBuffer::WriteMode writeMode = KisHairyInkBuffer::CompositeOver;
+
+    // the area is bigger than the wrap rect, so different tiles
+    // of the area map onto the same tile of the device
+    const QRect area(-150, -100, 300, 200);
+    const QVector<TestWrite> writes = generateWrites(150000, area, true, testColors(cs).size());
+
+    KisPaintDeviceSP reference = createWrapAroundDevice(cs);
+    referenceRasterize(reference, writeMode, writes);
+
+    KisHairyInkBufferSP ink = createInkBuffer(cs, writeMode, writes);
+    KisPaintDeviceSP dab = createWrapAroundDevice(cs);
+
+    DeferredJobsInterface jobsInterface;
+    ink->rasterize(dab, &jobsInterface, 4);
+
+    // everything should be rasterized serially by the calling thread
+    QVERIFY(jobsInterface.jobs.isEmpty());
+    QVERIFY(compareDevices(dab, reference, QRect(0, 0, 100, 100)));
+}
+
+SIMPLE_TEST_MAIN(KisHairyInkBufferTest)
@@ -0,0 +1,21 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef KISHAIRYINKBUFFERTEST_H
+#define KISHAIRYINKBUFFERTEST_H
+
+#include <simpletest.h>
+
+class KisHairyInkBufferTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testRasterize_data();
+    void testRasterize();
+
+    void testWrapAroundFallback();
+};
+
+#endif // KISHAIRYINKBUFFERTEST_H
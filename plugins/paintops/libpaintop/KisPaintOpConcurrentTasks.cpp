@@ -0,0 +1,98 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisPaintOpConcurrentTasks.h"
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSharedPointer>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <KisRunnableStrokeJobData.h>
+#include <KisRunnableStrokeJobUtils.h>
+#include <KisRunnableStrokeJobsInterface.h>
+
+namespace {
+
+struct SharedState
+{
+    SharedState(int _numTasks, std::function<void(int)> _func)
+        : numTasks(_numTasks),
+          func(_func)
+    {
+    }
+
+    bool processNextTask() {
+        const int index = nextTask.fetchAndAddOrdered(1);
+        if (index >= numTasks) return false;
+
+        func(index);
+
+        QMutexLocker l(&mutex);
+        if (++numFinishedTasks == numTasks) {
+            allTasksFinished.wakeAll();
+        }
+
+        return true;
+    }
+
+    void processAndWaitForDone() {
+        while (processNextTask());
+
+        QMutexLocker l(&mutex);
+        while (numFinishedTasks < numTasks) {
+            allTasksFinished.wait(&mutex);
+        }
+    }
+
+    const int numTasks;
+    const std::function<void(int)> func;
+
+    QAtomicInt nextTask {0};
+
+    QMutex mutex;
+    QWaitCondition allTasksFinished;
+    int numFinishedTasks {0};
+};
+
+}
+
+namespace KisPaintOpConcurrentTasks {
+
+void run(KisRunnableStrokeJobsInterface *jobsInterface,
+         int numTasks,
+         std::function<void(int)> func)
+{
+    if (!jobsInterface || numTasks < 2) {
+        for (int i = 0; i < numTasks; i++) {
+            func(i);
+        }
+        return;
+    }
+
+    /**
+     * The jobs that are started after all the tasks have been taken
+     * do nothing, but they may still be started after we return, so
+     * the state is shared with them.
+     */
+    QSharedPointer<SharedState> state(new SharedState(numTasks, func));
+
+    QVector<KisRunnableStrokeJobData*> jobs;
+
+    for (int i = 1; i < numTasks; i++) {
+        KritaUtils::addJobConcurrent(jobs, [state] () {
+            state->processNextTask();
+        });
+    }
+
+    jobsInterface->addRunnableJobs(jobs);
+
+    state->processAndWaitForDone();
+}
+
+}
@@ -0,0 +1,37 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISPAINTOPCONCURRENTTASKS_H
+#define KISPAINTOPCONCURRENTTASKS_H
+
+#include <functional>
+
+#include "kritapaintop_export.h"
+
+class KisRunnableStrokeJobsInterface;
+
+namespace KisPaintOpConcurrentTasks {
+
+/**
+ * Executes \p func for every index in range [0, numTasks) using the
+ * concurrent jobs of the stroke.
+ *
+ * The calling thread takes part in the execution and the function
+ * returns only when all the tasks are completed, so it can be used
+ * right inside paintAt() or paintLine() of a paintop. The thread never
+ * waits for a task that has not been started yet, therefore there is
+ * no deadlock even when the stroke has no free threads.
+ *
+ * When \p jobsInterface is null (e.g. the paintop is used outside of a
+ * stroke) or there is only one task, the tasks are executed serially.
+ */
+PAINTOP_EXPORT void run(KisRunnableStrokeJobsInterface *jobsInterface,
+                        int numTasks,
+                        std::function<void(int)> func);
+
+}
+
+#endif // KISPAINTOPCONCURRENTTASKS_H
@@ -107,6 +107,14 @@ QRect KisTextureMaskInfo::maskBounds() const {
     return m_maskBounds;
 }
 
+const quint8* KisTextureMaskInfo::maskData() const {
+    return m_maskData.constData();
+}
+
+int KisTextureMaskInfo::maskPixelSize() const {
+    return m_mask ? m_mask->pixelSize() : 0;
+}
+
 bool KisTextureMaskInfo::fillProperties(const KisPropertiesConfiguration *setting, KisResourcesInterfaceSP resourcesInterface, bool invertAdditionally)
 {
     KisTextureOptionData data;
@@ -240,6 +248,9 @@ void KisTextureMaskInfo::recalculateMask()
         m_mask->convertFromQImage(mask, 0);
     }
     m_maskBounds = QRect(0, 0, width, height);
+
+    m_maskData.resize(width * height * m_mask->pixelSize());
+    m_mask->readBytes(m_maskData.data(), m_maskBounds);
 }
 
 bool KisTextureMaskInfo::hasAlpha() {
@@ -11,6 +11,7 @@
 #include <kis_paint_device.h>
 #include <QSharedPointer>
 #include <QMutex>
+#include <QVector>
 
 
 #include <boost/operators.hpp>
@@ -42,6 +43,16 @@ public:
 
     QRect maskBounds() const;
 
+    /**
+     * The adjusted mask as a contiguous row-major buffer of
+     * maskBounds().size() pixels in the color space of mask().
+     * The dabs sample the pattern directly from this buffer instead
+     * of copying the pattern into a temporary device for every dab.
+     */
+    const quint8* maskData() const;
+
+    int maskPixelSize() const;
+
     bool fillProperties(const KisPropertiesConfiguration *setting, KisResourcesInterfaceSP resourcesInterface, bool invertAdditionally);
 
     void recalculateMask();
@@ -66,6 +77,7 @@ private:
 
     KisPaintDeviceSP m_mask;
     QRect m_maskBounds;
+    QVector<quint8> m_maskData;
 
 };
 
@@ -30,6 +30,7 @@
 #include <kis_painter.h>
 #include <kis_iterator_ng.h>
 #include <kis_fixed_paint_device.h>
+#include <KoColorSpace.h>
 #include "KoMixColorsOp.h"
 #include <strokes/KisMaskingBrushCompositeOpBase.h>
 #include <strokes/KisMaskingBrushCompositeOpFactory.h>
@@ -40,6 +41,54 @@
 #include <KoCanvasResourcesInterface.h>
 #include <KoResourceLoadResult.h>
 
+namespace {
+
+/**
+ * Splits the dab into the parts that map onto contiguous areas of the
+ * pattern buffer (the pattern is repeated infinitely) and calls
+ *
+ * func(patternPtr, patternRowStride, dabX, dabY, columns, rows)
+ *
+ * for every part.
+ */
+template <typename Func>
+void forEachPatternChunk(const QSize &dabSize, const QPoint &patternOffset,
+                         const quint8 *patternData, const QSize &patternSize,
+                         int patternPixelSize, Func func)
+{
+    auto wrap = [] (int value, int size) {
+        const int result = value % size;
+        return result >= 0 ? result : result + size;
+    };
+
+    const int patternRowStride = patternSize.width() * patternPixelSize;
+
+    int dabY = 0;
+    int patternY = wrap(patternOffset.y(), patternSize.height());
+
+    while (dabY < dabSize.height()) {
+        const int rows = qMin(dabSize.height() - dabY, patternSize.height() - patternY);
+
+        int dabX = 0;
+        int patternX = wrap(patternOffset.x(), patternSize.width());
+
+        while (dabX < dabSize.width()) {
+            const int columns = qMin(dabSize.width() - dabX, patternSize.width() - patternX);
+
+            func(patternData + patternY * patternRowStride + patternX * patternPixelSize,
+                 patternRowStride, dabX, dabY, columns, rows);
+
+            dabX += columns;
+            patternX = 0;
+        }
+
+        dabY += rows;
+        patternY = 0;
+    }
+}
+
+}
+
 /**********************************************************************/
 /*       KisTextureOption                                             */
 /**********************************************************************/
@@ -178,33 +227,34 @@ void KisTextureOption::applyLightness(KisFixedPaintDeviceSP dab, const QPoint& o
     if (!m_enabled) return;
     if (!m_maskInfo->isValid()) return;
 
-    KisPaintDeviceSP mask = m_maskInfo->mask();
+    KIS_SAFE_ASSERT_RECOVER_RETURN(m_maskInfo->maskPixelSize() == int(sizeof(QRgb)));
 
     const QRect rect = dab->bounds();
     const QRect maskBounds = m_maskInfo->maskBounds();
 
-    KisCachedPaintDevice::Guard g(mask, KoColorSpaceRegistry::instance()->rgb8(), m_cachedPaintDevice);
-    KisPaintDeviceSP fillMaskDevice = g.device();
+    const QPoint patternOffset(offset.x() % maskBounds.width() - m_offsetX,
+                               offset.y() % maskBounds.height() - m_offsetY);
 
-    int x = offset.x() % maskBounds.width() - m_offsetX;
-    int y = offset.y() % maskBounds.height() - m_offsetY;
+    const qreal pressure = m_strengthOption.apply(info);
+    const KoColorSpace *cs = dab->colorSpace();
+    const int pixelSize = dab->pixelSize();
+    const int dabRowStride = rect.width() * pixelSize;
 
-    const QRect maskPatchRect = QRect(x, y, rect.width(), rect.height());
+    forEachPatternChunk(rect.size(), patternOffset,
+                        m_maskInfo->maskData(), maskBounds.size(), sizeof(QRgb),
+                        [&] (const quint8 *patternPtr, int patternRowStride,
+                             int dabX, int dabY, int columns, int rows) {
 
-    KisFillPainter fillMaskPainter(fillMaskDevice);
-    fillMaskPainter.setCompositeOpId(COMPOSITE_COPY);
-    fillMaskPainter.fillRect(kisGrowRect(maskPatchRect, 1), mask, maskBounds);
-    fillMaskPainter.end();
+        quint8 *dabRow = dab->data() + dabY * dabRowStride + dabX * pixelSize;
 
-    qreal pressure = m_strengthOption.apply(info);
-    quint8* dabData = dab->data();
+        for (int row = 0; row < rows; row++) {
+            const QRgb *maskQRgb = reinterpret_cast<const QRgb*>(patternPtr);
+            cs->fillGrayBrushWithPixelColorAndLightnessWithStrength(dabRow, maskQRgb, pressure, columns);
 
-    KisSequentialConstIterator it(fillMaskDevice, QRect(x, y, rect.width(), rect.height()));
-    while (it.nextPixel()) {
-        const QRgb *maskQRgb = reinterpret_cast<const QRgb*>(it.oldRawData());
-        dab->colorSpace()->fillGrayBrushWithColorAndLightnessWithStrength(dabData, maskQRgb, dabData, pressure, 1);
-        dabData += dab->pixelSize();
-    }
+            patternPtr += patternRowStride;
+            dabRow += dabRowStride;
+        }
+    });
 }
 
 void KisTextureOption::applyGradient(KisFixedPaintDeviceSP dab, const QPoint& offset, const KisPaintInformation& info) {
@@ -212,26 +262,17 @@ void KisTextureOption::applyGradient(KisFixedPaintDeviceSP dab, const QPoint& of
     if (!m_maskInfo->isValid()) return;
 
     KIS_SAFE_ASSERT_RECOVER_RETURN(m_gradient && m_gradient->valid());
+    KIS_SAFE_ASSERT_RECOVER_RETURN(m_maskInfo->maskPixelSize() == int(sizeof(QRgb)));
 
-    KisPaintDeviceSP mask = m_maskInfo->mask();
     const QRect maskBounds = m_maskInfo->maskBounds();
     QRect rect = dab->bounds();
 
-    KisCachedPaintDevice::Guard g(mask, KoColorSpaceRegistry::instance()->rgb8(), m_cachedPaintDevice);
-    KisPaintDeviceSP fillDevice = g.device();
-
-    int x = offset.x() % maskBounds.width() - m_offsetX;
-    int y = offset.y() % maskBounds.height() - m_offsetY;
-
-    const QRect maskPatchRect = QRect(x, y, rect.width(), rect.height());
-
-    KisFillPainter fillPainter(fillDevice);
-    fillPainter.setCompositeOpId(COMPOSITE_COPY);
-    fillPainter.fillRect(kisGrowRect(maskPatchRect, 1), mask, maskBounds);
-    fillPainter.end();
+    const QPoint patternOffset(offset.x() % maskBounds.width() - m_offsetX,
+                               offset.y() % maskBounds.height() - m_offsetY);
 
     qreal pressure = m_strengthOption.apply(info);
-    quint8* dabData = dab->data();
+    const int pixelSize = dab->pixelSize();
+    const int dabRowStride = rect.width() * pixelSize;
 
     //for gradient textures...
     KoMixColorsOp* colorMix = dab->colorSpace()->mixColorsOp();
@@ -241,26 +282,36 @@ void KisTextureOption::applyGradient(KisFixedPaintDeviceSP dab, const QPoint& of
     quint8* colors[2];
     m_cachedGradient.setColorSpace(dab->colorSpace()); //Change colorspace here so we don't have to convert each pixel drawn
 
-    KisHLineIteratorSP iter = fillDevice->createHLineIteratorNG(x, y, rect.width());
-    for (int row = 0; row < rect.height(); ++row) {
-        for (int col = 0; col < rect.width(); ++col) {
-
-            const QRgb* maskQRgb = reinterpret_cast<const QRgb*>(iter->oldRawData());
-            qreal gradientvalue = qreal(qGray(*maskQRgb))/255.0;//qreal(*iter->oldRawData()) / 255.0;
-            KoColor paintcolor;
-            paintcolor.setColor(m_cachedGradient.cachedAt(gradientvalue), dab->colorSpace());
-            qreal paintOpacity = paintcolor.opacityF() * (qreal(qAlpha(*maskQRgb)) / 255.0);
-            paintcolor.setOpacity(qMin(paintOpacity, dab->colorSpace()->opacityF(dabData)));
-            colors[0] = paintcolor.data();
-            KoColor dabColor(dabData, dab->colorSpace());
-            colors[1] = dabColor.data();
-            colorMix->mixColors(colors, colorWeights, 2, dabData);
-
-            iter->nextPixel();
-            dabData += dab->pixelSize();
+    forEachPatternChunk(rect.size(), patternOffset,
+                        m_maskInfo->maskData(), maskBounds.size(), sizeof(QRgb),
+                        [&] (const quint8 *patternPtr, int patternRowStride,
+                             int dabX, int dabY, int columns, int rows) {
+
+        quint8 *dabRow = dab->data() + dabY * dabRowStride + dabX * pixelSize;
+
+        for (int row = 0; row < rows; ++row) {
+            const QRgb *maskQRgb = reinterpret_cast<const QRgb*>(patternPtr);
+            quint8 *dabData = dabRow;
+
+            for (int col = 0; col < columns; ++col) {
+                qreal gradientvalue = qreal(qGray(*maskQRgb))/255.0;
+                KoColor paintcolor;
+                paintcolor.setColor(m_cachedGradient.cachedAt(gradientvalue), dab->colorSpace());
+                qreal paintOpacity = paintcolor.opacityF() * (qreal(qAlpha(*maskQRgb)) / 255.0);
+                paintcolor.setOpacity(qMin(paintOpacity, dab->colorSpace()->opacityF(dabData)));
+                colors[0] = paintcolor.data();
+                KoColor dabColor(dabData, dab->colorSpace());
+                colors[1] = dabColor.data();
+                colorMix->mixColors(colors, colorWeights, 2, dabData);
+
+                maskQRgb++;
+                dabData += pixelSize;
+            }
+
+            patternPtr += patternRowStride;
+            dabRow += dabRowStride;
         }
-        iter->nextRow();
-    }
+    });
 }
 
 void KisTextureOption::apply(KisFixedPaintDeviceSP dab, const QPoint &offset, const KisPaintInformation & info)
@@ -277,22 +328,13 @@ void KisTextureOption::apply(KisFixedPaintDeviceSP dab, const QPoint &offset, co
         return;
     }
 
-    QRect rect = dab->bounds();
-    KisPaintDeviceSP mask = m_maskInfo->mask();
+    const QRect rect = dab->bounds();
     const QRect maskBounds = m_maskInfo->maskBounds();
 
-    KisCachedPaintDevice::Guard g(mask, KoColorSpaceRegistry::instance()->alpha8(), m_cachedPaintDevice);
-    KisPaintDeviceSP maskPatch = g.device();
-
-    int x = offset.x() % maskBounds.width() - m_offsetX;
-    int y = offset.y() % maskBounds.height() - m_offsetY;
+    KIS_SAFE_ASSERT_RECOVER_RETURN(m_maskInfo->maskPixelSize() == 1);
 
-    const QRect maskPatchRect = QRect(x, y, rect.width(), rect.height());
-
-    KisFillPainter fillPainter(maskPatch);
-    fillPainter.setCompositeOpId(COMPOSITE_COPY);
-    fillPainter.fillRect(kisGrowRect(maskPatchRect, 1), mask, maskBounds);
-    fillPainter.end();
+    const QPoint patternOffset(offset.x() % maskBounds.width() - m_offsetX,
+                               offset.y() % maskBounds.height() - m_offsetY);
 
     // Compute final strength
     qreal strength = m_strengthOption.apply(info);
@@ -340,44 +382,16 @@ void KisTextureOption::apply(KisFixedPaintDeviceSP dab, const QPoint &offset, co
                         alphaChannelOffset, strength, m_useSoftTexturing));
 
     // Apply the mask to the dab
-    {
-        quint8 *dabIt = nullptr;
-        KisRandomConstAccessorSP maskPatchIt = maskPatch->createRandomConstAccessorNG();
-
-        qint32 dabY = dab->bounds().y();
-        qint32 maskPatchY = maskPatchRect.y();
-        qint32 rowsRemaining = dab->bounds().height();
-        const qint32 dabRowStride = dab->bounds().width() * dab->pixelSize();
-
-        while (rowsRemaining > 0) {
-            qint32 dabX = dab->bounds().x();
-            qint32 maskPatchX = maskPatchRect.x();
-            const qint32 numContiguousMaskPatchRows = maskPatchIt->numContiguousRows(maskPatchY);
-            const qint32 rows = std::min(rowsRemaining, numContiguousMaskPatchRows);
-            qint32 columnsRemaining = dab->bounds().width();
-
-            while (columnsRemaining > 0) {
-                const qint32 numContiguousMaskPatchColumns = maskPatchIt->numContiguousColumns(maskPatchX);
-                const qint32 columns = std::min(columnsRemaining, numContiguousMaskPatchColumns);
-
-                const qint32 maskPatchRowStride = maskPatchIt->rowStride(maskPatchX, maskPatchY);
-
-                dabIt = dab->data() + (dabY * dab->bounds().width() + dabX) * dab->pixelSize();
-                maskPatchIt->moveTo(maskPatchX, maskPatchY);
-
-                compositeOp->composite(maskPatchIt->rawDataConst(), maskPatchRowStride,
-                                       dabIt, dabRowStride,
-                                       columns, rows);
-
-                dabX += columns;
-                maskPatchX += columns;
-                columnsRemaining -= columns;
-
-            }
-
-            dabY += rows;
-            maskPatchY += rows;
-            rowsRemaining -= rows;
-        }
-    }
+    const int dabRowStride = rect.width() * dab->pixelSize();
+
+    forEachPatternChunk(rect.size(), patternOffset,
+                        m_maskInfo->maskData(), maskBounds.size(), 1,
+                        [&] (const quint8 *patternPtr, int patternRowStride,
+                             int dabX, int dabY, int columns, int rows) {
+
+        compositeOp->composite(patternPtr, patternRowStride,
+                               dab->data() + dabY * dabRowStride + dabX * dab->pixelSize(),
+                               dabRowStride,
+                               columns, rows);
+    });
 }
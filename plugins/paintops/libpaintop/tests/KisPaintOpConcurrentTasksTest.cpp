@@ -0,0 +1,115 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#include "KisPaintOpConcurrentTasksTest.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <KisPaintOpConcurrentTasks.h>
+#include <KisRunnableStrokeJobDataBase.h>
+#include <KisRunnableStrokeJobsInterface.h>
+
+namespace {
+
+/**
+ * Collects the jobs without running them, as if all the threads
+ * of the stroke were busy
+ */
+struct DeferredJobsInterface : public KisRunnableStrokeJobsInterface
+{
+    ~DeferredJobsInterface() override {
+        qDeleteAll(jobs);
+    }
+
+    void addRunnableJobs(const QVector<KisRunnableStrokeJobDataBase*> &list) override {
+        jobs += list;
+    }
+
+    QVector<KisRunnableStrokeJobDataBase*> jobs;
+};
+
+/**
+ * Starts every job in its own thread right away
+ */
+struct ThreadedJobsInterface : public KisRunnableStrokeJobsInterface
+{
+    ~ThreadedJobsInterface() override {
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+    }
+
+    void addRunnableJobs(const QVector<KisRunnableStrokeJobDataBase*> &list) override {
+        for (KisRunnableStrokeJobDataBase *job : list) {
+            threads.emplace_back([job] () {
+                job->run();
+                delete job;
+            });
+        }
+    }
+
+    std::vector<std::thread> threads;
+};
+
+}
+
+void KisPaintOpConcurrentTasksTest::testNoJobsInterface()
+{
+    QVector<int> executed;
+
+    KisPaintOpConcurrentTasks::run(nullptr, 5, [&] (int i) {
+        executed.append(i);
+    });
+
+    QCOMPARE(executed, QVector<int>({0, 1, 2, 3, 4}));
+}
+
+void KisPaintOpConcurrentTasksTest::testJobsStartedLate()
+{
+    DeferredJobsInterface jobsInterface;
+    QVector<int> executed;
+
+    KisPaintOpConcurrentTasks::run(&jobsInterface, 4, [&] (int i) {
+        executed.append(i);
+    });
+
+    // the calling thread has done all the work itself
+    QCOMPARE(executed, QVector<int>({0, 1, 2, 3}));
+    QCOMPARE(jobsInterface.jobs.size(), 3);
+
+    // the jobs started after the return should do nothing
+    for (KisRunnableStrokeJobDataBase *job : jobsInterface.jobs) {
+        job->run();
+    }
+
+    QCOMPARE(executed.size(), 4);
+}
+
+void KisPaintOpConcurrentTasksTest::testJobsStartedConcurrently()
+{
+    const int numTasks = 64;
+    std::vector<std::atomic<int>> counters(numTasks);
+
+    for (auto &counter : counters) {
+        counter = 0;
+    }
+
+    {
+        ThreadedJobsInterface jobsInterface;
+
+        KisPaintOpConcurrentTasks::run(&jobsInterface, numTasks, [&] (int i) {
+            counters[i]++;
+        });
+
+        // all the tasks should be completed on return
+        for (int i = 0; i < numTasks; i++) {
+            QCOMPARE(counters[i].load(), 1);
+        }
+    }
+}
+
+SIMPLE_TEST_MAIN(KisPaintOpConcurrentTasksTest)
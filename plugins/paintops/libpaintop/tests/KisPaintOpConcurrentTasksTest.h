@@ -0,0 +1,20 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef KISPAINTOPCONCURRENTTASKSTEST_H
+#define KISPAINTOPCONCURRENTTASKSTEST_H
+
+#include <simpletest.h>
+
+class KisPaintOpConcurrentTasksTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testNoJobsInterface();
+    void testJobsStartedLate();
+    void testJobsStartedConcurrently();
+};
+
+#endif // KISPAINTOPCONCURRENTTASKSTEST_H
@@ -19,6 +19,21 @@
 #include <qmath.h>
 #include <KoCompositeOpRegistry.h>
 #include <KoMixColorsOp.h>
+#include <kis_image_config.h>
+#include <kis_random_accessor_ng.h>
+#include <KisPaintOpConcurrentTasks.h>
+#include <KisPerformanceTracer.h>
+
+namespace {
+const int tileSizeShift = 6;
+const int tileSize = 1 << tileSizeShift;
+
+/**
+ * The queued dabs are rendered in parallel only when there is enough
+ * work for several threads.
+ */
+const qint64 minAreaPerThread = 4 * tileSize * tileSize;
+}
 
 using namespace std;
 
@@ -57,10 +72,13 @@ KisMyPaintSurface::KisMyPaintSurface(KisPainter *painter, KisPaintDeviceSP paint
     // devices for mask information
     static const KoColorSpace *maskCs = KoColorSpaceRegistry::instance()->alpha8();
     m_maskDevice = KisFixedPaintDeviceSP(new KisFixedPaintDevice(maskCs));
+
+    m_maxNumThreads = KisImageConfig(true).maxNumberOfThreads();
 }
 
 KisMyPaintSurface::~KisMyPaintSurface()
 {
+    flushQueuedDabs();
     mypaint_surface_unref(m_surface);
 }
 
@@ -116,6 +134,132 @@ void KisMyPaintSurface::get_color(MyPaintSurface *self, float x, float y, float
 
 
 /*GIMP's draw_dab and get_color code*/
+KisMyPaintSurface::Dab KisMyPaintSurface::prepareDab(float x, float y, float radius, float color_r, float color_g,
+                                                     float color_b, float opaque, float hardness, float color_a,
+                                                     float aspect_ratio, float angle, float colorize)
+{
+    Dab dab;
+
+    dab.x = x;
+    dab.y = y;
+    dab.radius = radius;
+    dab.colorR = color_r;
+    dab.colorG = color_g;
+    dab.colorB = color_b;
+    dab.colorA = color_a;
+    dab.opaque = opaque;
+
+    dab.oneOverRadius2 = 1.0f / (radius * radius);
+    const double angle_rad = kisDegreesToRadians(angle);
+    dab.cs = cos(angle_rad);
+    dab.sn = sin(angle_rad);
+
+    hardness = CLAMP (hardness, 0.0f, 1.0f);
+    dab.hardness = hardness;
+    dab.segment1Slope = -(1.0f / hardness - 1.0f);
+    dab.segment2Slope = -hardness / (1.0f - hardness);
+    dab.aspectRatio = max(1.0f, aspect_ratio);
+
+    float r_aa_start = radius - 1.0f;
+    r_aa_start = max(r_aa_start, 0.0f);
+    dab.rAaStart = (r_aa_start * r_aa_start) / dab.aspectRatio;
+
+    dab.normalMode = opaque * (1.0f - colorize);
+    dab.colorize = opaque * colorize;
+
+    const QPoint pt = QPoint(x - radius - 1, y - radius - 1);
+    const QSize sz = QSize(2 * (radius+1), 2 * (radius+1));
+
+    dab.rect = QRect(pt, sz);
+
+    return dab;
+}
+
+template <typename channelType>
+inline bool KisMyPaintSurface::blendDabPixel(const Dab &dab, int xp, int yp, channelType *nativeArray, bool eraser)
+{
+    const float unitValue = KoColorSpaceMathsTraits<channelType>::unitValue;
+    const float minValue = KoColorSpaceMathsTraits<channelType>::min;
+
+    float rr, base_alpha, alpha, dst_alpha, r, g, b, a;
+
+    if (dab.radius < 3.0) {
+        rr = calculate_rr_antialiased (xp, yp, dab.x, dab.y, dab.aspectRatio, dab.sn, dab.cs, dab.oneOverRadius2, dab.rAaStart);
+    }
+    else {
+        rr = calculate_rr (xp, yp, dab.x, dab.y, dab.aspectRatio, dab.sn, dab.cs, dab.oneOverRadius2);
+    }
+
+    base_alpha = calculate_alpha_for_rr (rr, dab.hardness, dab.segment1Slope, dab.segment2Slope);
+    alpha = base_alpha * dab.normalMode;
+
+    // the pixel is not covered by the dab mask
+    if (!(alpha > minValue)) {
+        return false;
+    }
+
+    b = nativeArray[0]/unitValue;
+    g = nativeArray[1]/unitValue;
+    r = nativeArray[2]/unitValue;
+    dst_alpha = nativeArray[3]/unitValue;
+
+    if (unitValue == 1.0f) {
+        swap(b, r);
+    }
+
+    a = alpha * (dab.colorA - dst_alpha) + dst_alpha;
+
+    if (eraser) {
+        alpha = 1 - (dab.opaque*base_alpha);
+        a = dst_alpha * alpha ;
+    } else {
+        if (a > 0.0f) {
+            float src_term = (alpha * dab.colorA) / a;
+            float dst_term = 1.0f - src_term;
+            r = dab.colorR * src_term + r * dst_term;
+            g = dab.colorG * src_term + g * dst_term;
+            b = dab.colorB * src_term + b * dst_term;
+        }
+
+        if (dab.colorize > 0.0f && base_alpha > 0.0f) {
+
+            alpha = base_alpha * dab.colorize;
+            a = alpha + dst_alpha - alpha * dst_alpha;
+
+            if (a > 0.0f) {
+
+                float pixel_h, pixel_s, pixel_l, out_h, out_s, out_l;
+                float out_r = r, out_g = g, out_b = b;
+
+                float src_term = alpha / a;
+                float dst_term = 1.0f - src_term;
+
+                RGBToHSL(dab.colorR, dab.colorG, dab.colorB, &pixel_h, &pixel_s, &pixel_l);
+                RGBToHSL(out_r, out_g, out_b, &out_h, &out_s, &out_l);
+
+                out_h = pixel_h;
+                out_s = pixel_s;
+
+                HSLToRGB(out_h, out_s, out_l, &out_r, &out_g, &out_b);
+
+                r = (float)out_r * src_term + r * dst_term;
+                g = (float)out_g * src_term + g * dst_term;
+                b = (float)out_b * src_term + b * dst_term;
+            }
+        }
+    }
+
+    if (unitValue == 1.0f) {
+        swap(b, r);
+    }
+    nativeArray[0] = KoColorSpaceMaths<float, channelType>::scaleToA(b);
+    nativeArray[1] = KoColorSpaceMaths<float, channelType>::scaleToA(g);
+    nativeArray[2] = KoColorSpaceMaths<float, channelType>::scaleToA(r);
+    nativeArray[3] = KoColorSpaceMaths<float, channelType>::scaleToA(a);
+
+    return true;
+}
+
 template <typename channelType>
 int KisMyPaintSurface::drawDabImpl(MyPaintSurface *self, float x, float y, float radius, float color_r, float color_g,
                                 float color_b, float opaque, float hardness, float color_a,
@@ -123,31 +267,18 @@ int KisMyPaintSurface::drawDabImpl(MyPaintSurface *self, float x, float y, float
 
     Q_UNUSED(self);
     Q_UNUSED(lock_alpha);
-    const float one_over_radius2 = 1.0f / (radius * radius);
-    const double angle_rad = kisDegreesToRadians(angle);
-    const float cs = cos(angle_rad);
-    const float sn = sin(angle_rad);
-    float normal_mode;
-    float segment1_slope;
-    float segment2_slope;
-    float r_aa_start;
-
-    hardness = CLAMP (hardness, 0.0f, 1.0f);
-    segment1_slope = -(1.0f / hardness - 1.0f);
-    segment2_slope = -hardness / (1.0f - hardness);
-    aspect_ratio = max(1.0f, aspect_ratio);
 
-    r_aa_start = radius - 1.0f;
-    r_aa_start = max(r_aa_start, 0.0f);
-    r_aa_start = (r_aa_start * r_aa_start) / aspect_ratio;
+    const Dab dab = prepareDab(x, y, radius, color_r, color_g, color_b, opaque,
+                               hardness, color_a, aspect_ratio, angle, colorize);
 
-    normal_mode = opaque * (1.0f - colorize);
-    colorize = opaque * colorize;
+    if (m_isInAtomicSection && canQueueDabs()) {
+        m_queuedDabs.append(dab);
+        return 1;
+    }
 
-    const QPoint pt = QPoint(x - radius - 1, y - radius - 1);
-    const QSize sz = QSize(2 * (radius+1), 2 * (radius+1));
+    flushQueuedDabs();
 
-    const QRect dabRectAligned = QRect(pt, sz);
+    const QRect dabRectAligned = dab.rect;
     const QPointF center = QPointF(x, y);
 
     KisAlgebra2D::OuterCircle outer(center, radius);
@@ -157,8 +288,6 @@ int KisMyPaintSurface::drawDabImpl(MyPaintSurface *self, float x, float y, float
 
     quint8 maskUnitValue = KoColorSpaceMathsTraits<quint8>::unitValue; // because it's alpha8
 
-    float unitValue = KoColorSpaceMathsTraits<channelType>::unitValue;
-    float minValue = KoColorSpaceMathsTraits<channelType>::min;
     bool eraser = painter()->compositeOpId() == COMPOSITE_ERASE;
 
 
@@ -183,96 +312,181 @@ int KisMyPaintSurface::drawDabImpl(MyPaintSurface *self, float x, float y, float
             continue;
         }
 
-        float rr, base_alpha, alpha, dst_alpha, r, g, b, a;
-
-        if (radius < 3.0) {
-            rr = calculate_rr_antialiased (it.x(), it.y(), x, y, aspect_ratio, sn, cs, one_over_radius2, r_aa_start);
-        }
-        else {
-            rr = calculate_rr (it.x(), it.y(), x, y, aspect_ratio, sn, cs, one_over_radius2);
-        }
-
-        base_alpha = calculate_alpha_for_rr (rr, hardness, segment1_slope, segment2_slope);
-
-        m_tempPainter->selection();
-        alpha = base_alpha * normal_mode;
+        channelType* nativeArray = reinterpret_cast<channelType*>(it.rawData());
 
         // set alpha to mask
-        if (alpha > minValue) {
+        if (blendDabPixel(dab, it.x(), it.y(), nativeArray, eraser)) {
             *maskPointer = (quint8)(maskUnitValue);
         }
 
-        channelType* nativeArray = reinterpret_cast<channelType*>(it.rawData());
+        maskPointer++;
+    }
 
-        b = nativeArray[0]/unitValue;
-        g = nativeArray[1]/unitValue;
-        r = nativeArray[2]/unitValue;
-        dst_alpha = nativeArray[3]/unitValue;
 
-        if (unitValue == 1.0f) {
-            swap(b, r);
-        }
+    m_tempPainter->bitBltWithFixedSelection(dabRectAligned.x(), dabRectAligned.y(), m_dab, m_maskDevice, dabRectAligned.x(), dabRectAligned.y(), dabRectAligned.x(), dabRectAligned.y(), dabRectAligned.width(), dabRectAligned.height());
+    m_tempPainter->renderMirrorMask(dabRectAligned, m_dab, dabRectAligned.x(), dabRectAligned.y(), m_maskDevice);
+    const QVector<QRect> dirtyRects = m_tempPainter->takeDirtyRegion();
+    m_precisePainterWrapper.writeRects(dirtyRects);
+    painter()->addDirtyRects(dirtyRects);
+    return 1;
+}
 
-        a = alpha * (color_a - dst_alpha) + dst_alpha;
+void KisMyPaintSurface::beginAtomic()
+{
+    m_isInAtomicSection = true;
+}
 
-        if (eraser) {
-            alpha = 1 - (opaque*base_alpha);
-            a = dst_alpha * alpha ;
-        } else {
-            if (a > 0.0f) {
-                float src_term = (alpha * color_a) / a;
-                float dst_term = 1.0f - src_term;
-                r = color_r * src_term + r * dst_term;
-                g = color_g * src_term + g * dst_term;
-                b = color_b * src_term + b * dst_term;
-            }
+void KisMyPaintSurface::endAtomic()
+{
+    flushQueuedDabs();
+    m_isInAtomicSection = false;
+}
 
-            if (colorize > 0.0f && base_alpha > 0.0f) {
+bool KisMyPaintSurface::canQueueDabs() const
+{
+    /**
+     * The queued dabs are blended in place, tile by tile, so every pixel
+     * of the result should depend on the same pixel of the device only.
+     * Mirroring and selections break this assumption, and in wrap-around
+     * mode two different tiles may be the same tile of the device.
+     */
+    const QBitArray channelFlags = m_painter->channelFlags();
 
-                alpha = base_alpha * colorize;
-                a = alpha + dst_alpha - alpha * dst_alpha;
+    return !m_painter->selection() &&
+        (channelFlags.isEmpty() || channelFlags.count(true) == channelFlags.size()) &&
+        !m_painter->hasMirroring() &&
+        !m_painter->device()->defaultBounds()->wrapAroundMode();
+}
 
-                if (a > 0.0f) {
+void KisMyPaintSurface::flushQueuedDabs()
+{
+    if (m_queuedDabs.isEmpty()) return;
 
-                    float pixel_h, pixel_s, pixel_l, out_h, out_s, out_l;
-                    float out_r = r, out_g = g, out_b = b;
+    const KoChannelInfo::enumChannelValueType bitDepth = m_surface->bitDepth;
 
-                    float src_term = alpha / a;
-                    float dst_term = 1.0f - src_term;
+    if (bitDepth == KoChannelInfo::UINT8) {
+        renderQueuedDabsImpl<quint8>();
+    }
+    else if (bitDepth == KoChannelInfo::UINT16) {
+        renderQueuedDabsImpl<quint16>();
+    }
+#if defined HAVE_OPENEXR
+    else if (bitDepth == KoChannelInfo::FLOAT16) {
+        renderQueuedDabsImpl<half>();
+    }
+#endif
+    else {
+        renderQueuedDabsImpl<float>();
+    }
+
+    m_queuedDabs.clear();
+}
+
+template <typename channelType>
+void KisMyPaintSurface::renderQueuedDabsImpl()
+{
+    KIS_TRACE_SCOPE("paintop", "KisMyPaintSurface::renderQueuedDabs");
 
-                    RGBToHSL(color_r, color_g, color_b, &pixel_h, &pixel_s, &pixel_l);
-                    RGBToHSL(out_r, out_g, out_b, &out_h, &out_s, &out_l);
+    QVector<QRect> dabRects;
+    dabRects.reserve(m_queuedDabs.size());
 
-                    out_h = pixel_h;
-                    out_s = pixel_s;
+    Q_FOREACH (const Dab &dab, m_queuedDabs) {
+        dabRects.append(dab.rect);
+    }
 
-                    HSLToRGB(out_h, out_s, out_l, &out_r, &out_g, &out_b);
+    m_precisePainterWrapper.readRects(dabRects);
 
-                    r = (float)out_r * src_term + r * dst_term;
-                    g = (float)out_g * src_term + g * dst_term;
-                    b = (float)out_b * src_term + b * dst_term;
+    /**
+     * Every pixel is affected only by the dabs covering it, so the dabs are
+     * binned by tiles, and every tile blends its dabs in the order they were
+     * drawn by libmypaint. The result is the same as if the dabs were drawn
+     * one by one, but the tiles can be processed in parallel.
+     */
+    QHash<quint64, int> tileIndexes;
+    QVector<QPoint> tiles;
+    QVector<QVector<int>> tileDabs;
+    qint64 totalArea = 0;
+
+    for (int i = 0; i < m_queuedDabs.size(); i++) {
+        const QRect &rc = m_queuedDabs[i].rect;
+        if (rc.isEmpty()) continue;
+
+        totalArea += qint64(rc.width()) * rc.height();
+
+        for (int ty = rc.top() >> tileSizeShift; ty <= rc.bottom() >> tileSizeShift; ty++) {
+            for (int tx = rc.left() >> tileSizeShift; tx <= rc.right() >> tileSizeShift; tx++) {
+                const quint64 key = (quint64(quint32(tx)) << 32) | quint64(quint32(ty));
+
+                auto it = tileIndexes.find(key);
+                if (it == tileIndexes.end()) {
+                    it = tileIndexes.insert(key, tiles.size());
+                    tiles.append(QPoint(tx, ty));
+                    tileDabs.append(QVector<int>());
                 }
+
+                tileDabs[*it].append(i);
             }
         }
+    }
 
-        if (unitValue == 1.0f) {
-            swap(b, r);
-        }
-        nativeArray[0] = KoColorSpaceMaths<float, channelType>::scaleToA(b);
-        nativeArray[1] = KoColorSpaceMaths<float, channelType>::scaleToA(g);
-        nativeArray[2] = KoColorSpaceMaths<float, channelType>::scaleToA(r);
-        nativeArray[3] = KoColorSpaceMaths<float, channelType>::scaleToA(a);
+    const int numGroups =
+        qBound(1, int(totalArea / minAreaPerThread), qMin(m_maxNumThreads, tiles.size()));
 
-        maskPointer++;
+    QVector<QVector<int>> groups(numGroups);
+    for (int i = 0; i < tiles.size(); i++) {
+        groups[i % numGroups].append(i);
     }
 
+    KisPaintDeviceSP overlay = m_precisePainterWrapper.overlay();
+    const bool eraser = painter()->compositeOpId() == COMPOSITE_ERASE;
 
-    m_tempPainter->bitBltWithFixedSelection(dabRectAligned.x(), dabRectAligned.y(), m_dab, m_maskDevice, dabRectAligned.x(), dabRectAligned.y(), dabRectAligned.x(), dabRectAligned.y(), dabRectAligned.width(), dabRectAligned.height());
-    m_tempPainter->renderMirrorMask(dabRectAligned, m_dab, dabRectAligned.x(), dabRectAligned.y(), m_maskDevice);
-    const QVector<QRect> dirtyRects = m_tempPainter->takeDirtyRegion();
-    m_precisePainterWrapper.writeRects(dirtyRects);
-    painter()->addDirtyRects(dirtyRects);
-    return 1;
+    KisPaintOpConcurrentTasks::run(painter()->runnableStrokeJobsInterface(), numGroups,
+        [&] (int group) {
+            KisRandomAccessorSP accessor = overlay->createRandomAccessorNG();
+
+            for (int tileIndex : groups[group]) {
+                const QPoint &tile = tiles[tileIndex];
+                const QRect tileRect(tile.x() << tileSizeShift, tile.y() << tileSizeShift,
+                                     tileSize, tileSize);
+
+                for (int dabIndex : tileDabs[tileIndex]) {
+                    const Dab &dab = m_queuedDabs[dabIndex];
+                    const QRect rc = dab.rect & tileRect;
+
+                    KisAlgebra2D::OuterCircle outer(QPointF(dab.x, dab.y), dab.radius);
+
+                    int rows = 0;
+                    for (int y = rc.top(); y <= rc.bottom(); y += rows) {
+                        rows = qMin(accessor->numContiguousRows(y), rc.bottom() - y + 1);
+
+                        int columns = 0;
+                        for (int x = rc.left(); x <= rc.right(); x += columns) {
+                            columns = qMin(accessor->numContiguousColumns(x), rc.right() - x + 1);
+
+                            const qint32 rowStride = accessor->rowStride(x, y);
+                            accessor->moveTo(x, y);
+                            quint8 *rowPtr = accessor->rawData();
+
+                            for (int row = 0; row < rows; row++) {
+                                channelType *nativeArray = reinterpret_cast<channelType*>(rowPtr);
+
+                                for (int col = 0; col < columns; col++) {
+                                    if (outer.fadeSq(QPoint(x + col, y + row)) <= 1.0f) {
+                                        blendDabPixel(dab, x + col, y + row, nativeArray, eraser);
+                                    }
+                                    nativeArray += 4;
+                                }
+
+                                rowPtr += rowStride;
+                            }
+                        }
+                    }
+                }
+            }
+        });
+
+    m_precisePainterWrapper.writeRects(dabRects);
+    painter()->addDirtyRects(dabRects);
 }
 
 template <typename channelType>
@@ -298,6 +512,9 @@ void KisMyPaintSurface::getColorImpl(MyPaintSurface *self, float x, float y, flo
     const float one_over_radius2 = 1.0f / (radius * radius);
     quint32 sum_weight = 0.0f;
 
+    // the color is sampled from the surface with all the dabs drawn so far
+    flushQueuedDabs();
+
     m_precisePainterWrapper.readRect(dabRectAligned);
     KisPaintDeviceSP activeDev = m_precisePainterWrapper.overlay();
     if(m_image) {
@@ -35,6 +35,17 @@ public:
     KisMyPaintSurface(KisPainter* painter, KisPaintDeviceSP paintNode=nullptr, KisImageSP image = nullptr);
     ~KisMyPaintSurface();
 
+    /**
+     * Starts an atomic section of libmypaint painting. The dabs drawn
+     * inside the section are queued and rendered all together in
+     * endAtomic(), tile by tile, using the stroke's worker threads.
+     * Sampling the color with get_color() renders the queued dabs first.
+     *
+     * Outside the atomic section every dab is drawn immediately.
+     */
+    void beginAtomic();
+    void endAtomic();
+
     /**
       * mypaint_surface_draw_dab:
       *
@@ -76,6 +87,48 @@ public:
 
     MyPaintSurface* surface();
 
+private:
+    struct Dab {
+        QRect rect;
+        float x = 0.0f;
+        float y = 0.0f;
+        float radius = 0.0f;
+        float colorR = 0.0f;
+        float colorG = 0.0f;
+        float colorB = 0.0f;
+        float colorA = 0.0f;
+        float opaque = 0.0f;
+        float hardness = 0.0f;
+        float aspectRatio = 1.0f;
+        float normalMode = 0.0f;
+        float colorize = 0.0f;
+        float oneOverRadius2 = 0.0f;
+        float sn = 0.0f;
+        float cs = 1.0f;
+        float segment1Slope = 0.0f;
+        float segment2Slope = 0.0f;
+        float rAaStart = 0.0f;
+    };
+
+    Dab prepareDab(float x, float y, float radius, float color_r, float color_g,
+                   float color_b, float opaque, float hardness, float color_a,
+                   float aspect_ratio, float angle, float colorize);
+
+    /**
+     * Blends the dab into a single pixel in place.
+     *
+     * \return false if the pixel is not covered by the dab and has not
+     *         been changed
+     */
+    template <typename channelType>
+    inline bool blendDabPixel(const Dab &dab, int xp, int yp, channelType *nativeArray, bool eraser);
+
+    bool canQueueDabs() const;
+    void flushQueuedDabs();
+
+    template <typename channelType>
+    void renderQueuedDabsImpl();
+
 private:
     KisPainter *m_painter;
     KisPaintDeviceSP m_imageDevice;
@@ -88,6 +141,9 @@ private:
     KisFixedPaintDeviceSP m_blendDevice;
     KisFixedPaintDeviceSP m_maskDevice;
 
+    bool m_isInAtomicSection = false;
+    QVector<Dab> m_queuedDabs;
+    int m_maxNumThreads = 1;
 };
 
 #endif // KIS_MYPAINT_SURFACE_H
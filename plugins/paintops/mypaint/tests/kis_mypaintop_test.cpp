@@ -79,6 +79,47 @@ void KisMyPaintOpTest::testGetColor() {
     QVERIFY(qFuzzyCompare((float)qRound(a), 1.0L));
 }
 
+void KisMyPaintOpTest::testQueuedDabs() {
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    KisPaintDeviceSP immediateDevice = new KisPaintDevice(cs);
+    KisPaintDeviceSP queuedDevice = new KisPaintDevice(cs);
+
+    KisPainter immediatePainter(immediateDevice);
+    KisPainter queuedPainter(queuedDevice);
+
+    QScopedPointer<KisMyPaintSurface> immediateSurface(new KisMyPaintSurface(&immediatePainter, immediateDevice));
+    QScopedPointer<KisMyPaintSurface> queuedSurface(new KisMyPaintSurface(&queuedPainter, queuedDevice));
+
+    auto drawDabs = [] (KisMyPaintSurface *surface) {
+        // overlapping dabs of different sizes crossing the tile borders
+        for (int i = 0; i < 40; i++) {
+            surface->draw_dab(surface->surface(), 20 + i * 7.3, 50 + i * 3.1, 2.0 + (i % 7) * 9.5,
+                              0.1 * (i % 10), 0.5, 1.0 - 0.1 * (i % 10), 0.7, 0.3 + 0.015 * i,
+                              0.9, 1.0 + (i % 3), 13.0 * i, 0, (i % 5 == 0) ? 0.5 : 0.0);
+        }
+    };
+
+    drawDabs(immediateSurface.data());
+
+    queuedSurface->beginAtomic();
+    drawDabs(queuedSurface.data());
+    queuedSurface->endAtomic();
+
+    QCOMPARE(queuedDevice->exactBounds(), immediateDevice->exactBounds());
+
+    const QRect rc = immediateDevice->exactBounds();
+    QImage immediateImage = immediateDevice->convertToQImage(0, rc.x(), rc.y(), rc.width(), rc.height());
+    QImage queuedImage = queuedDevice->convertToQImage(0, rc.x(), rc.y(), rc.width(), rc.height());
+
+    QPoint errpoint;
+    if (!TestUtil::compareQImages(errpoint, immediateImage, queuedImage)) {
+        queuedImage.save("mypaint_test_queued_dabs.png");
+        QFAIL(QString("Queued dabs differ from immediate ones, first different pixel: %1,%2 \n").arg(errpoint.x()).arg(errpoint.y()).toLatin1());
+    }
+}
+
 void KisMyPaintOpTest::testLoading() {
 
     QScopedPointer<KisMyPaintPaintOpPreset> brush (new KisMyPaintPaintOpPreset(QString(FILES_DATA_DIR) + QDir::separator() + "basic.myb"));
@@ -0,0 +1,312 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisSprayParticleBatch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <QHash>
+
+#include <KoColorSpace.h>
+#include <KoCompositeOp.h>
+#include <KoCompositeOpRegistry.h>
+
+#include <kis_assert.h>
+#include <kis_default_bounds_base.h>
+#include <kis_global.h>
+#include <kis_paint_device.h>
+#include <kis_random_accessor_ng.h>
+#include <KisPaintOpConcurrentTasks.h>
+
+namespace {
+
+// the size of the tiles of a paint device
+const int tileSizeShift = 6;
+const int tileSize = 1 << tileSizeShift;
+
+/**
+ * Splitting the dabs smaller than that between the threads
+ * doesn't pay off
+ */
+const qint64 minAreaPerThread = 4 * tileSize * tileSize;
+
+}
+
+void KisSprayParticleBatch::reset(const KoColorSpace *colorSpace)
+{
+    m_colorSpace = colorSpace;
+    m_pixelSize = colorSpace->pixelSize();
+
+    m_particles.clear();
+    m_colors.clear();
+    m_currentColorOffset = -1;
+    m_totalArea = 0;
+}
+
+void KisSprayParticleBatch::setColor(const quint8 *color)
+{
+    if (m_currentColorOffset >= 0 &&
+        !memcmp(m_colors.constData() + m_currentColorOffset, color, m_pixelSize)) {
+
+        return;
+    }
+
+    m_currentColorOffset = m_colors.size();
+    m_colors.resize(m_currentColorOffset + m_pixelSize);
+    memcpy(m_colors.data() + m_currentColorOffset, color, m_pixelSize);
+}
+
+void KisSprayParticleBatch::addShape(Shape shape, qreal x, qreal y, qreal halfWidth, qreal halfHeight, qreal angle, qreal opacity)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(m_currentColorOffset >= 0);
+
+    Particle particle;
+    particle.shape = shape;
+    particle.x = x;
+    particle.y = y;
+    particle.halfWidth = halfWidth;
+    particle.halfHeight = halfHeight;
+    particle.cosAngle = std::cos(angle);
+    particle.sinAngle = std::sin(angle);
+    particle.opacity = opacity;
+    particle.colorOffset = m_currentColorOffset;
+
+    // the extent of the rotated shape plus one pixel of antialiasing
+    const qreal extentX = qAbs(particle.cosAngle) * halfWidth + qAbs(particle.sinAngle) * halfHeight + 1.0;
+    const qreal extentY = qAbs(particle.sinAngle) * halfWidth + qAbs(particle.cosAngle) * halfHeight + 1.0;
+
+    particle.bounds = QRect(QPoint(int(std::floor(x - extentX)), int(std::floor(y - extentY))),
+                            QPoint(int(std::ceil(x + extentX)), int(std::ceil(y + extentY))));
+
+    m_totalArea += qint64(particle.bounds.width()) * particle.bounds.height();
+    m_particles.append(particle);
+}
+
+void KisSprayParticleBatch::addEllipse(qreal x, qreal y, qreal a, qreal b, qreal angle, qreal opacity)
+{
+    addShape(Ellipse, x, y, a, b, angle, opacity);
+}
+
+void KisSprayParticleBatch::addRectangle(qreal x, qreal y, qreal width, qreal height, qreal angle, qreal opacity)
+{
+    addShape(Rectangle, x, y, 0.5 * width, 0.5 * height, angle, opacity);
+}
+
+void KisSprayParticleBatch::addPixel(int x, int y, qreal opacity)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(m_currentColorOffset >= 0);
+
+    Particle particle;
+    particle.shape = Pixel;
+    particle.x = x;
+    particle.y = y;
+    particle.halfWidth = 0.5;
+    particle.halfHeight = 0.5;
+    particle.cosAngle = 1.0;
+    particle.sinAngle = 0.0;
+    particle.opacity = opacity;
+    particle.colorOffset = m_currentColorOffset;
+    particle.bounds = QRect(x, y, 1, 1);
+
+    m_totalArea++;
+    m_particles.append(particle);
+}
+
+void KisSprayParticleBatch::addWuParticle(qreal x, qreal y)
+{
+    const int ipx = int(x);
+    const int ipy = int(y);
+    const qreal fx = x - ipx;
+    const qreal fy = y - ipy;
+
+    addPixel(ipx, ipy, (1 - fx) * (1 - fy));
+    addPixel(ipx + 1, ipy, fx * (1 - fy));
+    addPixel(ipx, ipy + 1, (1 - fx) * fy);
+    addPixel(ipx + 1, ipy + 1, fx * fy);
+}
+
+bool KisSprayParticleBatch::isEmpty() const
+{
+    return m_particles.isEmpty();
+}
+
+void KisSprayParticleBatch::rasterize(KisPaintDeviceSP dab,
+                                      KisRunnableStrokeJobsInterface *jobsInterface,
+                                      int maxNumThreads)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(*dab->colorSpace() == *m_colorSpace);
+
+    /**
+     * In wrap-around mode the accessors wrap the coordinates, so two
+     * different bins may end up in the same tile of the device. Then we
+     * can neither rasterize them in parallel, nor paint them bin by bin,
+     * because the order of the particles covering the same pixel would
+     * change. All the particles are painted serially in one go instead.
+     */
+    if (dab->defaultBounds()->wrapAroundMode()) {
+        QRect totalBounds;
+        QVector<int> particles;
+        particles.reserve(m_particles.size());
+
+        for (int i = 0; i < m_particles.size(); i++) {
+            totalBounds |= m_particles[i].bounds;
+            particles.append(i);
+        }
+
+        rasterizeArea(dab->createRandomAccessorNG(), totalBounds, particles);
+        return;
+    }
+
+    QHash<quint64, int> tileIndexes;
+    QVector<QPoint> tiles;
+    QVector<QVector<int>> tileParticles;
+
+    for (int i = 0; i < m_particles.size(); i++) {
+        const QRect &rc = m_particles[i].bounds;
+
+        for (int ty = rc.top() >> tileSizeShift; ty <= rc.bottom() >> tileSizeShift; ty++) {
+            for (int tx = rc.left() >> tileSizeShift; tx <= rc.right() >> tileSizeShift; tx++) {
+                const quint64 key = (quint64(quint32(tx)) << 32) | quint64(quint32(ty));
+
+                auto it = tileIndexes.find(key);
+                if (it == tileIndexes.end()) {
+                    it = tileIndexes.insert(key, tiles.size());
+                    tiles.append(QPoint(tx, ty));
+                    tileParticles.append(QVector<int>());
+                }
+
+                tileParticles[*it].append(i);
+            }
+        }
+    }
+
+    const int numGroups =
+        qBound(1, int(m_totalArea / minAreaPerThread), qMin(maxNumThreads, tiles.size()));
+
+    QVector<QVector<int>> groups(numGroups);
+    for (int i = 0; i < tiles.size(); i++) {
+        groups[i % numGroups].append(i);
+    }
+
+    KisPaintOpConcurrentTasks::run(jobsInterface, numGroups,
+        [&] (int group) {
+            KisRandomAccessorSP accessor = dab->createRandomAccessorNG();
+
+            for (int tileIndex : groups[group]) {
+                const QPoint &tile = tiles[tileIndex];
+                const QRect tileRect(tile.x() << tileSizeShift, tile.y() << tileSizeShift,
+                                     tileSize, tileSize);
+
+                rasterizeArea(accessor, tileRect, tileParticles[tileIndex]);
+            }
+        });
+}
+
+void KisSprayParticleBatch::rasterizeArea(KisRandomAccessorSP accessor, const QRect &area, const QVector<int> &particles) const
+{
+    const KoCompositeOp *compositeOp = m_colorSpace->compositeOp(COMPOSITE_OVER);
+
+    QVector<quint8> colorBuffer(m_pixelSize);
+    quint8 *color = colorBuffer.data();
+
+    float coverage[tileSize];
+    QVector<quint8> maskBuffer(tileSize * tileSize);
+
+    for (int index : particles) {
+        const Particle &p = m_particles[index];
+        const QRect rc = p.bounds & area;
+        if (rc.isEmpty()) continue;
+
+        memcpy(color, m_colors.constData() + p.colorOffset, m_pixelSize);
+
+        if (p.shape == Pixel) {
+            accessor->moveTo(rc.x(), rc.y());
+
+            if (p.opacity >= 0.0) {
+                m_colorSpace->setOpacity(color, p.opacity, 1);
+            }
+
+            /**
+             * The pixels overwrite each other, e.g. when two particles
+             * are sprayed next to each other, the pixel with lower opacity
+             * can override the other one.
+             */
+            memcpy(accessor->rawData(), color, m_pixelSize);
+            continue;
+        }
+
+        /**
+         * The area is split into the pieces of memory that are contiguous
+         * in the device, though inside a single tile it usually is just
+         * one piece.
+         */
+        int rows = 0;
+        for (int y = rc.top(); y <= rc.bottom(); y += rows) {
+            rows = qMin(accessor->numContiguousRows(y), rc.bottom() - y + 1);
+
+            int columns = 0;
+            for (int x = rc.left(); x <= rc.right(); x += columns) {
+                columns = qMin(accessor->numContiguousColumns(x), rc.right() - x + 1);
+
+                quint8 *maskPtr = maskBuffer.data();
+
+                for (int row = 0; row < rows; row++) {
+                    const float dy = y + row + 0.5f - p.y;
+                    const float x0 = x + 0.5f - p.x;
+
+                    if (p.shape == Ellipse) {
+                        for (int col = 0; col < columns; col++) {
+                            const float dx = x0 + col;
+
+                            // the position of the pixel in the coordinates of the ellipse
+                            const float nx = (p.cosAngle * dx + p.sinAngle * dy) / p.halfWidth;
+                            const float ny = (p.cosAngle * dy - p.sinAngle * dx) / p.halfHeight;
+
+                            /**
+                             * The approximation of the signed distance to the
+                             * ellipse: f(x, y) / |grad f(x, y)|
+                             */
+                            const float f = nx * nx + ny * ny - 1.0f;
+                            const float gx = nx / p.halfWidth;
+                            const float gy = ny / p.halfHeight;
+                            const float gradient = 2.0f * std::sqrt(gx * gx + gy * gy);
+
+                            coverage[col] = 0.5f - f / std::max(gradient, 1e-6f);
+                        }
+                    } else {
+                        for (int col = 0; col < columns; col++) {
+                            const float dx = x0 + col;
+
+                            // the position of the pixel in the coordinates of the rectangle
+                            const float lx = std::abs(p.cosAngle * dx + p.sinAngle * dy);
+                            const float ly = std::abs(p.cosAngle * dy - p.sinAngle * dx);
+
+                            coverage[col] =
+                                std::min(std::max(p.halfWidth + 0.5f - lx, 0.0f), 1.0f) *
+                                std::min(std::max(p.halfHeight + 0.5f - ly, 0.0f), 1.0f);
+                        }
+                    }
+
+                    for (int col = 0; col < columns; col++) {
+                        maskPtr[col] = quint8(std::min(std::max(coverage[col], 0.0f), 1.0f) * 255.0f + 0.5f);
+                    }
+
+                    maskPtr += columns;
+                }
+
+                accessor->moveTo(x, y);
+
+                compositeOp->composite(accessor->rawData(), accessor->rowStride(x, y),
+                                       color, 0,
+                                       maskBuffer.constData(), columns,
+                                       rows, columns,
+                                       p.opacity);
+            }
+        }
+    }
+}
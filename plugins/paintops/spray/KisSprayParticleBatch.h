@@ -0,0 +1,108 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISSPRAYPARTICLEBATCH_H
+#define KISSPRAYPARTICLEBATCH_H
+
+#include <QRect>
+#include <QVector>
+
+#include <kis_types.h>
+
+class KoColorSpace;
+class KisRunnableStrokeJobsInterface;
+
+/**
+ * The particles of a single spray dab.
+ *
+ * The particles are generated by SprayBrush one by one (the random
+ * values and the colors should be fetched in a fixed order), but they
+ * are not painted immediately. Instead, the batch bins them by the
+ * tiles of the dab and rasterizes every tile separately. The tiles are
+ * independent, so they are rasterized in parallel, and the particles
+ * of every tile are painted in the order they were added.
+ *
+ * The coverage of the ellipses and the rectangles is computed
+ * analytically for a whole row of pixels at once.
+ */
+class KisSprayParticleBatch
+{
+public:
+    void reset(const KoColorSpace *colorSpace);
+
+    /**
+     * Makes \p color the color of the following particles
+     */
+    void setColor(const quint8 *color);
+
+    /**
+     * Adds an antialiased ellipse with the center at (\p x, \p y),
+     * composited over the dab with \p opacity
+     */
+    void addEllipse(qreal x, qreal y, qreal a, qreal b, qreal angle, qreal opacity);
+
+    /**
+     * Adds an antialiased rectangle with the center at (\p x, \p y),
+     * composited over the dab with \p opacity
+     */
+    void addRectangle(qreal x, qreal y, qreal width, qreal height, qreal angle, qreal opacity);
+
+    /**
+     * Adds a pixel that overwrites the pixel of the dab. If \p opacity is
+     * not negative, it replaces the opacity of the color.
+     */
+    void addPixel(int x, int y, qreal opacity = -1.0);
+
+    /**
+     * Adds a Wu particle, i.e. four pixels weighted by the distance to
+     * the point
+     */
+    void addWuParticle(qreal x, qreal y);
+
+    bool isEmpty() const;
+
+    /**
+     * Paints the particles into \p dab. The work is split between
+     * \p maxNumThreads threads of the stroke if the dab is big enough.
+     */
+    void rasterize(KisPaintDeviceSP dab,
+                   KisRunnableStrokeJobsInterface *jobsInterface,
+                   int maxNumThreads);
+
+private:
+    enum Shape {
+        Ellipse,
+        Rectangle,
+        Pixel
+    };
+
+    struct Particle {
+        Shape shape;
+        float x;
+        float y;
+        float halfWidth;
+        float halfHeight;
+        float cosAngle;
+        float sinAngle;
+        qreal opacity;
+        int colorOffset;
+        QRect bounds;
+    };
+
+    void addShape(Shape shape, qreal x, qreal y, qreal halfWidth, qreal halfHeight, qreal angle, qreal opacity);
+    void rasterizeArea(KisRandomAccessorSP accessor, const QRect &area, const QVector<int> &particles) const;
+
+private:
+    const KoColorSpace *m_colorSpace {nullptr};
+    int m_pixelSize {0};
+
+    QVector<Particle> m_particles;
+    QVector<quint8> m_colors;
+    int m_currentColorOffset {-1};
+    qint64 m_totalArea {0};
+};
+
+#endif // KISSPRAYPARTICLEBATCH_H
@@ -110,7 +110,8 @@ KisSpacingInformation KisSprayPaintOp::paintAt(const KisPaintInformation& info)
                        rotation,
                        scale, lodScale,
                        painter()->paintColor(),
-                       painter()->backgroundColor());
+                       painter()->backgroundColor(),
+                       painter()->runnableStrokeJobsInterface());
 
     QRect rc = m_dab->extent();
     painter()->bitBlt(rc.topLeft(), m_dab, rc);
@@ -30,6 +30,7 @@
 #include <kis_cross_device_color_sampler.h>
 
 #include "kis_spray_paintop_settings.h"
+#include "kis_image_config.h"
 
 #include <cmath>
 #include <ctime>
@@ -37,6 +38,7 @@
 #include <QtGlobal>
 
 SprayBrush::SprayBrush()
+    : m_maxNumThreads(KisImageConfig(true).maxNumberOfThreads())
 {
     m_painter = nullptr;
     m_transfo = nullptr;
@@ -93,12 +95,13 @@ void SprayBrush::paint(KisPaintDeviceSP dab, KisPaintDeviceSP source,
                        const KisPaintInformation& info,
                        qreal rotation, qreal scale,
                        qreal additionalScale,
-                       const KoColor &color, const KoColor &bgColor)
+                       const KoColor &color, const KoColor &bgColor,
+                       KisRunnableStrokeJobsInterface *jobsInterface)
 {
     if (m_sprayOpOption->data.angularDistributionType == KisSprayOpOptionData::ParticleDistribution_Uniform) {
-        paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor, m_sprayOpOption->m_uniformDistribution);
+        paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor, jobsInterface, m_sprayOpOption->m_uniformDistribution);
     } else {
-        paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor, m_sprayOpOption->m_angularCurveBasedDistribution);
+        paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor, jobsInterface, m_sprayOpOption->m_angularCurveBasedDistribution);
     }
 }
 
@@ -109,29 +112,30 @@ void SprayBrush::paintImpl(KisPaintDeviceSP dab, KisPaintDeviceSP source,
                            qreal additionalScale,
                            const KoColor &color,
                            const KoColor &bgColor,
+                           KisRunnableStrokeJobsInterface *jobsInterface,
                            const AngularDistribution &angularDistribution)
 {
     if (m_sprayOpOption->data.radialDistributionType == KisSprayOpOptionData::ParticleDistribution_Uniform) {
         if (m_sprayOpOption->data.radialDistributionCenterBiased) {
-            paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor,
+            paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor, jobsInterface,
                       angularDistribution, m_sprayOpOption->m_uniformDistribution);
         } else {
-            paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor,
+            paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor, jobsInterface,
                       angularDistribution, m_sprayOpOption->m_uniformDistributionPolarDistance);
         }
     } else if (m_sprayOpOption->data.radialDistributionType == KisSprayOpOptionData::ParticleDistribution_Gaussian) {
         if (m_sprayOpOption->data.radialDistributionCenterBiased) {
-            paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor,
+            paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor, jobsInterface,
                       angularDistribution, m_sprayOpOption->m_normalDistribution);
         } else {
-            paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor,
+            paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor, jobsInterface,
                       angularDistribution, m_sprayOpOption->m_normalDistributionPolarDistance);
         }
     } else if (m_sprayOpOption->data.radialDistributionType == KisSprayOpOptionData::ParticleDistribution_ClusterBased) {
-        paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor,
+        paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor, jobsInterface,
                   angularDistribution, m_sprayOpOption->m_clusterBasedDistributionPolarDistance);
     } else {
-        paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor,
+        paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor, jobsInterface,
                   angularDistribution, m_sprayOpOption->m_radialCurveBasedDistributionPolarDistance);
     }
 }
@@ -143,6 +147,7 @@ void SprayBrush::paintImpl(KisPaintDeviceSP dab, KisPaintDeviceSP source,
                            qreal additionalScale,
                            const KoColor &color,
                            const KoColor &bgColor,
+                           KisRunnableStrokeJobsInterface *jobsInterface,
                            const AngularDistribution &angularDistribution,
                            const RadialDistribution &radialDistribution)
 {
@@ -174,7 +179,8 @@ void SprayBrush::paintImpl(KisPaintDeviceSP dab, KisPaintDeviceSP source,
 
     qreal x = info.pos().x();
     qreal y = info.pos().y();
-    KisRandomAccessorSP accessor = dab->createRandomAccessorNG();
+
+    m_particles.reset(dab->colorSpace());
 
     Q_ASSERT(color.colorSpace()->pixelSize() == dab->pixelSize());
     m_inkColor = color;
@@ -310,31 +316,33 @@ void SprayBrush::paintImpl(KisPaintDeviceSP dab, KisPaintDeviceSP source,
             // ellipse
             case 0:
             {
+                m_particles.setColor(m_inkColor.data());
+
                 if (effectiveSize.width() == effectiveSize.height()){
-                    paintCircle(m_painter, nx + x, ny + y, jitteredWidth * 0.5);
+                    m_particles.addEllipse(nx + x, ny + y, jitteredWidth * 0.5, jitteredWidth * 0.5, 0.0, m_painter->opacityF());
                 }
                 else {
-                    paintEllipse(m_painter, nx + x, ny + y, jitteredWidth * 0.5 , jitteredHeight * 0.5, rotationZ);
+                    m_particles.addEllipse(nx + x, ny + y, jitteredWidth * 0.5 , jitteredHeight * 0.5, rotationZ, m_painter->opacityF());
                 }
                 break;
             }
             // rectangle
             case 1:
             {
-                paintRectangle(m_painter, nx + x, ny + y, qRound(jitteredWidth) , qRound(jitteredHeight), rotationZ);
+                m_particles.setColor(m_inkColor.data());
+                m_particles.addRectangle(nx + x, ny + y, qRound(jitteredWidth) , qRound(jitteredHeight), rotationZ, m_painter->opacityF());
                 break;
             }
             // wu-particle
             case 2: {
-                paintParticle(accessor, m_inkColor, nx + x, ny + y);
+                m_particles.setColor(m_inkColor.data());
+                m_particles.addWuParticle(nx + x, ny + y);
                 break;
             }
             // pixel
             case 3: {
-                ix = qRound(nx + x);
-                iy = qRound(ny + y);
-                accessor->moveTo(ix, iy);
-                memcpy(accessor->rawData(), m_inkColor.data(), m_dabPixelSize);
+                m_particles.setColor(m_inkColor.data());
+                m_particles.addPixel(qRound(nx + x), qRound(ny + y));
                 break;
             }
             case 4: {
@@ -412,47 +420,14 @@ void SprayBrush::paintImpl(KisPaintDeviceSP dab, KisPaintDeviceSP source,
     }
     // recover from jittering of color,
     // m_inkColor.opacity is recovered with every paint
+
+    if (!m_particles.isEmpty()) {
+        m_particles.rasterize(dab, jobsInterface, m_maxNumThreads);
+    }
 }
 
 
 
-void SprayBrush::paintParticle(KisRandomAccessorSP &writeAccessor, const KoColor &color, qreal rx, qreal ry)
-{
-    // opacity top left, right, bottom left, right
-    KoColor pcolor(color);
-    //int opacity = pcolor.opacityU8();
-
-    int ipx = int (rx);
-    int ipy = int (ry);
-    qreal fx = rx - ipx;
-    qreal fy = ry - ipy;
-
-    qreal btl = (1 - fx) * (1 - fy);
-    qreal btr = (fx)  * (1 - fy);
-    qreal bbl = (1 - fx) * (fy);
-    qreal bbr = (fx)  * (fy);
-
-    // this version overwrite pixels, e.g. when it sprays two particle next
-    // to each other, the pixel with lower opacity can override other pixel.
-    // Maybe some kind of compositing using here would be cool
-
-    pcolor.setOpacity(btl);
-    writeAccessor->moveTo(ipx  , ipy);
-    memcpy(writeAccessor->rawData(), pcolor.data(), m_dabPixelSize);
-
-    pcolor.setOpacity(btr);
-    writeAccessor->moveTo(ipx + 1, ipy);
-    memcpy(writeAccessor->rawData(), pcolor.data(), m_dabPixelSize);
-
-    pcolor.setOpacity(bbl);
-    writeAccessor->moveTo(ipx, ipy + 1);
-    memcpy(writeAccessor->rawData(), pcolor.data(), m_dabPixelSize);
-
-    pcolor.setOpacity(bbr);
-    writeAccessor->moveTo(ipx + 1, ipy + 1);
-    memcpy(writeAccessor->rawData(), pcolor.data(), m_dabPixelSize);
-}
-
 void SprayBrush::paintCircle(KisPainter* painter, qreal x, qreal y, qreal radius)
 {
     QPainterPath path;
@@ -461,29 +436,6 @@ void SprayBrush::paintCircle(KisPainter* painter, qreal x, qreal y, qreal radius
 }
 
 
-void SprayBrush::paintEllipse(KisPainter* painter, qreal x, qreal y, qreal a, qreal b, qreal angle)
-{
-    QPainterPath path;
-    path.addEllipse(QPointF(), a, b);
-    QTransform t;
-    t.translate(x, y);
-    t.rotateRadians(angle);
-    path = t.map(path);
-    painter->fillPainterPath(path);
-}
-
-void SprayBrush::paintRectangle(KisPainter* painter, qreal x, qreal y, qreal width, qreal height, qreal angle)
-{
-    QPainterPath path;
-    path.addRect(QRectF(-0.5 * width, -0.5 * height, width, height));
-    QTransform t;
-    t.translate(x, y);
-    t.rotateRadians(angle);
-    path = t.map(path);
-    painter->fillPainterPath(path);
-}
-
-
 void SprayBrush::paintOutline(KisPaintDeviceSP dev , const KoColor &outlineColor, qreal posX, qreal posY, qreal radius)
 {
     QList<QPointF> antiPixels;
@@ -18,6 +18,7 @@
 #include "KisSprayOpOption.h"
 #include "KisSprayShapeDynamicsOptionData.h"
 #include "KisSprayShapeOptionData.h"
+#include "KisSprayParticleBatch.h"
 
 
 
@@ -27,6 +28,7 @@
 #include <kis_brush.h>
 
 class KisPaintInformation;
+class KisRunnableStrokeJobsInterface;
 
 class SprayBrush
 {
@@ -42,7 +44,8 @@ public:
                qreal scale,
                qreal additionalScale,
                const KoColor &color,
-               const KoColor &bgColor);
+               const KoColor &bgColor,
+               KisRunnableStrokeJobsInterface *jobsInterface = nullptr);
     void setProperties(KisSprayOpOptionData * properties,
                        KisColorOptionData * colorProperties,
                        KisSprayShapeOptionData * shapeProperties,
@@ -74,6 +77,9 @@ private:
     KisBrushSP m_brush;
     KisFixedPaintDeviceSP m_fixedDab;
 
+    KisSprayParticleBatch m_particles;
+    int m_maxNumThreads {1};
+
 private:
     template <typename AngularDistribution>
     void paintImpl(KisPaintDeviceSP dab,
@@ -84,6 +90,7 @@ private:
                    qreal additionalScale,
                    const KoColor &color,
                    const KoColor &bgColor,
+                   KisRunnableStrokeJobsInterface *jobsInterface,
                    const AngularDistribution &angularDistribution);
     template <typename AngularDistribution, typename RadialDistribution>
     void paintImpl(KisPaintDeviceSP dab,
@@ -94,15 +101,12 @@ private:
                    qreal additionalScale,
                    const KoColor &color,
                    const KoColor &bgColor,
+                   KisRunnableStrokeJobsInterface *jobsInterface,
                    const AngularDistribution &angularDistribution,
                    const RadialDistribution &radialDistribution);
     /// rotation in radians according the settings (gauss distribution, uniform distribution or fixed angle)
     qreal rotationAngle(KisRandomSourceSP randomSource);
-    /// Paints Wu Particle
-    void paintParticle(KisRandomAccessorSP &writeAccessor, const KoColor &color, qreal rx, qreal ry);
     void paintCircle(KisPainter * painter, qreal x, qreal y, qreal radius);
-    void paintEllipse(KisPainter * painter, qreal x, qreal y, qreal a, qreal b, qreal angle);
-    void paintRectangle(KisPainter * painter, qreal x, qreal y, qreal width, qreal height, qreal angle);
 
     void paintOutline(KisPaintDeviceSP dev, const KoColor& painterColor, qreal posX, qreal posY, qreal radius);
 
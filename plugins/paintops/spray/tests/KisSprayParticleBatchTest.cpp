@@ -0,0 +1,491 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#include "KisSprayParticleBatchTest.h"
+
+#include <thread>
+#include <vector>
+
+#include <QPainterPath>
+#include <QRandomGenerator>
+#include <QTransform>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoColorSpaceTraits.h>
+
+#include <kis_default_bounds_base.h>
+#include <kis_paint_device.h>
+#include <kis_painter.h>
+#include <kis_random_accessor_ng.h>
+#include <KisRunnableStrokeJobDataBase.h>
+#include <KisRunnableStrokeJobsInterface.h>
+
+#include "../KisSprayParticleBatch.h"
+
+namespace {
+
+enum ParticleType {
+    Ellipse,
+    Rectangle,
+    Pixel,
+    PixelWithOpacity,
+    WuParticle
+};
+
+struct TestParticle {
+    ParticleType type;
+    qreal x;
+    qreal y;
+    qreal width;
+    qreal height;
+    qreal angle;
+    qreal opacity;
+    int colorIndex;
+};
+
+QVector<KoColor> testColors(const KoColorSpace *cs)
+{
+    return {
+        KoColor(QColor(255, 0, 0, 255), cs),
+        KoColor(QColor(0, 255, 0, 128), cs),
+        KoColor(QColor(0, 0, 255, 200), cs),
+        KoColor(QColor(30, 60, 90, 64), cs),
+        KoColor(QColor(250, 200, 10, 16), cs)
+    };
+}
+
+/**
+ * The particles are spread over several tiles, including the ones at
+ * negative coordinates, so that many of them cross the borders of
+ * the tiles and are painted in several bins.
+ */
+QVector<TestParticle> generateParticles(int numParticles, const QRect &area,
+                                        const QVector<ParticleType> &types, int numColors)
+{
+    QRandomGenerator rng(1234);
+
+    QVector<TestParticle> particles;
+
+    for (int i = 0; i < numParticles; i++) {
+        TestParticle p;
+        p.type = types[rng.bounded(types.size())];
+        p.x = area.x() + rng.generateDouble() * area.width();
+        p.y = area.y() + rng.generateDouble() * area.height();
+        p.angle = rng.generateDouble() * 2.0 * M_PI;
+        p.opacity = 0.2 + 0.8 * rng.generateDouble();
+        p.colorIndex = rng.bounded(numColors);
+
+        if (p.type == Ellipse) {
+            p.width = 2.0 + 10.0 * rng.generateDouble();
+            p.height = 2.0 + 10.0 * rng.generateDouble();
+        } else {
+            // the rectangles of SprayBrush have integer sizes
+            p.width = 4 + rng.bounded(21);
+            p.height = 4 + rng.bounded(21);
+        }
+
+        particles.append(p);
+    }
+
+    return particles;
+}
+
+void addParticles(KisSprayParticleBatch &batch, const KoColorSpace *cs,
+                  const QVector<TestParticle> &particles)
+{
+    const QVector<KoColor> colors = testColors(cs);
+
+    batch.reset(cs);
+
+    for (const TestParticle &p : particles) {
+        batch.setColor(colors[p.colorIndex].data());
+
+        switch (p.type) {
+        case Ellipse:
+            batch.addEllipse(p.x, p.y, p.width, p.height, p.angle, p.opacity);
+            break;
+        case Rectangle:
+            batch.addRectangle(p.x, p.y, p.width, p.height, p.angle, p.opacity);
+            break;
+        case Pixel:
+            batch.addPixel(qRound(p.x), qRound(p.y));
+            break;
+        case PixelWithOpacity:
+            batch.addPixel(qRound(p.x), qRound(p.y), p.opacity);
+            break;
+        case WuParticle:
+            batch.addWuParticle(p.x, p.y);
+            break;
+        }
+    }
+}
+
+/**
+ * Paints the particles one by one, the way SprayBrush did it before
+ * they were batched: the shapes are filled with KisPainter as painter
+ * paths, the pixels are written with a random accessor.
+ */
+void referenceRasterize(KisPaintDeviceSP dab, const QVector<TestParticle> &particles)
+{
+    const KoColorSpace *cs = dab->colorSpace();
+    const int pixelSize = cs->pixelSize();
+    const QVector<KoColor> colors = testColors(cs);
+
+    KisPainter painter(dab);
+    painter.setFillStyle(KisPainter::FillStyleForegroundColor);
+
+    KisRandomAccessorSP accessor = dab->createRandomAccessorNG();
+
+    auto writePixel = [&] (int x, int y, KoColor color, qreal opacity) {
+        if (opacity >= 0.0) {
+            color.setOpacity(opacity);
+        }
+        accessor->moveTo(x, y);
+        memcpy(accessor->rawData(), color.data(), pixelSize);
+    };
+
+    for (const TestParticle &p : particles) {
+        const KoColor &color = colors[p.colorIndex];
+
+        switch (p.type) {
+        case Ellipse:
+        case Rectangle: {
+            QPainterPath path;
+            if (p.type == Ellipse) {
+                path.addEllipse(QPointF(), p.width, p.height);
+            } else {
+                path.addRect(QRectF(-0.5 * p.width, -0.5 * p.height, p.width, p.height));
+            }
+
+            QTransform t;
+            t.translate(p.x, p.y);
+            t.rotateRadians(p.angle);
+
+            painter.setPaintColor(color);
+            painter.setOpacityF(p.opacity);
+            painter.fillPainterPath(t.map(path));
+            break;
+        }
+        case Pixel:
+            writePixel(qRound(p.x), qRound(p.y), color, -1.0);
+            break;
+        case PixelWithOpacity:
+            writePixel(qRound(p.x), qRound(p.y), color, p.opacity);
+            break;
+        case WuParticle: {
+            const int ipx = int(p.x);
+            const int ipy = int(p.y);
+            const qreal fx = p.x - ipx;
+            const qreal fy = p.y - ipy;
+
+            writePixel(ipx, ipy, color, (1 - fx) * (1 - fy));
+            writePixel(ipx + 1, ipy, color, fx * (1 - fy));
+            writePixel(ipx, ipy + 1, color, (1 - fx) * fy);
+            writePixel(ipx + 1, ipy + 1, color, fx * fy);
+            break;
+        }
+        }
+    }
+}
+
+QVector<quint8> readBytes(KisPaintDeviceSP dev, const QRect &rect)
+{
+    QVector<quint8> bytes(rect.width() * rect.height() * dev->pixelSize());
+    dev->readBytes(bytes.data(), rect);
+    return bytes;
+}
+
+bool compareDevices(KisPaintDeviceSP dev1, KisPaintDeviceSP dev2, const QRect &rect)
+{
+    return readBytes(dev1, rect) == readBytes(dev2, rect);
+}
+
+/**
+ * The coverage of the batched shapes is estimated analytically, while
+ * KisPainter rasterizes the painter paths with QPainter, so the pixels
+ * on the edges of the shapes differ slightly. For an isolated shape the
+ * estimated coverage is within 0.1 of the exact area coverage, i.e.
+ * within 26 of 255, and it is exact inside the shapes.
+ *
+ * Compares the premultiplied 8-bit channels with \p fuzzy tolerance and
+ * checks that the mean difference of the alpha over the painted pixels
+ * is below \p maxMeanAlphaDifference.
+ */
+bool compareDevicesFuzzy(KisPaintDeviceSP dev1, KisPaintDeviceSP dev2, const QRect &rect,
+                         int fuzzy, qreal maxMeanAlphaDifference)
+{
+    const QVector<quint8> bytes1 = readBytes(dev1, rect);
+    const QVector<quint8> bytes2 = readBytes(dev2, rect);
+
+    const KoBgrU8Traits::Pixel *pixels1 = reinterpret_cast<const KoBgrU8Traits::Pixel*>(bytes1.constData());
+    const KoBgrU8Traits::Pixel *pixels2 = reinterpret_cast<const KoBgrU8Traits::Pixel*>(bytes2.constData());
+
+    auto premultiplied = [] (int channel, int alpha) {
+        return (channel * alpha + 127) / 255;
+    };
+
+    qint64 alphaDifference = 0;
+    int numPaintedPixels = 0;
+    bool result = true;
+
+    for (int i = 0; i < rect.width() * rect.height(); i++) {
+        const KoBgrU8Traits::Pixel &p1 = pixels1[i];
+        const KoBgrU8Traits::Pixel &p2 = pixels2[i];
+
+        if (!p1.alpha && !p2.alpha) continue;
+
+        numPaintedPixels++;
+        alphaDifference += qAbs(p1.alpha - p2.alpha);
+
+        const int maxDifference =
+            qMax(qMax(qAbs(premultiplied(p1.red, p1.alpha) - premultiplied(p2.red, p2.alpha)),
+                      qAbs(premultiplied(p1.green, p1.alpha) - premultiplied(p2.green, p2.alpha))),
+                 qMax(qAbs(premultiplied(p1.blue, p1.alpha) - premultiplied(p2.blue, p2.alpha)),
+                      qAbs(p1.alpha - p2.alpha)));
+
+        if (maxDifference > fuzzy && result) {
+            qWarning() << "Pixels differ at" << rect.x() + i % rect.width() << rect.y() + i / rect.width()
+                       << "by" << maxDifference;
+            result = false;
+        }
+    }
+
+    const qreal meanAlphaDifference = numPaintedPixels ? qreal(alphaDifference) / numPaintedPixels : 0.0;
+
+    if (meanAlphaDifference > maxMeanAlphaDifference) {
+        qWarning() << "Mean alpha difference is" << meanAlphaDifference;
+        result = false;
+    }
+
+    return result && numPaintedPixels > 0;
+}
+
+/**
+ * The maximum difference of a premultiplied channel between the shapes
+ * rasterized by the batch and by KisPainter, allowing for the errors
+ * of the overlapping shapes and the rounding of the 8-bit mask
+ */
+const int shapesFuzzy = 40;
+const qreal shapesMaxMeanAlphaDifference = 3.0;
+
+/**
+ * Starts every job in its own thread right away
+ */
+struct ThreadedJobsInterface : public KisRunnableStrokeJobsInterface
+{
+    ~ThreadedJobsInterface() override {
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+    }
+
+    void addRunnableJobs(const QVector<KisRunnableStrokeJobDataBase*> &list) override {
+        for (KisRunnableStrokeJobDataBase *job : list) {
+            threads.emplace_back([job] () {
+                job->run();
+                delete job;
+            });
+        }
+    }
+
+    std::vector<std::thread> threads;
+};
+
+/**
+ * Collects the jobs without running them
+ */
+struct DeferredJobsInterface : public KisRunnableStrokeJobsInterface
+{
+    ~DeferredJobsInterface() override {
+        qDeleteAll(jobs);
+    }
+
+    void addRunnableJobs(const QVector<KisRunnableStrokeJobDataBase*> &list) override {
+        jobs += list;
+    }
+
+    QVector<KisRunnableStrokeJobDataBase*> jobs;
+};
+
+struct WrapAroundDefaultBounds : public KisDefaultBoundsBase
+{
+    QRect bounds() const override {
+        return QRect(0, 0, 100, 100);
+    }
+    bool wrapAroundMode() const override {
+        return true;
+    }
+    WrapAroundAxis wrapAroundModeAxis() const override {
+        return WRAPAROUND_BOTH;
+    }
+    int currentLevelOfDetail() const override {
+        return 0;
+    }
+    int currentTime() const override {
+        return 0;
+    }
+    bool externalFrameActive() const override {
+        return false;
+    }
+    void * sourceCookie() const override {
+        return 0;
+    }
+};
+
+KisPaintDeviceSP createWrapAroundDevice(const KoColorSpace *cs)
+{
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->setDefaultBounds(new WrapAroundDefaultBounds());
+    dev->setSupportsWraparoundMode(true);
+    return dev;
+}
+
+/**
+ * Checks that the threads paint exactly the same pixels as the serial
+ * path, the tiles are independent
+ */
+void checkConcurrentPath(KisSprayParticleBatch &batch, KisPaintDeviceSP serialDab, const QRect &area)
+{
+    const KoColorSpace *cs = serialDab->colorSpace();
+    KisPaintDeviceSP dab = new KisPaintDevice(cs);
+
+    {
+        ThreadedJobsInterface jobsInterface;
+        batch.rasterize(dab, &jobsInterface, 4);
+        QCOMPARE(jobsInterface.threads.size(), size_t(3));
+    }
+
+    QVERIFY(compareDevices(dab, serialDab, area));
+}
+
+}
+
+void KisSprayParticleBatchTest::testShapes_data()
+{
+    QTest::addColumn<QVector<int>>("types");
+
+    QTest::newRow("ellipse") << QVector<int>{Ellipse};
+    QTest::newRow("rectangle") << QVector<int>{Rectangle};
+    QTest::newRow("mixed") << QVector<int>{Ellipse, Rectangle};
+}
+
+void KisSprayParticleBatchTest::testShapes()
+{
+    QFETCH(QVector<int>, types);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    QVector<ParticleType> particleTypes;
+    for (int type : types) {
+        particleTypes.append(ParticleType(type));
+    }
+
+    const QRect area(-150, -100, 300, 200);
+    const QRect checkRect = area.adjusted(-20, -20, 20, 20);
+    const QVector<TestParticle> particles = generateParticles(400, area, particleTypes, testColors(cs).size());
+
+    KisPaintDeviceSP reference = new KisPaintDevice(cs);
+    referenceRasterize(reference, particles);
+
+    KisSprayParticleBatch batch;
+    addParticles(batch, cs, particles);
+
+    KisPaintDeviceSP dab = new KisPaintDevice(cs);
+    batch.rasterize(dab, nullptr, 1);
+
+    QVERIFY(compareDevicesFuzzy(dab, reference, checkRect, shapesFuzzy, shapesMaxMeanAlphaDifference));
+
+    checkConcurrentPath(batch, dab, checkRect);
+}
+
+void KisSprayParticleBatchTest::testPixels_data()
+{
+    QTest::addColumn<int>("type");
+
+    QTest::newRow("pixel") << int(Pixel);
+    QTest::newRow("pixel-opacity") << int(PixelWithOpacity);
+    QTest::newRow("wu-particle") << int(WuParticle);
+}
+
+void KisSprayParticleBatchTest::testPixels()
+{
+    QFETCH(int, type);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    // a few particles per pixel, so that the order of the writes matters
+    const QRect area(-150, -100, 300, 200);
+    const QRect checkRect = area.adjusted(-2, -2, 2, 2);
+    const QVector<TestParticle> particles =
+        generateParticles(type == WuParticle ? 20000 : 80000, area, {ParticleType(type)}, testColors(cs).size());
+
+    KisPaintDeviceSP reference = new KisPaintDevice(cs);
+    referenceRasterize(reference, particles);
+
+    KisSprayParticleBatch batch;
+    addParticles(batch, cs, particles);
+
+    KisPaintDeviceSP dab = new KisPaintDevice(cs);
+    batch.rasterize(dab, nullptr, 1);
+
+    // the pixels are written the same way, so there should be no difference
+    QVERIFY(compareDevices(dab, reference, checkRect));
+
+    checkConcurrentPath(batch, dab, checkRect);
+}
+
+void KisSprayParticleBatchTest::testWrapAroundFallback_data()
+{
+    QTest::addColumn<QVector<int>>("types");
+    QTest::addColumn<bool>("exact");
+
+    QTest::newRow("shapes") << QVector<int>{Ellipse, Rectangle} << false;
+    QTest::newRow("pixels") << QVector<int>{Pixel, PixelWithOpacity, WuParticle} << true;
+}
+
+void KisSprayParticleBatchTest::testWrapAroundFallback()
+{
+    QFETCH(QVector<int>, types);
+    QFETCH(bool, exact);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    QVector<ParticleType> particleTypes;
+    for (int type : types) {
+        particleTypes.append(ParticleType(type));
+    }
+
+    // the area is bigger than the wrap rect, so different bins
+    // of the area map onto the same tile of the device
+    const QRect area(-150, -100, 300, 200);
+    const QRect wrapRect(0, 0, 100, 100);
+    const QVector<TestParticle> particles =
+        generateParticles(exact ? 80000 : 400, area, particleTypes, testColors(cs).size());
+
+    KisPaintDeviceSP reference = createWrapAroundDevice(cs);
+    referenceRasterize(reference, particles);
+
+    KisSprayParticleBatch batch;
+    addParticles(batch, cs, particles);
+
+    KisPaintDeviceSP dab = createWrapAroundDevice(cs);
+
+    DeferredJobsInterface jobsInterface;
+    batch.rasterize(dab, &jobsInterface, 4);
+
+    // everything should be rasterized serially by the calling thread,
+    // in the order the particles were added
+    QVERIFY(jobsInterface.jobs.isEmpty());
+
+    if (exact) {
+        QVERIFY(compareDevices(dab, reference, wrapRect));
+    } else {
+        QVERIFY(compareDevicesFuzzy(dab, reference, wrapRect, shapesFuzzy, shapesMaxMeanAlphaDifference));
+    }
+}
+
+SIMPLE_TEST_MAIN(KisSprayParticleBatchTest)
@@ -0,0 +1,25 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita Contributors
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef KISSPRAYPARTICLEBATCHTEST_H
+#define KISSPRAYPARTICLEBATCHTEST_H
+
+#include <simpletest.h>
+
+class KisSprayParticleBatchTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testShapes_data();
+    void testShapes();
+
+    void testPixels_data();
+    void testPixels();
+
+    void testWrapAroundFallback_data();
+    void testWrapAroundFallback();
+};
+
+#endif // KISSPRAYPARTICLEBATCHTEST_H